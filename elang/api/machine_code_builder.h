@@ -26,6 +26,13 @@ class MachineCodeBuilder {
   virtual void EmitCode(const uint8_t* codes, size_t code_size) = 0;
   virtual void FinishCode() = 0;
   virtual void PrepareCode(size_t code_size) = 0;
+
+  // Reserves |code_size| bytes of memory for machine code and returns it.
+  // Code emitter writes machine code into returned memory directly instead of
+  // calling |PrepareCode()| and |EmitCode()|, then calls |SetXXX()| functions
+  // to fix references in place.
+  virtual uint8_t* ReserveCode(size_t code_size) = 0;
+
   virtual void SetCallSite(size_t offset, base::StringPiece16 string) = 0;
   virtual void SetCodeOffset(size_t offset, size_t target_offset) = 0;
   virtual void SetFloat32(size_t offset, float32_t float32) = 0;
@@ -47,21 +47,16 @@ class WorkList {
   DISALLOW_COPY_AND_ASSIGN(WorkList);
 };
 
-#ifndef NDEBUG
-template <typename Element>
-bool WorkList<Element>::Contains(const Element* element) const {
-  return !!static_cast<const Item*>(element)->previous_element_;
-}
-#else
 template <typename Element>
 bool WorkList<Element>::Contains(const Element* element) const {
-  auto const item = static_cast<Item*>(element);
-  if (!item->work_list)
+  auto const item = static_cast<const Item*>(element);
+  if (!item->previous_element_)
     return false;
-  DCHECK_EQ(item->work_list, this);
+#ifndef NDEBUG
+  DCHECK_EQ(item->work_list_, this);
+#endif
   return true;
 }
-#endif
 
 template <typename Element>
 Element* WorkList<Element>::Pop() {
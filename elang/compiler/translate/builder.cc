@@ -377,6 +377,11 @@ void Builder::EndBlockWithRet(ir::Data* data) {
   EndBlock(ret_node);
 }
 
+void Builder::EndBlockWithThrow(ir::Data* value) {
+  DCHECK(basic_block_);
+  EndBlock(editor_->SetThrow(value));
+}
+
 void Builder::EndLoopBlock(ir::Data* condition,
                            ir::Control* true_target_node,
                            ir::Control* false_target_node) {
@@ -409,6 +414,11 @@ Builder::BasicBlock* Builder::NewBasicBlock(ir::Control* start_node,
   return basic_block;
 }
 
+ir::Data* Builder::NewElement(ir::Data* array, ir::Node* indexes) {
+  DCHECK(basic_block_);
+  return editor_->NewElement(array, indexes, basic_block_->start_node());
+}
+
 ir::Data* Builder::NewLoad(ir::Data* anchor, ir::Data* pointer) {
   DCHECK(basic_block_);
   return editor_->NewLoad(basic_block_->effect(), anchor, pointer);
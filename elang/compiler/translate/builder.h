@@ -45,6 +45,7 @@ class Builder final : public ZoneOwner {
   ir::Control* EndBlockWithBranch(ir::Data* condition);
   ir::Control* EndBlockWithJump(ir::Control* target);
   void EndBlockWithRet(ir::Data* data);
+  void EndBlockWithThrow(ir::Data* value);
   void EndLoopBlock(ir::Data* condition,
                     ir::Control* true_target,
                     ir::Control* false_target);
@@ -61,6 +62,10 @@ class Builder final : public ZoneOwner {
   ir::Data* NewLoad(ir::Data* anchor, ir::Data* pointer);
   void NewStore(ir::Data* anchor, ir::Data* pointer, ir::Data* new_value);
 
+  // Returns element pointer which isn't computed before start of current
+  // block, e.g. 'if_true' of bounds check.
+  ir::Data* NewElement(ir::Data* array, ir::Node* indexes);
+
   // Variable management
   void AssignVariable(sm::Variable* variable, ir::Data* value);
   void BindVariable(sm::Variable* variable, ir::Data* value);
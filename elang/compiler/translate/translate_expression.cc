@@ -2,7 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <sstream>
 #include <vector>
 
 #include "elang/compiler/translate/translator.h"
@@ -10,7 +9,6 @@
 #include "base/auto_reset.h"
 #include "base/containers/adapters.h"
 #include "base/logging.h"
-#include "base/strings/utf_string_conversions.h"
 #include "elang/base/atomic_string.h"
 #include "elang/compiler/analysis/analysis.h"
 #include "elang/compiler/ast/class.h"
@@ -173,7 +171,26 @@ Translator::Reference Translator::TranslateElement(ast::ArrayAccess* element) {
   indexes.resize(0);
   for (auto const index : element->indexes())
     indexes.push_back(Translate(index));
-  auto const element_pointer = NewElement(array, NewDataOrTuple(indexes));
+  // Emit bounds check for each dimension. Since we compare index and length
+  // as unsigned integer, negative index is also out of range.
+  for (auto rank = 0u; rank < indexes.size(); ++rank) {
+    auto const index = indexes[rank]->as<ir::Data>();
+    auto const index_type =
+        index->output_type()->as<ir::PrimitiveValueType>();
+    DCHECK(index_type) << *index;
+    auto const compare_type =
+        index_type->bit_size() == 64 ? uint64_type() : uint32_type();
+    auto const length = NewStaticCast(compare_type, NewLength(array, rank));
+    auto const in_range =
+        NewIntCmp(ir::IntCondition::UnsignedGreaterThan, length,
+                  NewStaticCast(compare_type, index));
+    auto const if_node = builder_->EndBlockWithBranch(in_range);
+    builder_->StartIfBlock(NewIfFalse(if_node));
+    builder_->EndBlockWithThrow(void_value());
+    builder_->StartIfBlock(NewIfTrue(if_node));
+  }
+  auto const element_pointer =
+      builder_->NewElement(array, NewDataOrTuple(indexes));
   return Reference{array, element_pointer};
 }
 
@@ -237,13 +254,8 @@ ir::Data* Translator::TranslateLiteral(ir::Type* type, const Token* token) {
 }
 
 ir::Data* Translator::TranslateMethodReference(sm::Method* method) {
-  // TODO(eval1749) We should calculate key as |base::string16| from
-  // |sm::Method|.
-  std::ostringstream ostream;
-  ostream << *method;
-  auto const method_name =
-      factory()->NewAtomicString(base::UTF8ToUTF16(ostream.str()));
-  return factory()->NewReference(MapType(method->signature()), method_name);
+  return factory()->NewReference(MapType(method->signature()),
+                                 MethodNameOf(method));
 }
 
 void Translator::TranslateVariable(ast::NamedNode* ast_variable) {
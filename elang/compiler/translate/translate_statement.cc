@@ -229,8 +229,10 @@ void Translator::VisitForEachStatement(ast::ForEachStatement* node) {
 
   auto const element_type = array_type->as<ir::ArrayType>()->element_type();
   auto const element_pointer_type = NewPointerType(element_type);
-  auto const start_element_pointer = NewElement(array, NewInt32(0));
-  auto const end_element_pointer = NewElement(array, NewLength(array, 0));
+  auto const start_element_pointer =
+      builder_->NewElement(array, NewInt32(0));
+  auto const end_element_pointer =
+      builder_->NewElement(array, NewLength(array, 0));
 
   builder_->BindVariable(pointer_variable, start_element_pointer);
   auto const head_compare =
@@ -49,6 +49,11 @@ std::string TranslateTest::FormatFunction(ir::Function* function) {
   return ostream.str();
 }
 
+ir::Function* TranslateTest::FunctionOf(base::StringPiece name) {
+  auto const ast_method = FindMember(name)->as<ast::Method>();
+  return ast_method ? session()->IrFunctionOf(ast_method) : nullptr;
+}
+
 std::string TranslateTest::GetFunction(base::StringPiece name) {
   auto const ast_method = FindMember(name)->as<ast::Method>();
   if (!ast_method)
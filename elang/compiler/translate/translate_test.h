@@ -46,10 +46,12 @@ class TranslateTest : public testing::AnalyzerTest,
 
   ir::Factory* factory() const { return factory_.get(); }
 
+  std::string FormatFunction(ir::Function* function);
+  // Returns IR function of method |name| or null if |name| isn't translated.
+  ir::Function* FunctionOf(base::StringPiece name);
   std::string Translate(base::StringPiece function_name);
 
  private:
-  std::string FormatFunction(ir::Function* function);
   std::string GetFunction(base::StringPiece name);
 
   const std::unique_ptr<ir::FactoryConfig> factory_config_;
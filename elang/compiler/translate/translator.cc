@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <sstream>
+
 #include "elang/compiler/translate/translator.h"
 
 #include "base/auto_reset.h"
@@ -76,6 +78,14 @@ ir::Type* Translator::MapType(sm::Type* type) const {
 }
 
 // The entry point of |Translator::|.
+AtomicString* Translator::MethodNameOf(sm::Method* method) {
+  // TODO(eval1749) We should calculate key as |base::string16| from
+  // |sm::Method|.
+  std::ostringstream ostream;
+  ostream << *method;
+  return factory()->NewAtomicString(base::UTF8ToUTF16(ostream.str()));
+}
+
 void Translator::Run() {
   session()->Apply(this);
 }
@@ -124,6 +134,7 @@ void Translator::VisitMethod(ast::Method* ast_method) {
   auto const function = factory()->NewFunction(
       type_mapper()->Map(method->function_signature())->as<ir::FunctionType>());
   session()->RegisterFunction(ast_method, function);
+  factory()->RegisterFunction(MethodNameOf(method), function);
 
   Builder builder(factory(), function);
   base::AutoReset<Builder*> builder_scope(&builder_, &builder);
@@ -56,6 +56,8 @@ class Translator final : public CompilationSessionUser,
   ir::Type* MapType(sm::Type* type) const;
 
   // Translate
+  // Returns name of |method| for referring |method| by |ir::ReferenceNode|.
+  AtomicString* MethodNameOf(sm::Method* method);
   ir::Node* NewDataOrTuple(const std::vector<ir::Node*> nodes);
   ir::Data* NewOperationFor(ast::Expression* node,
                             ir::Data* left,
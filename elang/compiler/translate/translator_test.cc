@@ -15,7 +15,9 @@
 #include "elang/compiler/semantics/factory.h"
 #include "elang/compiler/semantics/nodes.h"
 #include "elang/compiler/translate/type_mapper.h"
+#include "elang/optimizer/editor.h"
 #include "elang/optimizer/factory.h"
+#include "elang/optimizer/transforms/tail_call_pass.h"
 #include "elang/optimizer/type_factory.h"
 #include "elang/optimizer/types.h"
 
@@ -44,13 +46,21 @@ TEST_F(TranslatorTest, ArrayAccessLoad) {
   EXPECT_EQ(
       "function1 int32(int32[]*)\n"
       "0000: control(int32[]*) %c1 = entry()\n"
-      "0001: effect %e4 = get_effect(%c1)\n"
-      "0002: int32[]* %r5 = param(%c1, 0)\n"
-      "0003: int32* %r6 = element(%r5, 1)\n"
-      "0004: int32 %r7 = load(%e4, %r5, %r6)\n"
-      "0005: control %c8 = ret(%c1, %e4, %r7)\n"
-      "0006: control %c2 = merge(%c8)\n"
-      "0007: exit(%c2)\n",
+      "0001: int32[]* %r5 = param(%c1, 0)\n"
+      "0002: int32 %r6 = length(%r5, 0)\n"
+      "0003: uint32 %r7 = static_cast(%r6)\n"
+      "0004: uint32 %r8 = static_cast(1)\n"
+      "0005: bool %r9 = cmp_ugt(%r7, %r8)\n"
+      "0006: control %c10 = if(%c1, %r9)\n"
+      "0007: control %c11 = if_false(%c10)\n"
+      "0008: control %c12 = throw(%c11, void)\n"
+      "0009: control %c13 = if_true(%c10)\n"
+      "0010: effect %e4 = get_effect(%c1)\n"
+      "0011: int32* %r14 = element(%r5, 1, %c13)\n"
+      "0012: int32 %r15 = load(%e4, %r5, %r14)\n"
+      "0013: control %c16 = ret(%c13, %e4, %r15)\n"
+      "0014: control %c2 = merge(%c12, %c16)\n"
+      "0015: exit(%c2)\n",
       Translate("Sample.Foo"));
 }
 
@@ -62,13 +72,21 @@ TEST_F(TranslatorTest, ArrayAccessStore) {
   EXPECT_EQ(
       "function1 void(int32[]*)\n"
       "0000: control(int32[]*) %c1 = entry()\n"
-      "0001: effect %e4 = get_effect(%c1)\n"
-      "0002: int32[]* %r5 = param(%c1, 0)\n"
-      "0003: int32* %r6 = element(%r5, 1)\n"
-      "0004: effect %e7 = store(%e4, %r5, %r6, 42)\n"
-      "0005: control %c8 = ret(%c1, %e7, void)\n"
-      "0006: control %c2 = merge(%c8)\n"
-      "0007: exit(%c2)\n",
+      "0001: int32[]* %r5 = param(%c1, 0)\n"
+      "0002: int32 %r6 = length(%r5, 0)\n"
+      "0003: uint32 %r7 = static_cast(%r6)\n"
+      "0004: uint32 %r8 = static_cast(1)\n"
+      "0005: bool %r9 = cmp_ugt(%r7, %r8)\n"
+      "0006: control %c10 = if(%c1, %r9)\n"
+      "0007: control %c11 = if_false(%c10)\n"
+      "0008: control %c12 = throw(%c11, void)\n"
+      "0009: control %c13 = if_true(%c10)\n"
+      "0010: effect %e4 = get_effect(%c1)\n"
+      "0011: int32* %r14 = element(%r5, 1, %c13)\n"
+      "0012: effect %e15 = store(%e4, %r5, %r14, 42)\n"
+      "0013: control %c16 = ret(%c13, %e15, void)\n"
+      "0014: control %c2 = merge(%c12, %c16)\n"
+      "0015: exit(%c2)\n",
       Translate("Sample.Foo"));
 }
 
@@ -344,9 +362,9 @@ TEST_F(TranslatorTest, ForEach) {
       "function1 void(char[]*)\n"
       "0000: control(char[]*) %c1 = entry()\n"
       "0001: char[]* %r5 = param(%c1, 0)\n"
-      "0002: char* %r9 = element(%r5, 0)\n"
+      "0002: char* %r9 = element(%r5, 0, %c1)\n"
       "0003: int32 %r10 = length(%r5, 0)\n"
-      "0004: char* %r11 = element(%r5, %r10)\n"
+      "0004: char* %r11 = element(%r5, %r10, %c1)\n"
       "0005: bool %r12 = cmp_ult(%r9, %r11)\n"
       "0006: control %c13 = if(%c1, %r12)\n"
       "0007: control %c14 = if_false(%c13)\n"
@@ -537,6 +555,46 @@ TEST_F(TranslatorTest, ReturnParameter) {
       Translate("Sample.Foo"));
 }
 
+// Self tail call referred by name is converted to loop.
+TEST_F(TranslatorTest, TailCall) {
+  Prepare(
+      "class Sample {"
+      "  static int Sum(int n, int acc) {"
+      "    if (n == 0) return acc;"
+      "    return Sum(n - 1, acc + n);"
+      "  }"
+      "}");
+  Translate("Sample.Sum");
+  auto const function = FunctionOf("Sample.Sum");
+  ASSERT_TRUE(function);
+  ir::Editor editor(factory(), function);
+  ir::TailCallPass(&editor).Run();
+  EXPECT_EQ(
+      "function1 int32(int32, int32)\n"
+      "0000: control((int32, int32)) %c1 = entry()\n"
+      "0001: control %c22 = br(%c1)\n"
+      "0002: control %c12 = if_false(%c8)\n"
+      "0003: control %c13 = br(%c12)\n"
+      "0004: control %c9 = merge(%c13)\n"
+      "0005: control %c26 = br(%c9)\n"
+      "0006: control %c21 = loop(%c22, %c26)\n"
+      "0007: int32 %r5 = param(%c1, 0)\n"
+      "0008: int32 %r14 = sub(%r24, 1)\n"
+      "0009: int32 %r24 = phi(%c22: %r5, %c26: %r14)\n"
+      "0010: bool %r7 = cmp_eq(%r24, 0)\n"
+      "0011: control %c8 = if(%c21, %r7)\n"
+      "0012: control %c10 = if_true(%c8)\n"
+      "0013: effect %e4 = get_effect(%c1)\n"
+      "0014: effect %e23 = effect_phi(%c22: %e4, %c26: %e23)\n"
+      "0015: int32 %r6 = param(%c1, 1)\n"
+      "0016: int32 %r15 = add(%r25, %r24)\n"
+      "0017: int32 %r25 = phi(%c22: %r6, %c26: %r15)\n"
+      "0018: control %c11 = ret(%c10, %e23, %r25)\n"
+      "0019: control %c2 = merge(%c11)\n"
+      "0020: exit(%c2)\n",
+      FormatFunction(function));
+}
+
 TEST_F(TranslatorTest, While) {
   Prepare(
       "class Sample {"
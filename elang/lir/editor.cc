@@ -226,6 +226,7 @@ void Editor::DidChangeControlFlow() {
   using_control_flow_ = false;
   dominator_tree_.reset();
   post_dominator_tree_.reset();
+  conflict_map_.reset();
   liveness_data_.reset();
   pre_order_list_.reset();
   post_order_list_.reset();
@@ -233,12 +234,19 @@ void Editor::DidChangeControlFlow() {
   reverse_post_order_list_.reset();
 }
 
+void Editor::DidChangeOperands() {
+  conflict_map_.reset();
+  liveness_data_.reset();
+}
+
 void Editor::DidInsertInstruction() {
   is_index_valid_ = false;
+  DidChangeOperands();
 }
 
 void Editor::DidRemoveInstruction() {
   is_index_valid_ = false;
+  DidChangeOperands();
 }
 
 void Editor::DiscardBlock(BasicBlock* block) {
@@ -451,6 +459,7 @@ void Editor::SetInput(Instruction* instruction, int index, Value new_value) {
   DCHECK(basic_block_) << instruction;
   DCHECK_EQ(basic_block_, instruction->basic_block()) << instruction;
   instruction->SetInput(index, new_value);
+  DidChangeOperands();
 }
 
 void Editor::SetJump(BasicBlock* target_block) {
@@ -470,6 +479,7 @@ void Editor::SetPhiInput(PhiInstruction* phi,
                          Value new_value) {
   DCHECK_EQ(basic_block_, phi->basic_block()) << phi;
   DCHECK(basic_block_) << phi;
+  DidChangeOperands();
   if (auto const present = phi->FindPhiInputFor(block)) {
     present->value_ = new_value;
     return;
@@ -482,6 +492,7 @@ void Editor::SetOutput(Instruction* instruction, int index, Value new_value) {
   DCHECK(basic_block_) << instruction;
   DCHECK_EQ(basic_block_, instruction->basic_block()) << instruction;
   instruction->SetOutput(index, new_value);
+  DidChangeOperands();
 }
 
 void Editor::SetReturn() {
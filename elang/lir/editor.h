@@ -152,6 +152,9 @@ class ELANG_LIR_EXPORT Editor final : public ErrorReporter {
 
   // For cache invalidation.
   void DidChangeControlFlow();
+  // Discard cached liveness and conflict map, since they depend on operands
+  // of instructions.
+  void DidChangeOperands();
   void DidInsertInstruction();
   void DidRemoveInstruction();
 
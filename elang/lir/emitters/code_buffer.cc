@@ -2,6 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "elang/lir/emitters/code_buffer.h"
 
 #include "base/logging.h"
@@ -10,16 +14,39 @@
 #include "elang/base/zone_allocated.h"
 #include "elang/lir/emitters/value_emitter.h"
 #include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
 #include "elang/lir/literals.h"
 
 namespace elang {
 namespace lir {
 
 namespace {
+
+// Estimated average size of machine instruction for reserving code buffer.
+const int kAverageInstructionSize = 4;
+
+// Upper bound of size of jump instruction for finding jumps near code block.
+const int kMaxJumpSize = 8;
+
 // TODO(eval1749) We should move |Is8Bit()| to another place to share code.
 bool Is8Bit(int data) {
   return data >= -128 && data <= 127;
 }
+
+// Writes |value| into |code| and returns pointer after written byte.
+uint8_t* Patch8(uint8_t* code, int value) {
+  *code = static_cast<uint8_t>(value);
+  return code + 1;
+}
+
+// Writes |value| into |code| in little endian.
+void Patch32(uint8_t* code, int value) {
+  code[0] = static_cast<uint8_t>(value);
+  code[1] = static_cast<uint8_t>(value >> 8);
+  code[2] = static_cast<uint8_t>(value >> 16);
+  code[3] = static_cast<uint8_t>(value >> 24);
+}
+
 }  // namespace
 
 //////////////////////////////////////////////////////////////////////
@@ -98,6 +125,32 @@ CodeBuffer::CallSite::CallSite(int buffer_offset,
     : CodeLocation(buffer_offset, code_offset), callee_(callee) {
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// CodeBuffer::ConstantSite represents displacement to constant in constant
+// pool.
+//
+class CodeBuffer::ConstantSite final : public CodeLocation {
+  DECLARE_CASTABLE_CLASS(ConstantSite, CodeLocation);
+
+ public:
+  ConstantSite(int buffer_offset, int code_offset, Value value);
+  ~ConstantSite() final = default;
+
+  Value value() const { return value_; }
+
+ private:
+  const Value value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConstantSite);
+};
+
+CodeBuffer::ConstantSite::ConstantSite(int buffer_offset,
+                                       int code_offset,
+                                       Value value)
+    : CodeLocation(buffer_offset, code_offset), value_(value) {
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // CodeBuffer::CodeBlock
@@ -142,21 +195,38 @@ class CodeBuffer::BasicBlockData final : public CodeBlock {
   DECLARE_CASTABLE_CLASS(BasicBlockData, CodeBlock);
 
  public:
-  BasicBlockData() = default;
+  BasicBlockData();
   ~BasicBlockData() final = default;
 
+  int alignment() const { return alignment_; }
+  int max_padding() const { return max_padding_; }
+
   void EndBasicBlock(int code_offset);
+  void SetAlignment(int alignment, int max_padding);
 
  private:
+  int alignment_;
+  int max_padding_;
+
   DISALLOW_COPY_AND_ASSIGN(BasicBlockData);
 };
 
+CodeBuffer::BasicBlockData::BasicBlockData() : alignment_(1), max_padding_(0) {
+}
+
 void CodeBuffer::BasicBlockData::EndBasicBlock(int code_size) {
   auto const new_code_length = code_size - code_offset();
   DCHECK_GE(new_code_length, 0);
   set_code_length(new_code_length);
 }
 
+void CodeBuffer::BasicBlockData::SetAlignment(int alignment, int max_padding) {
+  DCHECK_GT(alignment, 0);
+  DCHECK_GE(max_padding, 0);
+  alignment_ = alignment;
+  max_padding_ = max_padding;
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // CodeBuffer::Jump
@@ -185,7 +255,6 @@ class CodeBuffer::JumpSite final : public CodeBlock {
   const Jump& jump() const { return is_long_jump_ ? long_jump_ : short_jump_; }
   int target_code_offset() const;
 
-  bool IsCrossing(int code_offset) const;
   int RelativeOffset() const;
   const Jump& UseLongJump();
 
@@ -214,20 +283,6 @@ CodeBuffer::JumpSite::JumpSite(int buffer_offset,
   DCHECK_GT(long_jump_.size(), short_jump_.size());
 }
 
-bool CodeBuffer::JumpSite::IsCrossing(int ref_code_offset) const {
-  if (code_offset() < ref_code_offset) {
-    //    jump target
-    //    -- |code_offset| --
-    //  target:
-    return target_block_->code_offset() >= ref_code_offset;
-  }
-
-  // target:
-  //    -- |code_offset|
-  //    jump target
-  return target_block_->code_offset() < ref_code_offset;
-}
-
 int CodeBuffer::JumpSite::RelativeOffset() const {
   return target_block_->code_offset() - (code_offset() + jump().size());
 }
@@ -239,10 +294,62 @@ const CodeBuffer::Jump& CodeBuffer::JumpSite::UseLongJump() {
   return long_jump_;
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// CodeBuffer::Padding represents NOP instructions for aligning start of
+// basic block.
+//
+class CodeBuffer::Padding final : public CodeBlock {
+  DECLARE_CASTABLE_CLASS(Padding, CodeBlock);
+
+ public:
+  Padding(int buffer_offset, int code_offset, int alignment, int max_padding);
+  ~Padding() final = default;
+
+  // Returns length of padding when padding starts at |code_offset|.
+  int LengthAt(int code_offset) const;
+
+  // Updates length of padding for current code offset.
+  void Update();
+
+ private:
+  const int alignment_;
+  const int max_padding_;
+
+  DISALLOW_COPY_AND_ASSIGN(Padding);
+};
+
+CodeBuffer::Padding::Padding(int buffer_offset,
+                             int code_offset,
+                             int alignment,
+                             int max_padding)
+    : CodeBlock(buffer_offset, code_offset, 0),
+      alignment_(alignment),
+      max_padding_(max_padding) {
+  set_code_length(LengthAt(code_offset));
+}
+
+int CodeBuffer::Padding::LengthAt(int code_offset) const {
+  auto const length = (alignment_ - code_offset % alignment_) % alignment_;
+  return length <= max_padding_ ? length : 0;
+}
+
+void CodeBuffer::Padding::Update() {
+  set_code_length(LengthAt(code_offset()));
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // CodeBuffer::JumpResolver
 //
+// Implements span-dependent instruction resolution. We start with all jumps
+// as short jumps and check each jump once. When a jump is widened, we
+// re-check only short jumps crossing it, and paddings after it which change
+// length, then jumps crossing changed paddings. Since short jump reaches
+// only 128 bytes, a change has a few crossing jumps, and we find them by
+// binary search. We track code offsets in Fenwick tree of length changes,
+// and update code locations in one sweep at end.
+//
 class CodeBuffer::JumpResolver final {
  public:
   explicit JumpResolver(CodeBuffer* code_buffer);
@@ -251,50 +358,169 @@ class CodeBuffer::JumpResolver final {
   void Run();
 
  private:
-  void AnalyzeJump(JumpSite* data);
-  void SetJump(const JumpSite* data);
-  void UpdateWorkSet(int code_offset);
+  void ChangeLength(size_t index, int delta);
+  int CodeOffsetOf(size_t index) const;
+  int DeltaBefore(size_t index) const;
+  bool IsCrossing(size_t jump_index, size_t index) const;
+  int RelativeOffsetOf(size_t jump_index) const;
+  void ScheduleCrossingJumps(size_t index, int delta);
+  size_t TargetIndexOf(size_t jump_index) const;
+  void UpdatePaddings(size_t index, int delta);
 
   CodeBuffer* const code_buffer_;
-  std::unordered_set<JumpSite*> work_set_;
+
+  // Jumps and paddings in code order, their code offsets before resolution
+  // and their current lengths.
+  std::vector<CodeBlock*> blocks_;
+  std::vector<int> code_offsets_;
+  std::vector<int> code_lengths_;
+
+  // Fenwick tree of length changes of |blocks_|.
+  std::vector<int> deltas_;
+
+  // Indexes of jumps and paddings in |blocks_|.
+  std::vector<size_t> jumps_;
+  std::vector<size_t> paddings_;
+
+  // Number of jumps and paddings before basic block.
+  std::unordered_map<const BasicBlockData*, size_t> block_indexes_;
+
+  std::vector<size_t> work_list_;
+  std::vector<bool> in_work_list_;
 
   DISALLOW_COPY_AND_ASSIGN(JumpResolver);
 };
 
 CodeBuffer::JumpResolver::JumpResolver(CodeBuffer* code_buffer)
     : code_buffer_(code_buffer) {
+  for (auto const code_location : code_buffer_->code_locations_) {
+    if (auto const block_data = code_location->as<BasicBlockData>()) {
+      block_indexes_[block_data] = blocks_.size();
+      continue;
+    }
+    if (code_location->is<JumpSite>()) {
+      jumps_.push_back(blocks_.size());
+    } else if (code_location->is<Padding>()) {
+      paddings_.push_back(blocks_.size());
+    } else {
+      continue;
+    }
+    auto const code_block = code_location->as<CodeBlock>();
+    blocks_.push_back(code_block);
+    code_offsets_.push_back(code_block->code_offset());
+    code_lengths_.push_back(code_block->code_length());
+  }
+  deltas_.resize(blocks_.size());
+  in_work_list_.resize(blocks_.size());
 }
 
-void CodeBuffer::JumpResolver::AnalyzeJump(JumpSite* data) {
-  if (data->is_long_jump())
-    return;
-  auto const relative_offset = data->RelativeOffset();
-  if (Is8Bit(relative_offset))
-    return;
-  UpdateWorkSet(data->code_offset());
-  auto const short_jump = data->jump();
-  auto const long_jump = data->UseLongJump();
-  code_buffer_->RelocateAfter(data->code_offset(),
-                              long_jump.size() - short_jump.size());
+// Changes length of |blocks_[index]| by |delta| bytes.
+void CodeBuffer::JumpResolver::ChangeLength(size_t index, int delta) {
+  code_lengths_[index] += delta;
+  for (auto node = index + 1; node <= deltas_.size();
+       node += node & (~node + 1)) {
+    deltas_[node - 1] += delta;
+  }
+}
+
+// Returns current code offset of |blocks_[index]|.
+int CodeBuffer::JumpResolver::CodeOffsetOf(size_t index) const {
+  return code_offsets_[index] + DeltaBefore(index);
+}
+
+// Returns sum of length changes of |blocks_[0]| to |blocks_[index - 1]|.
+int CodeBuffer::JumpResolver::DeltaBefore(size_t index) const {
+  auto delta = 0;
+  for (auto node = index; node; node -= node & (~node + 1))
+    delta += deltas_[node - 1];
+  return delta;
+}
+
+// Returns true if changing length of |blocks_[index]| changes relative
+// offset of jump |blocks_[jump_index]|.
+bool CodeBuffer::JumpResolver::IsCrossing(size_t jump_index,
+                                          size_t index) const {
+  auto const target_index = TargetIndexOf(jump_index);
+  if (target_index > jump_index)
+    return jump_index < index && index < target_index;
+  return target_index <= index && index < jump_index;
+}
+
+int CodeBuffer::JumpResolver::RelativeOffsetOf(size_t jump_index) const {
+  auto const jump_site = blocks_[jump_index]->as<JumpSite>();
+  auto const target_offset = jump_site->target_block_->code_offset() +
+                             DeltaBefore(TargetIndexOf(jump_index));
+  return target_offset - (CodeOffsetOf(jump_index) + code_lengths_[jump_index]);
 }
 
 void CodeBuffer::JumpResolver::Run() {
-  work_set_.insert(code_buffer_->jump_sites_.begin(),
-                   code_buffer_->jump_sites_.end());
-  while (!work_set_.empty()) {
-    auto const data = *work_set_.begin();
-    AnalyzeJump(data);
-    work_set_.erase(data);
+  for (auto const index : jumps_) {
+    work_list_.push_back(index);
+    in_work_list_[index] = true;
+  }
+  while (!work_list_.empty()) {
+    auto const index = work_list_.back();
+    work_list_.pop_back();
+    in_work_list_[index] = false;
+    auto const jump_site = blocks_[index]->as<JumpSite>();
+    if (jump_site->is_long_jump() || Is8Bit(RelativeOffsetOf(index)))
+      continue;
+    auto const short_size = jump_site->jump().size();
+    auto const delta = jump_site->UseLongJump().size() - short_size;
+    ChangeLength(index, delta);
+    ScheduleCrossingJumps(index, delta);
+    UpdatePaddings(index, delta);
+  }
+  code_buffer_->UpdateCodeOffsets();
+}
+
+// Adds short jumps crossing |blocks_[index]| to work list. Since short jumps
+// which aren't in work list reach at most 128 bytes before changing length by
+// |delta|, we check only jumps near |blocks_[index]|.
+void CodeBuffer::JumpResolver::ScheduleCrossingJumps(size_t index, int delta) {
+  auto const reach = 128 + kMaxJumpSize + std::max(delta, -delta);
+  auto const code_offset = CodeOffsetOf(index);
+  auto const start =
+      std::lower_bound(jumps_.begin(), jumps_.end(), code_offset - reach,
+                       [this](size_t jump_index, int offset) {
+                         return CodeOffsetOf(jump_index) < offset;
+                       });
+  for (auto it = start; it != jumps_.end(); ++it) {
+    auto const jump_index = *it;
+    if (CodeOffsetOf(jump_index) > code_offset + reach)
+      break;
+    if (in_work_list_[jump_index] || !IsCrossing(jump_index, index))
+      continue;
+    if (blocks_[jump_index]->as<JumpSite>()->is_long_jump())
+      continue;
+    work_list_.push_back(jump_index);
+    in_work_list_[jump_index] = true;
   }
 }
 
-void CodeBuffer::JumpResolver::UpdateWorkSet(int code_offset) {
-  for (auto const data : code_buffer_->jump_sites_) {
-    if (work_set_.count(data))
+// Returns number of jumps and paddings before target block of jump
+// |blocks_[jump_index]|.
+size_t CodeBuffer::JumpResolver::TargetIndexOf(size_t jump_index) const {
+  auto const jump_site = blocks_[jump_index]->as<JumpSite>();
+  auto const it = block_indexes_.find(jump_site->target_block_);
+  DCHECK(it != block_indexes_.end());
+  return it->second;
+}
+
+// Updates lengths of paddings after |blocks_[index]| moved by |delta| bytes,
+// until a padding absorbs the move.
+void CodeBuffer::JumpResolver::UpdatePaddings(size_t index, int delta) {
+  auto it = std::upper_bound(paddings_.begin(), paddings_.end(), index);
+  for (auto shift = delta; shift && it != paddings_.end(); ++it) {
+    auto const padding_index = *it;
+    auto const padding = blocks_[padding_index]->as<Padding>();
+    auto const change = padding->LengthAt(CodeOffsetOf(padding_index)) -
+                        code_lengths_[padding_index];
+    if (!change)
       continue;
-    if (!data->IsCrossing(code_offset))
-      continue;
-    work_set_.insert(data);
+    ChangeLength(padding_index, change);
+    ScheduleCrossingJumps(padding_index, change);
+    shift += change;
   }
 }
 
@@ -327,12 +553,23 @@ CodeBuffer::ValueInCode::ValueInCode(int buffer_offset,
 //
 // CodeBuffer
 //
-// TODO(eval1749) We should provide hint for size of |bytes_| to reduce
-// number of re-allocation of internal buffer.
 CodeBuffer::CodeBuffer(const Function* function)
-    : code_size_(0), current_block_data_(nullptr) {
-  for (auto const block : function->basic_blocks())
+    : code_size_(0), current_block_data_(nullptr), nop_table_(nullptr) {
+  auto number_of_instructions = 0;
+  for (auto const block : function->basic_blocks()) {
     block_data_map_[block] = new (zone()) BasicBlockData();
+    number_of_instructions += block->instructions().Count();
+  }
+  // Reserve |bytes_| to reduce number of re-allocation.
+  bytes_.reserve(number_of_instructions * kAverageInstructionSize);
+}
+
+void CodeBuffer::AlignBasicBlock(const BasicBlock* block,
+                                 int alignment,
+                                 int max_padding) {
+  auto const it = block_data_map_.find(block);
+  DCHECK(it != block_data_map_.end());
+  it->second->SetAlignment(alignment, max_padding);
 }
 
 void CodeBuffer::AssociateCallSite(base::StringPiece16 callee) {
@@ -341,21 +578,48 @@ void CodeBuffer::AssociateCallSite(base::StringPiece16 callee) {
                                 CallSite(buffer_size(), code_size_, callee));
 }
 
+void CodeBuffer::AssociateConstant(Value value) {
+  DCHECK(current_block_data_);
+  DCHECK(value.is_literal()) << value;
+  code_locations_.push_back(new (zone()) ConstantSite(buffer_size(),
+                                                      code_size_, value));
+}
+
 void CodeBuffer::AssociateValue(Value value) {
   DCHECK(current_block_data_);
   code_locations_.push_back(new (zone())
                                 ValueInCode(buffer_size(), code_size_, value));
 }
 
+// Since code size is fixed after resolving jumps, we write code blocks into
+// memory reserved by |builder| directly, and jumps and values are fixed in
+// place. Constants are placed in constant pool after code, aligned to their
+// size.
 void CodeBuffer::Finish(const Factory* factory,
                         api::MachineCodeBuilder* builder) {
   // TODO(eval1749) Fix code references, e.g. branches, indirect jumps, etc.
   JumpResolver(this).Run();
-  for (auto const jump_site : jump_sites_)
-    PatchJump(jump_site);
-  builder->PrepareCode(code_size_);
+
+  std::unordered_map<Value, int> constant_offsets;
+  std::vector<Value> constants;
+  auto pool_end = code_size_;
+  for (auto const code_location : code_locations_) {
+    auto const constant_site = code_location->as<ConstantSite>();
+    if (!constant_site || constant_offsets.count(constant_site->value()))
+      continue;
+    auto const size = constant_site->value().is_64bit() ? 8 : 4;
+    auto const offset = (pool_end + size - 1) / size * size;
+    constant_offsets[constant_site->value()] = offset;
+    constants.push_back(constant_site->value());
+    pool_end = offset + size;
+  }
+
+  auto const code = builder->ReserveCode(pool_end);
+  ::memset(code + code_size_, 0, pool_end - code_size_);
 
   ValueEmitter value_emitter(factory, builder);
+  for (auto const constant : constants)
+    value_emitter.Emit(constant_offsets[constant], constant);
 
   auto code_offset = 0;
   for (auto const code_location : code_locations_) {
@@ -363,6 +627,12 @@ void CodeBuffer::Finish(const Factory* factory,
       builder->SetCallSite(call_site->code_offset(), call_site->callee());
       continue;
     }
+    if (auto const constant_site = code_location->as<ConstantSite>()) {
+      auto const site_offset = constant_site->code_offset();
+      Patch32(code + site_offset,
+              constant_offsets[constant_site->value()] - (site_offset + 4));
+      continue;
+    }
     if (auto const value_in_code = code_location->as<ValueInCode>()) {
       value_emitter.Emit(value_in_code->code_offset(), value_in_code->value());
       continue;
@@ -374,13 +644,20 @@ void CodeBuffer::Finish(const Factory* factory,
     DCHECK_GE(code_block->buffer_offset(), 0);
     DCHECK_EQ(code_offset, code_block->code_offset());
     code_offset += code_block->code_length();
-    // TODO(eval1749) Insert target specific NOP instructions for code
-    // alignment.
+    if (code_block->is<Padding>()) {
+      EmitNops(code + code_block->code_offset(), code_block->code_length());
+      continue;
+    }
+    if (auto const jump_site = code_block->as<JumpSite>()) {
+      PatchJump(code + jump_site->code_offset(), jump_site);
+      continue;
+    }
     if (!code_block->code_length())
       continue;
     DCHECK_GT(code_block->code_length(), 0);
-    builder->EmitCode(bytes_.data() + code_block->buffer_offset(),
-                      code_block->code_length());
+    ::memcpy(code + code_block->code_offset(),
+             bytes_.data() + code_block->buffer_offset(),
+             code_block->code_length());
   }
 
   builder->FinishCode();
@@ -415,9 +692,10 @@ void CodeBuffer::Emit8(int value) {
   ++code_size_;
 }
 
-// Emit jump into code buffer. We assume all jump are short jump but we reserve
-// room for long jump. In |Finish()| function, we change short jumps to long
-// jumps if needed.
+// Emit jump into code buffer. We assume all jump are short jump. In |Finish()|
+// function, we change short jumps to long jumps if needed, and write jump
+// instructions into final code directly, so we don't need room for them in
+// |bytes_|.
 void CodeBuffer::EmitJump(const Jump& long_jump,
                           const Jump& short_jump,
                           BasicBlock* target_block) {
@@ -428,9 +706,6 @@ void CodeBuffer::EmitJump(const Jump& long_jump,
       new (zone()) JumpSite(buffer_size(), code_size_, long_jump, short_jump,
                             block_data_map_[target_block]);
   code_locations_.push_back(jump_site);
-  jump_sites_.push_back(jump_site);
-  // Reserve buffer for long jump.
-  bytes_.resize(buffer_size() + long_jump.size());
   code_size_ += short_jump.size();
 }
 
@@ -442,64 +717,76 @@ void CodeBuffer::EndBasicBlock() {
   block_data->EndBasicBlock(code_size_);
 }
 
-void CodeBuffer::RelocateAfter(int ref_code_offset, int delta) {
-  DCHECK_GT(delta, 0);
-  code_size_ += delta;
-  for (auto it = code_locations_.rbegin(); it != code_locations_.rend(); ++it) {
-    auto const code_location = *it;
-    if (code_location->code_offset() <= ref_code_offset)
-      break;
-    code_location->Relocate(delta);
+// Emits NOP instructions of |size| bytes, using longest NOP instructions
+// first to reduce number of instructions to decode.
+void CodeBuffer::EmitNops(uint8_t* code, int size) {
+  DCHECK(!size || nop_table_);
+  while (size > 0) {
+    auto const nop_size = std::min(size, nop_table_->max_size);
+    ::memcpy(code, nop_table_->bytes[nop_size - 1], nop_size);
+    code += nop_size;
+    size -= nop_size;
   }
 }
 
-void CodeBuffer::Patch8(int buffer_offset, int value) {
-  bytes_[buffer_offset] = static_cast<uint8_t>(value);
-}
-
-void CodeBuffer::Patch32(int buffer_offset, int value) {
-  bytes_[buffer_offset] = static_cast<uint8_t>(value);
-  bytes_[buffer_offset + 1] = static_cast<uint8_t>(value >> 8);
-  bytes_[buffer_offset + 2] = static_cast<uint8_t>(value >> 16);
-  bytes_[buffer_offset + 3] = static_cast<uint8_t>(value >> 24);
-}
-
-void CodeBuffer::PatchJump(const JumpSite* jump_site) {
+// Writes jump instruction of |jump_site| into |code|.
+void CodeBuffer::PatchJump(uint8_t* code, const JumpSite* jump_site) {
   auto const jump = jump_site->jump();
   DCHECK_LE(jump.opcode_size, 2);
-  auto buffer_offset = jump_site->buffer_offset();
 
   // Set opcode of jump instruction
   auto opcode = jump.opcode;
-  if (jump.opcode_size == 2) {
-    Patch8(buffer_offset, opcode >> 8);
-    ++buffer_offset;
-  }
-  Patch8(buffer_offset, opcode);
-  ++buffer_offset;
+  if (jump.opcode_size == 2)
+    code = Patch8(code, opcode >> 8);
+  code = Patch8(code, opcode);
 
   // Set operand of jump instruction
   auto const relative_offset = jump_site->RelativeOffset();
   if (jump.operand_size == 4) {
     DCHECK(!Is8Bit(relative_offset));
-    Patch32(buffer_offset, relative_offset);
+    Patch32(code, relative_offset);
     return;
   }
   if (jump.operand_size == 1) {
     DCHECK(Is8Bit(relative_offset));
-    Patch8(buffer_offset, relative_offset);
+    Patch8(code, relative_offset);
     return;
   }
   NOTREACHED() << "Unsupported relative offset size" << jump.operand_size;
 }
 
+// Code blocks, e.g. basic blocks, jumps and paddings, are contiguous in
+// |code_locations_|, and other code locations in basic block follow it.
+void CodeBuffer::UpdateCodeOffsets() {
+  auto code_offset = 0;
+  auto delta = 0;
+  for (auto const code_location : code_locations_) {
+    auto const code_block = code_location->as<CodeBlock>();
+    if (!code_block) {
+      code_location->Relocate(delta);
+      continue;
+    }
+    delta = code_offset - code_block->code_offset();
+    code_block->Relocate(delta);
+    if (auto const padding = code_block->as<Padding>())
+      padding->Update();
+    code_offset += code_block->code_length();
+  }
+  code_size_ = code_offset;
+}
+
 void CodeBuffer::StartBasicBlock(const BasicBlock* block) {
   DCHECK(!current_block_data_);
   auto const it = block_data_map_.find(block);
   DCHECK(it != block_data_map_.end());
   auto const block_data = it->second;
-  // TODO(eval1749) If one of incoming edge is back edge, we should align
-  // code offset of this block in target's code cache alignment, e.g. 16 bytes.
+  if (block_data->alignment() > 1) {
+    auto const padding = new (zone())
+        Padding(buffer_size(), code_size_, block_data->alignment(),
+                block_data->max_padding());
+    code_locations_.push_back(padding);
+    code_size_ += padding->code_length();
+  }
   block_data->Start(buffer_size(), code_size_);
   current_block_data_ = block_data;
   code_locations_.push_back(block_data);
@@ -40,6 +40,13 @@ class ELANG_LIR_EXPORT CodeBuffer final : public ZoneOwner {
     int size() const { return opcode_size + operand_size; }
   };
 
+  // Target specific NOP instructions for code alignment. |bytes[n - 1]|
+  // points n-byte NOP instruction, for n in [1, |max_size|].
+  struct ELANG_LIR_EXPORT NopTable {
+    const uint8_t* const* bytes;
+    int max_size;
+  };
+
   explicit CodeBuffer(const Function* function);
   ~CodeBuffer() = default;
 
@@ -49,6 +56,18 @@ class ELANG_LIR_EXPORT CodeBuffer final : public ZoneOwner {
   // Associate |value| to current offset.
   void AssociateValue(Value value);
 
+  // Associate literal |value| to 32-bit displacement at current offset. We
+  // place |value| in constant pool after code, and set displacement to
+  // |value| relative to end of displacement, e.g. RIP relative addressing.
+  void AssociateConstant(Value value);
+
+  // Aligns start of |basic_block| to |alignment| bytes by inserting NOP
+  // instructions before it, if it needs at most |max_padding| bytes.
+  // Padding is recomputed when jumps are widened in |Finish()|.
+  void AlignBasicBlock(const BasicBlock* basic_block,
+                       int alignment,
+                       int max_padding);
+
   // Tells code emission is finished.
   void Finish(const Factory* factory, api::MachineCodeBuilder* builder);
   void Emit16(int value);
@@ -61,28 +80,33 @@ class ELANG_LIR_EXPORT CodeBuffer final : public ZoneOwner {
   void EndBasicBlock();
   void StartBasicBlock(const BasicBlock* basic_block);
 
+  void set_nop_table(const NopTable* nop_table) { nop_table_ = nop_table; }
+
  private:
   class BasicBlockData;
   class CallSite;
   class CodeBlock;
   class CodeLocation;
+  class ConstantSite;
   class JumpSite;
   class JumpResolver;
+  class Padding;
   class ValueInCode;
 
   int buffer_size() const { return static_cast<int>(bytes_.size()); }
 
-  void Patch8(int buffer_offset, int value);
-  void Patch32(int buffer_offset, int value);
-  void PatchJump(const JumpSite* jump_site);
-  void RelocateAfter(int code_offset, int delta);
+  void EmitNops(uint8_t* code, int size);
+  void PatchJump(uint8_t* code, const JumpSite* jump_site);
+
+  // Recomputes code offsets of all code locations after widening jumps.
+  void UpdateCodeOffsets();
 
   std::unordered_map<const BasicBlock*, BasicBlockData*> block_data_map_;
   std::vector<uint8_t> bytes_;
   std::vector<CodeLocation*> code_locations_;
   int code_size_;
   BasicBlockData* current_block_data_;
-  std::vector<JumpSite*> jump_sites_;
+  const NopTable* nop_table_;
 
   DISALLOW_COPY_AND_ASSIGN(CodeBuffer);
 };
@@ -23,6 +23,13 @@ enum Opcode {
 
 typedef CodeBuffer::Jump Jump;
 
+// NOP instructions for testing, e.g. "22" for two bytes NOP.
+const uint8_t kNop1[] = {'1'};
+const uint8_t kNop2[] = {'2', '2'};
+const uint8_t kNop3[] = {'3', '3', '3'};
+const uint8_t* const kNops[] = {kNop1, kNop2, kNop3};
+const CodeBuffer::NopTable kNopTable = {kNops, arraysize(kNops)};
+
 //////////////////////////////////////////////////////////////////////
 //
 // CodeBufferTest
@@ -140,6 +147,162 @@ TEST_F(CodeBufferTest, JumpLong) {
       builder.GetResult());
 }
 
+// Widening jump in |block1| makes jump in entry block out of range.
+// entry:
+//  jump block2
+// block1:
+//  jump block3
+// block4:
+//  NOP x 123
+// block2:
+//  NOP x 130
+// block3:
+//  ret
+//
+TEST_F(CodeBufferTest, JumpLongCascade) {
+  auto const function = CreateFunctionEmptySample();
+
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(editor.exit_block());
+  auto const block2 = editor.NewBasicBlock(editor.exit_block());
+  auto const block3 = editor.NewBasicBlock(editor.exit_block());
+  auto const block4 = editor.NewBasicBlock(editor.exit_block());
+
+  CodeBuffer code_buffer(function);
+
+  code_buffer.StartBasicBlock(editor.entry_block());
+  code_buffer.EmitJump(long_jump(), short_jump(), block2);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block1);
+  code_buffer.EmitJump(long_jump(), short_jump(), block3);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block4);
+  for (auto index = 0; index < 123; ++index)
+    code_buffer.Emit8(Nop);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block2);
+  for (auto index = 0; index < 130; ++index)
+    code_buffer.Emit8(Nop);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block3);
+  code_buffer.Emit8(Ret);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(editor.exit_block());
+  code_buffer.EndBasicBlock();
+
+  TestMachineCodeBuilder builder;
+  code_buffer.Finish(factory(), &builder);
+  EXPECT_EQ(
+      "0000 4A 80 00 00 00 4A FD 00 00 00 4E 4E 4E 4E 4E 4E\n"
+      "0010 ... 0x4E x 240 ...\n"
+      "0100 4E 4E 4E 4E 4E 4E 4E 52\n",
+      builder.GetResult());
+}
+
+// entry:
+//  NOP x 3
+// block1: aligned
+//  NOP
+//  br %b, block1, block2
+// block2:
+//  ret
+//
+TEST_F(CodeBufferTest, AlignBasic) {
+  auto const function = CreateFunctionEmptySample();
+
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(editor.exit_block());
+  auto const block2 = editor.NewBasicBlock(editor.exit_block());
+
+  CodeBuffer code_buffer(function);
+  code_buffer.set_nop_table(&kNopTable);
+  code_buffer.AlignBasicBlock(block1, 16, 15);
+
+  code_buffer.StartBasicBlock(editor.entry_block());
+  code_buffer.Emit8(Nop);
+  code_buffer.Emit8(Nop);
+  code_buffer.Emit8(Nop);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block1);
+  code_buffer.Emit8(Nop);
+  code_buffer.EmitJump(long_branch(), short_branch(), block1);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block2);
+  code_buffer.Emit8(Ret);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(editor.exit_block());
+  code_buffer.EndBasicBlock();
+
+  TestMachineCodeBuilder builder;
+  code_buffer.Finish(factory(), &builder);
+  EXPECT_EQ(
+      "0000 4E 4E 4E 33 33 33 33 33 33 33 33 33 33 33 33 31\n"
+      "0010 4E 62 FD 52\n",
+      builder.GetResult());
+}
+
+// Expanding jump in entry block moves padding before |block2| from offset 15
+// to 18, then padding is expanded from 1 byte to 14 bytes.
+// entry:
+//  jump block3
+// block1:
+//  NOP x 13
+// block2: aligned
+//  NOP x 130
+// block3:
+//  ret
+//
+TEST_F(CodeBufferTest, AlignJumpLong) {
+  auto const function = CreateFunctionEmptySample();
+
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(editor.exit_block());
+  auto const block2 = editor.NewBasicBlock(editor.exit_block());
+  auto const block3 = editor.NewBasicBlock(editor.exit_block());
+
+  CodeBuffer code_buffer(function);
+  code_buffer.set_nop_table(&kNopTable);
+  code_buffer.AlignBasicBlock(block2, 16, 15);
+
+  code_buffer.StartBasicBlock(editor.entry_block());
+  code_buffer.EmitJump(long_jump(), short_jump(), block3);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block1);
+  for (auto index = 0; index < 13; ++index)
+    code_buffer.Emit8(Nop);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block2);
+  for (auto index = 0; index < 130; ++index)
+    code_buffer.Emit8(Nop);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(block3);
+  code_buffer.Emit8(Ret);
+  code_buffer.EndBasicBlock();
+
+  code_buffer.StartBasicBlock(editor.exit_block());
+  code_buffer.EndBasicBlock();
+
+  TestMachineCodeBuilder builder;
+  code_buffer.Finish(factory(), &builder);
+  EXPECT_EQ(
+      "0000 4A 9D 00 00 00 4E 4E 4E 4E 4E 4E 4E 4E 4E 4E 4E\n"
+      "0010 4E 4E 33 33 33 33 33 33 33 33 33 33 33 33 32 32\n"
+      "0020 ... 0x4E x 128 ...\n"
+      "00A0 4E 4E 52\n",
+      builder.GetResult());
+}
+
 }  // namespace
 }  // namespace lir
 }  // namespace elang
@@ -24,6 +24,10 @@ void CodeBufferUser::AssociateCallSite(base::StringPiece16 callee) {
   code_buffer_->AssociateCallSite(callee);
 }
 
+void CodeBufferUser::AssociateConstant(Value value) {
+  code_buffer_->AssociateConstant(value);
+}
+
 void CodeBufferUser::AssociateValue(Value value) {
   code_buffer_->AssociateValue(value);
 }
@@ -26,6 +26,7 @@ class CodeBufferUser {
   CodeBuffer* code_buffer() const { return code_buffer_; }
 
   void AssociateCallSite(base::StringPiece16 callee);
+  void AssociateConstant(Value value);
   void AssociateValue(Value value);
   void Emit16(int data);
   void Emit32(uint32_t data);
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <unordered_map>
+
 #include "elang/lir/emitters/code_emitter.h"
 
 #include "elang/lir/emitters/code_buffer.h"
@@ -13,6 +15,33 @@
 namespace elang {
 namespace lir {
 
+namespace {
+
+// Start of loop header is aligned to fetch block boundary, to reduce number
+// of fetch blocks of small loop body. Since padding is executed once when
+// control falls into loop header, we always align loop header.
+const int kLoopHeaderAlignment = 16;
+const int kLoopHeaderMaxPadding = kLoopHeaderAlignment - 1;
+
+// Marks blocks which have back edge in emission order for aligning.
+void AlignLoopHeaders(const Function* function, CodeBuffer* code_buffer) {
+  std::unordered_map<const BasicBlock*, int> position_map;
+  for (auto const block : function->basic_blocks())
+    position_map[block] = static_cast<int>(position_map.size());
+  for (auto const block : function->basic_blocks()) {
+    auto const position = position_map[block];
+    for (auto const predecessor : block->predecessors()) {
+      if (position_map[predecessor] < position)
+        continue;
+      code_buffer->AlignBasicBlock(block, kLoopHeaderAlignment,
+                                   kLoopHeaderMaxPadding);
+      break;
+    }
+  }
+}
+
+}  // namespace
+
 //////////////////////////////////////////////////////////////////////
 //
 // CodeEmitter
@@ -27,6 +56,8 @@ CodeEmitter::~CodeEmitter() {
 
 void CodeEmitter::Process(const Function* function) {
   CodeBuffer code_buffer(function);
+  // Function entry is aligned by code memory allocator.
+  AlignLoopHeaders(function, &code_buffer);
   // Generate codes
   {
     auto const handler = NewInstructionHandler(&code_buffer);
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <cmath>
 #include <limits>
 
 #include "base/macros.h"
@@ -80,6 +81,53 @@ isa::Opcode OpcodeForStore(Value output) {
   return isa::Opcode::MOVSD_Wsd_Vsd;
 }
 
+// Returns 'pp' field of VEX prefix for mandatory |prefix|.
+int VexPpOf(uint32_t prefix) {
+  switch (prefix) {
+    case 0x00:
+      return 0;
+    case 0x66:
+      return 1;
+    case 0xF3:
+      return 2;
+    case 0xF2:
+      return 3;
+  }
+  NOTREACHED() << "Invalid mandatory prefix " << prefix;
+  return 0;
+}
+
+static_assert(static_cast<int>(isa::Opcode::VADDSD_Vsd_Hsd_Wsd) ==
+                  static_cast<int>(isa::Opcode::ADDSD_Vsd_Wsd),
+              "VEX opcode should be as same as legacy SSE opcode");
+
+// Returns opcode of SSE scalar instruction for |output| from opcodes for
+// float32 and float64.
+isa::Opcode OpcodeForFloat(Value output,
+                           isa::Opcode float32_opcode,
+                           isa::Opcode float64_opcode) {
+  DCHECK(output.is_float()) << output;
+  if (output.is_32bit())
+    return float32_opcode;
+  DCHECK(output.is_64bit()) << output;
+  return float64_opcode;
+}
+
+Scale ScaleOf(int scale) {
+  switch (scale) {
+    case 1:
+      return Scale::One;
+    case 2:
+      return Scale::Two;
+    case 4:
+      return Scale::Four;
+    case 8:
+      return Scale::Eight;
+  }
+  NOTREACHED() << "Invalid scale " << scale;
+  return Scale::One;
+}
+
 isa::Register ToRegister(Value reg) {
   DCHECK(reg.is_physical());
   if (reg.is_float()) {
@@ -106,7 +154,7 @@ isa::Register ToRegister(Value reg) {
 
 isa::Tttn ToTttn(IntCondition condition) {
   static const isa::Tttn tttns[] = {
-      isa::Tttn::NotEqual,        // 0
+      isa::Tttn::Equal,           // 0
       isa::Tttn::GreaterOrEqual,  // 1
       isa::Tttn::GreaterThan,     // 2
       isa::Tttn::AboveOrEqual,    // 3
@@ -124,13 +172,81 @@ isa::Tttn ToTttn(IntCondition condition) {
       isa::Tttn::Below,            // 12
       isa::Tttn::LessThanOrEqual,  // 13
       isa::Tttn::LessThan,         // 14
-      isa::Tttn::Equal,            // 15
+      isa::Tttn::NotEqual,         // 15
   };
   auto const it = std::begin(tttns) + static_cast<size_t>(condition);
   DCHECK(it < std::end(tttns));
   return *it;
 }
 
+// Returns true if we compare operands in reverse order, e.g. |right < left|,
+// to implement |condition| by one of 'A', 'AE', 'B', 'BE' or 'E', 'NE'
+// condition after 'UCOMISS'/'UCOMISD', which sets flags as:
+//   unordered: ZF=1 PF=1 CF=1
+//   less than: ZF=0 PF=0 CF=1
+//   equal:     ZF=1 PF=0 CF=0
+//   greater:   ZF=0 PF=0 CF=0
+bool ShouldSwapOperands(FloatCondition condition) {
+  switch (condition) {
+    case FloatCondition::OrderedLessThan:
+    case FloatCondition::OrderedLessThanOrEqual:
+    case FloatCondition::UnorderedGreaterThan:
+    case FloatCondition::UnorderedGreaterThanOrEqual:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Note: 'OrderedEqual' and 'UnorderedNotEqual' also require checking 'PF'.
+isa::Tttn ToTttn(FloatCondition condition) {
+  switch (condition) {
+    case FloatCondition::OrderedEqual:
+    case FloatCondition::UnorderedEqual:
+      return isa::Tttn::Equal;
+    case FloatCondition::OrderedGreaterThan:
+    case FloatCondition::OrderedLessThan:
+      return isa::Tttn::Above;
+    case FloatCondition::OrderedGreaterThanOrEqual:
+    case FloatCondition::OrderedLessThanOrEqual:
+      return isa::Tttn::AboveOrEqual;
+    case FloatCondition::OrderedNotEqual:
+    case FloatCondition::UnorderedNotEqual:
+      return isa::Tttn::NotEqual;
+    case FloatCondition::UnorderedGreaterThan:
+    case FloatCondition::UnorderedLessThan:
+      return isa::Tttn::Below;
+    case FloatCondition::UnorderedGreaterThanOrEqual:
+    case FloatCondition::UnorderedLessThanOrEqual:
+      return isa::Tttn::BelowOrEqual;
+    default:
+      NOTREACHED() << "Invalid float condition: "
+                   << static_cast<int>(condition);
+      return isa::Tttn::Parity;
+  }
+}
+
+// Returns condition code for negation of |tttn|. Conditions are encoded in
+// pair in x86 instruction set, e.g. 'E'=4 and 'NE'=5.
+isa::Tttn NegateTttn(isa::Tttn tttn) {
+  return static_cast<isa::Tttn>(static_cast<int>(tttn) ^ 1);
+}
+
+// Recommended multi-byte NOP instructions in Intel 64 and IA-32 Architectures
+// Software Developer's Manual, "NOP - No Operation".
+const uint8_t kNop1[] = {0x90};
+const uint8_t kNop2[] = {0x66, 0x90};
+const uint8_t kNop3[] = {0x0F, 0x1F, 0x00};
+const uint8_t kNop4[] = {0x0F, 0x1F, 0x40, 0x00};
+const uint8_t kNop5[] = {0x0F, 0x1F, 0x44, 0x00, 0x00};
+const uint8_t kNop6[] = {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00};
+const uint8_t kNop7[] = {0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00};
+const uint8_t kNop8[] = {0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t kNop9[] = {0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t* const kNops[] = {kNop1, kNop2, kNop3, kNop4, kNop5,
+                                kNop6, kNop7, kNop8, kNop9};
+const CodeBuffer::NopTable kNopTable = {kNops, arraysize(kNops)};
+
 CodeBuffer::Jump JumpOf(isa::Opcode opcode,
                         isa::Tttn tttn,
                         int opcode_size,
@@ -153,6 +269,13 @@ class InstructionHandlerX64 final : public CodeBufferUser,
 
  private:
   void EmitBranch(IntCondition condition, BasicBlock* target_block);
+  void EmitBranch(isa::Tttn tttn, BasicBlock* target_block);
+  void EmitFloatBranch(FloatCondition condition,
+                       BasicBlock* true_block,
+                       BasicBlock* false_block,
+                       BasicBlock* next_block);
+  // Load float literal |input| into |output| register.
+  void EmitFloatLiteral(Value output, Value input);
   // Emit Iz (imm8, imm16 or imm32) operand.
   void EmitIz(Value output, int imm);
   void EmitJump(BasicBlock* target_block);
@@ -175,6 +298,18 @@ class InstructionHandlerX64 final : public CodeBufferUser,
   // Emit REX prefix for ModRm reg and rm fields.
   void EmitRexPrefix(Value reg, Value rm);
 
+  // Emit SSE instruction |opcode| with REX prefix for ModRm reg and rm
+  // fields. REX prefix is placed between mandatory prefix, e.g. F2, and
+  // two-byte escape 0F. REX.W is set if |reg| or |rm| is 64-bit integer.
+  // If target supports VEX, we emit VEX prefix with |vvvv| as non-destructive
+  // source operand instead. |vvvv| should be same as |reg| or |Value()|
+  // for legacy SSE instruction.
+  void EmitSseOpcode(isa::Opcode opcode, Value reg, Value vvvv, Value rm);
+
+  // Emit VEX prefix and opcode byte of |opcode|. Mandatory prefix and
+  // two-byte escape of |opcode| are encoded into 'pp' and 'mmmmm' fields.
+  void EmitVexOpcode(isa::Opcode opcode, Value reg, Value vvvv, Value rm);
+
   // Emit REX prefix for ModRm rm fields.
   void EmitRexPrefix(Value rm);
 
@@ -184,6 +319,14 @@ class InstructionHandlerX64 final : public CodeBufferUser,
   // Emit SIB byte.
   void EmitSib(Scale scale, Register index, Register base);
 
+  void HandleFloatArithmetic(Instruction* instr,
+                             isa::Opcode float32_opcode,
+                             isa::Opcode float64_opcode);
+
+  // Emits 'INC' or 'DEC' for adding |sign| * immediate one and returns true,
+  // otherwise returns false.
+  bool HandleIncrement(Instruction* instr, int sign);
+
   void HandleIntegerArithmetic(Instruction* instr,
                                isa::Opcode op_eb_gb,
                                isa::OpcodeExt opext);
@@ -205,29 +348,44 @@ class InstructionHandlerX64 final : public CodeBufferUser,
   void VisitBitXor(BitXorInstruction* instr) final;
   void VisitBranch(BranchInstruction* instr) final;
   void VisitCall(CallInstruction* instr) final;
+  void VisitCMovX64(CMovX64Instruction* instr) final;
   void VisitCmp(CmpInstruction* instr) final;
   void VisitCopy(CopyInstruction* instr) final;
   void VisitEntry(EntryInstruction* instr) final;
   void VisitExit(ExitInstruction* instr) final;
+  void VisitExtend(ExtendInstruction* instr) final;
+  void VisitFloatAdd(FloatAddInstruction* instr) final;
+  void VisitFloatCmp(FloatCmpInstruction* instr) final;
+  void VisitFloatDiv(FloatDivInstruction* instr) final;
+  void VisitFloatMul(FloatMulInstruction* instr) final;
+  void VisitFloatSub(FloatSubInstruction* instr) final;
   void VisitIntAdd(IntAddInstruction* instr) final;
   void VisitIntDivX64(IntDivX64Instruction* instr) final;
   void VisitIntMul(IntMulInstruction* instr) final;
   void VisitIntSignX64(IntSignX64Instruction* instr) final;
+  void VisitLeaX64(LeaX64Instruction* instr) final;
   void VisitIntSub(IntSubInstruction* instr) final;
   void VisitJump(JumpInstruction* instr) final;
   void VisitLiteral(LiteralInstruction* instr) final;
   void VisitLoad(LoadInstruction* instr) final;
   void VisitRet(RetInstruction* instr) final;
+  void VisitSignedConvert(SignedConvertInstruction* instr) final;
   void VisitSignExtend(SignExtendInstruction* instr) final;
   void VisitShl(ShlInstruction* instr) final;
   void VisitShr(ShrInstruction* instr) final;
   void VisitStore(StoreInstruction* instr) final;
+  void VisitTruncate(TruncateInstruction* instr) final;
   void VisitUIntDivX64(UIntDivX64Instruction* instr) final;
+  void VisitUIntMulX64(UIntMulX64Instruction* instr) final;
   void VisitUIntShr(UIntShrInstruction* instr) final;
+  void VisitUnsignedConvert(UnsignedConvertInstruction* instr) final;
   void VisitZeroExtend(ZeroExtendInstruction* instr) final;
 
   const Factory* const factory_;
 
+  // True if we emit VEX encoded instructions for floating-point operations.
+  const bool use_vex_;
+
   // Holds an instruction which is fused in previous instruction, otherwise
   // it is |nullptr| if no fusion is occurred.
   Instruction* fused_instruction_;
@@ -245,18 +403,77 @@ InstructionHandlerX64::InstructionHandlerX64(const Factory* factory,
     : CodeBufferUser(code_buffer),
       ErrorReporter(const_cast<Factory*>(factory)),
       factory_(factory),
+      use_vex_(Target::HasVexInstruction()),
       fused_instruction_(nullptr),
       last_cmp_instruction_(nullptr) {
+  code_buffer->set_nop_table(&kNopTable);
 }
 
 void InstructionHandlerX64::EmitBranch(IntCondition condition,
                                        BasicBlock* target_block) {
-  auto const tttn = ToTttn(condition);
+  EmitBranch(ToTttn(condition), target_block);
+}
+
+void InstructionHandlerX64::EmitBranch(isa::Tttn tttn,
+                                       BasicBlock* target_block) {
   auto const long_branch = JumpOf(isa::Opcode::Jcc_Jv, tttn, 2, 4);
   auto const short_branch = JumpOf(isa::Opcode::Jcc_Jb, tttn, 1, 1);
   code_buffer()->EmitJump(long_branch, short_branch, target_block);
 }
 
+// Since 'UCOMISS'/'UCOMISD' set 'PF' for unordered operands, 'OrderedEqual'
+// and 'UnorderedNotEqual' take additional 'JP' instruction:
+//   OrderedEqual:      JP false_block; JE true_block
+//   UnorderedNotEqual: JP true_block; JNE true_block
+void InstructionHandlerX64::EmitFloatBranch(FloatCondition condition,
+                                            BasicBlock* true_block,
+                                            BasicBlock* false_block,
+                                            BasicBlock* next_block) {
+  if (condition == FloatCondition::OrderedEqual)
+    EmitBranch(isa::Tttn::Parity, false_block);
+  else if (condition == FloatCondition::UnorderedNotEqual)
+    EmitBranch(isa::Tttn::Parity, true_block);
+
+  auto const tttn = ToTttn(condition);
+  if (next_block == true_block) {
+    EmitBranch(NegateTttn(tttn), false_block);
+    return;
+  }
+  EmitBranch(tttn, true_block);
+  if (next_block == false_block)
+    return;
+  EmitJump(false_block);
+}
+
+// There is no instruction loading immediate into XMM register, so we load
+// float literal from constant pool after code:
+//  F3 0F 10 /r     MOVSS xmm, [RIP+disp32]
+//  F2 0F 10 /r     MOVSD xmm, [RIP+disp32]
+// For positive zero, we use:
+//  0F 57 /r        XORPS xmm, xmm
+// With VEX, MOVSS/MOVSD and XORPS are encoded as VMOVSS/VMOVSD and VXORPS.
+void InstructionHandlerX64::EmitFloatLiteral(Value output, Value input) {
+  DCHECK(output.is_physical()) << output;
+  auto const literal = factory_->GetLiteral(input);
+  if (auto const f32 = literal->as<Float32Literal>()) {
+    if (f32->data() == 0 && !std::signbit(f32->data())) {
+      EmitSseOpcode(isa::Opcode::XORPS_Vps_Wps, output, output, output);
+      EmitModRm(output, output);
+      return;
+    }
+  } else if (auto const f64 = literal->as<Float64Literal>()) {
+    if (f64->data() == 0 && !std::signbit(f64->data())) {
+      EmitSseOpcode(isa::Opcode::XORPS_Vps_Wps, output, output, output);
+      EmitModRm(output, output);
+      return;
+    }
+  }
+  EmitSseOpcode(OpcodeForLoad(output), output, Value(), Value());
+  EmitModRm(Mod::Disp0, ToRegister(output), Rm::Disp32);
+  AssociateConstant(input);
+  Emit32(0);
+}
+
 void InstructionHandlerX64::EmitIz(Value output, int imm) {
   if (output.is_8bit()) {
     Emit8(imm);
@@ -426,12 +643,84 @@ void InstructionHandlerX64::EmitRexPrefix(Value reg, Value rm) {
   Emit8(isa::REX | rex);
 }
 
+void InstructionHandlerX64::EmitSseOpcode(isa::Opcode opcode,
+                                          Value reg,
+                                          Value vvvv,
+                                          Value rm) {
+  if (use_vex_)
+    return EmitVexOpcode(opcode, reg, vvvv, rm);
+  DCHECK(!vvvv.is_physical() || vvvv == reg) << vvvv << " " << reg;
+  auto const value = static_cast<uint32_t>(opcode);
+  DCHECK_LT(value, 1u << 24);
+  if (value > 0xFFFF)
+    Emit8(value >> 16);
+  auto rex = 0;
+  if (reg.is_integer() && reg.is_64bit())
+    rex |= isa::REX_W;
+  if (rm.is_integer() && rm.is_64bit())
+    rex |= isa::REX_W;
+  if (reg.is_physical() && reg.data >= 8)
+    rex |= isa::REX_R;
+  if (rm.is_physical() && rm.data >= 8)
+    rex |= isa::REX_B;
+  if (rex)
+    Emit8(isa::REX | rex);
+  Emit8(value >> 8);
+  Emit8(value);
+}
+
+void InstructionHandlerX64::EmitVexOpcode(isa::Opcode opcode,
+                                          Value reg,
+                                          Value vvvv,
+                                          Value rm) {
+  auto const value = static_cast<uint32_t>(opcode);
+  DCHECK_LT(value, 1u << 24);
+  DCHECK_EQ(0x0Fu, (value >> 8) & 0xFF) << "Only 0F opcode map is supported";
+  auto const pp = VexPpOf(value >> 16);
+  auto const w = (reg.is_integer() && reg.is_64bit()) ||
+                 (rm.is_integer() && rm.is_64bit());
+  auto const r = reg.is_physical() && reg.data >= 8;
+  auto const b = rm.is_physical() && rm.data >= 8;
+  // Register specifier in inverted form, 1111 if unused.
+  auto const v = vvvv.is_physical() ? (~vvvv.data & 15) << 3 : 0x78;
+  if (!w && !b) {
+    Emit8(isa::VEX2);
+    Emit8((r ? 0 : 0x80) | v | pp);
+  } else {
+    // R, X, B, mmmmm=00001
+    Emit8(isa::VEX3);
+    Emit8((r ? 0 : 0x80) | 0x40 | (b ? 0 : 0x20) | 1);
+    Emit8((w ? 0x80 : 0) | v | pp);
+  }
+  Emit8(value);
+}
+
 void InstructionHandlerX64::EmitSib(Scale scale,
                                     Register index,
                                     Register base) {
   Emit8(static_cast<int>(scale) | ((index & 7) << 3) | (base & 7));
 }
 
+// Emit code for SSE scalar arithmetic instructions:
+//  F3 0F xx /r OP xmm1, xmm2/m32
+//  F2 0F xx /r OP xmm1, xmm2/m64
+//  VEX.NDS.LIG.F3.0F.WIG xx /r VOP xmm1, xmm2, xmm3/m32
+//  VEX.NDS.LIG.F2.0F.WIG xx /r VOP xmm1, xmm2, xmm3/m64
+void InstructionHandlerX64::HandleFloatArithmetic(Instruction* instr,
+                                                  isa::Opcode float32_opcode,
+                                                  isa::Opcode float64_opcode) {
+  auto const output = instr->output(0);
+  auto const left = instr->input(0);
+  auto const right = instr->input(1);
+  DCHECK(use_vex_ || output == left) << *instr;
+  DCHECK(output.is_physical()) << *instr;
+  DCHECK(left.is_physical()) << *instr;
+  DCHECK_EQ(Value::TypeOf(output), Value::TypeOf(right)) << *instr;
+  EmitSseOpcode(OpcodeForFloat(output, float32_opcode, float64_opcode), output,
+                left, right);
+  EmitModRm(output, right);
+}
+
 // Emit code for arithmetic instructions using opcode extension:
 //  opext=0 ADD
 //  opext=1 OR
@@ -439,6 +728,27 @@ void InstructionHandlerX64::EmitSib(Scale scale,
 //  opext=5 SUB
 //  opext=6 XOR
 //  opext=7 CMP
+// FE /0        INC r/m8
+// FF /0        INC r/m32
+// REX.W FF /0  INC r/m64
+// FE /1        DEC r/m8
+// FF /1        DEC r/m32
+// REX.W FF /1  DEC r/m64
+// 'INC' and 'DEC' are one byte shorter than 'ADD' and 'SUB' with imm8. They
+// don't update CF, but it is safe since we use only flags set by 'cmp'.
+bool InstructionHandlerX64::HandleIncrement(Instruction* instr, int sign) {
+  auto const output = instr->output(0);
+  auto const right = instr->input(1);
+  if (!right.is_immediate() || (right.data != 1 && right.data != -1))
+    return false;
+  auto const opext = right.data * sign > 0 ? isa::OpcodeExt::INC_Ev
+                                           : isa::OpcodeExt::DEC_Ev;
+  EmitRexPrefix(output);
+  EmitOpcode(output.is_8bit() ? isa::Opcode::INC_Eb : isa::Opcode::INC_Ev);
+  EmitOpcodeExt(opext, output);
+  return true;
+}
+
 void InstructionHandlerX64::HandleIntegerArithmetic(Instruction* instr,
                                                     isa::Opcode op_eb_gb,
                                                     isa::OpcodeExt opext) {
@@ -626,7 +936,10 @@ void InstructionHandlerX64::Handle(Instruction* instr) {
     return;
   }
   instr->Accept(this);
-  last_cmp_instruction_ = instr->as<CmpInstruction>();
+  last_cmp_instruction_ =
+      instr->is<CmpInstruction>() || instr->is<FloatCmpInstruction>()
+          ? instr
+          : nullptr;
 }
 
 // InstructionVisitor
@@ -674,8 +987,15 @@ void InstructionHandlerX64::VisitBranch(BranchInstruction* instr) {
   auto const false_block = instr->block_operand(1);
   DCHECK_NE(true_block, false_block);
 
-  auto const condition = UseCondition(instr);
   auto const next_block = instr->basic_block()->next();
+  if (auto const float_cmp = last_cmp_instruction_->as<FloatCmpInstruction>()) {
+    DCHECK_EQ(float_cmp->output(0), instr->input(0));
+    EmitFloatBranch(float_cmp->condition(), true_block, false_block,
+                    next_block);
+    return;
+  }
+
+  auto const condition = UseCondition(instr);
   if (next_block == true_block) {
     EmitBranch(CommuteCondition(condition), false_block);
     return;
@@ -697,6 +1017,22 @@ void InstructionHandlerX64::VisitCall(CallInstruction* instr) {
   Emit32(0);
 }
 
+// 0F 40+cc /r        CMOVcc r32, r/m32
+// REX.W 0F 40+cc /r  CMOVcc r64, r/m64
+// Condition flags are set by preceding 'cmp' instruction. Register allocator
+// may insert 'MOV' instructions between them, which don't change flags.
+void InstructionHandlerX64::VisitCMovX64(CMovX64Instruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(1);
+  DCHECK_EQ(output, instr->input(0)) << *instr;
+  DCHECK(output.is_physical()) << *instr;
+  EmitRexPrefix(output, input);
+  EmitOpcode(static_cast<isa::Opcode>(
+      static_cast<int>(isa::Opcode::CMOVcc_Gv_Ev) +
+      static_cast<int>(ToTttn(instr->condition()))));
+  EmitModRm(output, input);
+}
+
 // Instruction formats are as same as ADD.
 // Base opcode = 0x38, opext = 7
 void InstructionHandlerX64::VisitCmp(CmpInstruction* instr) {
@@ -738,6 +1074,20 @@ void InstructionHandlerX64::VisitCopy(CopyInstruction* instr) {
   auto const output = instr->output(0);
   DCHECK_EQ(Value::TypeOf(output), Value::TypeOf(input));
 
+  if (output.is_float()) {
+    if (output.is_physical()) {
+      // 'VMOVSS'/'VMOVSD' with register operands merge upper bits of |vvvv|.
+      EmitSseOpcode(OpcodeForLoad(output), output,
+                    input.is_physical() ? output : Value(), input);
+      EmitModRm(output, input);
+      return;
+    }
+    DCHECK(input.is_physical());
+    EmitSseOpcode(OpcodeForStore(input), input, Value(), output);
+    EmitModRm(output, input);
+    return;
+  }
+
   if (output.is_physical()) {
     EmitRexPrefix(output, input);
     EmitOpcode(OpcodeForLoad(output));
@@ -757,6 +1107,62 @@ void InstructionHandlerX64::VisitEntry(EntryInstruction* instr) {
 void InstructionHandlerX64::VisitExit(ExitInstruction* instr) {
 }
 
+// F3 0F 5A /r CVTSS2SD xmm1, xmm2/m32
+void InstructionHandlerX64::VisitExtend(ExtendInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  if (!output.is_float())
+    return DoDefaultVisit(instr);
+  DCHECK(output.is_64bit()) << *instr;
+  DCHECK(input.is_32bit()) << *instr;
+  EmitSseOpcode(isa::Opcode::CVTSS2SD_Vsd_Wss, output, output, input);
+  EmitModRm(output, input);
+}
+
+// F3 0F 58 /r ADDSS xmm1, xmm2/m32
+// F2 0F 58 /r ADDSD xmm1, xmm2/m64
+void InstructionHandlerX64::VisitFloatAdd(FloatAddInstruction* instr) {
+  HandleFloatArithmetic(instr, isa::Opcode::ADDSS_Vss_Wss,
+                        isa::Opcode::ADDSD_Vsd_Wsd);
+}
+
+// 0F 2E /r    UCOMISS xmm1, xmm2/m32
+// 66 0F 2E /r UCOMISD xmm1, xmm2/m64
+// Branch instruction using result of 'FloatCmp' emits conditional jump by
+// |EmitFloatBranch()|.
+void InstructionHandlerX64::VisitFloatCmp(FloatCmpInstruction* instr) {
+  DCHECK(instr->output(0).is_conditional());
+  auto const swap = ShouldSwapOperands(instr->condition());
+  auto const left = instr->input(swap ? 1 : 0);
+  auto const right = instr->input(swap ? 0 : 1);
+  DCHECK(left.is_physical()) << *instr;
+  EmitSseOpcode(OpcodeForFloat(left, isa::Opcode::UCOMISS_Vss_Wss,
+                               isa::Opcode::UCOMISD_Vsd_Wsd),
+                left, Value(), right);
+  EmitModRm(left, right);
+}
+
+// F3 0F 5E /r DIVSS xmm1, xmm2/m32
+// F2 0F 5E /r DIVSD xmm1, xmm2/m64
+void InstructionHandlerX64::VisitFloatDiv(FloatDivInstruction* instr) {
+  HandleFloatArithmetic(instr, isa::Opcode::DIVSS_Vss_Wss,
+                        isa::Opcode::DIVSD_Vsd_Wsd);
+}
+
+// F3 0F 59 /r MULSS xmm1, xmm2/m32
+// F2 0F 59 /r MULSD xmm1, xmm2/m64
+void InstructionHandlerX64::VisitFloatMul(FloatMulInstruction* instr) {
+  HandleFloatArithmetic(instr, isa::Opcode::MULSS_Vss_Wss,
+                        isa::Opcode::MULSD_Vsd_Wsd);
+}
+
+// F3 0F 5C /r SUBSS xmm1, xmm2/m32
+// F2 0F 5C /r SUBSD xmm1, xmm2/m64
+void InstructionHandlerX64::VisitFloatSub(FloatSubInstruction* instr) {
+  HandleFloatArithmetic(instr, isa::Opcode::SUBSS_Vss_Wss,
+                        isa::Opcode::SUBSD_Vsd_Wsd);
+}
+
 // int8:
 //  04 ib           ADD AL, imm8
 //  80 /0 ib        ADD r/m8, imm8
@@ -786,8 +1192,9 @@ void InstructionHandlerX64::VisitExit(ExitInstruction* instr) {
 //
 void InstructionHandlerX64::VisitIntAdd(IntAddInstruction* instr) {
   auto const output = instr->output(0);
-  auto const right = instr->input(1);
   DCHECK_EQ(output, instr->input(0)) << *instr;
+  if (HandleIncrement(instr, 1))
+    return;
   HandleIntegerArithmetic(instr, isa::Opcode::ADD_Eb_Gb,
                           isa::OpcodeExt::ADD_Eb_Ib);
 }
@@ -868,11 +1275,48 @@ void InstructionHandlerX64::VisitIntSignX64(IntSignX64Instruction* instr) {
   EmitOpcode(isa::Opcode::CDQ);
 }
 
+// REX.W 8D /r LEA r64, [base + index * scale + disp]
+//
+// Note: Since r/m=101 with mod=00 means disp32 without base, we use disp8
+// for RBP and R13 as base register.
+void InstructionHandlerX64::VisitLeaX64(LeaX64Instruction* instr) {
+  auto const output = instr->output(0);
+  auto const base = instr->input(0);
+  auto const index = instr->input(1);
+  auto const scale = instr->input(2).data;
+  auto const displacement = instr->input(3).data;
+  DCHECK(output.is_64bit()) << *instr;
+  DCHECK_NE(ToRegister(index), isa::RSP) << *instr;
+
+  auto rex = 0;
+  rex |= isa::REX_W;
+  if (output.data >= 8)
+    rex |= isa::REX_R;
+  if (index.data >= 8)
+    rex |= isa::REX_X;
+  if (base.data >= 8)
+    rex |= isa::REX_B;
+  Emit8(isa::REX | rex);
+  EmitOpcode(isa::Opcode::LEA_Gv_M);
+
+  auto const mod = !displacement && (base.data & 7) != 5
+                       ? Mod::Disp0
+                       : Is8Bit(displacement) ? Mod::Disp8 : Mod::Disp32;
+  EmitModRm(mod, ToRegister(output), Rm::Sib);
+  EmitSib(ScaleOf(scale), ToRegister(index), ToRegister(base));
+  if (mod == Mod::Disp8)
+    Emit8(displacement);
+  else if (mod == Mod::Disp32)
+    Emit32(displacement);
+}
+
 // Instruction formats are as same as ADD.
 // Base opcode = 0x28, opext = 5
 void InstructionHandlerX64::VisitIntSub(IntSubInstruction* instr) {
   auto const output = instr->output(0);
   DCHECK_EQ(output, instr->input(0)) << *instr;
+  if (HandleIncrement(instr, -1))
+    return;
   HandleIntegerArithmetic(instr, isa::Opcode::SUB_Eb_Gb,
                           isa::OpcodeExt::SUB_Eb_Ib);
 }
@@ -904,14 +1348,16 @@ void InstructionHandlerX64::VisitJump(JumpInstruction* instr) {
 //  REX.W C7 0/r imm32  MOV r/m64, imm32; imm32 < 0
 //
 // Note: imm64 to m64 isn't supported.
-// Note: float literal should be lowered to integer literal and 'bitcast'.
+// Note: float literal is loaded by |EmitFloatLiteral()|.
 //
 void InstructionHandlerX64::VisitLiteral(LiteralInstruction* instr) {
   auto const input = instr->input(0);
   auto const output = instr->output(0);
   DCHECK_EQ(input.size, output.size);
   DCHECK_EQ(input.type, output.type);
-  DCHECK(output.is_integer()) << "Float literal should be lowered " << *instr;
+
+  if (output.is_float())
+    return EmitFloatLiteral(output, input);
 
   if (output.is_64bit()) {
     auto const imm64 = Int64ValueOf(input);
@@ -981,6 +1427,10 @@ void InstructionHandlerX64::VisitLiteral(LiteralInstruction* instr) {
 //      8B /r MOV r32, r/m32
 //  int64:
 //      REX.W 8B /r MOV r64, r/m64
+//  float32:
+//      F3 0F 10 /r MOVSS xmm, m32
+//  float64:
+//      F2 0F 10 /r MOVSD xmm, m64
 //
 // Note: |instr->input(0)| doesn't contribute code emission, it holds base
 // address of pointer in |instr->input(1)|.
@@ -988,8 +1438,13 @@ void InstructionHandlerX64::VisitLiteral(LiteralInstruction* instr) {
 void InstructionHandlerX64::VisitLoad(LoadInstruction* instr) {
   auto const output = instr->output(0);
   auto const pointer = instr->input(1);
-  EmitRexPrefix(output, pointer);
-  EmitOpcode(OpcodeForLoad(output));
+  if (output.is_float()) {
+    EmitSseOpcode(OpcodeForLoad(output), output, Value(),
+                  To32bitValue(pointer));
+  } else {
+    EmitRexPrefix(output, pointer);
+    EmitOpcode(OpcodeForLoad(output));
+  }
   auto const displacement = instr->input(2);
   DCHECK_EQ(Value::Int32Type(), Value::TypeOf(displacement));
   DCHECK(displacement.is_immediate());
@@ -1000,6 +1455,36 @@ void InstructionHandlerX64::VisitRet(RetInstruction* instr) {
   EmitOpcode(isa::Opcode::RET);
 }
 
+// Integer to float:
+//  F3 0F 2A /r       CVTSI2SS xmm, r/m32
+//  F3 REX.W 0F 2A /r CVTSI2SS xmm, r/m64
+//  F2 0F 2A /r       CVTSI2SD xmm, r/m32
+//  F2 REX.W 0F 2A /r CVTSI2SD xmm, r/m64
+// Float to integer, truncated toward zero:
+//  F3 0F 2C /r       CVTTSS2SI r32, xmm/m32
+//  F3 REX.W 0F 2C /r CVTTSS2SI r64, xmm/m32
+//  F2 0F 2C /r       CVTTSD2SI r32, xmm/m64
+//  F2 REX.W 0F 2C /r CVTTSD2SI r64, xmm/m64
+void InstructionHandlerX64::VisitSignedConvert(
+    SignedConvertInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  DCHECK(output.is_physical()) << *instr;
+  if (output.is_float()) {
+    DCHECK(input.is_32bit() || input.is_64bit()) << *instr;
+    EmitSseOpcode(OpcodeForFloat(output, isa::Opcode::CVTSI2SS_Vss_Ed,
+                                 isa::Opcode::CVTSI2SD_Vsd_Ed),
+                  output, output, input);
+    EmitModRm(output, input);
+    return;
+  }
+  DCHECK(output.is_32bit() || output.is_64bit()) << *instr;
+  EmitSseOpcode(OpcodeForFloat(input, isa::Opcode::CVTTSS2SI_Gd_Wss,
+                               isa::Opcode::CVTTSD2SI_Gd_Wsd),
+                output, Value(), input);
+  EmitModRm(output, input);
+}
+
 // 0F BE /r     MOVSX r32, r/m8
 // 0F BF /r     MOVSX r32, r/m16
 // REX 0F BE /r MOVSX r64, r/m8
@@ -1049,6 +1534,9 @@ void InstructionHandlerX64::VisitShr(ShrInstruction* instr) {
 //  imm32: C7 /0 id         MOV r/m32, id
 //  imm32: REX.W C7 /0 id   MOV r/m64, id ; sign extended to 64-bit
 //
+//  float32: F3 0F 11 /r    MOVSS m32, xmm
+//  float64: F2 0F 11 /r    MOVSD m64, xmm
+//
 // Note: |instr->input(0)| doesn't contribute code emission, it holds base
 // address of pointer in |instr->input(1)|.
 //
@@ -1067,11 +1555,28 @@ void InstructionHandlerX64::VisitStore(StoreInstruction* instr) {
     EmitOperand(new_value);
     return;
   }
-  EmitRexPrefix(new_value, pointer);
-  EmitOpcode(OpcodeForStore(new_value));
+  if (new_value.is_float()) {
+    EmitSseOpcode(OpcodeForStore(new_value), new_value, Value(),
+                  To32bitValue(pointer));
+  } else {
+    EmitRexPrefix(new_value, pointer);
+    EmitOpcode(OpcodeForStore(new_value));
+  }
   EmitModRmDisp(ToRegister(new_value), ToRegister(pointer), displacement.data);
 }
 
+// F2 0F 5A /r CVTSD2SS xmm1, xmm2/m64
+void InstructionHandlerX64::VisitTruncate(TruncateInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  if (!output.is_float())
+    return DoDefaultVisit(instr);
+  DCHECK(output.is_32bit()) << *instr;
+  DCHECK(input.is_64bit()) << *instr;
+  EmitSseOpcode(isa::Opcode::CVTSD2SS_Vss_Wsd, output, output, input);
+  EmitModRm(output, input);
+}
+
 // F7 /6        DIV r/m32
 // REX.W F7 /6  DIV r/m64
 void InstructionHandlerX64::VisitUIntDivX64(UIntDivX64Instruction* instr) {
@@ -1094,10 +1599,51 @@ void InstructionHandlerX64::VisitUIntDivX64(UIntDivX64Instruction* instr) {
   EmitOpcodeExt(isa::OpcodeExt::DIV_Ev, right);
 }
 
+// F7 /4        MUL r/m32
+// REX.W F7 /4  MUL r/m64
+void InstructionHandlerX64::VisitUIntMulX64(UIntMulX64Instruction* instr) {
+  if (instr->output(0).is_32bit()) {
+    DCHECK_EQ(ToRegister(instr->output(0)), isa::EDX) << instr;
+    DCHECK_EQ(ToRegister(instr->output(1)), isa::EAX) << instr;
+    DCHECK_EQ(ToRegister(instr->input(0)), isa::EAX) << instr;
+  } else if (instr->output(0).is_64bit()) {
+    DCHECK_EQ(ToRegister(instr->output(0)), isa::RDX) << instr;
+    DCHECK_EQ(ToRegister(instr->output(1)), isa::RAX) << instr;
+    DCHECK_EQ(ToRegister(instr->input(0)), isa::RAX) << instr;
+  } else {
+    NOTREACHED() << instr;
+  }
+  auto const right = instr->input(1);
+  EmitRexPrefix(right);
+  EmitOpcode(isa::Opcode::MUL_Ev);
+  EmitOpcodeExt(isa::OpcodeExt::MUL_Ev, right);
+}
+
 void InstructionHandlerX64::VisitUIntShr(UIntShrInstruction* instr) {
   HandleShiftInstruction(instr, isa::OpcodeExt::SHR_Ev_One);
 }
 
+// |LoweringX64Pass| rewrites unsigned 32-bit integer to float conversion to
+// zero extension and signed conversion. For float to unsigned 32-bit integer,
+// we use 64-bit 'CVTTSD2SI' and take lower 32 bits:
+//  F3 REX.W 0F 2C /r CVTTSS2SI r64, xmm/m32
+//  F2 REX.W 0F 2C /r CVTTSD2SI r64, xmm/m64
+// TODO(eval1749) We should support conversion between unsigned 64-bit
+// integer and float.
+void InstructionHandlerX64::VisitUnsignedConvert(
+    UnsignedConvertInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  if (output.is_float() || !input.is_float() || !output.is_32bit())
+    return DoDefaultVisit(instr);
+  DCHECK(output.is_physical()) << *instr;
+  auto const output64 = Target::NaturalRegisterOf(output);
+  EmitSseOpcode(OpcodeForFloat(input, isa::Opcode::CVTTSS2SI_Gd_Wss,
+                               isa::Opcode::CVTTSD2SI_Gd_Wsd),
+                output64, Value(), input);
+  EmitModRm(output64, input);
+}
+
 // 0F B6 /r     MOVZX r32, r/m8
 // 0F B7 /r     MOVXZ r32, r/m16
 // REX 0F B6 /r MOVZX r64, r/m8
@@ -227,6 +227,42 @@ TEST_F(CodeEmitterX64Test, Branch) {
   EXPECT_EQ("0000 39 D8 7D 01 C3 C3\n", Emit(&editor));
 }
 
+// 'eq' and 'ne' are negated for branch to next block.
+TEST_F(CodeEmitterX64Test, BranchEqual) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(function->exit_block());
+  auto const block2 = editor.NewBasicBlock(function->exit_block());
+  auto const block3 = editor.NewBasicBlock(function->exit_block());
+
+  editor.Edit(function->entry_block());
+  auto const conditional1 = NewConditional();
+  editor.Append(NewCmpInstruction(conditional1, IntCondition::Equal,
+                                  Target::RegisterOf(isa::EAX),
+                                  Target::RegisterOf(isa::EBX)));
+  editor.SetBranch(conditional1, block1, block2);
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block1);
+  auto const conditional2 = NewConditional();
+  editor.Append(NewCmpInstruction(conditional2, IntCondition::NotEqual,
+                                  Target::RegisterOf(isa::EAX),
+                                  Target::RegisterOf(isa::ECX)));
+  editor.SetBranch(conditional2, block2, block3);
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block2);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block3);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  // JNE block2; JE block3
+  EXPECT_EQ("0000 39 D8 75 04 39 C8 74 01 C3 C3\n", Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, Call) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -240,6 +276,35 @@ TEST_F(CodeEmitterX64Test, Call) {
       Emit(&editor));
 }
 
+// CMOVcc uses flags set by preceding 'cmp' instruction.
+TEST_F(CodeEmitterX64Test, CMovX64) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ebx = Target::RegisterOf(isa::EBX);
+  auto const r9d = Target::RegisterOf(isa::R9D);
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const rbx = Target::RegisterOf(isa::RBX);
+  auto const var33 = Value::FrameSlot(Value::Int32Type(), 33);
+  auto const cond = NewConditional();
+  auto const lt = IntCondition::SignedLessThan;
+
+  editor.Append(NewCmpInstruction(cond, lt, eax, ebx));
+  // 0F 4C /r CMOVL r32, r/m32
+  editor.Append(New<CMovX64Instruction>(eax, lt, eax, ebx));
+  editor.Append(New<CMovX64Instruction>(eax, IntCondition::Equal, eax, r9d));
+  editor.Append(New<CMovX64Instruction>(rax, IntCondition::NotEqual, rax, rbx));
+  editor.Append(New<CMovX64Instruction>(eax, IntCondition::UnsignedLessThan,
+                                        eax, var33));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "0000 39 D8 0F 4C C3 41 0F 44 C1 48 0F 45 C3 0F 42 45\n"
+      "0010 21 C3\n",
+      Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, CmpInt32) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -282,6 +347,38 @@ TEST_F(CodeEmitterX64Test, CmpInt32) {
       Emit(&editor));
 }
 
+TEST_F(CodeEmitterX64Test, ConvertFloat) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const r9 = Target::RegisterOf(isa::R9);
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const xmm0d = Target::RegisterOf(isa::XMM0D);
+  auto const xmm0s = Target::RegisterOf(isa::XMM0S);
+  auto const xmm1d = Target::RegisterOf(isa::XMM1D);
+  auto const xmm1s = Target::RegisterOf(isa::XMM1S);
+  // F2 0F 2A /r CVTSI2SD xmm, r/m32
+  editor.Append(NewSignedConvertInstruction(xmm0d, eax));
+  // F2 REX.W 0F 2A /r CVTSI2SD xmm, r/m64
+  editor.Append(NewSignedConvertInstruction(xmm0d, rax));
+  // F2 0F 2C /r CVTTSD2SI r32, xmm/m64
+  editor.Append(NewSignedConvertInstruction(eax, xmm1d));
+  editor.Append(NewSignedConvertInstruction(r9, xmm0d));
+  // F3 0F 5A /r CVTSS2SD xmm, xmm/m32
+  editor.Append(NewExtendInstruction(xmm0d, xmm1s));
+  // F2 0F 5A /r CVTSD2SS xmm, xmm/m64
+  editor.Append(NewTruncateInstruction(xmm0s, xmm1d));
+  // F2 REX.W 0F 2C /r CVTTSD2SI r64, xmm/m64
+  editor.Append(NewUnsignedConvertInstruction(eax, xmm1d));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "0000 F2 0F 2A C0 F2 48 0F 2A C0 F2 0F 2C C1 F2 4C 0F\n"
+      "0010 2C C8 F3 0F 5A C1 F2 0F 5A C1 F2 48 0F 2C C1 C3\n",
+      Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, CopyInt16) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -527,6 +624,125 @@ TEST_F(CodeEmitterX64Test, Empty) {
   EXPECT_EQ("0000 C3\n", Emit(&editor));
 }
 
+TEST_F(CodeEmitterX64Test, FloatArithmetic) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const var33 = Value::FrameSlot(Value::Float64Type(), 33);
+  auto const xmm0d = Target::RegisterOf(isa::XMM0D);
+  auto const xmm0s = Target::RegisterOf(isa::XMM0S);
+  auto const xmm1d = Target::RegisterOf(isa::XMM1D);
+  auto const xmm1s = Target::RegisterOf(isa::XMM1S);
+  auto const xmm9d = Target::RegisterOf(isa::XMM9D);
+  // F2 0F 58 /r ADDSD xmm1, xmm2/m64
+  editor.Append(NewFloatAddInstruction(xmm0d, xmm0d, xmm1d));
+  editor.Append(NewFloatAddInstruction(xmm0d, xmm0d, xmm9d));
+  editor.Append(NewFloatAddInstruction(xmm9d, xmm9d, xmm0d));
+  editor.Append(NewFloatAddInstruction(xmm0d, xmm0d, var33));
+  // F2 0F 5C /r SUBSD xmm1, xmm2/m64
+  editor.Append(NewFloatSubInstruction(xmm0d, xmm0d, xmm1d));
+  // F2 0F 59 /r MULSD xmm1, xmm2/m64
+  editor.Append(NewFloatMulInstruction(xmm0d, xmm0d, xmm1d));
+  // F2 0F 5E /r DIVSD xmm1, xmm2/m64
+  editor.Append(NewFloatDivInstruction(xmm0d, xmm0d, xmm1d));
+  // F3 0F 58 /r ADDSS xmm1, xmm2/m32
+  editor.Append(NewFloatAddInstruction(xmm0s, xmm0s, xmm1s));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "0000 F2 0F 58 C1 F2 41 0F 58 C1 F2 44 0F 58 C8 F2 0F\n"
+      "0010 58 45 21 F2 0F 5C C1 F2 0F 59 C1 F2 0F 5E C1 F3\n"
+      "0020 0F 58 C1 C3\n",
+      Emit(&editor));
+}
+
+TEST_F(CodeEmitterX64Test, FloatArithmeticVex) {
+  Target::UseVexInstructionForTesting(true);
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const xmm0d = Target::RegisterOf(isa::XMM0D);
+  auto const xmm0s = Target::RegisterOf(isa::XMM0S);
+  auto const xmm1d = Target::RegisterOf(isa::XMM1D);
+  auto const xmm1s = Target::RegisterOf(isa::XMM1S);
+  auto const xmm2d = Target::RegisterOf(isa::XMM2D);
+  auto const xmm2s = Target::RegisterOf(isa::XMM2S);
+  auto const xmm9d = Target::RegisterOf(isa::XMM9D);
+  auto const xmm10d = Target::RegisterOf(isa::XMM10D);
+  // VEX.NDS.LIG.F2.0F.WIG 58 /r VADDSD xmm1, xmm2, xmm3/m64
+  editor.Append(NewFloatAddInstruction(xmm0d, xmm1d, xmm2d));
+  editor.Append(NewFloatAddInstruction(xmm9d, xmm0d, xmm10d));
+  // VEX.NDS.LIG.F3.0F.WIG 59 /r VMULSS xmm1, xmm2, xmm3/m32
+  editor.Append(NewFloatMulInstruction(xmm0s, xmm1s, xmm2s));
+  // VEX.NDS.LIG.F2.0F.W1 2A /r VCVTSI2SD xmm1, xmm2, r/m64
+  editor.Append(NewSignedConvertInstruction(xmm0d, rax));
+  // VEX.NDS.LIG.F2.0F.WIG 10 /r VMOVSD xmm1, xmm2, xmm3
+  editor.Append(NewCopyInstruction(xmm1d, xmm0d));
+  // VEX.LIG.F2.0F.WIG 10 /r VMOVSD xmm1, m64
+  editor.Append(NewLiteralInstruction(xmm0d, NewFloat64Value(1.5)));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "float64 +0020 1.500000\n"
+      "0000 C5 F3 58 C2 C4 41 7B 58 CA C5 F2 59 C2 C4 E1 FB\n"
+      "0010 2A C0 C5 F3 10 C8 C5 FB 10 05 02 00 00 00 C3 00\n"
+      "0020 00 00 00 00 00 00 00 00\n",
+      Emit(&editor));
+}
+
+TEST_F(CodeEmitterX64Test, FloatBranch) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(function->exit_block());
+  auto const block2 = editor.NewBasicBlock(function->exit_block());
+
+  editor.Edit(function->entry_block());
+  auto const conditional = NewConditional();
+  editor.Append(NewFloatCmpInstruction(
+      conditional, FloatCondition::OrderedLessThan,
+      Target::RegisterOf(isa::XMM0D), Target::RegisterOf(isa::XMM1D)));
+  editor.SetBranch(conditional, block1, block2);
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block1);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block2);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  // UCOMISD xmm1, xmm0; JBE block2
+  EXPECT_EQ("0000 66 0F 2E C8 76 01 C3 C3\n", Emit(&editor));
+}
+
+TEST_F(CodeEmitterX64Test, FloatBranchEqual) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  auto const block1 = editor.NewBasicBlock(function->exit_block());
+  auto const block2 = editor.NewBasicBlock(function->exit_block());
+
+  editor.Edit(function->entry_block());
+  auto const conditional = NewConditional();
+  editor.Append(NewFloatCmpInstruction(
+      conditional, FloatCondition::OrderedEqual,
+      Target::RegisterOf(isa::XMM0D), Target::RegisterOf(isa::XMM1D)));
+  editor.SetBranch(conditional, block1, block2);
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block1);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  editor.Edit(block2);
+  editor.SetReturn();
+  ASSERT_EQ("", Commit(&editor));
+
+  // UCOMISD xmm0, xmm1; JP block2; JNE block2
+  EXPECT_EQ("0000 66 0F 2E C1 7A 03 75 01 C3 C3\n", Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, FrameSlot) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -540,6 +756,29 @@ TEST_F(CodeEmitterX64Test, FrameSlot) {
   EXPECT_EQ("0000 48 8B 45 00 89 55 08 C3\n", Emit(&editor));
 }
 
+// Adding or subtracting one is emitted as 'INC' or 'DEC'.
+TEST_F(CodeEmitterX64Test, IncDec) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const r9d = Target::RegisterOf(isa::R9D);
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const one = Value::SmallInt32(1);
+  auto const var33 = Value::FrameSlot(Value::Int32Type(), 33);
+
+  editor.Append(NewIntAddInstruction(eax, eax, one));
+  editor.Append(NewIntAddInstruction(rax, rax, Value::SmallInt64(-1)));
+  editor.Append(NewIntSubInstruction(ecx, ecx, one));
+  editor.Append(NewIntAddInstruction(r9d, r9d, one));
+  editor.Append(NewIntAddInstruction(var33, var33, one));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ("0000 FF C0 48 FF C8 FF C9 41 FF C1 FF 45 21 C3\n",
+            Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, IntDivX6432) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -592,6 +831,60 @@ TEST_F(CodeEmitterX64Test, IntSignX64) {
   EXPECT_EQ("0000 99 48 99 C3\n", Emit(&editor));
 }
 
+TEST_F(CodeEmitterX64Test, LeaX64) {
+  auto const function = factory()->NewFunction({});
+  auto const r12 = Target::RegisterOf(isa::R12);
+  auto const r8 = Target::RegisterOf(isa::R8);
+  auto const r9 = Target::RegisterOf(isa::R9);
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const rbp = Target::RegisterOf(isa::RBP);
+  auto const rbx = Target::RegisterOf(isa::RBX);
+  auto const rcx = Target::RegisterOf(isa::RCX);
+  auto const rdx = Target::RegisterOf(isa::RDX);
+
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+
+  // LEA RAX, [RCX+RDX*4+16]
+  editor.Append(factory()->NewLeaX64Instruction(
+      rax, rcx, rdx, Value::SmallInt32(4), Value::SmallInt32(16)));
+  // LEA R8, [RBP+R9*8]
+  editor.Append(factory()->NewLeaX64Instruction(
+      r8, rbp, r9, Value::SmallInt32(8), Value::SmallInt32(0)));
+  // LEA RAX, [R12+RBX]
+  editor.Append(factory()->NewLeaX64Instruction(
+      rax, r12, rbx, Value::SmallInt32(1), Value::SmallInt32(0)));
+  ASSERT_EQ("", Commit(&editor));
+  EXPECT_EQ("0000 48 8D 44 91 10 4E 8D 44 CD 00 49 8D 04 1C C3\n",
+            Emit(&editor));
+}
+
+TEST_F(CodeEmitterX64Test, LiteralFloat) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const xmm0d = Target::RegisterOf(isa::XMM0D);
+  auto const xmm1d = Target::RegisterOf(isa::XMM1D);
+  auto const xmm9s = Target::RegisterOf(isa::XMM9S);
+  // 0F 57 /r XORPS xmm1, xmm2/m128
+  editor.Append(NewLiteralInstruction(xmm0d, NewFloat64Value(0.0)));
+  // F2 0F 10 /r MOVSD xmm, [RIP+disp32]
+  editor.Append(NewLiteralInstruction(xmm1d, NewFloat64Value(1.5)));
+  // F3 REX 0F 10 /r MOVSS xmm, [RIP+disp32]
+  editor.Append(NewLiteralInstruction(xmm9s, NewFloat32Value(2.5f)));
+  // Constant pool has one 1.5 for two loads.
+  editor.Append(NewLiteralInstruction(xmm0d, NewFloat64Value(1.5)));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "float64 +0020 1.500000\n"
+      "float32 +0028 2.500000f\n"
+      "0000 0F 57 C0 F2 0F 10 0D 15 00 00 00 F3 44 0F 10 0D\n"
+      "0010 14 00 00 00 F2 0F 10 05 04 00 00 00 C3 00 00 00\n"
+      "0020 00 00 00 00 00 00 00 00 00 00 00 00\n",
+      Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, LiteralInt16) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -1201,6 +1494,50 @@ TEST_F(CodeEmitterX64Test, StackSlot) {
   EXPECT_EQ("0000 48 8B 04 24 89 54 24 08 C3\n", Emit(&editor));
 }
 
+// Register allocators use spill slot as the second operand of these
+// instructions. Spill slots are assigned to stack slots, which are addressed
+// relative to RSP.
+TEST_F(CodeEmitterX64Test, StackSlotOperand) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const cond = NewConditional();
+  auto const m64 = Value::StackSlot(Value::Int64Type(), 8);
+  auto const m64d = Value::StackSlot(Value::Float64Type(), 16);
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const xmm0d = Target::RegisterOf(isa::XMM0D);
+  // REX.W 03 /r ADD r64, r/m64
+  editor.Append(NewIntAddInstruction(rax, rax, m64));
+  // REX.W 2B /r SUB r64, r/m64
+  editor.Append(NewIntSubInstruction(rax, rax, m64));
+  // REX.W 23 /r AND r64, r/m64
+  editor.Append(NewBitAndInstruction(rax, rax, m64));
+  // REX.W 0B /r OR r64, r/m64
+  editor.Append(NewBitOrInstruction(rax, rax, m64));
+  // REX.W 33 /r XOR r64, r/m64
+  editor.Append(NewBitXorInstruction(rax, rax, m64));
+  // REX.W 3B /r CMP r64, r/m64
+  editor.Append(NewCmpInstruction(cond, IntCondition::Equal, rax, m64));
+  // REX.W 0F AF /r IMUL r64, r/m64
+  editor.Append(New<IntMulInstruction>(rax, rax, m64));
+  // F2 0F 58 /r ADDSD xmm1, xmm2/m64
+  editor.Append(NewFloatAddInstruction(xmm0d, xmm0d, m64d));
+  // F2 0F 5C /r SUBSD xmm1, xmm2/m64
+  editor.Append(NewFloatSubInstruction(xmm0d, xmm0d, m64d));
+  // F2 0F 59 /r MULSD xmm1, xmm2/m64
+  editor.Append(NewFloatMulInstruction(xmm0d, xmm0d, m64d));
+  // F2 0F 5E /r DIVSD xmm1, xmm2/m64
+  editor.Append(NewFloatDivInstruction(xmm0d, xmm0d, m64d));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "0000 48 03 44 24 08 48 2B 44 24 08 48 23 44 24 08 48\n"
+      "0010 0B 44 24 08 48 33 44 24 08 48 3B 44 24 08 48 0F\n"
+      "0020 AF 44 24 08 F2 0F 58 44 24 10 F2 0F 5C 44 24 10\n"
+      "0030 F2 0F 59 44 24 10 F2 0F 5E 44 24 10 C3\n",
+      Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, Store16) {
   auto const function = factory()->NewFunction({});
   auto const ax = Target::RegisterOf(isa::AX);
@@ -1514,6 +1851,42 @@ TEST_F(CodeEmitterX64Test, UIntDivX6464) {
   EXPECT_EQ("0000 48 F7 F3 49 F7 F1 48 F7 75 21 C3\n", Emit(&editor));
 }
 
+TEST_F(CodeEmitterX64Test, UIntMulX6432) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ebx = Target::RegisterOf(isa::EBX);
+  auto const edx = Target::RegisterOf(isa::EDX);
+  auto const r9d = Target::RegisterOf(isa::R9D);
+  auto const var33 = Value::FrameSlot(Value::Int32Type(), 33);
+
+  editor.Append(New<UIntMulX64Instruction>(edx, eax, eax, ebx));
+  editor.Append(New<UIntMulX64Instruction>(edx, eax, eax, r9d));
+  editor.Append(New<UIntMulX64Instruction>(edx, eax, eax, var33));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ("0000 F7 E3 41 F7 E1 F7 65 21 C3\n", Emit(&editor));
+}
+
+TEST_F(CodeEmitterX64Test, UIntMulX6464) {
+  auto const function = factory()->NewFunction({});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const rbx = Target::RegisterOf(isa::RBX);
+  auto const rdx = Target::RegisterOf(isa::RDX);
+  auto const r9 = Target::RegisterOf(isa::R9);
+  auto const var33 = Value::FrameSlot(Value::Int64Type(), 33);
+
+  editor.Append(New<UIntMulX64Instruction>(rdx, rax, rax, rbx));
+  editor.Append(New<UIntMulX64Instruction>(rdx, rax, rax, r9));
+  editor.Append(New<UIntMulX64Instruction>(rdx, rax, rax, var33));
+  ASSERT_EQ("", Commit(&editor));
+
+  EXPECT_EQ("0000 48 F7 E3 49 F7 E1 48 F7 65 21 C3\n", Emit(&editor));
+}
+
 TEST_F(CodeEmitterX64Test, UIntShrInt64) {
   auto const function = factory()->NewFunction({});
   Editor editor(factory(), function);
@@ -55,11 +55,10 @@ enum class Rm {
 };
 
 enum class Scale {
-  None = 1,
   One = 0x00,
-  Two = 0x20,
-  Four = 0x40,
-  RIght = 0xC0,
+  Two = 0x40,
+  Four = 0x80,
+  Eight = 0xC0,
 };
 
 // VEX instruction format
@@ -69,7 +68,7 @@ enum class Scale {
 //             +--------+ +--------+ +--------+
 //
 //             +--------+ +--------+
-//  2-byte VEX | C3     | |RvvvvLpp|
+//  2-byte VEX | C5     | |RvvvvLpp|
 //             +--------+ +--------+
 //
 //  R=REX.R inverted form
@@ -90,6 +89,12 @@ enum class Scale {
 //  mmmmm=00100 reserved
 //  ...
 //  mmmmm=11111 reserved
+//
+//  2-byte VEX is available only for mmmmm=00001, X=1, B=1 and W=0.
+enum Vex {
+  VEX2 = 0xC5,
+  VEX3 = 0xC4,
+};
 
 // Rex prefix:
 //  Field   Bits    Definition
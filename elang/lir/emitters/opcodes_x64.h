@@ -19,6 +19,10 @@ enum class Opcode {
 #define V3(opcode, mnemonic, format1, format2, format3) \
   mnemonic##_##format1##_##format2##_##format3 = opcode,
   FOR_EACH_X64_OPCODE(V0, V1, V2, V3)
+  FOR_EACH_X64_OPCODE_0F20(V0, V1, V2, V3)
+  // Note: VEX opcodes have same value as legacy SSE opcodes, since mandatory
+  // prefix and escape bytes are encoded in VEX prefix.
+  FOR_EACH_VEX(V2, V3)
 #undef V0
 #undef V1
 #undef V2
@@ -48,8 +48,9 @@ void Factory::AddError(ErrorCode error_code,
 }
 
 bool Factory::GenerateMachineCode(api::MachineCodeBuilder* builder,
-                                  Function* function) {
-  return Pipeline(this, builder, function).Run();
+                                  Function* function,
+                                  int level) {
+  return Pipeline(this, builder, function, level).Run();
 }
 
 Literal* Factory::GetLiteral(Value value) const {
@@ -123,7 +124,7 @@ Value Factory::NewFloat32Value(float32_t data) {
     return it->second;
   auto const value = literal_map_->next_literal_value(Value::Float32Literal());
   RegisterLiteral(new (zone()) Float32Literal(data));
-  float32_map_[value.data] = value;
+  float32_map_[data] = value;
   return value;
 }
 
@@ -133,7 +134,7 @@ Value Factory::NewFloat64Value(float64_t data) {
     return it->second;
   auto const value = literal_map_->next_literal_value(Value::Float64Literal());
   RegisterLiteral(new (zone()) Float64Literal(data));
-  float64_map_[value.data] = value;
+  float64_map_[data] = value;
   return value;
 }
 
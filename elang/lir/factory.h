@@ -56,10 +56,11 @@ class ELANG_LIR_EXPORT Factory final : public ZoneOwner {
                 Value value,
                 const std::vector<Value>& details);
 
-  // Returns true if successfully generate machine code function for |function|,
-  // otherwise returns false.
+  // Returns true if successfully generate machine code function for |function|
+  // with optimization |level|, otherwise returns false.
   bool GenerateMachineCode(api::MachineCodeBuilder* builder,
-                           Function* function);
+                           Function* function,
+                           int level);
 
   // Returns |Literal| associated with |index|.
   Literal* GetLiteral(Value value) const;
@@ -125,12 +126,21 @@ class ELANG_LIR_EXPORT Factory final : public ZoneOwner {
 #undef V
 
 #ifdef ELANG_TARGET_ARCH_X64
+  Instruction* NewCMovX64Instruction(Value output,
+                                     IntCondition condition,
+                                     Value left,
+                                     Value right);
   Instruction* NewIntDivX64Instruction(Value div_output,
                                        Value mod_output,
                                        Value high_left,
                                        Value low_left,
                                        Value right);
   Instruction* NewIntSignX64Instruction(Value output, Value input);
+  Instruction* NewLeaX64Instruction(Value output,
+                                    Value base,
+                                    Value index,
+                                    Value scale,
+                                    Value displacement);
   Instruction* NewUIntDivX64Instruction(Value div_output,
                                         Value mod_output,
                                         Value high_left,
@@ -15,6 +15,16 @@
 namespace elang {
 namespace lir {
 
+Instruction* Factory::NewCMovX64Instruction(Value output,
+                                            IntCondition condition,
+                                            Value left,
+                                            Value right) {
+  DCHECK(output.is_int32() || output.is_int64()) << output;
+  DCHECK_EQ(Value::TypeOf(output), Value::TypeOf(left)) << left;
+  DCHECK_EQ(Value::TypeOf(output), Value::TypeOf(right)) << right;
+  return new (zone()) CMovX64Instruction(output, condition, left, right);
+}
+
 Instruction* Factory::NewIntDivX64Instruction(Value div_output,
                                               Value mod_output,
                                               Value high_left,
@@ -28,6 +38,15 @@ Instruction* Factory::NewIntSignX64Instruction(Value output, Value input) {
   return new (zone()) IntSignX64Instruction(output, input);
 }
 
+Instruction* Factory::NewLeaX64Instruction(Value output,
+                                           Value base,
+                                           Value index,
+                                           Value scale,
+                                           Value displacement) {
+  return new (zone())
+      LeaX64Instruction(output, base, index, scale, displacement);
+}
+
 Instruction* Factory::NewUIntDivX64Instruction(Value div_output,
                                                Value mod_output,
                                                Value high_left,
@@ -85,8 +85,10 @@ namespace lir {
 // X64
 //
 #define FOR_EACH_X64_LIR_INSTRUCTION(V) \
+  V(CMovX64, "cmov_x64")                \
   V(IntDivX64, "sdiv_x64")              \
   V(IntSignX64, "sign_x64")             \
+  V(LeaX64, "lea_x64")                  \
   V(UIntDivX64, "udiv_x64")             \
   V(UIntMulX64, "umul_x64")
 
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <iterator>
+
 #include "base/logging.h"
 #include "elang/lir/instructions_x64.h"
 #include "elang/lir/target_x64.h"
@@ -10,6 +12,27 @@
 namespace elang {
 namespace lir {
 
+// CMovX64
+CMovX64Instruction::CMovX64Instruction(Value output,
+                                       IntCondition condition,
+                                       Value left,
+                                       Value right)
+    : condition_(condition) {
+  InitOutput(0, output);
+  InitInput(0, left);
+  InitInput(1, right);
+}
+
+base::StringPiece CMovX64Instruction::mnemonic() const {
+  static const char* const mnemonics[] = {
+#define V(Name, mnemonic, ...) "cmov_x64_" mnemonic,
+      FOR_EACH_INTEGER_CONDITION(V)
+#undef V
+  };
+  auto const it = std::begin(mnemonics) + static_cast<size_t>(condition());
+  return it < std::end(mnemonics) ? *it : "cmov_x64_invalid";
+}
+
 // IntDivX64
 IntDivX64Instruction::IntDivX64Instruction(Value div_output,
                                            Value mod_output,
@@ -29,6 +52,19 @@ IntSignX64Instruction::IntSignX64Instruction(Value output, Value input) {
   InitInput(0, input);
 }
 
+// LeaX64
+LeaX64Instruction::LeaX64Instruction(Value output,
+                                     Value base,
+                                     Value index,
+                                     Value scale,
+                                     Value displacement) {
+  InitOutput(0, output);
+  InitInput(0, base);
+  InitInput(1, index);
+  InitInput(2, scale);
+  InitInput(3, displacement);
+}
+
 // UIntDivX64
 UIntDivX64Instruction::UIntDivX64Instruction(Value div_output,
                                              Value mod_output,
@@ -10,6 +10,26 @@
 namespace elang {
 namespace lir {
 
+// CMovX64 sets |right| to output if |condition| is satisfied by flags set by
+// preceding 'cmp' instruction, otherwise sets |left|, e.g. 'CMOVcc'.
+class ELANG_LIR_EXPORT CMovX64Instruction final
+    : public InstructionTemplate<1, 2> {
+  DECLARE_CONCRETE_LIR_INSTRUCTION_CLASS(CMovX64);
+
+ public:
+  IntCondition condition() const { return condition_; }
+
+ private:
+  CMovX64Instruction(Value output,
+                     IntCondition condition,
+                     Value left,
+                     Value right);
+
+  base::StringPiece mnemonic() const final;
+
+  IntCondition condition_;
+};
+
 // DivX64
 class ELANG_LIR_EXPORT IntDivX64Instruction final
     : public InstructionTemplate<2, 3> {
@@ -32,6 +52,19 @@ class ELANG_LIR_EXPORT IntSignX64Instruction final
   IntSignX64Instruction(Value output, Value input);
 };
 
+// LeaX64 computes |base + index * scale + displacement| by 'LEA' instruction.
+class ELANG_LIR_EXPORT LeaX64Instruction final
+    : public InstructionTemplate<1, 4> {
+  DECLARE_CONCRETE_LIR_INSTRUCTION_CLASS(LeaX64);
+
+ private:
+  LeaX64Instruction(Value output,
+                    Value base,
+                    Value index,
+                    Value scale,
+                    Value displacement);
+};
+
 // UIntDivX64
 class ELANG_LIR_EXPORT UIntDivX64Instruction final
     : public InstructionTemplate<2, 3> {
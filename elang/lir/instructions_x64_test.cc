@@ -90,6 +90,18 @@ TEST_F(LirInstructionsTestX64, BranchInstruction) {
       FormatFunction(&editor));
 }
 
+TEST_F(LirInstructionsTestX64, CMovX64Instruction) {
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const instr = factory()->NewCMovX64Instruction(
+      eax, IntCondition::SignedLessThan, eax, ecx);
+  EXPECT_FALSE(instr->IsTerminator());
+  EXPECT_EQ(0, instr->id());
+  EXPECT_EQ(2, instr->inputs().size());
+  EXPECT_EQ(1, instr->outputs().size());
+  EXPECT_EQ("--:0:cmov_x64_lt EAX = EAX, ECX", ToString(*instr));
+}
+
 TEST_F(LirInstructionsTestX64, CopyInstruction) {
   auto const function = CreateFunctionEmptySample();
   Editor editor(factory(), function);
@@ -136,6 +148,19 @@ TEST_F(LirInstructionsTestX64, IntSignX64Instruction) {
   EXPECT_EQ("--:0:sign_x64 EDX = EAX", ToString(*instr));
 }
 
+TEST_F(LirInstructionsTestX64, LeaX64Instruction) {
+  auto const rax = Target::RegisterOf(isa::RAX);
+  auto const rcx = Target::RegisterOf(isa::RCX);
+  auto const rdx = Target::RegisterOf(isa::RDX);
+  auto const instr = factory()->NewLeaX64Instruction(
+      rax, rcx, rdx, Value::SmallInt32(4), Value::SmallInt32(16));
+  EXPECT_FALSE(instr->IsTerminator());
+  EXPECT_EQ(0, instr->id());
+  EXPECT_EQ(4, instr->inputs().size());
+  EXPECT_EQ(1, instr->outputs().size());
+  EXPECT_EQ("--:0:lea_x64 RAX = RCX, RDX, 4, 16", ToString(*instr));
+}
+
 TEST_F(LirInstructionsTestX64, LoadInstruction) {
   auto const function = CreateFunctionEmptySample();
   Editor editor(factory(), function);
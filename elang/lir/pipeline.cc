@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <iterator>
 
 #include "elang/lir/pipeline.h"
@@ -11,7 +12,10 @@
 #include "elang/lir/factory.h"
 #include "elang/lir/emitters/code_emitter.h"
 #include "elang/lir/transforms/clean_pass.h"
+#include "elang/lir/transforms/copy_coalescing_pass.h"
+#include "elang/lir/transforms/if_conversion_x64_pass.h"
 #include "elang/lir/transforms/lowering_x64_pass.h"
+#include "elang/lir/transforms/peephole_x64_pass.h"
 #include "elang/lir/transforms/remove_critical_edges_pass.h"
 #include "elang/lir/transforms/register_allocation_pass.h"
 
@@ -20,15 +24,25 @@ namespace lir {
 
 namespace {
 
+const int kMaxLevel = 3;
+
 template <typename Pass>
 bool RunPass(base::StringPiece name, Editor* editor) {
   return Pass(name, editor).Run();
 }
 
+template <RegisterAssignmentsPass::Allocator allocator>
+bool RunRegisterAssignmentsPass(base::StringPiece name, Editor* editor) {
+  return RegisterAssignmentsPass(name, editor, allocator).Run();
+}
+
 typedef bool PassEntry(base::StringPiece name, Editor* editor);
 
+// A pass runs when optimization level is in [|min_level|, |max_level|].
 struct PassInfo {
   const char* name;
+  int min_level;
+  int max_level;
   PassEntry* entry;
 };
 
@@ -78,18 +92,25 @@ bool CodeEmitterPass::Run() {
 // kPassList
 //
 PassInfo const kPassList[] = {
-    {"lowering", &RunPass<LoweringX64Pass>},
-    {"critical_edge", &RunPass<RemoveCriticalEdgesPass>},
-    {"ra", &RunPass<RegisterAssignmentsPass>},
-    {"final_clean", &RunPass<CleanPass>},
+    {"if_conversion", 1, kMaxLevel, &RunPass<IfConversionX64Pass>},
+    {"lowering", 0, kMaxLevel, &RunPass<LoweringX64Pass>},
+    {"critical_edge", 0, kMaxLevel, &RunPass<RemoveCriticalEdgesPass>},
+    {"coalesce", 1, kMaxLevel, &RunPass<CopyCoalescingPass>},
+    {"ra", 0, 1, &RunRegisterAssignmentsPass<
+                     RegisterAssignmentsPass::Allocator::Local>},
+    {"ra", 2, kMaxLevel, &RunRegisterAssignmentsPass<
+                             RegisterAssignmentsPass::Allocator::LinearScan>},
+    {"peephole", 1, kMaxLevel, &RunPass<PeepholeX64Pass>},
+    {"final_clean", 0, kMaxLevel, &RunPass<CleanPass>},
 };
 
 }  // namespace
 
 Pipeline::Pipeline(Factory* factory,
                    api::MachineCodeBuilder* builder,
-                   Function* function)
-    : builder_(builder), factory_(factory), function_(function) {
+                   Function* function,
+                   int level)
+    : builder_(builder), factory_(factory), function_(function), level_(level) {
 }
 
 Pipeline::~Pipeline() {
@@ -97,7 +118,10 @@ Pipeline::~Pipeline() {
 
 bool Pipeline::Run() {
   Editor editor(factory_, function_);
+  auto const level = std::min(level_, kMaxLevel);
   for (auto it = std::begin(kPassList); it != std::end(kPassList); ++it) {
+    if (level < it->min_level || level > it->max_level)
+      continue;
     if (!it->entry(it->name, &editor))
       return false;
     if (!factory_->errors().empty())
@@ -30,9 +30,12 @@ class Function;
 //
 class Pipeline final {
  public:
+  // |level| is optimization level, e.g. we use |LinearScanAllocator| at
+  // level 2 or higher.
   Pipeline(Factory* factory,
            api::MachineCodeBuilder* builder,
-           Function* function);
+           Function* function,
+           int level);
   ~Pipeline();
 
   bool Run();
@@ -41,6 +44,7 @@ class Pipeline final {
   api::MachineCodeBuilder* const builder_;
   Factory* const factory_;
   Function* const function_;
+  int const level_;
 
   DISALLOW_COPY_AND_ASSIGN(Pipeline);
 };
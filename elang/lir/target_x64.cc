@@ -6,10 +6,12 @@
 #include <ostream>
 #include <string>
 
+#include "base/cpu.h"
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/string_piece.h"
 #include "elang/lir/instructions.h"
+#include "elang/lir/instructions_x64.h"
 #include "elang/lir/instruction_visitor.h"
 #include "elang/lir/literals.h"
 #include "elang/lir/literal_map.h"
@@ -20,6 +22,14 @@ namespace elang {
 namespace lir {
 
 namespace {
+enum class VexUsage {
+  Cpu,
+  Disabled,
+  Enabled,
+};
+
+VexUsage vex_usage = VexUsage::Cpu;
+
 Value AdjustTypeForCall(Value type) {
   return type.is_int8() || type.is_int16() ? Value::Int32Type() : type;
 }
@@ -194,12 +204,12 @@ static_assert(sizeof(kIntegerParameters) == sizeof(kFloatParameters),
 std::vector<Value> Target::AllocatableFloatRegisters() {
   std::vector<Value> registers(0);
   auto index = 0;
-  for (auto mask = isa::kAllocatableFloatRegisters; mask; mask >>= 1) {
+  for (auto mask = isa::kAllocatableFloatRegisters; mask;
+       mask >>= 1, ++index) {
     if ((mask & 1) == 0)
       continue;
     registers.push_back(
         RegisterOf(static_cast<isa::Register>(isa::XMM0D + index)));
-    ++index;
   }
   return registers;
 }
@@ -207,12 +217,12 @@ std::vector<Value> Target::AllocatableFloatRegisters() {
 std::vector<Value> Target::AllocatableGeneralRegisters() {
   std::vector<Value> registers(0);
   auto index = 0;
-  for (auto mask = isa::kAllocatableGeneralRegisters; mask; mask >>= 1) {
+  for (auto mask = isa::kAllocatableGeneralRegisters; mask;
+       mask >>= 1, ++index) {
     if ((mask & 1) == 0)
       continue;
     registers.push_back(
         RegisterOf(static_cast<isa::Register>(isa::RAX + index)));
-    ++index;
   }
   return registers;
 }
@@ -229,6 +239,22 @@ Value Target::ArgumentAt(Value output, size_t position) {
   return Value::Argument(output, base::checked_cast<int>(position));
 }
 
+// Instructions take 'r/m' as second operand:
+//  ADD/AND/CMOVcc/CMP/IMUL/OR/SUB/XOR r, r/m
+//  ADDSx/DIVSx/MULSx/SUBSx xmm, xmm/m
+// Note: Since 'UCOMISx' swaps operands depending on condition, we don't use
+// memory operand for 'fcmp'.
+bool Target::CanUseMemoryOperand(Instruction* instr, int position) {
+  if (position != 1)
+    return false;
+  return instr->is<BitAndInstruction>() || instr->is<BitOrInstruction>() ||
+         instr->is<BitXorInstruction>() || instr->is<CMovX64Instruction>() ||
+         instr->is<CmpInstruction>() || instr->is<FloatAddInstruction>() ||
+         instr->is<FloatDivInstruction>() || instr->is<FloatMulInstruction>() ||
+         instr->is<FloatSubInstruction>() || instr->is<IntAddInstruction>() ||
+         instr->is<IntMulInstruction>() || instr->is<IntSubInstruction>();
+}
+
 // We can use |MOV r/m, imm32| instruction.
 bool Target::HasCopyImmediateToMemory(Value value) {
   if (value.is_float())
@@ -245,6 +271,15 @@ bool Target::HasSwapInstruction(Value value) {
   return value.is_integer();
 }
 
+// Note: |base::CPU::has_avx()| also checks whether OS saves YMM registers
+// on context switch.
+bool Target::HasVexInstruction() {
+  if (vex_usage != VexUsage::Cpu)
+    return vex_usage == VexUsage::Enabled;
+  static const bool has_avx = base::CPU().has_avx();
+  return has_avx;
+}
+
 bool Target::HasXorInstruction(Value value) {
   return true;
 }
@@ -325,5 +360,9 @@ Value Target::ReturnAt(Value type, size_t position) {
   return Value::Void();
 }
 
+void Target::UseVexInstructionForTesting(bool use_vex) {
+  vex_usage = use_vex ? VexUsage::Enabled : VexUsage::Disabled;
+}
+
 }  // namespace lir
 }  // namespace elang
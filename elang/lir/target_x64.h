@@ -210,6 +210,7 @@ const int kFloatParameterRegisters =
 
 }  // namespace isa
 
+class Instruction;
 struct Value;
 enum class ValueSize : uint32_t;
 
@@ -226,6 +227,11 @@ class ELANG_LIR_EXPORT Target {
   // Returns register or location for argument at |position|.
   static Value ArgumentAt(Value output, size_t position);
 
+  // Returns true if input operand of |instruction| at |position| can be a
+  // memory operand, e.g. 'ADD r32, r/m32', so register allocator uses spill
+  // slot instead of reloading it into register.
+  static bool CanUseMemoryOperand(Instruction* instruction, int position);
+
   // Returns true if |value| is an integer literal represented in 32-bit
   // integer, otherwise false.
   static bool HasCopyImmediateToMemory(Value value);
@@ -235,6 +241,11 @@ class ELANG_LIR_EXPORT Target {
   // For x64, we use 'XCHG' instruction for swapping integer register.
   static bool HasSwapInstruction(Value value);
 
+  // Returns true if target CPU supports VEX prefixed instructions, e.g.
+  // 'VADDSD xmm1, xmm2, xmm3/m64', which take non-destructive three operands.
+  // We determine this value from |base::CPU| at first call.
+  static bool HasVexInstruction();
+
   // Returns true if this target 'xor' instruction for |value|. Parallel copy
   // expander emits 'xor' instruction for swapping physical registers without
   // temporary register. For x64, we use 'XORSD'/'XORSS' for swapping float
@@ -263,6 +274,10 @@ class ELANG_LIR_EXPORT Target {
 
   // Returns physical register for return value.
   static Value ReturnAt(Value type, size_t position);
+
+  // Overrides |HasVexInstruction()| to make test results independent from
+  // CPU running tests.
+  static void UseVexInstructionForTesting(bool use_vex);
 };
 
 }  // namespace lir
@@ -16,6 +16,7 @@
 #include "elang/lir/instructions.h"
 #include "elang/lir/literals.h"
 #include "elang/lir/target.h"
+#include "elang/lir/transforms/linear_scan_allocator.h"
 #include "elang/lir/transforms/register_allocator.h"
 #include "elang/lir/transforms/register_assignments.h"
 #include "elang/lir/transforms/remove_critical_edges_pass.h"
@@ -107,6 +108,35 @@ std::ostream& operator<<(std::ostream& ostream,
   }
   return ostream;
 }
+
+std::string PrintFunctionWithAllocation(const RegisterAssignments& assignments,
+                                       Function* function) {
+  std::ostringstream ostream;
+  ostream << *function << ":" << std::endl;
+  for (auto const block : function->basic_blocks()) {
+    ostream << *block << ":" << std::endl;
+
+    ostream << "  // In: ";
+    ostream << SortBasicBlocks(block->predecessors());
+    ostream << std::endl;
+
+    ostream << "  // Out: ";
+    ostream << SortBasicBlocks(block->successors());
+    ostream << std::endl;
+
+    for (auto const phi : block->phi_instructions())
+      ostream << "  " << PrintWithAllocation(assignments, phi) << std::endl;
+    for (auto const instr : block->instructions()) {
+      for (auto action : assignments.BeforeActionOf(instr)) {
+        ostream << "* " << PrintWithAllocation(assignments, action)
+                << std::endl;
+      }
+      ostream << "  " << PrintWithAllocation(assignments, instr) << std::endl;
+    }
+  }
+  return ostream.str();
+}
+
 }  // namespace
 
 //////////////////////////////////////////////////////////////////////
@@ -114,6 +144,9 @@ std::ostream& operator<<(std::ostream& ostream,
 // LirTest
 //
 LirTest::LirTest() : FactoryUser(new Factory(this)), factory_(factory()) {
+  // Expectations of test cases are written for SSE instructions. Test cases
+  // for VEX instructions enable them explicitly.
+  Target::UseVexInstructionForTesting(false);
 }
 
 LirTest::~LirTest() {
@@ -132,30 +165,23 @@ std::string LirTest::Allocate(Function* function) {
     allocator.Run();
   }
 
-  std::ostringstream ostream;
-  ostream << *function << ":" << std::endl;
-  for (auto const block : function->basic_blocks()) {
-    ostream << *block << ":" << std::endl;
+  return PrintFunctionWithAllocation(assignments, function);
+}
 
-    ostream << "  // In: ";
-    ostream << SortBasicBlocks(block->predecessors());
-    ostream << std::endl;
+std::string LirTest::AllocateByLinearScan(Function* function) {
+  Editor editor(factory(), function);
 
-    ostream << "  // Out: ";
-    ostream << SortBasicBlocks(block->successors());
-    ostream << std::endl;
+  RunPassForTesting<RemoveCriticalEdgesPass>(&editor);
 
-    for (auto const phi : block->phi_instructions())
-      ostream << "  " << PrintWithAllocation(assignments, phi) << std::endl;
-    for (auto const instr : block->instructions()) {
-      for (auto action : assignments.BeforeActionOf(instr)) {
-        ostream << "* " << PrintWithAllocation(assignments, action)
-                << std::endl;
-      }
-      ostream << "  " << PrintWithAllocation(assignments, instr) << std::endl;
-    }
+  RegisterAssignments assignments;
+  StackAssignments stack_assignments;
+
+  {
+    LinearScanAllocator allocator(&editor, &assignments, &stack_assignments);
+    allocator.Run();
   }
-  return ostream.str();
+
+  return PrintFunctionWithAllocation(assignments, function);
 }
 
 std::string LirTest::Commit(Editor* editor) {
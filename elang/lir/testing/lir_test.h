@@ -41,6 +41,10 @@ class LirTest : public ::testing::Test,
   // Returns instruction dump with register allocation results for |function|.
   std::string Allocate(Function* function);
 
+  // Returns instruction dump with |LinearScanAllocator| results for
+  // |function|.
+  std::string AllocateByLinearScan(Function* function);
+
   // Returns validation results as string after calling |Editor::Commit()|.
   std::string Commit(Editor* editor);
 
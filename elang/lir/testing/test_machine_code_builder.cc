@@ -129,6 +129,12 @@ void TestMachineCodeBuilder::PrepareCode(size_t size) {
   bytes_.resize(size);
 }
 
+uint8_t* TestMachineCodeBuilder::ReserveCode(size_t size) {
+  PrepareCode(size);
+  size_ = size;
+  return bytes_.data();
+}
+
 void TestMachineCodeBuilder::SetCallSite(size_t offset,
                                          base::StringPiece16 callee) {
   stream_ << base::StringPrintf("call site +%04X ", offset)
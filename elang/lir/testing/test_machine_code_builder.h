@@ -30,6 +30,7 @@ class TestMachineCodeBuilder final : public api::MachineCodeBuilder {
   void EmitCode(const uint8_t* bytes, size_t size) final;
   void FinishCode() final;
   void PrepareCode(size_t size) final;
+  uint8_t* ReserveCode(size_t size) final;
   void SetCallSite(size_t offset, base::StringPiece16 string) final;
   void SetCodeOffset(size_t offset, size_t target_offset) final;
   void SetFloat32(size_t offset, float32_t data) final;
@@ -0,0 +1,321 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <ostream>
+
+#include "elang/lir/transforms/copy_coalescing_pass.h"
+
+#include "base/containers/adapters.h"
+#include "base/logging.h"
+#include "elang/api/pass.h"
+#include "elang/base/analysis/liveness.h"
+#include "elang/base/analysis/liveness_collection.h"
+#include "elang/base/work_list.h"
+#include "elang/lir/editor.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+
+namespace elang {
+namespace lir {
+
+namespace {
+
+// Returns true if |instr| is two operands instruction rewritten by lowering
+// pass, e.g. 'copy %4 = %1; add %5 = %4, %2'.
+bool IsTwoOperandsInstruction(const Instruction* instr) {
+  return instr->is<BitAndInstruction>() || instr->is<BitOrInstruction>() ||
+         instr->is<BitXorInstruction>() || instr->is<FloatAddInstruction>() ||
+         instr->is<FloatDivInstruction>() || instr->is<FloatModInstruction>() ||
+         instr->is<FloatMulInstruction>() || instr->is<FloatSubInstruction>() ||
+         instr->is<IntAddInstruction>() || instr->is<IntMulInstruction>() ||
+         instr->is<IntSubInstruction>() || instr->is<ShlInstruction>() ||
+         instr->is<ShrInstruction>() || instr->is<UIntShrInstruction>() ||
+         instr->opcode() == Opcode::CMovX64;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// CopyCoalescingPass
+//
+CopyCoalescingPass::CopyCoalescingPass(base::StringPiece name, Editor* editor)
+    : FunctionPass(name, editor),
+      number_of_eliminated_copies_(0),
+      number_of_float_registers_(
+          Target::AllocatableFloatRegisters().size()),
+      number_of_general_registers_(
+          Target::AllocatableGeneralRegisters().size()) {
+}
+
+CopyCoalescingPass::~CopyCoalescingPass() {
+}
+
+void CopyCoalescingPass::AddInterference(Value value1, Value value2) {
+  if (value1 == value2 || !value1.is_virtual() || !value2.is_virtual())
+    return;
+  if (Value::TypeOf(value1) != Value::TypeOf(value2))
+    return;
+  interferences_[value1].insert(value2);
+  interferences_[value2].insert(value1);
+}
+
+// Build interference graph of virtual registers by reverse instruction list
+// scanning. An output of instruction interferes with virtual registers live
+// after the instruction, and an output of phi interferes with virtual
+// registers live at start of block.
+void CopyCoalescingPass::BuildInterferences() {
+  auto const& liveness_map = editor()->AnalyzeLiveness();
+  for (auto const block : function()->basic_blocks()) {
+    std::unordered_set<Value> lives;
+    for (auto const number : liveness_map.LivenessOf(block).out()) {
+      auto const live = liveness_map.VariableOf(number);
+      if (live.is_virtual())
+        lives.insert(live);
+    }
+
+    for (auto const instr : base::Reversed(block->instructions())) {
+      for (auto const output : instr->outputs()) {
+        for (auto const live : lives)
+          AddInterference(output, live);
+        for (auto const other : instr->outputs())
+          AddInterference(output, other);
+      }
+      for (auto const output : instr->outputs())
+        lives.erase(output);
+      for (auto const input : instr->inputs()) {
+        if (input.is_virtual())
+          lives.insert(input);
+      }
+    }
+
+    for (auto const phi : block->phi_instructions()) {
+      auto const output = phi->output(0);
+      for (auto const live : lives)
+        AddInterference(output, live);
+      for (auto const other : block->phi_instructions())
+        AddInterference(output, other->output(0));
+    }
+  }
+}
+
+// Returns true if |leader1| and |leader2| don't interfere and merging them
+// doesn't make graph harder to color. We use Briggs' test, merged node has
+// fewer than K neighbors of significant degree, or George's test, every
+// neighbor of |leader1| already interferes with |leader2| or has
+// insignificant degree.
+bool CopyCoalescingPass::CanCoalesce(Value leader1, Value leader2) {
+  auto const& neighbors1 = interferences_[leader1];
+  auto const& neighbors2 = interferences_[leader2];
+  if (neighbors2.count(leader1))
+    return false;
+  auto const limit = NumberOfRegistersFor(leader1);
+
+  auto george = true;
+  for (auto const neighbor : neighbors1) {
+    if (neighbors2.count(neighbor))
+      continue;
+    if (interferences_[neighbor].size() < limit)
+      continue;
+    george = false;
+    break;
+  }
+  if (george)
+    return true;
+
+  auto number_of_significants = 0u;
+  std::unordered_set<Value> neighbors(neighbors1.begin(), neighbors1.end());
+  neighbors.insert(neighbors2.begin(), neighbors2.end());
+  for (auto const neighbor : neighbors) {
+    auto degree = interferences_[neighbor].size();
+    // A neighbor of both |leader1| and |leader2| loses one neighbor.
+    if (neighbors1.count(neighbor) && neighbors2.count(neighbor))
+      --degree;
+    if (degree >= limit)
+      ++number_of_significants;
+  }
+  return number_of_significants < limit;
+}
+
+void CopyCoalescingPass::Coalesce(Value output, Value input) {
+  if (!output.is_virtual() || !input.is_virtual())
+    return;
+  if (Value::TypeOf(output) != Value::TypeOf(input) ||
+      output.size != input.size) {
+    return;
+  }
+  if (tied_registers_.count(output))
+    return;
+  auto const leader1 = LeaderOf(output);
+  auto const leader2 = LeaderOf(input);
+  if (leader1 == leader2 || !CanCoalesce(leader1, leader2))
+    return;
+  MergeInterferences(leader1, leader2);
+  // Merge group of |output| into group of |input|, which contains the
+  // definition of coalesced value.
+  auto& members2 = members_map_[leader2];
+  if (members2.empty())
+    members2.push_back(leader2);
+  auto const it1 = members_map_.find(leader1);
+  if (it1 == members_map_.end()) {
+    members2.push_back(leader1);
+    leader_map_[leader1] = leader2;
+    return;
+  }
+  for (auto const member : it1->second) {
+    members2.push_back(member);
+    leader_map_[member] = leader2;
+  }
+  members_map_.erase(it1);
+}
+
+void CopyCoalescingPass::CollectTiedRegisters() {
+  for (auto const block : function()->basic_blocks()) {
+    for (auto const instr : block->instructions()) {
+      if (!IsTwoOperandsInstruction(instr))
+        continue;
+      if (instr->input(0).is_virtual())
+        tied_registers_.insert(instr->input(0));
+    }
+  }
+}
+
+Value CopyCoalescingPass::LeaderOf(Value value) const {
+  auto const it = leader_map_.find(value);
+  return it == leader_map_.end() ? value : it->second;
+}
+
+// Moves interferences of |leader1| to |leader2|.
+void CopyCoalescingPass::MergeInterferences(Value leader1, Value leader2) {
+  auto const it = interferences_.find(leader1);
+  if (it == interferences_.end())
+    return;
+  for (auto const neighbor : it->second) {
+    auto& neighbors = interferences_[neighbor];
+    neighbors.erase(leader1);
+    neighbors.insert(leader2);
+    interferences_[leader2].insert(neighbor);
+  }
+  interferences_.erase(leader1);
+}
+
+size_t CopyCoalescingPass::NumberOfRegistersFor(Value value) const {
+  return value.is_float() ? number_of_float_registers_
+                          : number_of_general_registers_;
+}
+
+void CopyCoalescingPass::RewriteInstruction(Instruction* instr) {
+  auto position = 0;
+  for (auto const output : instr->outputs()) {
+    auto const leader = LeaderOf(output);
+    if (leader != output)
+      editor()->SetOutput(instr, position, leader);
+    ++position;
+  }
+  position = 0;
+  for (auto const input : instr->inputs()) {
+    auto const leader = LeaderOf(input);
+    if (leader != input)
+      editor()->SetInput(instr, position, leader);
+    ++position;
+  }
+}
+
+// Remove pairs of same output and input from 'pcopy' instruction.
+void CopyCoalescingPass::RewritePCopy(PCopyInstruction* instr) {
+  std::vector<Value> outputs;
+  std::vector<Value> inputs;
+  auto changed = false;
+  auto it = instr->inputs().begin();
+  for (auto const output : instr->outputs()) {
+    auto const input = *it;
+    ++it;
+    if (output == input) {
+      ++number_of_eliminated_copies_;
+      changed = true;
+      continue;
+    }
+    outputs.push_back(output);
+    inputs.push_back(input);
+  }
+  if (!changed)
+    return;
+  if (outputs.empty()) {
+    editor()->Remove(instr);
+    return;
+  }
+  editor()->Replace(NewPCopyInstruction(outputs, inputs), instr);
+}
+
+// api::Pass
+void CopyCoalescingPass::DumpAfterPass(const api::PassDumpContext& context) {
+  *context.ostream << "// Eliminated " << number_of_eliminated_copies_
+                   << " copies" << std::endl;
+  FunctionPass::DumpAfterPass(context);
+}
+
+void CopyCoalescingPass::DumpBeforePass(const api::PassDumpContext& context) {
+  FunctionPass::DumpBeforePass(context);
+}
+
+// FunctionPass
+void CopyCoalescingPass::RunOnFunction() {
+  BuildInterferences();
+  CollectTiedRegisters();
+
+  // Collect coalescing candidates in reverse post order so that we visit
+  // definition of virtual register before its copies.
+  for (auto const block : editor()->ReversePostOrderList()) {
+    for (auto const instr : block->instructions()) {
+      if (!instr->is<CopyInstruction>() && !instr->is<PCopyInstruction>())
+        continue;
+      auto it = instr->inputs().begin();
+      for (auto const output : instr->outputs()) {
+        Coalesce(output, *it);
+        ++it;
+      }
+    }
+  }
+  if (leader_map_.empty())
+    return;
+
+  // Rewrite virtual registers with leader of their group.
+  WorkList<Instruction> useless_instructions;
+  for (auto const block : function()->basic_blocks()) {
+    Editor::ScopedEdit scope(editor());
+    editor()->Edit(block);
+    for (auto const phi : block->phi_instructions()) {
+      auto const output = LeaderOf(phi->output(0));
+      if (output != phi->output(0))
+        editor()->SetOutput(phi, 0, output);
+      for (auto const phi_input : phi->phi_inputs()) {
+        auto const leader = LeaderOf(phi_input->value());
+        if (leader == phi_input->value())
+          continue;
+        editor()->SetPhiInput(phi, phi_input->basic_block(), leader);
+      }
+    }
+    std::vector<PCopyInstruction*> pcopy_instrs;
+    for (auto const instr : block->instructions()) {
+      RewriteInstruction(instr);
+      if (auto const pcopy = instr->as<PCopyInstruction>()) {
+        pcopy_instrs.push_back(pcopy);
+        continue;
+      }
+      if (!instr->is<CopyInstruction>() || instr->output(0) != instr->input(0))
+        continue;
+      useless_instructions.Push(instr);
+      ++number_of_eliminated_copies_;
+    }
+    for (auto const pcopy : pcopy_instrs)
+      RewritePCopy(pcopy);
+  }
+  editor()->BulkRemoveInstructions(&useless_instructions);
+  DVLOG(1) << "Eliminated " << number_of_eliminated_copies_ << " copies in "
+           << *function();
+}
+
+}  // namespace lir
+}  // namespace elang
@@ -0,0 +1,88 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_LIR_TRANSFORMS_COPY_COALESCING_PASS_H_
+#define ELANG_LIR_TRANSFORMS_COPY_COALESCING_PASS_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "elang/lir/instructions_forward.h"
+#include "elang/lir/lir_export.h"
+#include "elang/lir/pass.h"
+#include "elang/lir/value.h"
+
+namespace elang {
+namespace lir {
+
+class Editor;
+
+//////////////////////////////////////////////////////////////////////
+//
+// CopyCoalescingPass merges virtual registers related by 'copy' and 'pcopy'
+// instructions, e.g. 'copy %r2 = %r1', if they don't interfere each other,
+// then removes copies which become 'copy %r1 = %r1'.
+//
+// We build interference graph from liveness at each definition, and merge
+// registers only if merged register passes Briggs' or George's test, so
+// coalescing doesn't make graph harder to color. We don't coalesce copy of
+// the first operand of two operands instruction rewritten by lowering pass,
+// since register allocator requires output and the first input of such
+// instruction to be same register.
+//
+class ELANG_LIR_EXPORT CopyCoalescingPass final : public FunctionPass {
+ public:
+  CopyCoalescingPass(base::StringPiece name, Editor* editor);
+  ~CopyCoalescingPass() final;
+
+  // Number of copies eliminated by this pass.
+  int number_of_eliminated_copies() const {
+    return number_of_eliminated_copies_;
+  }
+
+ private:
+  void AddInterference(Value value1, Value value2);
+  void BuildInterferences();
+  bool CanCoalesce(Value leader1, Value leader2);
+  void CollectTiedRegisters();
+  void Coalesce(Value output, Value input);
+  Value LeaderOf(Value value) const;
+  void MergeInterferences(Value leader1, Value leader2);
+  size_t NumberOfRegistersFor(Value value) const;
+  void RewriteInstruction(Instruction* instr);
+  void RewritePCopy(PCopyInstruction* instr);
+
+  // api::Pass
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  // FunctionPass
+  void RunOnFunction() final;
+
+  // Interference graph of leaders of coalesced groups.
+  std::unordered_map<Value, std::unordered_set<Value>> interferences_;
+
+  // Map virtual register to leader of coalesced group.
+  std::unordered_map<Value, Value> leader_map_;
+
+  // Map leader to members of coalesced group including leader itself.
+  std::unordered_map<Value, std::vector<Value>> members_map_;
+
+  int number_of_eliminated_copies_;
+  const size_t number_of_float_registers_;
+  const size_t number_of_general_registers_;
+
+  // Virtual registers used as the first operand of two operands
+  // instructions.
+  std::unordered_set<Value> tied_registers_;
+
+  DISALLOW_COPY_AND_ASSIGN(CopyCoalescingPass);
+};
+
+}  // namespace lir
+}  // namespace elang
+
+#endif  // ELANG_LIR_TRANSFORMS_COPY_COALESCING_PASS_H_
@@ -0,0 +1,241 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/lir/testing/lir_test.h"
+
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+#include "elang/lir/transforms/copy_coalescing_pass.h"
+
+namespace elang {
+namespace lir {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LirCopyCoalescingPassTest
+//
+class LirCopyCoalescingPassTest : public testing::LirTest {
+ protected:
+  LirCopyCoalescingPassTest() = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LirCopyCoalescingPassTest);
+};
+
+// Test cases...
+
+TEST_F(LirCopyCoalescingPassTest, Basic) {
+  auto const var0 = NewIntPtrRegister();
+  auto const var1 = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(var0, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(var0, parameter));
+  editor.Append(NewCopyInstruction(var1, var0));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var1, 0), var1));
+  EXPECT_EQ("", Commit(&editor));
+
+  CopyCoalescingPass pass("test", &editor);
+  pass.Run();
+  EXPECT_EQ(1, pass.number_of_eliminated_copies());
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX =\n"
+      "  mov %r1l = RCX\n"
+      "  mov RAX = %r1l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+TEST_F(LirCopyCoalescingPassTest, Conflict) {
+  auto const var0 = NewIntPtrRegister();
+  auto const var1 = NewIntPtrRegister();
+  auto const var2 = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(var0, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(var0, parameter));
+  editor.Append(NewCopyInstruction(var1, var0));
+  editor.Append(NewIntAddInstruction(var2, var0, var1));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var2, 0), var2));
+  EXPECT_EQ("", Commit(&editor));
+
+  CopyCoalescingPass pass("test", &editor);
+  pass.Run();
+  EXPECT_EQ(0, pass.number_of_eliminated_copies());
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX =\n"
+      "  mov %r1l = RCX\n"
+      "  mov %r2l = %r1l\n"
+      "  add %r3l = %r1l, %r2l\n"
+      "  mov RAX = %r3l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// Copy from a loop phi is coalesced even if a value live through the loop
+// is copied in the loop body.
+TEST_F(LirCopyCoalescingPassTest, Loop) {
+  auto const var0 = NewIntPtrRegister();
+  auto const var1 = NewIntPtrRegister();
+  auto const var2 = NewIntPtrRegister();
+  auto const var3 = NewIntPtrRegister();
+  auto const var4 = NewIntPtrRegister();
+  std::vector<Value> parameters{
+      Target::ParameterAt(var0, 0), Target::ParameterAt(var1, 1),
+  };
+  auto const function = CreateFunctionEmptySample(parameters);
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const loop_block = editor.NewBasicBlock(exit_block);
+  auto const done_block = editor.NewBasicBlock(exit_block);
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewPCopyInstruction({var0, var1}, parameters));
+  editor.SetJump(loop_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(loop_block);
+  auto const phi = editor.NewPhi(var2);
+  editor.SetPhiInput(phi, function->entry_block(), var1);
+  editor.SetPhiInput(phi, loop_block, var3);
+  editor.Append(NewCopyInstruction(var3, var2));
+  editor.Append(NewCopyInstruction(var4, var0));
+  auto const cond = factory()->NewConditional();
+  editor.Append(NewCmpInstruction(cond, IntCondition::Equal, var4, var3));
+  editor.SetBranch(cond, loop_block, done_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(done_block);
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  CopyCoalescingPass pass("test", &editor);
+  pass.Run();
+  EXPECT_EQ(1, pass.number_of_eliminated_copies());
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block3}\n"
+      "  entry RCX, RDX =\n"
+      "  pcopy %r1l, %r2l = RCX, RDX\n"
+      "  jmp block3\n"
+      "block3:\n"
+      "  // In: {block1, block3}\n"
+      "  // Out: {block3, block4}\n"
+      "  phi %r3l = block1 %r2l, block3 %r3l\n"
+      "  mov %r5l = %r1l\n"
+      "  cmp_eq %b2 = %r5l, %r3l\n"
+      "  br %b2, block3, block4\n"
+      "block4:\n"
+      "  // In: {block3}\n"
+      "  // Out: {block2}\n"
+      "  mov RAX = %r1l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block4}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// Copies feeding and consuming a phi are coalesced into the phi operands.
+TEST_F(LirCopyCoalescingPassTest, Phi) {
+  auto const var0 = NewIntPtrRegister();
+  auto const var1 = NewIntPtrRegister();
+  auto const var2 = NewIntPtrRegister();
+  auto const var3 = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(var0, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const true_block = editor.NewBasicBlock(exit_block);
+  auto const false_block = editor.NewBasicBlock(exit_block);
+  auto const merge_block = editor.NewBasicBlock(exit_block);
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(var0, parameter));
+  auto const cond = factory()->NewConditional();
+  editor.Append(
+      NewCmpInstruction(cond, IntCondition::Equal, var0, Value::SmallInt64(0)));
+  editor.SetBranch(cond, true_block, false_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(true_block);
+  editor.Append(NewCopyInstruction(var1, var0));
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(false_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(merge_block);
+  auto const phi = editor.NewPhi(var2);
+  editor.SetPhiInput(phi, true_block, var1);
+  editor.SetPhiInput(phi, false_block, var0);
+  editor.Append(NewCopyInstruction(var3, var2));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var3, 0), var3));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  CopyCoalescingPass pass("test", &editor);
+  pass.Run();
+  EXPECT_EQ(2, pass.number_of_eliminated_copies());
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block3, block4}\n"
+      "  entry RCX =\n"
+      "  mov %r1l = RCX\n"
+      "  cmp_eq %b2 = %r1l, 0l\n"
+      "  br %b2, block3, block4\n"
+      "block3:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block5}\n"
+      "  jmp block5\n"
+      "block4:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block5}\n"
+      "  jmp block5\n"
+      "block5:\n"
+      "  // In: {block3, block4}\n"
+      "  // Out: {block2}\n"
+      "  phi %r3l = block3 %r1l, block4 %r1l\n"
+      "  mov RAX = %r3l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block5}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+}  // namespace lir
+}  // namespace elang
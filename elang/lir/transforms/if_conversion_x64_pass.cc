@@ -0,0 +1,197 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/lir/transforms/if_conversion_x64_pass.h"
+
+#include "base/logging.h"
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/instructions_x64.h"
+#include "elang/lir/literals.h"
+
+namespace elang {
+namespace lir {
+
+namespace {
+
+// Maximum number of instructions in an arm, excluding 'jmp'.
+const int kMaxArmInstructions = 2;
+
+// Maximum number of 'phi' instructions in merge block.
+const int kMaxPhiInstructions = 2;
+
+// Returns true if |cmp| is predicted biased by heuristics as same as
+// |optimizer::StaticPredictor|, e.g. comparison to zero or null.
+bool IsBiasedCondition(const CmpInstruction* cmp) {
+  auto const right = cmp->input(1);
+  return right.is_immediate() && !right.data;
+}
+
+// Returns true if we can execute |instr| speculatively, e.g. it doesn't have
+// side effect and exception.
+bool IsSpeculatable(const Instruction* instr) {
+  for (auto const output : instr->outputs()) {
+    if (!output.is_virtual())
+      return false;
+  }
+  return instr->is<BitAndInstruction>() || instr->is<BitOrInstruction>() ||
+         instr->is<BitXorInstruction>() || instr->is<CopyInstruction>() ||
+         instr->is<IntAddInstruction>() || instr->is<IntMulInstruction>() ||
+         instr->is<IntSubInstruction>() || instr->is<LiteralInstruction>() ||
+         instr->is<ShlInstruction>() || instr->is<ShrInstruction>() ||
+         instr->is<SignExtendInstruction>() ||
+         instr->is<TruncateInstruction>() || instr->is<UIntShrInstruction>() ||
+         instr->is<ZeroExtendInstruction>();
+}
+
+// Returns true if |block| has only one predecessor, jumps to |merge_block|
+// and contains a few instructions we can execute speculatively.
+bool IsSpeculatableArm(BasicBlock* block, BasicBlock* merge_block) {
+  if (block->predecessors().size() != 1u)
+    return false;
+  auto const jump = block->last_instruction()->as<JumpInstruction>();
+  if (!jump || jump->target_block() != merge_block)
+    return false;
+  auto count = 0;
+  for (auto const instr : block->instructions()) {
+    if (instr == jump)
+      break;
+    if (!IsSpeculatable(instr) || ++count > kMaxArmInstructions)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// IfConversionX64Pass
+//
+IfConversionX64Pass::IfConversionX64Pass(base::StringPiece name,
+                                         Editor* editor)
+    : FunctionPass(name, editor) {
+}
+
+IfConversionX64Pass::~IfConversionX64Pass() {
+}
+
+//   block1:
+//     instructions...
+//     cmp_cc %b = %left, %right
+//     cmov_x64_cc %r1 = %false1, %true1
+//     cmov_x64_cc %r2 = %false2, %true2
+//     jmp merge
+// Where instructions are moved from arms.
+bool IfConversionX64Pass::ConvertBranch(BranchInstruction* branch) {
+  auto const previous = branch->previous();
+  auto const cmp = previous ? previous->as<CmpInstruction>() : nullptr;
+  if (!cmp || cmp->output(0) != branch->input(0) || IsBiasedCondition(cmp))
+    return false;
+
+  auto const block = branch->basic_block();
+  auto const merge_block = MergeBlockOf(branch);
+  if (!merge_block || merge_block == block ||
+      merge_block->predecessors().size() != 2u) {
+    return false;
+  }
+
+  auto count = 0;
+  for (auto const phi : merge_block->phi_instructions()) {
+    auto const output = phi->output(0);
+    if (!output.is_int32() && !output.is_int64())
+      return false;
+    if (++count > kMaxPhiInstructions)
+      return false;
+  }
+
+  // Predecessors of |merge_block| on true edge and false edge.
+  auto const true_block =
+      branch->true_block() == merge_block ? block : branch->true_block();
+  auto const false_block =
+      branch->false_block() == merge_block ? block : branch->false_block();
+
+  std::vector<Instruction*> cmov_instructions;
+  for (auto const phi : merge_block->phi_instructions()) {
+    cmov_instructions.push_back(factory()->NewCMovX64Instruction(
+        phi->output(0), cmp->condition(), phi->input_of(false_block),
+        phi->input_of(true_block)));
+  }
+
+  std::vector<BasicBlock*> arms;
+  if (true_block != block)
+    arms.push_back(true_block);
+  if (false_block != block)
+    arms.push_back(false_block);
+
+  DVLOG(1) << "If conversion: " << *branch;
+  std::vector<Instruction*> instructions;
+  for (auto const arm : arms) {
+    editor()->Edit(arm);
+    while (arm->first_instruction() != arm->last_instruction()) {
+      auto const instr = arm->first_instruction();
+      editor()->Remove(instr);
+      instructions.push_back(instr);
+    }
+    editor()->Commit();
+  }
+
+  editor()->Edit(merge_block);
+  editor()->DiscardPhiInstructions();
+  editor()->Commit();
+
+  editor()->Edit(block);
+  for (auto const instr : instructions)
+    editor()->InsertBefore(instr, cmp);
+  for (auto const instr : cmov_instructions)
+    editor()->InsertBefore(instr, branch);
+  editor()->SetJump(merge_block);
+  editor()->Commit();
+
+  for (auto const arm : arms)
+    editor()->DiscardBlock(arm);
+  return true;
+}
+
+BasicBlock* IfConversionX64Pass::MergeBlockOf(BranchInstruction* branch) const {
+  auto const true_block = branch->true_block();
+  auto const false_block = branch->false_block();
+  if (true_block == false_block)
+    return nullptr;
+  // Triangle
+  if (IsSpeculatableArm(true_block, false_block))
+    return false_block;
+  if (IsSpeculatableArm(false_block, true_block))
+    return true_block;
+  // Diamond
+  auto const jump = true_block->last_instruction()->as<JumpInstruction>();
+  if (!jump)
+    return nullptr;
+  auto const merge_block = jump->target_block();
+  if (!IsSpeculatableArm(true_block, merge_block) ||
+      !IsSpeculatableArm(false_block, merge_block)) {
+    return nullptr;
+  }
+  return merge_block;
+}
+
+// FunctionPass
+void IfConversionX64Pass::RunOnFunction() {
+  // Since we remove arms of converted branch, we can't iterate on
+  // |PostOrderList()| during conversion. We process successors first for
+  // discarded arms are processed before their branch.
+  std::vector<BasicBlock*> blocks(editor()->PostOrderList().begin(),
+                                  editor()->PostOrderList().end());
+  for (auto const block : blocks) {
+    if (auto const branch = block->last_instruction()->as<BranchInstruction>())
+      ConvertBranch(branch);
+  }
+  DCHECK(editor()->Validate()) << *editor();
+}
+
+}  // namespace lir
+}  // namespace elang
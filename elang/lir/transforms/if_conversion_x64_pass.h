@@ -0,0 +1,68 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_LIR_TRANSFORMS_IF_CONVERSION_X64_PASS_H_
+#define ELANG_LIR_TRANSFORMS_IF_CONVERSION_X64_PASS_H_
+
+#include "elang/lir/instructions_forward.h"
+#include "elang/lir/lir_export.h"
+#include "elang/lir/pass.h"
+
+namespace elang {
+namespace lir {
+
+class BasicBlock;
+
+//////////////////////////////////////////////////////////////////////
+//
+// IfConversionX64Pass converts small diamond and triangle shaped control
+// flow merging integer values into 'cmov_x64' instructions, since data
+// dependent branches are hard to predict:
+//
+//   block1:
+//     cmp_lt %b2 = %r1, %r2
+//     br %b2, block3, block4
+//   block3:
+//     jmp block5
+//   block4:
+//     jmp block5
+//   block5:
+//     phi %r3 = block3 %r1, block4 %r2
+//   =>
+//   block1:
+//     cmp_lt %b2 = %r1, %r2
+//     cmov_x64_lt %r3 = %r2, %r1
+//     jmp block5
+//   block5:
+//
+// Instructions in arms are executed speculatively before 'cmp', so we
+// convert only arms having a few instructions without side effect and
+// exception. Since LIR doesn't have edge profile, we skip branches which
+// |optimizer::StaticPredictor| predicts biased, e.g. comparison to zero.
+//
+// This pass should run before |LoweringX64Pass|.
+//
+class ELANG_LIR_EXPORT IfConversionX64Pass final : public FunctionPass {
+ public:
+  IfConversionX64Pass(base::StringPiece name, Editor* editor);
+  ~IfConversionX64Pass() final;
+
+ private:
+  // Returns true if we convert |branch| into 'cmov_x64' instructions.
+  bool ConvertBranch(BranchInstruction* branch);
+
+  // Returns merge block of diamond or triangle started by |branch|, or null if
+  // arms of |branch| can't be executed speculatively.
+  BasicBlock* MergeBlockOf(BranchInstruction* branch) const;
+
+  // FunctionPass
+  void RunOnFunction() final;
+
+  DISALLOW_COPY_AND_ASSIGN(IfConversionX64Pass);
+};
+
+}  // namespace lir
+}  // namespace elang
+
+#endif  // ELANG_LIR_TRANSFORMS_IF_CONVERSION_X64_PASS_H_
@@ -0,0 +1,122 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "elang/lir/testing/lir_test.h"
+
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+#include "elang/lir/transforms/if_conversion_x64_pass.h"
+
+namespace elang {
+namespace lir {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LirIfConversionX64PassTest
+//
+class LirIfConversionX64PassTest : public testing::LirTest {
+ protected:
+  LirIfConversionX64PassTest() = default;
+
+  // Returns function which returns |left| if |left| |condition| |right|,
+  // otherwise |right|:
+  //  block1:
+  //    cmp_cc %b2 = %r1, right
+  //    br %b2, block3, block4
+  //  block3:
+  //    jmp block5
+  //  block4:
+  //    jmp block5
+  //  block5:
+  //    phi %r3 = block3 %r1, block4 right
+  Function* CreateSelectFunction(IntCondition condition, Value right);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LirIfConversionX64PassTest);
+};
+
+Function* LirIfConversionX64PassTest::CreateSelectFunction(
+    IntCondition condition,
+    Value right) {
+  auto const type = Value::Int32Type();
+  auto const function =
+      CreateFunctionEmptySample({Target::ParameterAt(type, 0)});
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const true_block = editor.NewBasicBlock(exit_block);
+  auto const false_block = editor.NewBasicBlock(exit_block);
+  auto const merge_block = editor.NewBasicBlock(exit_block);
+  auto const var0 = NewRegister(type);
+  auto const cond = NewConditional();
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(var0, Target::ParameterAt(type, 0)));
+  editor.Append(NewCmpInstruction(cond, condition, var0, right));
+  editor.SetBranch(cond, true_block, false_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(true_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(false_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(merge_block);
+  auto const phi = editor.NewPhi(NewRegister(type));
+  editor.SetPhiInput(phi, true_block, var0);
+  editor.SetPhiInput(phi, false_block, right);
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), phi->output(0)));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  return function;
+}
+
+// Test cases...
+
+TEST_F(LirIfConversionX64PassTest, Basic) {
+  auto const function =
+      CreateSelectFunction(IntCondition::SignedLessThan, Value::SmallInt32(9));
+  Editor editor(factory(), function);
+  RunPassForTesting<IfConversionX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block5}\n"
+      "  entry ECX =\n"
+      "  mov %r1 = ECX\n"
+      "  cmp_lt %b2 = %r1, 9\n"
+      "  cmov_x64_lt %r2 = 9, %r1\n"
+      "  jmp block5\n"
+      "block5:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block2}\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block5}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// Comparison to zero is predicted biased, so we keep branch.
+TEST_F(LirIfConversionX64PassTest, Biased) {
+  auto const function =
+      CreateSelectFunction(IntCondition::SignedLessThan, Value::SmallInt32(0));
+  Editor editor(factory(), function);
+  auto const before = FormatFunction(&editor);
+  RunPassForTesting<IfConversionX64Pass>(&editor);
+  EXPECT_EQ(before, FormatFunction(&editor));
+}
+
+}  // namespace lir
+}  // namespace elang
@@ -0,0 +1,1143 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <unordered_set>
+
+#include "elang/lir/transforms/linear_scan_allocator.h"
+
+#include "base/logging.h"
+#include "elang/base/analysis/liveness.h"
+#include "elang/base/analysis/liveness_collection.h"
+#include "elang/base/ordered_list.h"
+#include "elang/base/zone_allocated.h"
+#include "elang/base/zone_vector.h"
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+#include "elang/lir/transforms/parallel_copy_expander.h"
+#include "elang/lir/transforms/stack_allocator.h"
+
+namespace elang {
+namespace lir {
+
+namespace {
+
+const int kMaxPosition = std::numeric_limits<int>::max();
+
+struct LiveRange {
+  int start;
+  int end;
+};
+
+struct UsePosition {
+  int position;
+  bool needs_register;
+};
+
+Value AdjustSize(Value type, Value value) {
+  DCHECK_EQ(type.type, value.type);
+  return Value(type.type, type.size, value.kind, value.data);
+}
+
+bool CompareRangeStart(const LiveRange& range1, const LiveRange& range2) {
+  return range1.start < range2.start;
+}
+
+bool CompareUsePosition(const UsePosition& use1, const UsePosition& use2) {
+  return use1.position < use2.position;
+}
+
+std::array<Value, 4> IntegerTypesAndFloatTypes() {
+  return {Value::Int32Type(),
+          Value::Int64Type(),
+          Value::Float32Type(),
+          Value::Float64Type()};
+}
+
+// We prefer caller saved registers, since callee saved registers need to be
+// preserved in prologue and epilogue. Intervals living across 'call'
+// instructions get callee saved registers, because fixed intervals of caller
+// saved registers block them.
+int PreferenceOf(const Value& reg) {
+  DCHECK(reg.is_physical());
+  return Target::IsCallerSavedRegister(reg) ? 0 : 1;
+}
+
+bool CompareRegister(const Value& reg1, const Value& reg2) {
+  return PreferenceOf(reg1) < PreferenceOf(reg2);
+}
+
+// Returns true if |instr| is two operands instruction rewritten by lowering
+// pass, e.g. 'add %2 = %1, %3', output of which must be allocated to same
+// register as the first input.
+bool IsTwoOperandsInstruction(const Instruction* instr) {
+  if (instr->CountOutputs() != 1 || instr->CountInputs() != 2)
+    return false;
+  if (!instr->output(0).is_virtual() || !instr->input(0).is_virtual())
+    return false;
+  return instr->is<BitAndInstruction>() || instr->is<BitOrInstruction>() ||
+         instr->is<BitXorInstruction>() || instr->is<FloatAddInstruction>() ||
+         instr->is<FloatDivInstruction>() || instr->is<FloatModInstruction>() ||
+         instr->is<FloatMulInstruction>() || instr->is<FloatSubInstruction>() ||
+         instr->is<IntAddInstruction>() || instr->is<IntMulInstruction>() ||
+         instr->is<IntSubInstruction>() || instr->is<ShlInstruction>() ||
+         instr->is<ShrInstruction>() || instr->is<UIntShrInstruction>() ||
+         instr->opcode() == Opcode::CMovX64;
+}
+
+// Returns true if input operand of |instr| at |position| must be in register.
+bool NeedsRegister(Instruction* instr, int position) {
+  if (instr->is<UseInstruction>())
+    return false;
+  if (Target::CanUseMemoryOperand(instr, position))
+    return false;
+  // Since first operand of |LoadInstruction| is used for GC map, we don't
+  // need to allocate physical register for it.
+  return !instr->is<LoadInstruction>() || position != 0;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// LinearScanAllocator::LiveInterval
+//
+// A live interval holds sorted list of half open ranges, e.g. [start, end),
+// and use positions. Splitting interval makes chain of intervals, starting
+// from root interval, each of them has own location.
+//
+class LinearScanAllocator::LiveInterval final : public ZoneAllocated {
+ public:
+  LiveInterval(Zone* zone, int id, Value value, LiveInterval* parent);
+
+  int end() const { return ranges_.back().end; }
+  LiveInterval* hint() const { return hint_; }
+  Value hint_physical() const { return hint_physical_; }
+  int id() const { return id_; }
+  bool is_fixed() const { return value_.is_physical(); }
+  Value location() const { return location_; }
+  LiveInterval* next() const { return next_; }
+  const ZoneVector<LiveRange>& ranges() const { return ranges_; }
+  LiveInterval* root() { return parent_ ? parent_ : this; }
+  int start() const { return ranges_.front().start; }
+  LiveInterval* tied() const { return tied_; }
+  Value value() const { return value_; }
+
+  void set_hint(LiveInterval* hint) { hint_ = hint; }
+  void set_hint_physical(Value natural) { hint_physical_ = natural; }
+  void set_location(Value location) { location_ = location; }
+  void set_tied(LiveInterval* tied) { tied_ = tied; }
+
+  // Functions used while building intervals.
+  void AddRange(int start, int end);
+  void AddUse(int position, bool needs_register);
+  void Normalize();
+  void SetRangeStart(size_t index, int start);
+
+  // Returns interval in chain starting from this interval which covers
+  // |position|, or null.
+  const LiveInterval* ChildAt(int position) const;
+
+  bool Covers(int position) const;
+
+  // Returns the first position where this interval and |other| are live,
+  // or |kMaxPosition|.
+  int FirstIntersectionWith(const LiveInterval* other) const;
+
+  // Returns the first position of use requiring register at or after
+  // |position|, or |kMaxPosition|.
+  int NextRegisterUseAfter(int position) const;
+
+  // Split this interval at |position| and move ranges and uses after
+  // |position| to |child|.
+  void SplitAt(int position, LiveInterval* child);
+
+  // Interval which has lower spill weight is cheaper to spill.
+  float SpillWeight() const;
+
+  // Returns true if |interval1| should be processed after |interval2|.
+  static bool StartsAfter(const LiveInterval* interval1,
+                          const LiveInterval* interval2);
+
+ private:
+  LiveInterval* hint_;
+  Value hint_physical_;
+  int const id_;
+  Value location_;
+  LiveInterval* next_;
+  LiveInterval* const parent_;
+  ZoneVector<LiveRange> ranges_;
+  LiveInterval* tied_;
+  ZoneVector<UsePosition> uses_;
+  Value const value_;
+
+  DISALLOW_COPY_AND_ASSIGN(LiveInterval);
+};
+
+LinearScanAllocator::LiveInterval::LiveInterval(Zone* zone,
+                                                int id,
+                                                Value value,
+                                                LiveInterval* parent)
+    : hint_(nullptr),
+      id_(id),
+      next_(nullptr),
+      parent_(parent),
+      ranges_(zone),
+      tied_(nullptr),
+      uses_(zone),
+      value_(value) {
+}
+
+void LinearScanAllocator::LiveInterval::AddRange(int start, int end) {
+  DCHECK_LT(start, end);
+  ranges_.push_back({start, end});
+}
+
+void LinearScanAllocator::LiveInterval::AddUse(int position,
+                                               bool needs_register) {
+  uses_.push_back({position, needs_register});
+}
+
+const LinearScanAllocator::LiveInterval*
+LinearScanAllocator::LiveInterval::ChildAt(int position) const {
+  for (auto interval = this; interval; interval = interval->next_) {
+    if (interval->Covers(position))
+      return interval;
+  }
+  return nullptr;
+}
+
+bool LinearScanAllocator::LiveInterval::Covers(int position) const {
+  for (auto const range : ranges_) {
+    if (position < range.start)
+      return false;
+    if (position < range.end)
+      return true;
+  }
+  return false;
+}
+
+int LinearScanAllocator::LiveInterval::FirstIntersectionWith(
+    const LiveInterval* other) const {
+  auto it1 = ranges_.begin();
+  auto it2 = other->ranges_.begin();
+  while (it1 != ranges_.end() && it2 != other->ranges_.end()) {
+    auto const start = std::max(it1->start, it2->start);
+    auto const end = std::min(it1->end, it2->end);
+    if (start < end)
+      return start;
+    if (it1->end <= it2->end)
+      ++it1;
+    else
+      ++it2;
+  }
+  return kMaxPosition;
+}
+
+int LinearScanAllocator::LiveInterval::NextRegisterUseAfter(
+    int position) const {
+  for (auto const use : uses_) {
+    if (use.needs_register && use.position >= position)
+      return use.position;
+  }
+  return kMaxPosition;
+}
+
+// Sort ranges and uses, and merge overlapped or adjacent ranges, since we
+// add them in arbitrary order while building intervals.
+void LinearScanAllocator::LiveInterval::Normalize() {
+  std::sort(uses_.begin(), uses_.end(), CompareUsePosition);
+  if (ranges_.empty())
+    return;
+  std::sort(ranges_.begin(), ranges_.end(), CompareRangeStart);
+  auto last = ranges_.begin();
+  for (auto it = ranges_.begin() + 1; it != ranges_.end(); ++it) {
+    if (it->start <= last->end) {
+      last->end = std::max(last->end, it->end);
+      continue;
+    }
+    ++last;
+    *last = *it;
+  }
+  ranges_.erase(last + 1, ranges_.end());
+}
+
+void LinearScanAllocator::LiveInterval::SetRangeStart(size_t index,
+                                                      int start) {
+  DCHECK_LT(start, ranges_[index].end);
+  ranges_[index].start = start;
+}
+
+float LinearScanAllocator::LiveInterval::SpillWeight() const {
+  auto length = 0;
+  for (auto const range : ranges_)
+    length += range.end - range.start;
+  auto count = 1;
+  for (auto const use : uses_) {
+    if (use.needs_register)
+      ++count;
+  }
+  return static_cast<float>(count) / length;
+}
+
+void LinearScanAllocator::LiveInterval::SplitAt(int position,
+                                                LiveInterval* child) {
+  DCHECK_GT(position, start());
+  DCHECK_LT(position, end());
+  DCHECK(child->ranges_.empty());
+  auto range = ranges_.begin();
+  while (range->end <= position)
+    ++range;
+  if (range->start < position) {
+    child->ranges_.push_back({position, range->end});
+    range->end = position;
+    ++range;
+  }
+  child->ranges_.insert(child->ranges_.end(), range, ranges_.end());
+  ranges_.erase(range, ranges_.end());
+
+  auto use = uses_.begin();
+  while (use != uses_.end() && use->position < position)
+    ++use;
+  child->uses_.insert(child->uses_.end(), use, uses_.end());
+  uses_.erase(use, uses_.end());
+
+  child->next_ = next_;
+  next_ = child;
+}
+
+bool LinearScanAllocator::LiveInterval::StartsAfter(
+    const LiveInterval* interval1,
+    const LiveInterval* interval2) {
+  if (interval1->start() != interval2->start())
+    return interval1->start() > interval2->start();
+  return interval1->id() > interval2->id();
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// LinearScanAllocator
+//
+LinearScanAllocator::LinearScanAllocator(
+    Editor* editor,
+    RegisterAssignments* register_assignments,
+    StackAssignments* stack_assignments)
+    : assignments_(register_assignments),
+      editor_(editor),
+      liveness_(editor->AnalyzeLiveness()),
+      stack_allocator_(new StackAllocator(editor, stack_assignments)),
+      float_registers_(Target::AllocatableFloatRegisters()),
+      general_registers_(Target::AllocatableGeneralRegisters()),
+      last_interval_id_(0) {
+  std::stable_sort(float_registers_.begin(), float_registers_.end(),
+                   CompareRegister);
+  std::stable_sort(general_registers_.begin(), general_registers_.end(),
+                   CompareRegister);
+}
+
+LinearScanAllocator::~LinearScanAllocator() {
+}
+
+Factory* LinearScanAllocator::factory() const {
+  return editor_->factory();
+}
+
+Function* LinearScanAllocator::function() const {
+  return editor_->function();
+}
+
+const std::vector<Value>& LinearScanAllocator::AllocatableRegistersFor(
+    Value type) const {
+  return type.is_float() ? float_registers_ : general_registers_;
+}
+
+void LinearScanAllocator::AllocateIntervals() {
+  for (auto const interval : intervals_)
+    PushUnhandled(interval);
+  while (!unhandled_.empty()) {
+    std::pop_heap(unhandled_.begin(), unhandled_.end(),
+                  LiveInterval::StartsAfter);
+    auto const current = unhandled_.back();
+    unhandled_.pop_back();
+    UpdateActiveIntervals(current->start());
+    if (!TryAllocateFreeRegister(current) && !AllocateBlockedRegister(current))
+      continue;
+    active_.push_back(current);
+  }
+}
+
+// Returns true if |current| is allocated to register, or returns false if
+// |current| is spilled.
+bool LinearScanAllocator::AllocateBlockedRegister(LiveInterval* current) {
+  auto const start = current->start();
+  auto const first_use = current->NextRegisterUseAfter(start);
+  if (first_use == kMaxPosition) {
+    AssignSpillSlot(current);
+    return false;
+  }
+
+  // Choose register which intervals are cheapest to spill. Output of two
+  // operands instruction can use only register of the first input.
+  auto const tied = TiedRegisterFor(current);
+  Value candidate;
+  auto candidate_cost = 0.0f;
+  for (auto const natural : AllocatableRegistersFor(current->value())) {
+    if (tied.is_physical() && natural != tied)
+      continue;
+    if (FixedIntersectionOf(natural, current) <= first_use)
+      continue;
+    auto cost = 0.0f;
+    auto pinned = false;
+    for (auto const active : active_) {
+      if (Target::NaturalRegisterOf(active->location()) != natural)
+        continue;
+      if (active->start() == start ||
+          active->NextRegisterUseAfter(start) == start) {
+        pinned = true;
+        break;
+      }
+      cost += active->SpillWeight();
+    }
+    if (pinned)
+      continue;
+    for (auto const inactive : inactive_) {
+      if (Target::NaturalRegisterOf(inactive->location()) != natural)
+        continue;
+      if (inactive->FirstIntersectionWith(current) == kMaxPosition)
+        continue;
+      cost += inactive->SpillWeight();
+    }
+    if (candidate.is_void() || cost < candidate_cost) {
+      candidate = natural;
+      candidate_cost = cost;
+    }
+  }
+
+  if (first_use > start && !tied.is_physical() &&
+      (candidate.is_void() || current->SpillWeight() <= candidate_cost)) {
+    // |current| is cheaper than others. We spill |current| until its first
+    // use.
+    auto const split_position = SplitPositionBetween(start, first_use);
+    if (split_position > start) {
+      AssignSpillSlot(current);
+      SplitAndRequeue(current, split_position);
+      return false;
+    }
+  }
+
+  // Since instructions use at most as many registers as allocatable
+  // registers, there is a register not used at |start|.
+  DCHECK(candidate.is_physical()) << "No register for " << current->value()
+                                  << " at " << start;
+
+  // Evict intervals allocated to |candidate|.
+  std::vector<LiveInterval*> victims;
+  for (auto const active : active_) {
+    if (Target::NaturalRegisterOf(active->location()) == candidate)
+      victims.push_back(active);
+  }
+  for (auto const inactive : inactive_) {
+    if (Target::NaturalRegisterOf(inactive->location()) != candidate)
+      continue;
+    if (inactive->FirstIntersectionWith(current) == kMaxPosition)
+      continue;
+    victims.push_back(inactive);
+  }
+  for (auto const victim : victims) {
+    active_.erase(std::remove(active_.begin(), active_.end(), victim),
+                  active_.end());
+    inactive_.erase(std::remove(inactive_.begin(), inactive_.end(), victim),
+                    inactive_.end());
+    SplitAndSpill(victim, start);
+  }
+
+  AssignRegister(current, candidate);
+  auto const block_position = FixedIntersectionOf(candidate, current);
+  if (block_position < current->end())
+    SplitAndRequeue(current, SplitPositionBetween(start, block_position));
+  return true;
+}
+
+void LinearScanAllocator::AssignRegister(LiveInterval* interval,
+                                         Value natural) {
+  auto const physical = AdjustSize(interval->value(), natural);
+  interval->set_location(physical);
+  if (!Target::IsCalleeSavedRegister(physical))
+    return;
+  stack_allocator_->AllocateForPreserving(physical);
+}
+
+void LinearScanAllocator::AssignSpillSlot(LiveInterval* interval) {
+  auto const vreg = interval->value();
+  auto const value = RematerializedValueOf(vreg);
+  if (!value.is_void()) {
+    // Rematerializable interval doesn't need spill slot. Moves from it are
+    // expanded to 'lit' instruction and moves to it are omitted.
+    interval->set_location(value);
+    return;
+  }
+  auto spill_slot = assignments_.SpillSlotFor(vreg);
+  if (spill_slot.is_void()) {
+    // Virtual register holding parameter passed on stack is already assigned
+    // to the parameter.
+    spill_slot = stack_allocator_->AllocationFor(vreg);
+    if (spill_slot.is_void())
+      spill_slot = stack_allocator_->Allocate(vreg);
+    assignments_.SetSpillSlot(vreg, spill_slot);
+  }
+  interval->set_location(spill_slot);
+}
+
+void LinearScanAllocator::BuildIntervals() {
+  for (auto const natural : float_registers_)
+    interval_map_[natural] = NewInterval(natural, nullptr);
+  for (auto const natural : general_registers_)
+    interval_map_[natural] = NewInterval(natural, nullptr);
+
+  for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it)
+    BuildIntervalsForBlock(*it);
+
+  for (auto const pair : interval_map_)
+    pair.second->Normalize();
+}
+
+// Build ranges of intervals in |block| by scanning instructions backward.
+void LinearScanAllocator::BuildIntervalsForBlock(BasicBlock* block) {
+  auto const start = StartOf(block);
+  auto const end = EndOf(block);
+
+  // Map live interval to index of range covering current position.
+  std::unordered_map<LiveInterval*, size_t> lives;
+  for (auto const number : liveness_.LivenessOf(block).out()) {
+    auto const interval = IntervalFor(liveness_.VariableOf(number));
+    if (!interval)
+      continue;
+    interval->AddRange(start, end);
+    lives[interval] = interval->ranges().size() - 1;
+  }
+
+  // Phi inputs of successors are used at end of |block|, but they aren't in
+  // live out of |block|.
+  for (auto const successor : block->successors()) {
+    for (auto const phi : successor->phi_instructions()) {
+      auto const interval = IntervalFor(phi->input_of(block));
+      if (!interval || lives.count(interval))
+        continue;
+      interval->AddRange(start, end);
+      lives[interval] = interval->ranges().size() - 1;
+    }
+  }
+
+  // Position of the next 'call' instruction or the last instruction.
+  auto barrier = end - 2;
+  for (auto position = end - 2; position >= start; position -= 2) {
+    auto const instr = instructions_[position / 2];
+    PopulateHints(instr);
+
+    for (auto const output : instr->outputs()) {
+      auto const interval = IntervalFor(output);
+      if (!interval)
+        continue;
+      auto const it = lives.find(interval);
+      if (it != lives.end()) {
+        interval->SetRangeStart(it->second, position + 1);
+        lives.erase(it);
+      } else if (output.is_physical()) {
+        // Physical register without explicit user, e.g. return value, lives
+        // until next 'call' instruction or the last instruction.
+        interval->AddRange(position + 1, std::max(barrier, position) + 2);
+      } else {
+        interval->AddRange(position + 1, position + 2);
+      }
+      interval->AddUse(position + 1, true);
+    }
+
+    if (instr->is<CallInstruction>()) {
+      // 'call' instruction clobbers caller saved registers.
+      for (auto const pair : interval_map_) {
+        auto const interval = pair.second;
+        if (!interval->is_fixed() ||
+            !Target::IsCallerSavedRegister(interval->value())) {
+          continue;
+        }
+        interval->AddRange(position + 1, position + 2);
+      }
+      barrier = position;
+    }
+
+    auto input_position = 0;
+    for (auto const input : instr->inputs()) {
+      auto const interval = IntervalFor(input);
+      if (interval) {
+        if (!lives.count(interval)) {
+          interval->AddRange(start, position + 1);
+          lives[interval] = interval->ranges().size() - 1;
+        }
+        // Since spilled rematerializable value has no spill slot, users of
+        // it always need register.
+        interval->AddUse(position, NeedsRegister(instr, input_position) ||
+                                       rematerializable_map_.count(input));
+      }
+      ++input_position;
+    }
+  }
+
+  // Phi outputs are defined at start of |block|.
+  for (auto const phi : block->phi_instructions()) {
+    auto const interval = IntervalFor(phi->output(0));
+    if (lives.erase(interval))
+      continue;
+    interval->AddRange(start, start + 1);
+  }
+}
+
+// Collect virtual registers defined only once by 'lit' instruction with
+// immediate or literal operand.
+void LinearScanAllocator::CollectRematerializableValues() {
+  std::unordered_map<Value, int> definition_counts;
+  for (auto const block : blocks_) {
+    for (auto const phi : block->phi_instructions())
+      ++definition_counts[phi->output(0)];
+  }
+  for (auto const instr : instructions_) {
+    for (auto const output : instr->outputs()) {
+      if (!output.is_virtual())
+        continue;
+      ++definition_counts[output];
+      if (!instr->is<LiteralInstruction>() || !instr->input(0).is_read_only())
+        continue;
+      rematerializable_map_[output] = instr->input(0);
+    }
+  }
+  for (auto const pair : definition_counts) {
+    if (pair.second > 1)
+      rematerializable_map_.erase(pair.first);
+  }
+}
+
+int LinearScanAllocator::EndOf(BasicBlock* block) const {
+  return PositionOf(block->last_instruction()) + 2;
+}
+
+void LinearScanAllocator::ExpandMoves(const std::vector<ValuePair>& moves,
+                                      int position,
+                                      Instruction* ref_instr) {
+  // Registers holding live values around |position| can't be used as
+  // scratch register.
+  std::unordered_set<Value> live_registers;
+  for (auto const pair : interval_map_) {
+    for (const LiveInterval* interval = pair.second; interval;
+         interval = interval->next()) {
+      if (!interval->Covers(position - 1) && !interval->Covers(position))
+        continue;
+      if (interval->is_fixed()) {
+        live_registers.insert(interval->value());
+        continue;
+      }
+      if (!interval->location().is_physical())
+        continue;
+      live_registers.insert(Target::NaturalRegisterOf(interval->location()));
+    }
+  }
+  for (auto const move : moves) {
+    if (move.first.is_physical())
+      live_registers.insert(Target::NaturalRegisterOf(move.first));
+    if (move.second.is_physical())
+      live_registers.insert(Target::NaturalRegisterOf(move.second));
+  }
+
+  for (auto const type : IntegerTypesAndFloatTypes()) {
+    ParallelCopyExpander expander(factory(), type);
+    for (auto const move : moves) {
+      if (move.first.type != type.type || move.first.size != type.size)
+        continue;
+      if (move.first.is_read_only())
+        continue;
+      expander.AddTask(move.first, move.second);
+    }
+    if (!expander.HasTasks())
+      continue;
+    for (auto const natural : AllocatableRegistersFor(type)) {
+      if (live_registers.count(natural))
+        continue;
+      expander.AddScratch(AdjustSize(type, natural));
+    }
+    auto const instructions = expander.Expand();
+    DCHECK(!instructions.empty()) << "Failed to expand moves before "
+                                  << *ref_instr;
+    for (auto const instr : instructions) {
+      for (auto const output : instr->outputs()) {
+        if (output.is_physical() && Target::IsCalleeSavedRegister(output))
+          stack_allocator_->AllocateForPreserving(output);
+      }
+      assignments_.InsertBefore(instr, ref_instr);
+    }
+  }
+}
+
+// Replace 'pcopy' instruction with moves between allocated locations. Note:
+// |RegisterAssignmentsPass| removes 'pcopy' instructions.
+void LinearScanAllocator::ExpandParallelCopy(Instruction* instr) {
+  auto const position = PositionOf(instr);
+  std::vector<ValuePair> moves;
+  auto inputs = instr->inputs().begin();
+  for (auto const output : instr->outputs()) {
+    auto const input = *inputs;
+    ++inputs;
+    auto const to =
+        output.is_virtual() ? LocationOf(output, position + 1) : output;
+    auto const from = input.is_virtual() ? LocationOf(input, position) : input;
+    if (from == to)
+      continue;
+    moves.push_back(std::make_pair(to, from));
+  }
+  if (moves.empty())
+    return;
+  ExpandMoves(moves, position, instr);
+}
+
+int LinearScanAllocator::FixedIntersectionOf(
+    Value natural,
+    const LiveInterval* interval) const {
+  auto const it = interval_map_.find(natural);
+  DCHECK(it != interval_map_.end()) << natural;
+  return it->second->FirstIntersectionWith(interval);
+}
+
+Value LinearScanAllocator::HintFor(const LiveInterval* interval) const {
+  if (interval->hint_physical().is_physical())
+    return interval->hint_physical();
+  auto const hint = interval->hint();
+  if (!hint)
+    return Value();
+  auto const previous = hint->ChildAt(interval->start() - 1);
+  if (!previous || !previous->location().is_physical())
+    return Value();
+  return Target::NaturalRegisterOf(previous->location());
+}
+
+LinearScanAllocator::LiveInterval* LinearScanAllocator::IntervalFor(
+    Value value) {
+  if (value.is_physical()) {
+    auto const it = interval_map_.find(Target::NaturalRegisterOf(value));
+    return it == interval_map_.end() ? nullptr : it->second;
+  }
+  if (!value.is_virtual())
+    return nullptr;
+  auto const it = interval_map_.find(value);
+  if (it != interval_map_.end())
+    return it->second;
+  auto const interval = NewInterval(value, nullptr);
+  interval_map_[value] = interval;
+  intervals_.push_back(interval);
+  return interval;
+}
+
+Value LinearScanAllocator::LocationOf(Value vreg, int position) const {
+  DCHECK(vreg.is_virtual()) << vreg;
+  auto const it = interval_map_.find(vreg);
+  DCHECK(it != interval_map_.end()) << vreg;
+  auto const interval = it->second->ChildAt(position);
+  DCHECK(interval) << vreg << " isn't live at " << position;
+  return interval ? interval->location() : Value();
+}
+
+LinearScanAllocator::LiveInterval* LinearScanAllocator::NewInterval(
+    Value value,
+    LiveInterval* parent) {
+  return new (zone()) LiveInterval(zone(), ++last_interval_id_, value, parent);
+}
+
+void LinearScanAllocator::NumberInstructions() {
+  auto position = 0;
+  for (auto const block : editor_->ReversePostOrderList()) {
+    blocks_.push_back(block);
+    block_starts_.push_back(position);
+    for (auto const instr : block->instructions()) {
+      position_map_[instr] = position;
+      instructions_.push_back(instr);
+      TrackStackUsage(instr);
+      position += 2;
+    }
+  }
+}
+
+// Populate register hints from 'copy' and 'pcopy' instructions to avoid
+// moves between registers, and ties output of two operands instruction to
+// the first input.
+void LinearScanAllocator::PopulateHints(Instruction* instr) {
+  if (instr->is<CopyInstruction>() || instr->is<PCopyInstruction>()) {
+    auto inputs = instr->inputs().begin();
+    for (auto const output : instr->outputs()) {
+      auto const input = *inputs;
+      ++inputs;
+      auto const output_interval = IntervalFor(output);
+      auto const input_interval = IntervalFor(input);
+      if (!output_interval || !input_interval)
+        continue;
+      if (output.is_virtual()) {
+        if (input.is_virtual())
+          output_interval->set_hint(input_interval);
+        else
+          output_interval->set_hint_physical(input_interval->value());
+        continue;
+      }
+      if (input.is_virtual())
+        input_interval->set_hint_physical(output_interval->value());
+    }
+    return;
+  }
+  if (!IsTwoOperandsInstruction(instr))
+    return;
+  IntervalFor(instr->output(0))->set_tied(IntervalFor(instr->input(0)));
+}
+
+int LinearScanAllocator::PositionOf(Instruction* instr) const {
+  auto const it = position_map_.find(instr);
+  DCHECK(it != position_map_.end()) << *instr;
+  return it->second;
+}
+
+void LinearScanAllocator::PushUnhandled(LiveInterval* interval) {
+  unhandled_.push_back(interval);
+  std::push_heap(unhandled_.begin(), unhandled_.end(),
+                 LiveInterval::StartsAfter);
+}
+
+Value LinearScanAllocator::RematerializedValueOf(Value vreg) const {
+  auto const it = rematerializable_map_.find(vreg);
+  return it == rematerializable_map_.end() ? Value() : it->second;
+}
+
+// Moves at start of block are executed before moves for intervals split at
+// the first instruction, and moves at end of block are executed after moves
+// for intervals split at the last instruction.
+void LinearScanAllocator::ResolveDataFlow() {
+  for (auto const block : blocks_) {
+    for (auto const predecessor : block->predecessors()) {
+      if (predecessor->successors().size() != 1)
+        ResolveEdge(predecessor, block);
+    }
+  }
+  ResolveSplits();
+  for (auto const block : blocks_) {
+    for (auto const predecessor : block->predecessors()) {
+      if (predecessor->successors().size() == 1)
+        ResolveEdge(predecessor, block);
+    }
+  }
+}
+
+// Insert moves on edge from |predecessor| to |block| for live-in values and
+// phi operands which locations are different.
+void LinearScanAllocator::ResolveEdge(BasicBlock* predecessor,
+                                      BasicBlock* block) {
+  auto const from_position = EndOf(predecessor) - 1;
+  auto const to_position = StartOf(block);
+  std::vector<ValuePair> moves;
+  for (auto const number : liveness_.LivenessOf(block).in()) {
+    auto const vreg = liveness_.VariableOf(number);
+    if (!vreg.is_virtual())
+      continue;
+    auto const from = LocationOf(vreg, from_position);
+    auto const to = LocationOf(vreg, to_position);
+    if (from == to)
+      continue;
+    moves.push_back(std::make_pair(to, from));
+  }
+  for (auto const phi : block->phi_instructions()) {
+    auto const input = phi->input_of(predecessor);
+    auto const from =
+        input.is_virtual() ? LocationOf(input, from_position) : input;
+    auto const to = LocationOf(phi->output(0), to_position);
+    if (from == to)
+      continue;
+    moves.push_back(std::make_pair(to, from));
+  }
+  if (moves.empty())
+    return;
+
+  if (predecessor->successors().size() == 1) {
+    auto const last_instr = predecessor->last_instruction();
+    ExpandMoves(moves, PositionOf(last_instr), last_instr);
+    return;
+  }
+
+  // Since critical edges are removed, |block| has only one predecessor.
+  DCHECK_EQ(block->predecessors().size(), 1u) << *block;
+  ExpandMoves(moves, to_position, block->first_instruction());
+}
+
+// Insert moves between split intervals inside block. Moves at block boundary
+// are handled by |ResolveEdge()|.
+void LinearScanAllocator::ResolveSplits() {
+  std::map<int, std::vector<ValuePair>> moves_map;
+  for (auto const root : intervals_) {
+    for (auto interval = root; interval->next(); interval = interval->next()) {
+      auto const child = interval->next();
+      auto const position = child->start();
+      if (interval->end() != position)
+        continue;
+      if (std::binary_search(block_starts_.begin(), block_starts_.end(),
+                             position)) {
+        continue;
+      }
+      if (interval->location() == child->location())
+        continue;
+      // Moves for split at odd position, e.g. spilling interval at output of
+      // instruction, are inserted before the instruction.
+      moves_map[position & ~1].push_back(
+          std::make_pair(child->location(), interval->location()));
+    }
+  }
+  for (auto const pair : moves_map) {
+    auto const position = pair.first;
+    ExpandMoves(pair.second, position, instructions_[position / 2]);
+  }
+}
+
+void LinearScanAllocator::Run() {
+  NumberInstructions();
+  CollectRematerializableValues();
+  BuildIntervals();
+  AllocateIntervals();
+  ResolveDataFlow();
+  SetAllocations();
+}
+
+void LinearScanAllocator::SetAllocations() {
+  for (auto const block : blocks_) {
+    for (auto const phi : block->phi_instructions()) {
+      auto const output = phi->output(0);
+      assignments_.SetAllocation(phi, output,
+                                 LocationOf(output, StartOf(block)));
+      for (auto const phi_input : phi->phi_inputs()) {
+        auto const input = phi_input->value();
+        if (!input.is_virtual())
+          continue;
+        auto const position = EndOf(phi_input->basic_block()) - 1;
+        auto const location = LocationOf(input, position);
+        if (location.is_read_only())
+          continue;
+        assignments_.SetAllocation(phi, input, location);
+      }
+    }
+    for (auto const instr : block->instructions()) {
+      auto const position = PositionOf(instr);
+      for (auto const output : instr->outputs()) {
+        if (!output.is_virtual())
+          continue;
+        assignments_.SetAllocation(instr, output,
+                                   LocationOf(output, position + 1));
+      }
+      for (auto const input : instr->inputs()) {
+        if (!input.is_virtual())
+          continue;
+        assignments_.SetAllocation(instr, input, LocationOf(input, position));
+      }
+      if (instr->is<PCopyInstruction>())
+        ExpandParallelCopy(instr);
+    }
+  }
+}
+
+void LinearScanAllocator::SplitAndRequeue(LiveInterval* interval,
+                                          int position) {
+  DCHECK_GT(position, interval->start());
+  if (position >= interval->end())
+    return;
+  if (position % 2) {
+    // We can't move value between registers in middle of instruction.
+    SplitAndSpill(interval, position);
+    return;
+  }
+  PushUnhandled(SplitInterval(interval, position));
+}
+
+void LinearScanAllocator::SplitAndSpill(LiveInterval* interval,
+                                        int position) {
+  auto const child = SplitInterval(interval, position);
+  auto const next_use = child->NextRegisterUseAfter(child->start());
+  if (next_use == kMaxPosition) {
+    AssignSpillSlot(child);
+    return;
+  }
+  auto const split_position = SplitPositionBetween(child->start(), next_use);
+  if (split_position <= child->start()) {
+    // |child| needs register at start.
+    DCHECK_EQ(child->start() % 2, 0) << child->value() << " at " << position;
+    PushUnhandled(child);
+    return;
+  }
+  AssignSpillSlot(child);
+  SplitAndRequeue(child, split_position);
+}
+
+LinearScanAllocator::LiveInterval* LinearScanAllocator::SplitInterval(
+    LiveInterval* interval,
+    int position) {
+  auto const root = interval->root();
+  auto const child = NewInterval(interval->value(), root);
+  interval->SplitAt(position, child);
+  // We would like to keep |child| in the same register.
+  child->set_hint(root);
+  return child;
+}
+
+int LinearScanAllocator::SplitPositionBetween(int start, int end) const {
+  if (end <= start)
+    return start;
+  auto const it =
+      std::upper_bound(block_starts_.begin(), block_starts_.end(), end);
+  if (it != block_starts_.begin() && *(it - 1) > start)
+    return *(it - 1);
+  auto const position = end & ~1;
+  return position > start ? position : end;
+}
+
+int LinearScanAllocator::StartOf(BasicBlock* block) const {
+  return PositionOf(block->first_instruction());
+}
+
+Value LinearScanAllocator::TiedRegisterFor(
+    const LiveInterval* interval) const {
+  auto const tied = interval->tied();
+  if (!tied)
+    return Value();
+  auto const position = interval->start() - 1;
+  if (tied->ChildAt(position + 1))
+    return Value();
+  auto const input = tied->ChildAt(position);
+  DCHECK(input && input->location().is_physical()) << interval->value();
+  return Target::NaturalRegisterOf(input->location());
+}
+
+void LinearScanAllocator::TrackStackUsage(Instruction* instr) {
+  if (instr->is<CallInstruction>()) {
+    stack_allocator_->TrackCall(instr);
+    return;
+  }
+  if (!instr->is<CopyInstruction>() && !instr->is<PCopyInstruction>())
+    return;
+  // We use parameter passed on stack as spill slot of virtual register
+  // holding it.
+  auto inputs = instr->inputs().begin();
+  for (auto const output : instr->outputs()) {
+    auto const input = *inputs;
+    ++inputs;
+    if (!input.is_parameter() || !output.is_virtual())
+      continue;
+    stack_allocator_->Assign(output, input);
+  }
+}
+
+// Returns true if |current| is allocated to register which is free at start
+// of |current|.
+bool LinearScanAllocator::TryAllocateFreeRegister(LiveInterval* current) {
+  auto const start = current->start();
+  auto const end = current->end();
+  auto const& registers = AllocatableRegistersFor(current->value());
+
+  std::unordered_map<Value, int> free_until_map;
+  for (auto const natural : registers)
+    free_until_map[natural] = FixedIntersectionOf(natural, current);
+  for (auto const active : active_) {
+    auto const natural = Target::NaturalRegisterOf(active->location());
+    if (free_until_map.count(natural))
+      free_until_map[natural] = 0;
+  }
+  for (auto const inactive : inactive_) {
+    auto const natural = Target::NaturalRegisterOf(inactive->location());
+    if (!free_until_map.count(natural))
+      continue;
+    auto& free_until = free_until_map[natural];
+    free_until =
+        std::min(free_until, inactive->FirstIntersectionWith(current));
+  }
+
+  // Output of two operands instruction must be allocated to register of the
+  // first input. If the register isn't free at |start|, e.g. an inactive
+  // interval resumes at |start|, |AllocateBlockedRegister()| evicts it.
+  auto const tied = TiedRegisterFor(current);
+  if (tied.is_physical()) {
+    auto const free_until = free_until_map[tied];
+    if (free_until <= start)
+      return false;
+    AssignRegister(current, tied);
+    if (free_until < end)
+      SplitAndRequeue(current, SplitPositionBetween(start, free_until));
+    return true;
+  }
+
+  Value candidate;
+  auto const hint = HintFor(current);
+  if (hint.is_physical() && free_until_map.count(hint) &&
+      free_until_map[hint] >= end) {
+    candidate = hint;
+  }
+  if (candidate.is_void()) {
+    for (auto const natural : registers) {
+      if (free_until_map[natural] >= end) {
+        candidate = natural;
+        break;
+      }
+    }
+  }
+  if (candidate.is_physical()) {
+    AssignRegister(current, candidate);
+    return true;
+  }
+
+  // There are no registers free for whole |current|. We use register free
+  // for the longest and split |current|.
+  auto free_until = start;
+  for (auto const natural : registers) {
+    if (free_until_map[natural] > free_until) {
+      candidate = natural;
+      free_until = free_until_map[natural];
+    }
+  }
+  if (candidate.is_void())
+    return false;
+  auto const split_position = SplitPositionBetween(start, free_until);
+  if (split_position <= start ||
+      current->NextRegisterUseAfter(start) >= split_position) {
+    return false;
+  }
+  AssignRegister(current, candidate);
+  SplitAndRequeue(current, split_position);
+  return true;
+}
+
+void LinearScanAllocator::UpdateActiveIntervals(int position) {
+  std::vector<LiveInterval*> actives;
+  std::vector<LiveInterval*> inactives;
+  for (auto const interval : active_) {
+    if (interval->end() <= position)
+      continue;
+    if (interval->Covers(position))
+      actives.push_back(interval);
+    else
+      inactives.push_back(interval);
+  }
+  for (auto const interval : inactive_) {
+    if (interval->end() <= position)
+      continue;
+    if (interval->Covers(position))
+      actives.push_back(interval);
+    else
+      inactives.push_back(interval);
+  }
+  active_.swap(actives);
+  inactive_.swap(inactives);
+}
+
+}  // namespace lir
+}  // namespace elang
@@ -0,0 +1,194 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_LIR_TRANSFORMS_LINEAR_SCAN_ALLOCATOR_H_
+#define ELANG_LIR_TRANSFORMS_LINEAR_SCAN_ALLOCATOR_H_
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "elang/base/zone_owner.h"
+#include "elang/lir/lir_export.h"
+#include "elang/lir/transforms/register_assignments.h"
+#include "elang/lir/value.h"
+
+namespace elang {
+
+template <typename BasicBlock, typename Value>
+class LivenessCollection;
+
+namespace lir {
+
+class BasicBlock;
+class Editor;
+class Factory;
+class Function;
+class Instruction;
+class StackAllocator;
+class StackAssignments;
+
+//////////////////////////////////////////////////////////////////////
+//
+// LinearScanAllocator allocates registers to live intervals of virtual
+// registers over whole function rather than block by block:
+//  1. Number instructions in reverse post order. An instruction at position
+//     |p| reads its inputs at |p| and writes its outputs at |p + 1|.
+//  2. Build live intervals from |LivenessAnalyzer| results. Physical registers
+//     used in instructions and caller saved registers clobbered by 'call'
+//     instructions are represented by fixed intervals.
+//  3. Scan intervals in order of start position. If there is no register
+//     free for whole interval, we split the interval, preferably at block
+//     boundary, or evict intervals having the lowest spill weight.
+//  4. Resolve data flow between split intervals by inserting parallel copies
+//     expanded by |ParallelCopyExpander|, at split position inside block
+//     or on control flow edges, including phi operands.
+//
+// Spilled intervals of virtual registers defined only once by 'lit'
+// instruction are rematerialized by 'lit' instruction instead of storing to
+// and loading from spill slot, as same as |SpillManager|.
+//
+// Results are stored in |RegisterAssignments| as same as |RegisterAllocator|.
+//
+// Prerequisite:
+//  - Critical edges are removed.
+//  - Operands of two operands instructions are rewritten by lowering pass.
+//
+class ELANG_LIR_EXPORT LinearScanAllocator final : public ZoneOwner {
+ public:
+  LinearScanAllocator(Editor* editor,
+                      RegisterAssignments* register_assignments,
+                      StackAssignments* stack_assignments);
+  ~LinearScanAllocator();
+
+  // The entry point
+  void Run();
+
+ private:
+  class LiveInterval;
+  typedef std::pair<Value, Value> ValuePair;
+
+  Factory* factory() const;
+  Function* function() const;
+
+  // Returns list of all allocatable natural registers for |type| ordered by
+  // preference.
+  const std::vector<Value>& AllocatableRegistersFor(Value type) const;
+
+  ////////////////////////////////////////////////////////////
+  //
+  // Building live intervals
+  //
+  void BuildIntervals();
+  void BuildIntervalsForBlock(BasicBlock* block);
+  void CollectRematerializableValues();
+  void NumberInstructions();
+  void PopulateHints(Instruction* instr);
+  void TrackStackUsage(Instruction* instr);
+
+  // Returns live interval for |value| or null if |value| isn't a register
+  // to be allocated.
+  LiveInterval* IntervalFor(Value value);
+  LiveInterval* NewInterval(Value value, LiveInterval* parent);
+
+  ////////////////////////////////////////////////////////////
+  //
+  // Allocation
+  //
+  void AllocateIntervals();
+  bool AllocateBlockedRegister(LiveInterval* current);
+  void AssignRegister(LiveInterval* interval, Value natural);
+  void AssignSpillSlot(LiveInterval* interval);
+
+  // Returns the first position where fixed interval of |natural| intersects
+  // with |interval|.
+  int FixedIntersectionOf(Value natural, const LiveInterval* interval) const;
+
+  // Returns natural register |interval| would like to use, or void.
+  Value HintFor(const LiveInterval* interval) const;
+  void PushUnhandled(LiveInterval* interval);
+
+  // Returns immediate or literal value of rematerializable |vreg|, or void.
+  Value RematerializedValueOf(Value vreg) const;
+
+  // Returns split position in (|start|, |end|]. We prefer block boundary to
+  // reduce moves inside block, then even position, since we can move value
+  // between registers only between instructions. Returns |start| if |end| is
+  // not after |start|.
+  int SplitPositionBetween(int start, int end) const;
+
+  // Split |interval| at |position| and spill part from |position| until next
+  // use which requires register.
+  void SplitAndSpill(LiveInterval* interval, int position);
+  void SplitAndRequeue(LiveInterval* interval, int position);
+  LiveInterval* SplitInterval(LiveInterval* interval, int position);
+
+  // Returns natural register allocated to the first input of two operands
+  // instruction defining |interval|, or void.
+  Value TiedRegisterFor(const LiveInterval* interval) const;
+  bool TryAllocateFreeRegister(LiveInterval* current);
+  void UpdateActiveIntervals(int position);
+
+  ////////////////////////////////////////////////////////////
+  //
+  // Resolution
+  //
+  void ExpandMoves(const std::vector<ValuePair>& moves,
+                   int position,
+                   Instruction* ref_instr);
+  void ExpandParallelCopy(Instruction* instr);
+
+  // Returns physical register, spill slot or rematerialized value of |vreg|
+  // at |position|.
+  Value LocationOf(Value vreg, int position) const;
+
+  void ResolveDataFlow();
+  void ResolveEdge(BasicBlock* predecessor, BasicBlock* block);
+  void ResolveSplits();
+  void SetAllocations();
+
+  // Position of |block| and |instr|.
+  int EndOf(BasicBlock* block) const;
+  int PositionOf(Instruction* instr) const;
+  int StartOf(BasicBlock* block) const;
+
+  RegisterAssignments::Editor assignments_;
+  const Editor* const editor_;
+  const LivenessCollection<BasicBlock*, Value>& liveness_;
+  const std::unique_ptr<StackAllocator> stack_allocator_;
+
+  // Allocatable registers ordered by preference.
+  std::vector<Value> float_registers_;
+  std::vector<Value> general_registers_;
+
+  // Basic blocks in reverse post order and instructions in them.
+  std::vector<BasicBlock*> blocks_;
+  std::vector<int> block_starts_;
+  std::vector<Instruction*> instructions_;
+  std::unordered_map<Instruction*, int> position_map_;
+
+  // Map virtual register to its live interval and natural physical register to
+  // its fixed interval.
+  std::unordered_map<Value, LiveInterval*> interval_map_;
+  std::vector<LiveInterval*> intervals_;
+  int last_interval_id_;
+
+  // Map virtual register defined only once by 'lit' instruction to immediate
+  // or literal value to rematerialize instead of spilling.
+  std::unordered_map<Value, Value> rematerializable_map_;
+
+  // Working lists of linear scan.
+  std::vector<LiveInterval*> active_;
+  std::vector<LiveInterval*> inactive_;
+  std::vector<LiveInterval*> unhandled_;
+
+  DISALLOW_COPY_AND_ASSIGN(LinearScanAllocator);
+};
+
+}  // namespace lir
+}  // namespace elang
+
+#endif  // ELANG_LIR_TRANSFORMS_LINEAR_SCAN_ALLOCATOR_H_
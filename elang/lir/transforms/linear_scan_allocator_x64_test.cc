@@ -0,0 +1,499 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/lir/testing/lir_test.h"
+
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+#include "elang/lir/transforms/lowering_x64_pass.h"
+
+namespace elang {
+namespace lir {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LirLinearScanAllocatorX64Test
+//
+class LirLinearScanAllocatorX64Test : public testing::LirTest {
+ protected:
+  LirLinearScanAllocatorX64Test() = default;
+
+  // Appends loads as many as allocatable general registers from |base| and
+  // returns their outputs.
+  std::vector<Value> EmitLoads(Editor* editor, Value base);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LirLinearScanAllocatorX64Test);
+};
+
+std::vector<Value> LirLinearScanAllocatorX64Test::EmitLoads(Editor* editor,
+                                                             Value base) {
+  std::vector<Value> values;
+  auto const count = Target::AllocatableGeneralRegisters().size();
+  for (auto index = 0u; index < count; ++index) {
+    auto const value = NewIntPtrRegister();
+    editor->Append(NewLoadInstruction(value, base, base,
+                                      Value::SmallInt32(index * 8)));
+    values.push_back(value);
+  }
+  return values;
+}
+
+// Test cases...
+
+// |var0| has the lowest spill weight when loads occupy all registers. It is
+// evicted to spill slot and reloaded before its use.
+TEST_F(LirLinearScanAllocatorX64Test, Evict) {
+  auto const base = NewIntPtrRegister();
+  auto const var0 = NewIntPtrRegister();
+  std::vector<Value> parameters{
+      Target::ParameterAt(base, 0), Target::ParameterAt(var0, 1),
+  };
+  auto const function = CreateFunctionEmptySample(parameters);
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewPCopyInstruction({base, var0}, parameters));
+  for (auto const value : EmitLoads(&editor, base))
+    editor.Append(NewUseInstruction(value));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l, r2l =\n"
+      "  pcopy r1l, r2l = r1l, r2l\n"
+      "  load r0l = r1l, r1l, #0\n"
+      "  load r8l = r1l, r1l, #8\n"
+      "  load r9l = r1l, r1l, #16\n"
+      "  load r10l = r1l, r1l, #24\n"
+      "  load r11l = r1l, r1l, #32\n"
+      "  load r3l = r1l, r1l, #40\n"
+      "  load r6l = r1l, r1l, #48\n"
+      "  load r7l = r1l, r1l, #56\n"
+      "  load r12l = r1l, r1l, #64\n"
+      "  load r13l = r1l, r1l, #72\n"
+      "  load r14l = r1l, r1l, #80\n"
+      "  load r15l = r1l, r1l, #88\n"
+      "* mov $i56l = r2l\n"
+      "  load r2l = r1l, r1l, #96\n"
+      "  load r1l = r1l, r1l, #104\n"
+      "  use r0l\n"
+      "  use r8l\n"
+      "  use r9l\n"
+      "  use r10l\n"
+      "  use r11l\n"
+      "  use r3l\n"
+      "  use r6l\n"
+      "  use r7l\n"
+      "  use r12l\n"
+      "  use r13l\n"
+      "  use r14l\n"
+      "  use r15l\n"
+      "  use r2l\n"
+      "  use r1l\n"
+      "* mov r0l = $i56l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+
+// Virtual register living across 'call' instruction is allocated to callee
+// saved register.
+TEST_F(LirLinearScanAllocatorX64Test, LiveAcrossCall) {
+  auto const var0 = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(var0, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(factory()->NewCopyInstruction(var0, parameter));
+  editor.Append(factory()->NewCallInstruction({}, Value::SmallInt64(56)));
+  editor.Append(factory()->NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r3l = r1l\n"
+      "  call #56l\n"
+      "  mov r0l = r3l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+// |var0| lives through loop which loads values more than registers. It is
+// spilled in loop body, then reloaded on back edge to match its location at
+// loop header, and in exit block for its use.
+TEST_F(LirLinearScanAllocatorX64Test, Loop) {
+  auto const base = NewIntPtrRegister();
+  auto const var0 = NewIntPtrRegister();
+  auto const index = NewIntPtrRegister();
+  auto const index2 = NewIntPtrRegister();
+  std::vector<Value> parameters{
+      Target::ParameterAt(base, 0), Target::ParameterAt(var0, 1),
+  };
+  auto const function = CreateFunctionEmptySample(parameters);
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const loop_block = editor.NewBasicBlock(exit_block);
+  auto const done_block = editor.NewBasicBlock(exit_block);
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewPCopyInstruction({base, var0}, parameters));
+  editor.SetJump(loop_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(loop_block);
+  auto const phi = editor.NewPhi(index);
+  editor.SetPhiInput(phi, function->entry_block(), Value::SmallInt64(0));
+  editor.SetPhiInput(phi, loop_block, index2);
+  for (auto const value : EmitLoads(&editor, base))
+    editor.Append(NewUseInstruction(value));
+  editor.Append(NewLoadInstruction(index2, base, index, Value::SmallInt32(0)));
+  auto const cond = NewConditional();
+  editor.Append(NewCmpInstruction(cond, IntCondition::Equal, index2,
+                                  Value::SmallInt64(0)));
+  editor.SetBranch(cond, done_block, loop_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(done_block);
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block3}\n"
+      "  entry r1l, r2l =\n"
+      "  pcopy r1l, r2l = r1l, r2l\n"
+      "* lit r0l = #0l\n"
+      "  jmp block3\n"
+      "block3:\n"
+      "  // In: {block1, block5}\n"
+      "  // Out: {block4, block5}\n"
+      "  phi r0l = block1 #0l, block5 r0l\n"
+      "  load r8l = r1l, r1l, #0\n"
+      "  load r9l = r1l, r1l, #8\n"
+      "  load r10l = r1l, r1l, #16\n"
+      "  load r11l = r1l, r1l, #24\n"
+      "  load r3l = r1l, r1l, #32\n"
+      "  load r6l = r1l, r1l, #40\n"
+      "  load r7l = r1l, r1l, #48\n"
+      "  load r12l = r1l, r1l, #56\n"
+      "  load r13l = r1l, r1l, #64\n"
+      "  load r14l = r1l, r1l, #72\n"
+      "  load r15l = r1l, r1l, #80\n"
+      "* mov $i56l = r0l\n"
+      "  load r0l = r1l, r1l, #88\n"
+      "* mov $i64l = r2l\n"
+      "  load r2l = r1l, r1l, #96\n"
+      "* mov $i72l = r0l\n"
+      "  load r0l = r1l, r1l, #104\n"
+      "  use r8l\n"
+      "  use r9l\n"
+      "  use r10l\n"
+      "  use r11l\n"
+      "  use r3l\n"
+      "  use r6l\n"
+      "  use r7l\n"
+      "  use r12l\n"
+      "  use r13l\n"
+      "  use r14l\n"
+      "  use r15l\n"
+      "  use $i72l\n"
+      "  use r2l\n"
+      "  use r0l\n"
+      "* mov r0l = $i56l\n"
+      "  load r0l = r1l, r0l, #0\n"
+      "  cmp %b2 = r0l, #0l\n"
+      "  br %b2, block4, block5\n"
+      "block5:\n"
+      "  // In: {block3}\n"
+      "  // Out: {block3}\n"
+      "* mov r2l = $i64l\n"
+      "  jmp block3\n"
+      "block4:\n"
+      "  // In: {block3}\n"
+      "  // Out: {block2}\n"
+      "* mov r0l = $i64l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block4}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+// Phi operands living after merge block are copied to register of phi output
+// on each incoming edge.
+TEST_F(LirLinearScanAllocatorX64Test, Phi) {
+  auto const var0 = NewIntPtrRegister();
+  auto const var1 = NewIntPtrRegister();
+  auto const var2 = NewIntPtrRegister();
+  std::vector<Value> parameters{
+      Target::ParameterAt(var0, 0), Target::ParameterAt(var1, 1),
+  };
+  auto const function = CreateFunctionEmptySample(parameters);
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const true_block = editor.NewBasicBlock(exit_block);
+  auto const false_block = editor.NewBasicBlock(exit_block);
+  auto const merge_block = editor.NewBasicBlock(exit_block);
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewPCopyInstruction({var0, var1}, parameters));
+  auto const cond = NewConditional();
+  editor.Append(NewCmpInstruction(cond, IntCondition::Equal, var0, var1));
+  editor.SetBranch(cond, true_block, false_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(true_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(false_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(merge_block);
+  auto const phi = editor.NewPhi(var2);
+  editor.SetPhiInput(phi, true_block, var0);
+  editor.SetPhiInput(phi, false_block, var1);
+  editor.Append(NewUseInstruction(var0));
+  editor.Append(NewUseInstruction(var1));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var2, 0), var2));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block3, block4}\n"
+      "  entry r1l, r2l =\n"
+      "  pcopy r1l, r2l = r1l, r2l\n"
+      "  cmp %b2 = r1l, r2l\n"
+      "  br %b2, block3, block4\n"
+      "block3:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block5}\n"
+      "* mov r0l = r1l\n"
+      "  jmp block5\n"
+      "block4:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block5}\n"
+      "* mov r0l = r2l\n"
+      "  jmp block5\n"
+      "block5:\n"
+      "  // In: {block3, block4}\n"
+      "  // Out: {block2}\n"
+      "  phi r0l = block3 r1l, block4 r2l\n"
+      "  use r1l\n"
+      "  use r2l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block5}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+//  function1:
+//    block1:
+//      // In: {}
+//      // Out: {block2}
+//      entry
+//      pcopy %r1l, %r2l = RCX, RDX
+//      mov %r4l = %r1l
+//      add %r5l = %r4l, %r2l
+//      mov %r3l = %r5l
+//      mov RAX = %r3l
+//      ret block2
+//    block2:
+//      // In: {block1}
+//      // Out: {}
+//      exit
+TEST_F(LirLinearScanAllocatorX64Test, SampleAdd) {
+  auto const function = CreateFunctionSampleAdd();
+  {
+    Editor editor(factory(), function);
+    RunPassForTesting<LoweringX64Pass>(&editor);
+  }
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l, r2l =\n"
+      "  pcopy r1l, r2l = r1l, r2l\n"
+      "  mov r1l = r1l\n"
+      "  add r1l = r1l, r2l\n"
+      "  mov r0l = r1l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+// |var0| defined by 'lit' instruction is evicted without storing to spill
+// slot, and it is rematerialized by 'lit' instruction before its use.
+TEST_F(LirLinearScanAllocatorX64Test, Rematerialize) {
+  auto const base = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(base, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(base, parameter));
+  auto const var0 = NewIntPtrRegister();
+  editor.Append(NewLiteralInstruction(var0, Value::SmallInt64(42)));
+  auto const values = EmitLoads(&editor, base);
+  for (auto const value : values)
+    editor.Append(NewUseInstruction(value));
+  editor.Append(NewUseInstruction(base));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r1l = r1l\n"
+      "  lit r0l = #42l\n"
+      "  load r2l = r1l, r1l, #0\n"
+      "  load r8l = r1l, r1l, #8\n"
+      "  load r9l = r1l, r1l, #16\n"
+      "  load r10l = r1l, r1l, #24\n"
+      "  load r11l = r1l, r1l, #32\n"
+      "  load r3l = r1l, r1l, #40\n"
+      "  load r6l = r1l, r1l, #48\n"
+      "  load r7l = r1l, r1l, #56\n"
+      "  load r12l = r1l, r1l, #64\n"
+      "  load r13l = r1l, r1l, #72\n"
+      "  load r14l = r1l, r1l, #80\n"
+      "  load r15l = r1l, r1l, #88\n"
+      "  load r0l = r1l, r1l, #96\n"
+      "* mov $i56l = r0l\n"
+      "  load r0l = r1l, r1l, #104\n"
+      "  use r2l\n"
+      "  use r8l\n"
+      "  use r9l\n"
+      "  use r10l\n"
+      "  use r11l\n"
+      "  use r3l\n"
+      "  use r6l\n"
+      "  use r7l\n"
+      "  use r12l\n"
+      "  use r13l\n"
+      "  use r14l\n"
+      "  use r15l\n"
+      "  use $i56l\n"
+      "  use r0l\n"
+      "  use r1l\n"
+      "* lit r0l = #42l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+// Loaded values more than registers are spilled. Since 'use' instruction
+// doesn't need register, spilled values are used from spill slots without
+// reloading.
+TEST_F(LirLinearScanAllocatorX64Test, Spill) {
+  auto const base = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(base, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(base, parameter));
+  auto const values = EmitLoads(&editor, base);
+  auto const var0 = NewIntPtrRegister();
+  editor.Append(NewLoadInstruction(var0, base, base, Value::SmallInt32(0)));
+  for (auto const value : values)
+    editor.Append(NewUseInstruction(value));
+  editor.Append(NewUseInstruction(base));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r1l = r1l\n"
+      "  load r0l = r1l, r1l, #0\n"
+      "  load r2l = r1l, r1l, #8\n"
+      "  load r8l = r1l, r1l, #16\n"
+      "  load r9l = r1l, r1l, #24\n"
+      "  load r10l = r1l, r1l, #32\n"
+      "  load r11l = r1l, r1l, #40\n"
+      "  load r3l = r1l, r1l, #48\n"
+      "  load r6l = r1l, r1l, #56\n"
+      "  load r7l = r1l, r1l, #64\n"
+      "  load r12l = r1l, r1l, #72\n"
+      "  load r13l = r1l, r1l, #80\n"
+      "  load r14l = r1l, r1l, #88\n"
+      "  load r15l = r1l, r1l, #96\n"
+      "* mov $i56l = r0l\n"
+      "  load r0l = r1l, r1l, #104\n"
+      "* mov $i64l = r0l\n"
+      "  load r0l = r1l, r1l, #0\n"
+      "  use $i56l\n"
+      "  use r2l\n"
+      "  use r8l\n"
+      "  use r9l\n"
+      "  use r10l\n"
+      "  use r11l\n"
+      "  use r3l\n"
+      "  use r6l\n"
+      "  use r7l\n"
+      "  use r12l\n"
+      "  use r13l\n"
+      "  use r14l\n"
+      "  use r15l\n"
+      "  use $i64l\n"
+      "  use r1l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      AllocateByLinearScan(function));
+}
+
+}  // namespace lir
+}  // namespace elang
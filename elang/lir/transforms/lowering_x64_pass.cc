@@ -10,6 +10,7 @@
 #include "elang/lir/error_code.h"
 #include "elang/lir/factory.h"
 #include "elang/lir/instructions.h"
+#include "elang/lir/instructions_x64.h"
 #include "elang/lir/literals.h"
 #include "elang/lir/target_x64.h"
 #include "elang/lir/value.h"
@@ -17,6 +18,103 @@
 namespace elang {
 namespace lir {
 
+namespace {
+
+// Returns shift count if |data| is power of two, otherwise returns -1.
+int ShiftCountOf(uint64_t data) {
+  if (!data || (data & (data - 1)))
+    return -1;
+  auto count = 0;
+  while (data > 1) {
+    data >>= 1;
+    ++count;
+  }
+  return count;
+}
+
+// Computes magic number |multiplier| and |shift| count for signed division
+// by |divisor| greater than one, from "Hacker's Delight" 10-4. |multiplier|
+// is unsigned number, we subtract |multiplier| from high part of unsigned
+// multiplication when dividend is negative, to get high part of signed
+// multiplication adjusted by dividend.
+template <typename UInt>
+void ComputeSignedMagic(UInt divisor, UInt* multiplier, int* shift) {
+  auto const bit_size = static_cast<int>(sizeof(UInt) * 8);
+  auto const two_n1 = static_cast<UInt>(1) << (bit_size - 1);
+  auto const anc = two_n1 - 1 - two_n1 % divisor;
+  auto p = bit_size - 1;
+  auto q1 = two_n1 / anc;
+  auto r1 = two_n1 - q1 * anc;
+  auto q2 = two_n1 / divisor;
+  auto r2 = two_n1 - q2 * divisor;
+  UInt delta;
+  do {
+    ++p;
+    q1 *= 2;
+    r1 *= 2;
+    if (r1 >= anc) {
+      ++q1;
+      r1 -= anc;
+    }
+    q2 *= 2;
+    r2 *= 2;
+    if (r2 >= divisor) {
+      ++q2;
+      r2 -= divisor;
+    }
+    delta = divisor - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+  *multiplier = q2 + 1;
+  *shift = p - bit_size;
+}
+
+// Computes magic number |multiplier| and |shift| count for unsigned division
+// by |divisor| greater than one, from "Hacker's Delight" 10-9. When |add| is
+// true, multiplier is |multiplier| + 2^N.
+template <typename UInt>
+void ComputeUnsignedMagic(UInt divisor,
+                          UInt* multiplier,
+                          bool* add,
+                          int* shift) {
+  auto const bit_size = static_cast<int>(sizeof(UInt) * 8);
+  auto const two_n1 = static_cast<UInt>(1) << (bit_size - 1);
+  auto const nc = static_cast<UInt>(~static_cast<UInt>(0) -
+                                    static_cast<UInt>(0 - divisor) % divisor);
+  auto p = bit_size - 1;
+  auto q1 = two_n1 / nc;
+  auto r1 = two_n1 - q1 * nc;
+  auto q2 = (two_n1 - 1) / divisor;
+  auto r2 = (two_n1 - 1) - q2 * divisor;
+  UInt delta;
+  *add = false;
+  do {
+    ++p;
+    if (r1 >= nc - r1) {
+      q1 = q1 * 2 + 1;
+      r1 = r1 * 2 - nc;
+    } else {
+      q1 = q1 * 2;
+      r1 = r1 * 2;
+    }
+    if (r2 + 1 >= divisor - r2) {
+      if (q2 >= two_n1 - 1)
+        *add = true;
+      q2 = q2 * 2 + 1;
+      r2 = r2 * 2 + 1 - divisor;
+    } else {
+      if (q2 >= two_n1)
+        *add = true;
+      q2 = q2 * 2;
+      r2 = r2 * 2 + 1;
+    }
+    delta = divisor - 1 - r2;
+  } while (p < bit_size * 2 && (q1 < delta || (q1 == delta && r1 == 0)));
+  *multiplier = q2 + 1;
+  *shift = p - bit_size;
+}
+
+}  // namespace
+
 LoweringX64Pass::LoweringX64Pass(base::StringPiece name, Editor* editor)
     : FunctionPass(name, editor) {
 }
@@ -48,6 +146,79 @@ bool LoweringX64Pass::CanBe32BitsImmediate(Value value) const {
   return false;
 }
 
+Value LoweringX64Pass::InsertAndLower(Instruction* new_instr,
+                                      Instruction* ref_instr) {
+  auto const output = new_instr->output(0);
+  editor()->InsertBefore(new_instr, ref_instr);
+  new_instr->Accept(this);
+  return output;
+}
+
+Value LoweringX64Pass::InsertIntLiteral(Value type,
+                                        uint64_t data,
+                                        Instruction* ref_instr) {
+  auto const output = NewRegister(type);
+  editor()->InsertBefore(
+      NewLiteralInstruction(output, NewIntConstant(type, data)), ref_instr);
+  return output;
+}
+
+//   copy RAX = %input
+//   umul_x64 RDX, RAX = RAX, %magic
+//   copy %high = RDX
+Value LoweringX64Pass::InsertUIntMulHigh(Value input,
+                                         Value magic,
+                                         Instruction* ref_instr) {
+  auto const rax = GetRAX(input);
+  auto const rdx = GetRDX(input);
+  editor()->InsertCopyBefore(rax, input, ref_instr);
+  editor()->InsertBefore(
+      factory()->NewUIntMulX64Instruction(rdx, rax, rax, magic), ref_instr);
+  return editor()->InsertCopyBefore(NewRegister(input), rdx, ref_instr);
+}
+
+bool LoweringX64Pass::IntConstantOf(Value value, int64_t* data) const {
+  if (!value.is_integer())
+    return false;
+  if (value.is_immediate()) {
+    *data = value.data;
+    return true;
+  }
+  if (!value.is_literal())
+    return false;
+  auto const literal = factory()->GetLiteral(value);
+  if (auto const int32_literal = literal->as<Int32Literal>()) {
+    *data = int32_literal->data();
+    return true;
+  }
+  if (auto const int64_literal = literal->as<Int64Literal>()) {
+    *data = int64_literal->data();
+    return true;
+  }
+  return false;
+}
+
+Value LoweringX64Pass::NewIntConstant(Value type, uint64_t data) {
+  if (type.is_32bit())
+    return factory()->NewIntValue(type, static_cast<int32_t>(data));
+  return factory()->NewIntValue(type, static_cast<int64_t>(data));
+}
+
+// Rewrite float literal operand to register.
+//   fadd %a = %b, literal
+//   =>
+//   lit %1 = literal
+//   fadd %a = %b, %1
+void LoweringX64Pass::RewriteFloatLiteral(Instruction* instr,
+                                          size_t position) {
+  auto const input = instr->input(position);
+  if (!input.is_literal() || !input.is_float())
+    return;
+  auto const new_input = NewRegister(input);
+  editor()->InsertBefore(NewLiteralInstruction(new_input, input), instr);
+  editor()->SetInput(instr, position, new_input);
+}
+
 //   div %a = %b, %c | mod %a = %b, %c
 //   =>
 //   copy RAX = %b
@@ -69,6 +240,130 @@ void LoweringX64Pass::RewriteIntDiv(Instruction* instr, size_t index) {
                     instr);
 }
 
+// Rewrite division by positive constant |d| to shift or multiplication by
+// magic number |M| computed by |ComputeSignedMagic()|, where N is bit size:
+//   div %a = %b, 2^k
+//   =>
+//   shr %1 = %b, N - 1
+//   ushr %2 = %1, N - k
+//   add %3 = %b, %2
+//   shr %a = %3, k
+//
+//   div %a = %b, d
+//   =>
+//   lit %m = M
+//   high(%1) = umul %b, %m
+//   shr %2 = %b, N - 1
+//   and %3 = %2, %m
+//   sub %4 = %1, %3
+//   shr %5 = %4, s
+//   ushr %6 = %b, N - 1
+//   add %a = %5, %6
+// We compute modulo as |%b - %a * d|. Negative divisor is rewritten to
+// 'idiv' by |RewriteIntDiv()|.
+bool LoweringX64Pass::RewriteIntDivByConstant(Instruction* instr,
+                                              size_t index) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  int64_t divisor;
+  if (!IntConstantOf(instr->input(1), &divisor) || divisor <= 0)
+    return false;
+  if (!input.is_virtual() || !(output.is_32bit() || output.is_64bit()))
+    return false;
+  auto const type = Value::TypeOf(output);
+  auto const bit_size = output.is_64bit() ? 64 : 32;
+  auto const sign_shift = Value::SmallInt32(bit_size - 1);
+  auto const shift_count = ShiftCountOf(divisor);
+  if (shift_count == 0) {
+    RewriteRemainder(instr, index, input, 1);
+    return true;
+  }
+  if (shift_count > 0) {
+    auto const sign = InsertAndLower(
+        NewShrInstruction(NewRegister(type), input, sign_shift), instr);
+    auto const bias = InsertAndLower(
+        NewUIntShrInstruction(NewRegister(type), sign,
+                              Value::SmallInt32(bit_size - shift_count)),
+        instr);
+    auto const biased = InsertAndLower(
+        NewIntAddInstruction(NewRegister(type), input, bias), instr);
+    auto const quotient = InsertAndLower(
+        NewShrInstruction(NewRegister(type), biased,
+                          Value::SmallInt32(shift_count)),
+        instr);
+    RewriteRemainder(instr, index, quotient, divisor);
+    return true;
+  }
+
+  uint64_t multiplier;
+  int shift;
+  if (bit_size == 32) {
+    uint32_t multiplier32;
+    ComputeSignedMagic<uint32_t>(static_cast<uint32_t>(divisor),
+                                 &multiplier32, &shift);
+    multiplier = multiplier32;
+  } else {
+    ComputeSignedMagic<uint64_t>(static_cast<uint64_t>(divisor), &multiplier,
+                                 &shift);
+  }
+  auto const magic = InsertIntLiteral(type, multiplier, instr);
+  auto const high = InsertUIntMulHigh(input, magic, instr);
+  auto const sign = InsertAndLower(
+      NewShrInstruction(NewRegister(type), input, sign_shift), instr);
+  auto const adjust = InsertAndLower(
+      NewBitAndInstruction(NewRegister(type), sign, magic), instr);
+  auto product = InsertAndLower(
+      NewIntSubInstruction(NewRegister(type), high, adjust), instr);
+  if (shift) {
+    product = InsertAndLower(NewShrInstruction(NewRegister(type), product,
+                                               Value::SmallInt32(shift)),
+                             instr);
+  }
+  auto const sign_bit = InsertAndLower(
+      NewUIntShrInstruction(NewRegister(type), input, sign_shift), instr);
+  auto const quotient = InsertAndLower(
+      NewIntAddInstruction(NewRegister(type), product, sign_bit), instr);
+  RewriteRemainder(instr, index, quotient, divisor);
+  return true;
+}
+
+//   div %a = %b, d
+//   =>
+//   copy %a = %q
+// or
+//   mod %a = %b, d
+//   =>
+//   mul %1 = %q, d | shl %1 = %q, k
+//   sub %2 = %b, %1
+//   copy %a = %2
+void LoweringX64Pass::RewriteRemainder(Instruction* instr,
+                                       size_t index,
+                                       Value quotient,
+                                       uint64_t divisor) {
+  auto const output = instr->output(0);
+  if (index == 0) {
+    editor()->Replace(NewCopyInstruction(output, quotient), instr);
+    return;
+  }
+  auto const type = Value::TypeOf(output);
+  auto const shift_count = ShiftCountOf(divisor);
+  auto product = quotient;
+  if (shift_count > 0) {
+    product = InsertAndLower(NewShlInstruction(NewRegister(type), quotient,
+                                               Value::SmallInt32(shift_count)),
+                             instr);
+  } else if (shift_count < 0) {
+    auto multiplier = NewIntConstant(type, divisor);
+    if (!multiplier.is_immediate())
+      multiplier = InsertIntLiteral(type, divisor, instr);
+    product = InsertAndLower(
+        NewIntMulInstruction(NewRegister(type), quotient, multiplier), instr);
+  }
+  auto const remainder = InsertAndLower(
+      NewIntSubInstruction(NewRegister(type), instr->input(0), product), instr);
+  editor()->Replace(NewCopyInstruction(output, remainder), instr);
+}
+
 // Rewrite count operand to use |CL| register.
 void LoweringX64Pass::RewriteShiftInstruciton(Instruction* instr) {
   RewriteToTwoOperands(instr);
@@ -87,10 +382,14 @@ void LoweringX64Pass::RewriteShiftInstruciton(Instruction* instr) {
 //   copy %1 = %b
 //   add %2 = %1, %c
 //   copy %a = %2
+// If target supports VEX instruction, we don't need to rewrite floating
+// operation to two operands, e.g. 'VADDSD xmm1, xmm2, xmm3'.
 void LoweringX64Pass::RewriteToTwoOperands(Instruction* instr) {
-  // TODO(eval1749) If target supports VEX instruction, we don't need to rewrite
-  // floating operation to two operands.
   auto const output = instr->output(0);
+  if (output.is_float() && Target::HasVexInstruction()) {
+    RewriteFloatLiteral(instr, 0);
+    return;
+  }
   if (!instr->input(0).is_virtual()) {
     auto const new_input = NewRegister(output);
     editor()->InsertBefore(NewLiteralInstruction(new_input, instr->input(0)),
@@ -126,6 +425,87 @@ void LoweringX64Pass::RewriteUIntDiv(Instruction* instr, size_t index) {
                     instr);
 }
 
+// Rewrite division by constant |d| to shift or multiplication by magic
+// number |M| computed by |ComputeUnsignedMagic()|:
+//   udiv %a = %b, 2^k      => ushr %a = %b, k
+//   umod %a = %b, 2^k      => and %a = %b, 2^k - 1
+//   udiv %a = %b, d
+//   =>
+//   lit %m = M
+//   high(%1) = umul %b, %m
+//   ushr %a = %1, s
+// When |M| doesn't fit in N bits, we compute |(((%b - %1) >> 1) + %1) >> s-1|
+// instead of |%1 >> s|.
+bool LoweringX64Pass::RewriteUIntDivByConstant(Instruction* instr,
+                                               size_t index) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  int64_t data;
+  if (!IntConstantOf(instr->input(1), &data))
+    return false;
+  if (!input.is_virtual() || !(output.is_32bit() || output.is_64bit()))
+    return false;
+  auto const type = Value::TypeOf(output);
+  auto const bit_size = output.is_64bit() ? 64 : 32;
+  auto const divisor = bit_size == 32
+                           ? static_cast<uint64_t>(static_cast<uint32_t>(data))
+                           : static_cast<uint64_t>(data);
+  if (!divisor)
+    return false;
+  auto const shift_count = ShiftCountOf(divisor);
+  if (shift_count >= 0) {
+    if (index == 0) {
+      auto quotient = input;
+      if (shift_count) {
+        quotient = InsertAndLower(
+            NewUIntShrInstruction(NewRegister(type), input,
+                                  Value::SmallInt32(shift_count)),
+            instr);
+      }
+      editor()->Replace(NewCopyInstruction(output, quotient), instr);
+      return true;
+    }
+    auto mask = NewIntConstant(type, divisor - 1);
+    if (!mask.is_immediate())
+      mask = InsertIntLiteral(type, divisor - 1, instr);
+    auto const remainder = InsertAndLower(
+        NewBitAndInstruction(NewRegister(type), input, mask), instr);
+    editor()->Replace(NewCopyInstruction(output, remainder), instr);
+    return true;
+  }
+
+  uint64_t multiplier;
+  bool add;
+  int shift;
+  if (bit_size == 32) {
+    uint32_t multiplier32;
+    ComputeUnsignedMagic<uint32_t>(static_cast<uint32_t>(divisor),
+                                   &multiplier32, &add, &shift);
+    multiplier = multiplier32;
+  } else {
+    ComputeUnsignedMagic<uint64_t>(divisor, &multiplier, &add, &shift);
+  }
+  auto const magic = InsertIntLiteral(type, multiplier, instr);
+  auto product = InsertUIntMulHigh(input, magic, instr);
+  if (add) {
+    auto const diff = InsertAndLower(
+        NewIntSubInstruction(NewRegister(type), input, product), instr);
+    auto const half = InsertAndLower(
+        NewUIntShrInstruction(NewRegister(type), diff, Value::SmallInt32(1)),
+        instr);
+    product = InsertAndLower(
+        NewIntAddInstruction(NewRegister(type), half, product), instr);
+    --shift;
+  }
+  auto const quotient =
+      shift ? InsertAndLower(NewUIntShrInstruction(NewRegister(type), product,
+                                                   Value::SmallInt32(shift)),
+                             instr)
+            : product;
+  RewriteRemainder(instr, index, quotient, divisor);
+  return true;
+}
+
 void LoweringX64Pass::RunOnFunction() {
   for (auto const block : function()->basic_blocks()) {
     editor()->Edit(block);
@@ -153,11 +533,29 @@ void LoweringX64Pass::VisitBitXor(BitXorInstruction* instr) {
   RewriteToTwoOperands(instr);
 }
 
+// 'CMOVcc' doesn't take immediate operand.
+void LoweringX64Pass::VisitCMovX64(CMovX64Instruction* instr) {
+  auto const input = instr->input(1);
+  if (input.is_immediate() || input.is_literal()) {
+    auto const new_input = NewRegister(input);
+    editor()->InsertBefore(NewLiteralInstruction(new_input, input), instr);
+    editor()->SetInput(instr, 1, new_input);
+  }
+  RewriteToTwoOperands(instr);
+}
+
 void LoweringX64Pass::VisitFloatAdd(FloatAddInstruction* instr) {
+  RewriteFloatLiteral(instr, 1);
   RewriteToTwoOperands(instr);
 }
 
+void LoweringX64Pass::VisitFloatCmp(FloatCmpInstruction* instr) {
+  RewriteFloatLiteral(instr, 0);
+  RewriteFloatLiteral(instr, 1);
+}
+
 void LoweringX64Pass::VisitFloatDiv(FloatDivInstruction* instr) {
+  RewriteFloatLiteral(instr, 1);
   RewriteToTwoOperands(instr);
 }
 
@@ -166,10 +564,12 @@ void LoweringX64Pass::VisitFloatMod(FloatModInstruction* instr) {
 }
 
 void LoweringX64Pass::VisitFloatMul(FloatMulInstruction* instr) {
+  RewriteFloatLiteral(instr, 1);
   RewriteToTwoOperands(instr);
 }
 
 void LoweringX64Pass::VisitFloatSub(FloatSubInstruction* instr) {
+  RewriteFloatLiteral(instr, 1);
   RewriteToTwoOperands(instr);
 }
 
@@ -178,10 +578,14 @@ void LoweringX64Pass::VisitIntAdd(IntAddInstruction* instr) {
 }
 
 void LoweringX64Pass::VisitIntDiv(IntDivInstruction* instr) {
+  if (RewriteIntDivByConstant(instr, 0))
+    return;
   RewriteIntDiv(instr, 0);
 }
 
 void LoweringX64Pass::VisitIntMod(IntModInstruction* instr) {
+  if (RewriteIntDivByConstant(instr, 1))
+    return;
   RewriteIntDiv(instr, 1);
 }
 
@@ -203,13 +607,47 @@ void LoweringX64Pass::VisitShr(ShrInstruction* instr) {
   RewriteShiftInstruciton(instr);
 }
 
+// 'CVTSI2SS' and 'CVTSI2SD' don't take immediate operand.
+void LoweringX64Pass::VisitSignedConvert(SignedConvertInstruction* instr) {
+  auto const input = instr->input(0);
+  if (!input.is_immediate() && !input.is_literal())
+    return;
+  auto const new_input = NewRegister(input);
+  editor()->InsertBefore(NewLiteralInstruction(new_input, input), instr);
+  editor()->SetInput(instr, 0, new_input);
+}
+
 void LoweringX64Pass::VisitUIntDiv(UIntDivInstruction* instr) {
+  if (RewriteUIntDivByConstant(instr, 0))
+    return;
   RewriteUIntDiv(instr, 0);
 }
 
 void LoweringX64Pass::VisitUIntMod(UIntModInstruction* instr) {
+  if (RewriteUIntDivByConstant(instr, 1))
+    return;
   RewriteUIntDiv(instr, 1);
 }
 
+void LoweringX64Pass::VisitUIntShr(UIntShrInstruction* instr) {
+  RewriteShiftInstruciton(instr);
+}
+
+// There is no instruction converting unsigned integer to float, so we convert
+// zero extended 64-bit integer instead.
+//   uconv %f = %a
+//   =>
+//   zext %1 = %a
+//   sconv %f = %1
+void LoweringX64Pass::VisitUnsignedConvert(UnsignedConvertInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  if (!output.is_float() || input.is_float() || input.is_64bit())
+    return;
+  auto const input64 = NewRegister(Value::Int64Type());
+  editor()->InsertBefore(NewZeroExtendInstruction(input64, input), instr);
+  editor()->Replace(NewSignedConvertInstruction(output, input64), instr);
+}
+
 }  // namespace lir
 }  // namespace elang
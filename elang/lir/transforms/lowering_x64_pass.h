@@ -17,9 +17,17 @@ struct Value;
 //////////////////////////////////////////////////////////////////////
 //
 // LoweringX64Pass does:
-//  - Transforms three operands instruction to two operands.
+//  - Transforms three operands instruction to two operands. Floating-point
+//    instructions are kept in three operands if target supports VEX.
 //  - Transforms 'div' to use 'RAX'/'RDX'
 //  - Transforms 'udiv' to use 'RAX'/'RDX'
+//  - Transforms division and modulo by constant to shifts or multiplication
+//    by magic number.
+//  - Transforms float literal operand to register, since SSE instructions
+//    don't take immediate operand.
+//  - Transforms unsigned 32-bit integer to float conversion to zero
+//    extension and signed conversion.
+//  - Transforms literal operand of 'cmov_x64' to register.
 //
 class ELANG_LIR_EXPORT LoweringX64Pass final : public FunctionPass,
                                                public InstructionVisitor {
@@ -30,22 +38,47 @@ class ELANG_LIR_EXPORT LoweringX64Pass final : public FunctionPass,
  private:
   bool CanBe32BitsImmediate(Value value) const;
 
+  // Returns true and sets |data| if |value| is an integer constant.
+  bool IntConstantOf(Value value, int64_t* data) const;
+
   // FunctionPass
   void RunOnFunction() final;
 
   // Support functions
   Value GetRAX(Value type);
   Value GetRDX(Value type);
+
+  // Inserts |new_instr| before |ref_instr| and lowers it. Returns output of
+  // |new_instr|.
+  Value InsertAndLower(Instruction* new_instr, Instruction* ref_instr);
+  Value InsertIntLiteral(Value type, uint64_t data, Instruction* ref_instr);
+
+  // Returns register holding high part of unsigned multiplication of |input|
+  // and |magic|.
+  Value InsertUIntMulHigh(Value input, Value magic, Instruction* ref_instr);
+  Value NewIntConstant(Value type, uint64_t data);
+  void RewriteFloatLiteral(Instruction* instr, size_t position);
   void RewriteIntDiv(Instruction* instr, size_t index);
+  bool RewriteIntDivByConstant(Instruction* instr, size_t index);
+
+  // Rewrite |instr| to compute remainder from |quotient| if |index| is 1,
+  // otherwise replace |instr| with copy of |quotient|.
+  void RewriteRemainder(Instruction* instr,
+                        size_t index,
+                        Value quotient,
+                        uint64_t divisor);
   void RewriteShiftInstruciton(Instruction* instr);
   void RewriteToTwoOperands(Instruction* instr);
   void RewriteUIntDiv(Instruction* instr, size_t index);
+  bool RewriteUIntDivByConstant(Instruction* instr, size_t index);
 
   // InstructionVisitor
   void VisitBitAnd(BitAndInstruction* instr) final;
   void VisitBitOr(BitOrInstruction* instr) final;
   void VisitBitXor(BitXorInstruction* instr) final;
+  void VisitCMovX64(CMovX64Instruction* instr) final;
   void VisitFloatAdd(FloatAddInstruction* instr) final;
+  void VisitFloatCmp(FloatCmpInstruction* instr) final;
   void VisitFloatDiv(FloatDivInstruction* instr) final;
   void VisitFloatMod(FloatModInstruction* instr) final;
   void VisitFloatMul(FloatMulInstruction* instr) final;
@@ -57,8 +90,11 @@ class ELANG_LIR_EXPORT LoweringX64Pass final : public FunctionPass,
   void VisitIntSub(IntSubInstruction* instr) final;
   void VisitShl(ShlInstruction* instr) final;
   void VisitShr(ShrInstruction* instr) final;
+  void VisitSignedConvert(SignedConvertInstruction* instr) final;
   void VisitUIntDiv(UIntDivInstruction* instr) final;
   void VisitUIntMod(UIntModInstruction* instr) final;
+  void VisitUIntShr(UIntShrInstruction* instr) final;
+  void VisitUnsignedConvert(UnsignedConvertInstruction* instr) final;
 
   DISALLOW_COPY_AND_ASSIGN(LoweringX64Pass);
 };
@@ -99,6 +99,42 @@ DEFINE_FLOAT64_BINARY_OPERATION_TEST(FloatMod, "fmod")
 DEFINE_FLOAT64_BINARY_OPERATION_TEST(FloatMul, "fmul")
 DEFINE_FLOAT64_BINARY_OPERATION_TEST(FloatSub, "fsub")
 
+// float64 Foo(float64 x, float64 y) {
+//   return x + y;
+// }
+TEST_F(LirLoweringX64Test, FloatAddVex) {
+  Target::UseVexInstructionForTesting(true);
+  auto const type = Value::Float64Type();
+  auto const function = CreateSampleFunction(type, 2);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(NewFloatAddInstruction(output, parameters[0], parameters[1]));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry XMM0D, XMM1D =\n"
+      "  pcopy %f1d, %f2d = XMM0D, XMM1D\n"
+      "  fadd %f3d = %f1d, %f2d\n"
+      "  mov XMM0D = %f3d\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
 // int Foo(int x, int y) {
 //   return x + y;
 // }
@@ -184,6 +220,173 @@ TEST_F(LirLoweringX64Test, IntDiv) {
       FormatFunction(&editor));
 }
 
+// Signed division by 7 takes high part of product with magic number
+// 0x92492493, subtracting the magic number when dividend is negative, shifts
+// it right by 2, then adds sign bit of dividend to round toward zero.
+// int Foo(int x) {
+//   return x / 7;
+// }
+TEST_F(LirLoweringX64Test, IntDivMagic) {
+  auto const type = Value::Int32Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewIntDivInstruction(output, parameters[0], Value::SmallInt32(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  lit %r3 = -1840700269\n"
+      "  mov EAX = %r1\n"
+      "  umul_x64 EDX, EAX = EAX, %r3\n"
+      "  mov %r4 = EDX\n"
+      "  mov %r6 = %r1\n"
+      "  shr %r7 = %r6, 31\n"
+      "  mov %r5 = %r7\n"
+      "  mov %r9 = %r5\n"
+      "  and %r10 = %r9, %r3\n"
+      "  mov %r8 = %r10\n"
+      "  mov %r12 = %r4\n"
+      "  sub %r13 = %r12, %r8\n"
+      "  mov %r11 = %r13\n"
+      "  mov %r15 = %r11\n"
+      "  shr %r16 = %r15, 2\n"
+      "  mov %r14 = %r16\n"
+      "  mov %r18 = %r1\n"
+      "  ushr %r19 = %r18, 31\n"
+      "  mov %r17 = %r19\n"
+      "  mov %r21 = %r14\n"
+      "  add %r22 = %r21, %r17\n"
+      "  mov %r20 = %r22\n"
+      "  mov %r2 = %r20\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// long Foo(long x) {
+//   return x / 7;
+// }
+TEST_F(LirLoweringX64Test, IntDivMagicInt64) {
+  auto const type = Value::Int64Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewIntDivInstruction(output, parameters[0], Value::SmallInt64(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX =\n"
+      "  pcopy %r1l = RCX\n"
+      "  lit %r3l = 5270498306774157605l\n"
+      "  mov RAX = %r1l\n"
+      "  umul_x64 RDX, RAX = RAX, %r3l\n"
+      "  mov %r4l = RDX\n"
+      "  mov %r6l = %r1l\n"
+      "  shr %r7l = %r6l, 63\n"
+      "  mov %r5l = %r7l\n"
+      "  mov %r9l = %r5l\n"
+      "  and %r10l = %r9l, %r3l\n"
+      "  mov %r8l = %r10l\n"
+      "  mov %r12l = %r4l\n"
+      "  sub %r13l = %r12l, %r8l\n"
+      "  mov %r11l = %r13l\n"
+      "  mov %r15l = %r11l\n"
+      "  shr %r16l = %r15l, 1\n"
+      "  mov %r14l = %r16l\n"
+      "  mov %r18l = %r1l\n"
+      "  ushr %r19l = %r18l, 63\n"
+      "  mov %r17l = %r19l\n"
+      "  mov %r21l = %r14l\n"
+      "  add %r22l = %r21l, %r17l\n"
+      "  mov %r20l = %r22l\n"
+      "  mov %r2l = %r20l\n"
+      "  mov RAX = %r2l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// int Foo(int x) {
+//   return x / 4;
+// }
+TEST_F(LirLoweringX64Test, IntDivPowerOfTwo) {
+  auto const type = Value::Int32Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewIntDivInstruction(output, parameters[0], Value::SmallInt32(4)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  mov %r4 = %r1\n"
+      "  shr %r5 = %r4, 31\n"
+      "  mov %r3 = %r5\n"
+      "  mov %r7 = %r3\n"
+      "  ushr %r8 = %r7, 30\n"
+      "  mov %r6 = %r8\n"
+      "  mov %r10 = %r1\n"
+      "  add %r11 = %r10, %r6\n"
+      "  mov %r9 = %r11\n"
+      "  mov %r13 = %r9\n"
+      "  shr %r14 = %r13, 2\n"
+      "  mov %r12 = %r14\n"
+      "  mov %r2 = %r12\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
 // int Foo(int x) {
 //   return x * 3;
 // }
@@ -258,6 +461,69 @@ TEST_F(LirLoweringX64Test, IntMod) {
       FormatFunction(&editor));
 }
 
+// Modulo by 7 is computed as |x - x / 7 * 7|.
+// int Foo(int x) {
+//   return x % 7;
+// }
+TEST_F(LirLoweringX64Test, IntModMagic) {
+  auto const type = Value::Int32Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewIntModInstruction(output, parameters[0], Value::SmallInt32(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  lit %r3 = -1840700269\n"
+      "  mov EAX = %r1\n"
+      "  umul_x64 EDX, EAX = EAX, %r3\n"
+      "  mov %r4 = EDX\n"
+      "  mov %r6 = %r1\n"
+      "  shr %r7 = %r6, 31\n"
+      "  mov %r5 = %r7\n"
+      "  mov %r9 = %r5\n"
+      "  and %r10 = %r9, %r3\n"
+      "  mov %r8 = %r10\n"
+      "  mov %r12 = %r4\n"
+      "  sub %r13 = %r12, %r8\n"
+      "  mov %r11 = %r13\n"
+      "  mov %r15 = %r11\n"
+      "  shr %r16 = %r15, 2\n"
+      "  mov %r14 = %r16\n"
+      "  mov %r18 = %r1\n"
+      "  ushr %r19 = %r18, 31\n"
+      "  mov %r17 = %r19\n"
+      "  mov %r21 = %r14\n"
+      "  add %r22 = %r21, %r17\n"
+      "  mov %r20 = %r22\n"
+      "  mul %r23 = %r20, 7\n"
+      "  mov %r25 = %r1\n"
+      "  sub %r26 = %r25, %r23\n"
+      "  mov %r24 = %r26\n"
+      "  mov %r2 = %r24\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
 // int Foo(int x, int y) {
 //   var z = x << 5;
 //   return x << y;
@@ -347,6 +613,112 @@ TEST_F(LirLoweringX64Test, UIntDiv) {
       FormatFunction(&editor));
 }
 
+// Since magic number for unsigned division by 7 doesn't fit in 32 bits, we
+// add high part of product back to dividend.
+// uint Foo(uint x) {
+//   return x / 7;
+// }
+TEST_F(LirLoweringX64Test, UIntDivMagic) {
+  auto const type = Value::Int32Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewUIntDivInstruction(output, parameters[0], Value::SmallInt32(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  lit %r3 = 613566757\n"
+      "  mov EAX = %r1\n"
+      "  umul_x64 EDX, EAX = EAX, %r3\n"
+      "  mov %r4 = EDX\n"
+      "  mov %r6 = %r1\n"
+      "  sub %r7 = %r6, %r4\n"
+      "  mov %r5 = %r7\n"
+      "  mov %r9 = %r5\n"
+      "  ushr %r10 = %r9, 1\n"
+      "  mov %r8 = %r10\n"
+      "  mov %r12 = %r8\n"
+      "  add %r13 = %r12, %r4\n"
+      "  mov %r11 = %r13\n"
+      "  mov %r15 = %r11\n"
+      "  ushr %r16 = %r15, 2\n"
+      "  mov %r14 = %r16\n"
+      "  mov %r2 = %r14\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// ulong Foo(ulong x) {
+//   return x / 7;
+// }
+TEST_F(LirLoweringX64Test, UIntDivMagicInt64) {
+  auto const type = Value::Int64Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewUIntDivInstruction(output, parameters[0], Value::SmallInt64(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX =\n"
+      "  pcopy %r1l = RCX\n"
+      "  lit %r3l = 2635249153387078803l\n"
+      "  mov RAX = %r1l\n"
+      "  umul_x64 RDX, RAX = RAX, %r3l\n"
+      "  mov %r4l = RDX\n"
+      "  mov %r6l = %r1l\n"
+      "  sub %r7l = %r6l, %r4l\n"
+      "  mov %r5l = %r7l\n"
+      "  mov %r9l = %r5l\n"
+      "  ushr %r10l = %r9l, 1\n"
+      "  mov %r8l = %r10l\n"
+      "  mov %r12l = %r8l\n"
+      "  add %r13l = %r12l, %r4l\n"
+      "  mov %r11l = %r13l\n"
+      "  mov %r15l = %r11l\n"
+      "  ushr %r16l = %r15l, 2\n"
+      "  mov %r14l = %r16l\n"
+      "  mov %r2l = %r14l\n"
+      "  mov RAX = %r2l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
 TEST_F(LirLoweringX64Test, UIntMod) {
   auto const type = Value::Int32Type();
   auto const function = CreateSampleFunction(type, 2);
@@ -382,5 +754,97 @@ TEST_F(LirLoweringX64Test, UIntMod) {
       FormatFunction(&editor));
 }
 
+// uint Foo(uint x) {
+//   return x % 7;
+// }
+TEST_F(LirLoweringX64Test, UIntModMagic) {
+  auto const type = Value::Int32Type();
+  auto const function = CreateSampleFunction(type, 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto output = NewRegister(type);
+  editor.Append(
+      NewUIntModInstruction(output, parameters[0], Value::SmallInt32(7)));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  lit %r3 = 613566757\n"
+      "  mov EAX = %r1\n"
+      "  umul_x64 EDX, EAX = EAX, %r3\n"
+      "  mov %r4 = EDX\n"
+      "  mov %r6 = %r1\n"
+      "  sub %r7 = %r6, %r4\n"
+      "  mov %r5 = %r7\n"
+      "  mov %r9 = %r5\n"
+      "  ushr %r10 = %r9, 1\n"
+      "  mov %r8 = %r10\n"
+      "  mov %r12 = %r8\n"
+      "  add %r13 = %r12, %r4\n"
+      "  mov %r11 = %r13\n"
+      "  mov %r15 = %r11\n"
+      "  ushr %r16 = %r15, 2\n"
+      "  mov %r14 = %r16\n"
+      "  mul %r17 = %r14, 7\n"
+      "  mov %r19 = %r1\n"
+      "  sub %r20 = %r19, %r17\n"
+      "  mov %r18 = %r20\n"
+      "  mov %r2 = %r18\n"
+      "  mov EAX = %r2\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// float64 Foo(uint x) {
+//   return x;
+// }
+TEST_F(LirLoweringX64Test, UnsignedConvert) {
+  auto const function = CreateSampleFunction(Value::Int32Type(), 1);
+  auto const entry_block = function->entry_block();
+  Editor editor(factory(), function);
+  editor.Edit(entry_block);
+  auto const parameters = EmitCopyParameters(&editor);
+  auto const type = Value::Float64Type();
+  auto output = NewRegister(type);
+  editor.Append(NewUnsignedConvertInstruction(output, parameters[0]));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(type, 0), output));
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+  ASSERT_EQ("", Validate(&editor));
+
+  RunPassForTesting<LoweringX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  zext %r2l = %r1\n"
+      "  sconv %f1d = %r2l\n"
+      "  mov XMM0D = %f1d\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
 }  // namespace lir
 }  // namespace elang
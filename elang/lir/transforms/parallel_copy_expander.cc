@@ -26,7 +26,7 @@ namespace lir {
 namespace {
 
 bool IsMemory(Value value) {
-  return value.is_argument() || value.is_parameter() || value.is_stack_slot();
+  return value.is_memory_proxy() || value.is_stack_slot();
 }
 
 bool IsRegister(Value value) {
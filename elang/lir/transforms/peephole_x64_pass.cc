@@ -0,0 +1,236 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/lir/transforms/peephole_x64_pass.h"
+
+#include "base/logging.h"
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
+#include "elang/lir/instructions_x64.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+
+namespace elang {
+namespace lir {
+
+namespace {
+
+// Maximum number of blocks containing only 'jmp' we skip, to stop threading
+// cycle of such blocks.
+const int kMaxThreading = 8;
+
+// Returns true if |value1| and |value2| share physical register or memory
+// location.
+bool IsAlias(Value value1, Value value2) {
+  if (value1.is_physical() && value2.is_physical()) {
+    return Target::NaturalRegisterOf(value1) ==
+           Target::NaturalRegisterOf(value2);
+  }
+  return value1 == value2;
+}
+
+bool IsEmptyBlock(BasicBlock* block) {
+  return block->first_instruction()->is<JumpInstruction>() &&
+         block->phi_instructions().empty();
+}
+
+// Returns true if |instr| reads flags set by preceding 'cmp' instruction.
+bool IsFlagsUser(const Instruction* instr) {
+  return instr->is<BranchInstruction>() || instr->is<CMovX64Instruction>();
+}
+
+// Returns true if flags set before |instr| are used after |instr|. Since 'br'
+// and 'cmov_x64' use flags set by 'cmp' in the same block, we look into the
+// first instruction of successor of 'jmp' for conservativeness.
+bool IsFlagsLiveAfter(const Instruction* instr) {
+  for (auto runner = instr->next(); runner; runner = runner->next()) {
+    if (IsFlagsUser(runner))
+      return true;
+    if (runner->is<CmpInstruction>() || runner->is<FloatCmpInstruction>())
+      return false;
+    if (auto const jump = runner->as<JumpInstruction>())
+      return IsFlagsUser(jump->target_block()->first_instruction());
+  }
+  return false;
+}
+
+// Returns true if |instr| writes |value|.
+bool IsWrittenBy(const Instruction* instr, Value value) {
+  for (auto const output : instr->outputs()) {
+    if (IsAlias(output, value))
+      return true;
+  }
+  return false;
+}
+
+// Returns the first block other than empty block reached from |block|.
+BasicBlock* ThreadedTargetOf(BasicBlock* block) {
+  auto runner = block;
+  for (auto count = 0; count < kMaxThreading; ++count) {
+    if (!IsEmptyBlock(runner))
+      return runner;
+    auto const target =
+        runner->first_instruction()->as<JumpInstruction>()->target_block();
+    if (target == runner || !target->phi_instructions().empty())
+      return runner;
+    runner = target;
+  }
+  return runner;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// PeepholeX64Pass
+//
+PeepholeX64Pass::PeepholeX64Pass(base::StringPiece name, Editor* editor)
+    : FunctionPass(name, editor) {
+}
+
+PeepholeX64Pass::~PeepholeX64Pass() {
+}
+
+// Register allocator may insert 'mov' instructions for spilling and
+// resolving data flow between 'cmp' and 'br'. We move 'cmp' to just before
+// 'br' for code emitter and macro-fusion of 'cmp' and 'Jcc'.
+void PeepholeX64Pass::FuseCmpAndBranch(BranchInstruction* branch) {
+  auto const condition = branch->input(0);
+  auto cmp_instr = static_cast<Instruction*>(nullptr);
+  for (auto runner = branch->previous(); runner; runner = runner->previous()) {
+    if (runner->CountOutputs() && runner->output(0) == condition) {
+      cmp_instr = runner;
+      break;
+    }
+  }
+  if (!cmp_instr || cmp_instr->next() == branch)
+    return;
+  for (auto runner = cmp_instr->next(); runner != branch;
+       runner = runner->next()) {
+    if (IsFlagsUser(runner) || runner->is<CallInstruction>())
+      return;
+    for (auto const input : cmp_instr->inputs()) {
+      if (IsWrittenBy(runner, input))
+        return;
+    }
+  }
+  editor()->Remove(cmp_instr);
+  editor()->InsertBefore(cmp_instr, branch);
+}
+
+void PeepholeX64Pass::OptimizeCopy(CopyInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  // mov r = r
+  if (output == input) {
+    editor()->Remove(instr);
+    return;
+  }
+  auto const previous = instr->previous();
+  if (!previous || previous->CountOutputs() != 1u)
+    return;
+  if (previous->is<CopyInstruction>() && previous->output(0) == input) {
+    auto const source = previous->input(0);
+    // mov A = B; mov B = A
+    if (source == output) {
+      editor()->Remove(instr);
+      return;
+    }
+    // mov A = B; mov C = A => mov A = B; mov C = B
+    if (!source.is_memory_slot() || !output.is_memory_slot())
+      editor()->SetInput(instr, 0, source);
+  }
+  // mov A = B; mov A = C => mov A = C
+  if ((previous->is<CopyInstruction>() || previous->is<LiteralInstruction>()) &&
+      previous->output(0) == output && !IsAlias(instr->input(0), output)) {
+    editor()->Remove(previous);
+  }
+}
+
+// 'XOR r32, r32' is shorter than 'MOV r32, imm32', but it changes flags.
+// Upper 32 bits of 64-bit register are cleared by 'XOR r32, r32'.
+void PeepholeX64Pass::OptimizeLiteral(LiteralInstruction* instr) {
+  auto const output = instr->output(0);
+  auto const input = instr->input(0);
+  if (!output.is_physical() || output.is_float() ||
+      (!output.is_32bit() && !output.is_64bit())) {
+    return;
+  }
+  if (!input.is_immediate() || input.data || IsFlagsLiveAfter(instr))
+    return;
+  auto const output32 = Value(output.type, ValueSize::Size32, output.kind,
+                              output.data);
+  editor()->Replace(NewBitXorInstruction(output32, output32, output32), instr);
+}
+
+void PeepholeX64Pass::ThreadJumps(BasicBlock* block) {
+  auto const last = block->last_instruction();
+  if (!last->is<BranchInstruction>() && !last->is<JumpInstruction>())
+    return;
+  std::vector<BasicBlock*> targets;
+  auto changed = false;
+  for (auto const operand : last->block_operands()) {
+    auto const target = ThreadedTargetOf(operand);
+    if (target != operand)
+      changed = true;
+    targets.push_back(target);
+  }
+  if (!changed)
+    return;
+  DVLOG(1) << "Thread jumps: " << *last;
+  editor()->Edit(block);
+  if (targets.size() == 2u && targets[0] == targets[1]) {
+    editor()->SetJump(targets[0]);
+  } else {
+    auto position = 0;
+    for (auto const target : targets) {
+      editor()->SetBlockOperand(last, position, target);
+      ++position;
+    }
+  }
+  editor()->Commit();
+}
+
+// FunctionPass
+void PeepholeX64Pass::RunOnFunction() {
+  std::vector<BasicBlock*> blocks(editor()->ReversePostOrderList().begin(),
+                                  editor()->ReversePostOrderList().end());
+  for (auto const block : blocks) {
+    editor()->Edit(block);
+    if (auto const branch = block->last_instruction()->as<BranchInstruction>())
+      FuseCmpAndBranch(branch);
+    for (auto instr = block->first_instruction(); instr;) {
+      auto const next = instr->next();
+      if (auto const copy = instr->as<CopyInstruction>())
+        OptimizeCopy(copy);
+      else if (auto const literal = instr->as<LiteralInstruction>())
+        OptimizeLiteral(literal);
+      instr = next;
+    }
+    editor()->Commit();
+  }
+
+  for (auto const block : blocks)
+    ThreadJumps(block);
+
+  // Discard empty blocks which are no longer reachable by threading jumps.
+  for (;;) {
+    std::vector<BasicBlock*> unreachable_blocks;
+    for (auto const block : editor()->function()->basic_blocks()) {
+      if (block->predecessors().empty() && IsEmptyBlock(block))
+        unreachable_blocks.push_back(block);
+    }
+    if (unreachable_blocks.empty())
+      break;
+    for (auto const block : unreachable_blocks)
+      editor()->DiscardBlock(block);
+  }
+  DCHECK(editor()->Validate()) << *editor();
+}
+
+}  // namespace lir
+}  // namespace elang
@@ -0,0 +1,52 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_LIR_TRANSFORMS_PEEPHOLE_X64_PASS_H_
+#define ELANG_LIR_TRANSFORMS_PEEPHOLE_X64_PASS_H_
+
+#include "elang/lir/instructions_forward.h"
+#include "elang/lir/lir_export.h"
+#include "elang/lir/pass.h"
+
+namespace elang {
+namespace lir {
+
+class BasicBlock;
+
+//////////////////////////////////////////////////////////////////////
+//
+// PeepholeX64Pass cleans up instructions after register allocation:
+//  - Remove 'mov r = r'.
+//  - Collapse 'mov' chain, 'mov A = B; mov C = A' to 'mov A = B; mov C = B',
+//    and remove 'mov B = A' after 'mov A = B'.
+//  - Remove 'mov' or 'lit' overwritten by following 'mov'.
+//  - Replace 'lit r = 0' to 'xor r = r, r' if flags aren't used after it.
+//  - Move 'cmp' to just before 'br' if register allocator inserts
+//    instructions between them.
+//  - Thread jumps to block containing only 'jmp'.
+//
+// Note: 'add r, 1' is emitted as 'INC' by |CodeEmitter|, since LIR doesn't
+// have increment instruction.
+//
+class ELANG_LIR_EXPORT PeepholeX64Pass final : public FunctionPass {
+ public:
+  PeepholeX64Pass(base::StringPiece name, Editor* editor);
+  ~PeepholeX64Pass() final;
+
+ private:
+  void FuseCmpAndBranch(BranchInstruction* branch);
+  void OptimizeCopy(CopyInstruction* instr);
+  void OptimizeLiteral(LiteralInstruction* instr);
+  void ThreadJumps(BasicBlock* block);
+
+  // FunctionPass
+  void RunOnFunction() final;
+
+  DISALLOW_COPY_AND_ASSIGN(PeepholeX64Pass);
+};
+
+}  // namespace lir
+}  // namespace elang
+
+#endif  // ELANG_LIR_TRANSFORMS_PEEPHOLE_X64_PASS_H_
@@ -0,0 +1,169 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "elang/lir/testing/lir_test_x64.h"
+
+#include "elang/lir/editor.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions_x64.h"
+#include "elang/lir/literals.h"
+#include "elang/lir/target.h"
+#include "elang/lir/transforms/peephole_x64_pass.h"
+
+namespace elang {
+namespace lir {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LirPeepholeX64PassTest
+//
+class LirPeepholeX64PassTest : public testing::LirTestX64 {
+ protected:
+  LirPeepholeX64PassTest() = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LirPeepholeX64PassTest);
+};
+
+// Test cases...
+
+TEST_F(LirPeepholeX64PassTest, Copy) {
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const edx = Target::RegisterOf(isa::EDX);
+  auto const function = CreateFunctionEmptySample({ecx});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(ecx, ecx));
+  editor.Append(NewCopyInstruction(edx, ecx));
+  editor.Append(NewCopyInstruction(ecx, edx));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(edx, 0), edx));
+  EXPECT_EQ("", Commit(&editor));
+
+  RunPassForTesting<PeepholeX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  mov EDX = ECX\n"
+      "  mov EAX = ECX\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// 'cmp' is moved to just before 'br' and jump to 'block3' is threaded to
+// 'block5'.
+TEST_F(LirPeepholeX64PassTest, Branch) {
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const function = CreateFunctionEmptySample({ecx});
+  auto const exit_block = function->exit_block();
+  Editor editor(factory(), function);
+  auto const true_block = editor.NewBasicBlock(exit_block);
+  auto const false_block = editor.NewBasicBlock(exit_block);
+  auto const merge_block = editor.NewBasicBlock(exit_block);
+  auto const cond = NewConditional();
+
+  editor.Edit(function->entry_block());
+  editor.Append(NewCmpInstruction(cond, IntCondition::Equal, ecx,
+                                  Value::SmallInt32(1)));
+  editor.Append(NewCopyInstruction(eax, ecx));
+  editor.SetBranch(cond, true_block, false_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(true_block);
+  editor.SetJump(merge_block);
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(false_block);
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  editor.Edit(merge_block);
+  editor.SetReturn();
+  EXPECT_EQ("", Commit(&editor));
+
+  RunPassForTesting<PeepholeX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block4, block5}\n"
+      "  entry ECX =\n"
+      "  mov EAX = ECX\n"
+      "  cmp_eq %b2 = ECX, 1\n"
+      "  br %b2, block5, block4\n"
+      "block4:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block2}\n"
+      "  ret block2\n"
+      "block5:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block2}\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block4, block5}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+TEST_F(LirPeepholeX64PassTest, Literal) {
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const edx = Target::RegisterOf(isa::EDX);
+  auto const function = CreateFunctionEmptySample({ecx});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewLiteralInstruction(eax, Value::SmallInt32(42)));
+  editor.Append(NewCopyInstruction(eax, ecx));
+  editor.Append(NewLiteralInstruction(edx, Value::SmallInt32(0)));
+  EXPECT_EQ("", Commit(&editor));
+
+  RunPassForTesting<PeepholeX64Pass>(&editor);
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry ECX =\n"
+      "  mov EAX = ECX\n"
+      "  xor EDX = EDX, EDX\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      FormatFunction(&editor));
+}
+
+// We don't use 'xor' for zero, since it changes flags used by 'cmov_x64'.
+TEST_F(LirPeepholeX64PassTest, LiteralFlagsLive) {
+  auto const eax = Target::RegisterOf(isa::EAX);
+  auto const ecx = Target::RegisterOf(isa::ECX);
+  auto const function = CreateFunctionEmptySample({ecx});
+  auto const cond = NewConditional();
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCmpInstruction(cond, IntCondition::SignedLessThan, ecx,
+                                  Value::SmallInt32(1)));
+  editor.Append(NewLiteralInstruction(eax, Value::SmallInt32(0)));
+  editor.Append(factory()->NewCMovX64Instruction(
+      eax, IntCondition::SignedLessThan, eax, ecx));
+  EXPECT_EQ("", Commit(&editor));
+  auto const before = FormatFunction(&editor);
+
+  RunPassForTesting<PeepholeX64Pass>(&editor);
+  EXPECT_EQ(before, FormatFunction(&editor));
+}
+
+}  // namespace lir
+}  // namespace elang
@@ -122,7 +122,10 @@ void PhiExpander::EmitReload(Value physical, Value vreg) {
 void PhiExpander::EmitSpill(Value vreg, Value physical) {
   DCHECK(physical.is_physical()) << physical;
   DCHECK(vreg.is_virtual()) << vreg;
-  spills_.push_back(spill_manager_->NewSpill(vreg, physical));
+  auto const spill = spill_manager_->NewSpill(vreg, physical);
+  if (!spill)
+    return;
+  spills_.push_back(spill);
 }
 
 // TODO(eval1749) We should use free output registers in different size, e.g.
@@ -189,7 +192,7 @@ void PhiExpander::Expand() {
         auto const input = task.second;
         DCHECK_EQ(Value::TypeOf(output), Value::TypeOf(input)) << output << " "
                                                                << input;
-        expander.AddTask(AllocationOf(output), AllocationOf(input));
+        expander.AddTask(AllocationOf(output), SourceOf(input));
       }
       if (!expander.HasTasks())
         break;
@@ -289,6 +292,14 @@ bool PhiExpander::SpillFromOutput(Value type) {
   return true;
 }
 
+Value PhiExpander::SourceOf(Value value) const {
+  auto const allocation = AllocationOf(value);
+  if (!value.is_virtual() || !allocation.is_memory_proxy())
+    return allocation;
+  auto const rematerialized = spill_manager_->RematerializedValueOf(value);
+  return rematerialized.is_void() ? allocation : rematerialized;
+}
+
 Value PhiExpander::UpdateAllocationForSpill(Value vreg, Value spill_slot) {
   DCHECK(vreg.is_virtual()) << vreg;
   DCHECK(spill_slot.is_memory_proxy()) << spill_slot;
@@ -54,6 +54,10 @@ class PhiExpander final {
   void SpillFromLiveIn(Value type);
   bool SpillFromOutput(Value type);
 
+  // Returns source operand of copying |value|, which is allocation of
+  // |value| or immediate or literal value when |value| is rematerializable.
+  Value SourceOf(Value value) const;
+
   // Returns physical register allocated to |vreg|.
   Value UpdateAllocationForSpill(Value vreg, Value spill_slot);
 
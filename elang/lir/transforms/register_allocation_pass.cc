@@ -7,6 +7,7 @@
 #include "elang/lir/editor.h"
 #include "elang/lir/instructions.h"
 #include "elang/lir/literals.h"
+#include "elang/lir/transforms/linear_scan_allocator.h"
 #include "elang/lir/transforms/register_allocator.h"
 #include "elang/lir/transforms/register_assignments.h"
 #include "elang/lir/transforms/stack_allocator.h"
@@ -30,30 +31,43 @@ bool IsUselessInstruction(const Instruction* instr) {
 // RegisterAssignmentsPass
 //
 RegisterAssignmentsPass::RegisterAssignmentsPass(base::StringPiece name,
-                                                 Editor* editor)
+                                                 Editor* editor,
+                                                 Allocator allocator)
     : FunctionPass(name, editor),
+      allocator_(allocator),
       register_assignments_(new RegisterAssignments()),
       stack_assignments_(new StackAssignments()) {
 }
 
+RegisterAssignmentsPass::RegisterAssignmentsPass(base::StringPiece name,
+                                                 Editor* editor)
+    : RegisterAssignmentsPass(name, editor, Allocator::Local) {
+}
+
 RegisterAssignmentsPass::~RegisterAssignmentsPass() {
 }
 
 Value RegisterAssignmentsPass::AssignmentOf(Instruction* instr,
                                             Value operand) const {
+  if (operand.is_spill_slot())
+    return stack_assignments_->StackSlotOf(operand);
   if (!operand.is_virtual())
     return operand;
   auto const assignment = register_assignments_->AllocationOf(instr, operand);
   if (assignment.is_physical())
     return assignment;
-  if (assignment.is_spill_slot())
-    return stack_assignments_->StackSlotOf(operand);
+  if (assignment.is_memory_proxy())
+    return stack_assignments_->StackSlotOf(assignment);
   NOTREACHED() << "unexpected assignment for " << operand << " " << assignment;
   return Value::Void();
 }
 
 void RegisterAssignmentsPass::RunOnFunction() {
-  {
+  if (allocator_ == Allocator::LinearScan) {
+    LinearScanAllocator allocator(editor(), register_assignments_.get(),
+                                  stack_assignments_.get());
+    allocator.Run();
+  } else {
     RegisterAllocator allocator(editor(), register_assignments_.get(),
                                 stack_assignments_.get());
     allocator.Run();
@@ -82,8 +96,10 @@ void RegisterAssignmentsPass::RunOnFunction() {
     editor()->DiscardPhiInstructions();
     WorkList<Instruction> action_owners;
     for (auto const instr : block->instructions()) {
-      if (!register_assignments_->BeforeActionOf(instr).empty())
+      if (!register_assignments_->BeforeActionOf(instr).empty() ||
+          instr->is<PCopyInstruction>()) {
         action_owners.Push(instr);
+      }
       ProcessInstruction(instr);
     }
     while (!action_owners.empty()) {
@@ -23,7 +23,20 @@ class StackAssignments;
 //
 class ELANG_LIR_EXPORT RegisterAssignmentsPass final : public FunctionPass {
  public:
-  explicit RegisterAssignmentsPass(base::StringPiece name, Editor* editor);
+  // Register allocation algorithm used by this pass.
+  enum class Allocator {
+    // |RegisterAllocator| allocates registers block by block. It is fast but
+    // generates more moves and spills across blocks.
+    Local,
+    // |LinearScanAllocator| allocates registers over whole function with
+    // live interval splitting.
+    LinearScan,
+  };
+
+  RegisterAssignmentsPass(base::StringPiece name,
+                          Editor* editor,
+                          Allocator allocator);
+  RegisterAssignmentsPass(base::StringPiece name, Editor* editor);
   ~RegisterAssignmentsPass() final;
 
  private:
@@ -34,6 +47,7 @@ class ELANG_LIR_EXPORT RegisterAssignmentsPass final : public FunctionPass {
 
   void ProcessInstruction(Instruction* instr);
 
+  Allocator const allocator_;
   std::unique_ptr<RegisterAssignments> register_assignments_;
   std::unique_ptr<StackAssignments> stack_assignments_;
 
@@ -107,7 +107,7 @@ RegisterAllocator::RegisterAllocator(Editor* editor,
       liveness_(editor->AnalyzeLiveness()),
       stack_allocator_(new StackAllocator(editor, stack_assignments)),
       usage_tracker_(new RegisterUsageTracker(editor)),
-      spill_manager_(new SpillManager(factory(),
+      spill_manager_(new SpillManager(editor,
                                       allocation_tracker_.get(),
                                       stack_allocator_.get(),
                                       usage_tracker_.get())) {
@@ -269,8 +269,11 @@ void RegisterAllocator::ExpandParallelCopy(const std::vector<ValuePair>& pairs,
 }
 
 void RegisterAllocator::FreeInputOperandsIfNotUsed(Instruction* instr) {
+  // |instr| may use same register more than once, e.g.
+  //    load %r2 = %r1, %r1, 8
+  std::unordered_set<Value> inputs;
   for (auto const input : instr->inputs()) {
-    if (!input.is_virtual())
+    if (!input.is_virtual() || !inputs.insert(input).second)
       continue;
     if (usage_tracker_->IsUsedAfter(input, instr))
       continue;
@@ -314,7 +317,7 @@ Instruction* RegisterAllocator::NewSpill(Instruction* instr,
   auto const spill_slot = EnsureSpillSlot(vreg);
   DCHECK(spill_slot.is_memory_proxy()) << spill_slot;
   allocation_tracker_->SetAllocation(instr, vreg, spill_slot);
-  return factory()->NewCopyInstruction(spill_slot, physical);
+  return spill_manager_->NewSpill(vreg, physical);
 }
 
 Value RegisterAllocator::PhysicalFor(Value value) const {
@@ -411,26 +414,45 @@ void RegisterAllocator::ProcessInputOperand(Instruction* instr,
   DCHECK(SpillSlotFor(input).is_spill_slot())
       << input << " doesn't have spill slot at " << *instr;
 
-  if (instr->is<LoadInstruction>() && position == 0) {
+  if (instr->is<LoadInstruction>() && position == 0 &&
+      !spill_manager_->IsRematerializable(input)) {
     // Since first operand of |LoadInstruction| is used for GC map, we
     // don't need to allocate physical register for it.
     return;
   }
 
+  // Use spilled location as operand if |instr| can accept memory operand at
+  // |position|, e.g.
+  //    add %physical[1] = %physical[1], %stack[i]
+  if (Target::CanUseMemoryOperand(instr, position) &&
+      !spill_manager_->IsRematerializable(input)) {
+    allocation_tracker_->SetAllocation(instr, input, SpillSlotFor(input));
+    return;
+  }
+
+  // Reload |input| into free register if available:
+  //    reload %physical[1] = %stack[i]
+  //    use %physical[1]
+  for (auto const natural : AllocatableRegistersFor(input)) {
+    auto const physical = AdjustSize(input, natural);
+    if (!TryAllocate(instr, input, physical))
+      continue;
+    allocation_tracker_->InsertBefore(spill_manager_->NewReload(physical, input),
+                                      instr);
+    return;
+  }
+
   // Spill one of register for |input| at |instr| by emitting spill and
   // reload instr:
   //    spill %stack[i] = %physical[1]
   //    reload %physical[1] = %stack[j]
   //    use %physical[1]
-  //
-  // TODO(eval1749) If |instr| can accept memory operand at |position|,
-  // we can use spilled location as operand.
   auto const victim = ChooseRegisterToSpill(instr, input);
   DCHECK_NE(victim, input);
   auto const physical = Spill(instr, victim);
   auto const reload = spill_manager_->NewReload(physical, input);
   allocation_tracker_->InsertBefore(reload, instr);
-  allocation_tracker_->SetAllocation(instr, input, physical);
+  MustAllocate(instr, input, physical);
 }
 
 void RegisterAllocator::ProcessInputOperands(Instruction* instr) {
@@ -475,18 +497,22 @@ void RegisterAllocator::ProcessOutputOperand(Instruction* instr, Value output) {
       return;
   }
 
+  // When next use of |output| takes memory operand, we store |output| into
+  // spill slot directly rather than spilling another register:
+  //    copy %stack[i] = %physical[1]
+  //    add %physical[2] = %physical[2], %stack[i]
+  if (ShouldOutputToSpillSlot(instr, output)) {
+    allocation_tracker_->SetAllocation(instr, output, EnsureSpillSlot(output));
+    return;
+  }
+
   // Spill one of register for |output| at |instr| by emitting spill
   // instr:
   //    spill %stack[i] = %physical[1]
   //    def %physical[1] = ...
-  //
-  // TODO(eval1749) If next use of |output| is spilled and |instr| can
-  // output to memory operand, we should use memory operand rather than
-  // physical
-  // register.
   auto const victim = ChooseRegisterToSpill(instr, output);
   DCHECK_NE(victim, output);
-  allocation_tracker_->SetAllocation(instr, output, Spill(instr, victim));
+  MustAllocate(instr, output, Spill(instr, victim));
 }
 
 void RegisterAllocator::ProcessOutputOperands(Instruction* instr) {
@@ -591,6 +617,12 @@ void RegisterAllocator::ProcessPredecessors(BasicBlock* block) {
       DVLOG(2) << "  " << vreg << " " << physical << " " << assignment;
       if (assignment == physical)
         continue;
+      if (assignment.is_memory_proxy()) {
+        allocation_tracker_->InsertBefore(
+            spill_manager_->NewReload(physical, vreg),
+            predecessor->last_instruction());
+        continue;
+      }
       allocation_tracker_->InsertBefore(
           factory()->NewCopyInstruction(physical, assignment),
           predecessor->last_instruction());
@@ -635,10 +667,35 @@ Value RegisterAllocator::Spill(Instruction* instr, Value victim) {
   DCHECK(physical.is_physical());
   allocation_tracker_->FreePhysical(physical);
   auto const spill_instr = NewSpill(instr, victim, physical);
-  allocation_tracker_->InsertBefore(spill_instr, instr);
+  if (spill_instr)
+    allocation_tracker_->InsertBefore(spill_instr, instr);
   return physical;
 }
 
+// Returns true if |instr| is 'copy' from physical register and next use of
+// |output| can be memory operand.
+bool RegisterAllocator::ShouldOutputToSpillSlot(Instruction* instr,
+                                                Value output) const {
+  if (!instr->is<CopyInstruction>() || spill_manager_->IsRematerializable(output))
+    return false;
+  auto const input = instr->input(0);
+  auto const source =
+      input.is_virtual() ? allocation_tracker_->AllocationOf(instr, input)
+                         : input;
+  if (!source.is_physical())
+    return false;
+  auto const user = usage_tracker_->NextUseAfter(output, instr);
+  if (!user)
+    return false;
+  auto position = 0;
+  for (auto const operand : user->inputs()) {
+    if (operand == output && !Target::CanUseMemoryOperand(user, position))
+      return false;
+    ++position;
+  }
+  return true;
+}
+
 Value RegisterAllocator::SpillSlotFor(Value vreg) const {
   DCHECK(vreg.is_virtual()) << vreg;
   return allocation_tracker_->SpillSlotFor(vreg);
@@ -708,8 +765,9 @@ void RegisterAllocator::VisitCall(CallInstruction* instr) {
       allocation_tracker_->InsertBefore(save, instr);
       continue;
     }
-    auto const spill_slot = SpillSlotFor(vreg);
-    auto const spill = NewSpill(instr, spill_slot, physical);
+    auto const spill = NewSpill(instr, vreg, physical);
+    if (!spill)
+      continue;
     DVLOG(2) << "spill " << *spill;
     allocation_tracker_->InsertBefore(spill, instr);
   }
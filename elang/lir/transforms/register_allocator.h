@@ -100,6 +100,7 @@ class ELANG_LIR_EXPORT RegisterAllocator final : public InstructionVisitor {
   void ProcessPhiInputOperands(BasicBlock* block, BasicBlock* predecessor);
   void ProcessPhiOutputOperands(BasicBlock* block);
   void ProcessPredecessors(BasicBlock* block);
+  bool ShouldOutputToSpillSlot(Instruction* instruction, Value output) const;
   void SortAllocatableRegisters();
 
   // Returns true if |output| is allocated to |physical|, or returns false.
@@ -114,7 +115,9 @@ class ELANG_LIR_EXPORT RegisterAllocator final : public InstructionVisitor {
   // Spill physical register allocated to virtual register |victim| before
   // |instruction|.
   Value Spill(Instruction* instruction, Value victim);
-  Instruction* NewSpill(Instruction* instr, Value spill_slot, Value physical);
+  // Returns spill instruction for |vreg| or null if |vreg| is
+  // rematerializable.
+  Instruction* NewSpill(Instruction* instr, Value vreg, Value physical);
 
   ////////////////////////////////////////////////////////////
   //
@@ -154,8 +157,9 @@ class ELANG_LIR_EXPORT RegisterAllocator final : public InstructionVisitor {
   LocalAllocation* local_map_;
   const LivenessCollection<BasicBlock*, Value>& liveness_;
   const std::unique_ptr<StackAllocator> stack_allocator_;
-  const std::unique_ptr<SpillManager> spill_manager_;
+  // Note: |usage_tracker_| must be initialized before |spill_manager_|.
   const std::unique_ptr<RegisterUsageTracker> usage_tracker_;
+  const std::unique_ptr<SpillManager> spill_manager_;
 
   DISALLOW_COPY_AND_ASSIGN(RegisterAllocator);
 };
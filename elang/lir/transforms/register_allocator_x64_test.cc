@@ -2,10 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "elang/lir/testing/lir_test.h"
 
 #include "elang/lir/editor.h"
 #include "elang/lir/factory.h"
+#include "elang/lir/instructions.h"
 #include "elang/lir/literals.h"
 #include "elang/lir/transforms/lowering_x64_pass.h"
 #include "elang/lir/transforms/register_allocator.h"
@@ -25,12 +28,190 @@ class LirRegisterAllocatorX64Test : public testing::LirTest {
  protected:
   LirRegisterAllocatorX64Test() = default;
 
+  // Emits 'load' instructions as many as allocatable general registers to
+  // make register pressure.
+  std::vector<Value> EmitLoads(Editor* editor, Value base);
+  void EmitStores(Editor* editor, Value base, const std::vector<Value>& values);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(LirRegisterAllocatorX64Test);
 };
 
+std::vector<Value> LirRegisterAllocatorX64Test::EmitLoads(Editor* editor,
+                                                           Value base) {
+  std::vector<Value> values;
+  auto const count = Target::AllocatableGeneralRegisters().size();
+  for (auto index = 0u; index < count; ++index) {
+    auto const value = NewIntPtrRegister();
+    editor->Append(NewLoadInstruction(value, base, base,
+                                      Value::SmallInt32(index * 8)));
+    values.push_back(value);
+  }
+  return values;
+}
+
+void LirRegisterAllocatorX64Test::EmitStores(Editor* editor,
+                                             Value base,
+                                             const std::vector<Value>& values) {
+  auto offset = 0;
+  for (auto const value : values) {
+    editor->Append(New<StoreInstruction>(base, base,
+                                         Value::SmallInt32(offset), value));
+    offset += 8;
+  }
+}
+
 // Test cases...
 
+// Spilled |var0| is used as memory operand of 'add' without reloading, and
+// output of 'copy' to |var1| is stored into spill slot directly, since its
+// next use, 'sub', takes memory operand.
+TEST_F(LirRegisterAllocatorX64Test, MemoryOperand) {
+  auto const base = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(base, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(base, parameter));
+  auto const var0 = NewIntPtrRegister();
+  editor.Append(NewLoadInstruction(var0, base, base, Value::SmallInt32(0)));
+  auto const values = EmitLoads(&editor, base);
+  auto const var1 = NewIntPtrRegister();
+  editor.Append(NewCopyInstruction(var1, values.front()));
+  EmitStores(&editor, base, values);
+  auto const var2 = NewIntPtrRegister();
+  editor.Append(NewIntAddInstruction(var2, base, var0));
+  auto const var3 = NewIntPtrRegister();
+  editor.Append(NewIntSubInstruction(var3, var2, var1));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var3, 0), var3));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r0l = r1l\n"
+      "  load r1l = r0l, r0l, #0\n"
+      "  load r2l = r0l, r0l, #0\n"
+      "  load r8l = r0l, r0l, #8\n"
+      "  load r9l = r0l, r0l, #16\n"
+      "  load r10l = r0l, r0l, #24\n"
+      "  load r11l = r0l, r0l, #32\n"
+      "  load r3l = r0l, r0l, #40\n"
+      "  load r6l = r0l, r0l, #48\n"
+      "  load r7l = r0l, r0l, #56\n"
+      "  load r12l = r0l, r0l, #64\n"
+      "  load r13l = r0l, r0l, #72\n"
+      "  load r14l = r0l, r0l, #80\n"
+      "  load r15l = r0l, r0l, #88\n"
+      "* mov $i56l = r1l\n"
+      "  load r1l = r0l, r0l, #96\n"
+      "* mov $i64l = r1l\n"
+      "  load r1l = r0l, r0l, #104\n"
+      "  mov $i72l = r2l\n"
+      "  store r0l, r0l, #0, r2l\n"
+      "  store r0l, r0l, #8, r8l\n"
+      "  store r0l, r0l, #16, r9l\n"
+      "  store r0l, r0l, #24, r10l\n"
+      "  store r0l, r0l, #32, r11l\n"
+      "  store r0l, r0l, #40, r3l\n"
+      "  store r0l, r0l, #48, r6l\n"
+      "  store r0l, r0l, #56, r7l\n"
+      "  store r0l, r0l, #64, r12l\n"
+      "  store r0l, r0l, #72, r13l\n"
+      "  store r0l, r0l, #80, r14l\n"
+      "  store r0l, r0l, #88, r15l\n"
+      "* mov r2l = $i64l\n"
+      "  store r0l, r0l, #96, r2l\n"
+      "  store r0l, r0l, #104, r1l\n"
+      "  add r0l = r0l, $i56l\n"
+      "  sub r0l = r0l, $i72l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      Allocate(function));
+}
+
+// Spilled |var0| and |var1| are reloaded for the second operand of 'shl' and
+// the first operand of 'add', since they don't take memory operand.
+TEST_F(LirRegisterAllocatorX64Test, NoMemoryOperand) {
+  auto const base = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(base, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(base, parameter));
+  auto const var0 = NewIntPtrRegister();
+  editor.Append(NewLoadInstruction(var0, base, base, Value::SmallInt32(0)));
+  auto const var1 = NewIntPtrRegister();
+  editor.Append(NewLoadInstruction(var1, base, base, Value::SmallInt32(8)));
+  EmitStores(&editor, base, EmitLoads(&editor, base));
+  auto const var2 = NewIntPtrRegister();
+  editor.Append(NewShlInstruction(var2, base, var0));
+  auto const var3 = NewIntPtrRegister();
+  editor.Append(NewIntAddInstruction(var3, var1, var2));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var3, 0), var3));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r0l = r1l\n"
+      "  load r1l = r0l, r0l, #0\n"
+      "  load r2l = r0l, r0l, #8\n"
+      "  load r8l = r0l, r0l, #0\n"
+      "  load r9l = r0l, r0l, #8\n"
+      "  load r10l = r0l, r0l, #16\n"
+      "  load r11l = r0l, r0l, #24\n"
+      "  load r3l = r0l, r0l, #32\n"
+      "  load r6l = r0l, r0l, #40\n"
+      "  load r7l = r0l, r0l, #48\n"
+      "  load r12l = r0l, r0l, #56\n"
+      "  load r13l = r0l, r0l, #64\n"
+      "  load r14l = r0l, r0l, #72\n"
+      "  load r15l = r0l, r0l, #80\n"
+      "* mov $i56l = r2l\n"
+      "  load r2l = r0l, r0l, #88\n"
+      "* mov $i64l = r1l\n"
+      "  load r1l = r0l, r0l, #96\n"
+      "* mov $i72l = r1l\n"
+      "  load r1l = r0l, r0l, #104\n"
+      "  store r0l, r0l, #0, r8l\n"
+      "  store r0l, r0l, #8, r9l\n"
+      "  store r0l, r0l, #16, r10l\n"
+      "  store r0l, r0l, #24, r11l\n"
+      "  store r0l, r0l, #32, r3l\n"
+      "  store r0l, r0l, #40, r6l\n"
+      "  store r0l, r0l, #48, r7l\n"
+      "  store r0l, r0l, #56, r12l\n"
+      "  store r0l, r0l, #64, r13l\n"
+      "  store r0l, r0l, #72, r14l\n"
+      "  store r0l, r0l, #80, r15l\n"
+      "  store r0l, r0l, #88, r2l\n"
+      "* mov r2l = $i72l\n"
+      "  store r0l, r0l, #96, r2l\n"
+      "  store r0l, r0l, #104, r1l\n"
+      "* mov r1l = $i64l\n"
+      "  shl r0l = r0l, r1l\n"
+      "* mov r1l = $i56l\n"
+      "  add r0l = r1l, r0l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      Allocate(function));
+}
+
 TEST_F(LirRegisterAllocatorX64Test, NumberOfArguments) {
   auto const function = CreateFunctionEmptySample();
   Editor editor(factory(), function);
@@ -50,6 +231,69 @@ TEST_F(LirRegisterAllocatorX64Test, NumberOfArguments) {
   EXPECT_EQ(16, stack_assignments.maximum_arguments_size());
 }
 
+// |var0| defined by 'lit' instruction is spilled without storing to spill
+// slot, and it is rematerialized by 'lit' instruction before its use.
+TEST_F(LirRegisterAllocatorX64Test, Rematerialize) {
+  auto const base = NewIntPtrRegister();
+  auto const parameter = Target::ParameterAt(base, 0);
+  auto const function = CreateFunctionEmptySample({parameter});
+  Editor editor(factory(), function);
+  editor.Edit(function->entry_block());
+  editor.Append(NewCopyInstruction(base, parameter));
+  auto const var0 = NewIntPtrRegister();
+  editor.Append(NewLiteralInstruction(var0, Value::SmallInt64(42)));
+  EmitStores(&editor, base, EmitLoads(&editor, base));
+  editor.Append(NewCopyInstruction(Target::ReturnAt(var0, 0), var0));
+  EXPECT_EQ("", Commit(&editor));
+
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry r1l =\n"
+      "  mov r0l = r1l\n"
+      "  lit r1l = #42l\n"
+      "  load r2l = r0l, r0l, #0\n"
+      "  load r8l = r0l, r0l, #8\n"
+      "  load r9l = r0l, r0l, #16\n"
+      "  load r10l = r0l, r0l, #24\n"
+      "  load r11l = r0l, r0l, #32\n"
+      "  load r3l = r0l, r0l, #40\n"
+      "  load r6l = r0l, r0l, #48\n"
+      "  load r7l = r0l, r0l, #56\n"
+      "  load r12l = r0l, r0l, #64\n"
+      "  load r13l = r0l, r0l, #72\n"
+      "  load r14l = r0l, r0l, #80\n"
+      "  load r15l = r0l, r0l, #88\n"
+      "  load r1l = r0l, r0l, #96\n"
+      "* mov $i64l = r1l\n"
+      "  load r1l = r0l, r0l, #104\n"
+      "  store r0l, r0l, #0, r2l\n"
+      "  store r0l, r0l, #8, r8l\n"
+      "  store r0l, r0l, #16, r9l\n"
+      "  store r0l, r0l, #24, r10l\n"
+      "  store r0l, r0l, #32, r11l\n"
+      "  store r0l, r0l, #40, r3l\n"
+      "  store r0l, r0l, #48, r6l\n"
+      "  store r0l, r0l, #56, r7l\n"
+      "  store r0l, r0l, #64, r12l\n"
+      "  store r0l, r0l, #72, r13l\n"
+      "  store r0l, r0l, #80, r14l\n"
+      "  store r0l, r0l, #88, r15l\n"
+      "* mov r2l = $i64l\n"
+      "  store r0l, r0l, #96, r2l\n"
+      "  store r0l, r0l, #104, r1l\n"
+      "* lit r0l = #42l\n"
+      "  mov r0l = r0l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      Allocate(function));
+}
+
 //  function1:
 //    block1:
 //      // In: {}
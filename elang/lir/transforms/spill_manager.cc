@@ -2,11 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <limits>
+#include <unordered_map>
+
 #include "elang/lir/transforms/spill_manager.h"
 
 #include "base/logging.h"
+#include "elang/lir/editor.h"
 #include "elang/lir/factory.h"
 #include "elang/lir/instructions.h"
+#include "elang/lir/literals.h"
 #include "elang/lir/transforms/register_allocation_tracker.h"
 #include "elang/lir/transforms/register_usage_tracker.h"
 #include "elang/lir/transforms/stack_allocator.h"
@@ -28,20 +33,41 @@ struct SpillVictim {
 //
 // SpillManager
 //
-SpillManager::SpillManager(Factory* factory,
+SpillManager::SpillManager(Editor* editor,
                            RegisterAllocationTracker* allocation_tracker,
                            StackAllocator* stack_allocator,
                            RegisterUsageTracker* usage_tracker)
     : allocation_tracker_(allocation_tracker),
-      factory_(factory),
+      factory_(editor->factory()),
       stack_allocator_(stack_allocator),
       usage_tracker_(usage_tracker) {
+  // Collect virtual registers defined only once by 'lit' instruction.
+  std::unordered_map<Value, int> definition_counts;
+  for (auto const block : editor->function()->basic_blocks()) {
+    for (auto const phi : block->phi_instructions())
+      ++definition_counts[phi->output(0)];
+    for (auto const instr : block->instructions()) {
+      for (auto const output : instr->outputs()) {
+        if (!output.is_virtual())
+          continue;
+        ++definition_counts[output];
+        if (!instr->is<LiteralInstruction>() || !instr->input(0).is_read_only())
+          continue;
+        rematerializable_map_[output] = instr->input(0);
+      }
+    }
+  }
+  for (auto const pair : definition_counts) {
+    if (pair.second > 1)
+      rematerializable_map_.erase(pair.first);
+  }
 }
 
 SpillManager::~SpillManager() {
 }
 
-// Returns farthest used virtual register which types is |type| or farthest
+// Returns farthest used virtual register which types is |type| and which
+// doesn't need store, e.g. already spilled or rematerializable, or farthest
 // used virtual register.
 Value SpillManager::ChooseRegisterToSpill(Value type,
                                           Instruction* instr) const {
@@ -52,14 +78,18 @@ Value SpillManager::ChooseRegisterToSpill(Value type,
     if (physical.type != type.type)
       continue;
     auto const candidate = it.first;
-    auto const next_use = usage_tracker_->NextUseAfter(candidate, instr);
-    if (!next_use || victim.next_use < next_use->index()) {
-      victim.next_use = next_use->index();
+    // Candidate which isn't used in this block is the farthest one.
+    auto const user = usage_tracker_->NextUseAfter(candidate, instr);
+    auto const next_use =
+        user ? user->index() : std::numeric_limits<int>::max();
+    if (victim.next_use < next_use) {
+      victim.next_use = next_use;
       victim.vreg = candidate;
     }
-    if (SpillSlotFor(candidate).is_memory_proxy() &&
-        (!next_use || spilled_victim.next_use < next_use->index())) {
-      spilled_victim.next_use = next_use->index();
+    if ((SpillSlotFor(candidate).is_memory_proxy() ||
+         IsRematerializable(candidate)) &&
+        spilled_victim.next_use < next_use) {
+      spilled_victim.next_use = next_use;
       spilled_victim.vreg = candidate;
     }
   }
@@ -88,9 +118,16 @@ Value SpillManager::EnsureSpillSlot(Value vreg) {
   return spill_slot;
 }
 
+bool SpillManager::IsRematerializable(Value vreg) const {
+  return !RematerializedValueOf(vreg).is_void();
+}
+
 Instruction* SpillManager::NewReload(Value physical, Value vreg) {
   DCHECK(physical.is_physical());
   DCHECK(vreg.is_virtual());
+  auto const value = RematerializedValueOf(vreg);
+  if (!value.is_void())
+    return factory_->NewLiteralInstruction(physical, value);
   auto const spill_slot = allocation_tracker_->SpillSlotFor(vreg);
   DCHECK(spill_slot.is_memory_proxy());
   return factory_->NewCopyInstruction(physical, spill_slot);
@@ -99,8 +136,15 @@ Instruction* SpillManager::NewReload(Value physical, Value vreg) {
 Instruction* SpillManager::NewSpill(Value vreg, Value physical) {
   DCHECK(vreg.is_virtual());
   DCHECK(physical.is_physical());
-  auto const spill_slot = EnsureSpillSlot(vreg);
-  return factory_->NewCopyInstruction(spill_slot, physical);
+  if (IsRematerializable(vreg))
+    return nullptr;
+  return factory_->NewCopyInstruction(EnsureSpillSlot(vreg), physical);
+}
+
+Value SpillManager::RematerializedValueOf(Value vreg) const {
+  DCHECK(vreg.is_virtual());
+  auto const it = rematerializable_map_.find(vreg);
+  return it == rematerializable_map_.end() ? Value() : it->second;
 }
 
 Value SpillManager::SpillSlotFor(Value vreg) const {
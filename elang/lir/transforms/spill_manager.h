@@ -5,25 +5,32 @@
 #ifndef ELANG_LIR_TRANSFORMS_SPILL_MANAGER_H_
 #define ELANG_LIR_TRANSFORMS_SPILL_MANAGER_H_
 
+#include <unordered_map>
+
 #include "base/macros.h"
+#include "elang/lir/value.h"
 
 namespace elang {
 namespace lir {
 
+class Editor;
 class Factory;
 class Instruction;
 class RegisterAllocationTracker;
 class RegisterUsageTracker;
 class StackAllocator;
-struct Value;
 
 //////////////////////////////////////////////////////////////////////
 //
 // SpillManager
 //
+// Virtual registers defined only once by 'lit' instruction with immediate or
+// literal operand are rematerializable. Instead of storing them into spill
+// slot and loading them from it, we emit 'lit' instruction again at reload.
+//
 class SpillManager final {
  public:
-  explicit SpillManager(Factory* factory,
+  explicit SpillManager(Editor* editor,
                         RegisterAllocationTracker* allocation_tracker,
                         StackAllocator* stack_allocator,
                         RegisterUsageTracker* usage_tracker);
@@ -37,19 +44,28 @@ class SpillManager final {
   // allocates spill slot |vreg|.
   Value EnsureSpillSlot(Value vreg);
 
+  // Returns true if |vreg| can be rematerialized rather than reloading from
+  // spill slot.
+  bool IsRematerializable(Value vreg) const;
+
   // Returns a newly created instruction to load |physical| from spill
-  // slot for |vreg|.
+  // slot for |vreg|, or to rematerialize |vreg| into |physical|.
   Instruction* NewReload(Value physical, Value vreg);
 
   // Returns a newly created instruction to store |physical| to spill
-  // slot for |vreg|.
-  Instruction* NewSpill(Value spill_slot, Value physical);
+  // slot for |vreg|, or null if |vreg| is rematerializable.
+  Instruction* NewSpill(Value vreg, Value physical);
+
+  // Returns immediate or literal value of rematerializable |vreg|, or void.
+  Value RematerializedValueOf(Value vreg) const;
 
   Value SpillSlotFor(Value vreg) const;
 
  private:
   RegisterAllocationTracker* const allocation_tracker_;
   Factory* const factory_;
+  // Map virtual register to immediate or literal value to rematerialize.
+  std::unordered_map<Value, Value> rematerializable_map_;
   StackAllocator* const stack_allocator_;
   RegisterUsageTracker* const usage_tracker_;
 
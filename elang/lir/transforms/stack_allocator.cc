@@ -156,8 +156,9 @@ StackAllocator::Slot* StackAllocator::NewSlot(Value type) {
   size_ += Value::SizeOf(type);
   assignments_->maximum_variables_size_ = Align(size_, alignment_);
   auto const slot = new (zone()) Slot(zone());
-  live_slots_.insert(slot);
+  // Note: |live_slots_| is ordered by |proxy|.
   slot->proxy = Value::SpillSlot(type, offset);
+  live_slots_.insert(slot);
   return slot;
 }
 
@@ -76,8 +76,10 @@ class ELANG_LIR_EXPORT Validator final : public ErrorReporter,
   void VisitZeroExtend(ZeroExtendInstruction* instruction) final;
 
 #ifdef ELANG_TARGET_ARCH_X64
+  void VisitCMovX64(CMovX64Instruction* instruction) final;
   void VisitIntDivX64(IntDivX64Instruction* instruction) final;
   void VisitIntSignX64(IntSignX64Instruction* instruction) final;
+  void VisitLeaX64(LeaX64Instruction* instruction) final;
   void VisitUIntDivX64(UIntDivX64Instruction* instruction) final;
   void VisitUIntMulX64(UIntMulX64Instruction* instruction) final;
 #endif
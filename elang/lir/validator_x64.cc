@@ -17,6 +17,16 @@
 namespace elang {
 namespace lir {
 
+void Validator::VisitCMovX64(CMovX64Instruction* instr) {
+  auto const output = instr->output(0);
+  if (!output.is_int32() && !output.is_int64())
+    Error(ErrorCode::ValidateInstructionOutput, instr, 0);
+  if (Value::TypeOf(instr->input(0)) != Value::TypeOf(output))
+    Error(ErrorCode::ValidateInstructionInput, instr, 0);
+  if (Value::TypeOf(instr->input(1)) != Value::TypeOf(output))
+    Error(ErrorCode::ValidateInstructionInput, instr, 1);
+}
+
 void Validator::VisitIntDivX64(IntDivX64Instruction* instr) {
   auto const expected_output0 =
       Target::RegisterOf(instr->output(0).is_int32() ? isa::EAX : isa::RAX);
@@ -45,6 +55,27 @@ void Validator::VisitIntSignX64(IntSignX64Instruction* instr) {
     Error(ErrorCode::ValidateInstructionInput, instr, 0);
 }
 
+void Validator::VisitLeaX64(LeaX64Instruction* instr) {
+  auto const output = instr->output(0);
+  if (!output.is_register() || Value::TypeOf(output) != Target::IntPtrType())
+    Error(ErrorCode::ValidateInstructionOutput, instr, 0);
+  auto const base = instr->input(0);
+  if (!base.is_register() || Value::TypeOf(base) != Target::IntPtrType())
+    Error(ErrorCode::ValidateInstructionInput, instr, 0);
+  auto const index = instr->input(1);
+  if (!index.is_register() || Value::TypeOf(index) != Target::IntPtrType())
+    Error(ErrorCode::ValidateInstructionInput, instr, 1);
+  auto const scale = instr->input(2);
+  if (!scale.is_immediate() || !scale.is_int32() ||
+      (scale.data != 1 && scale.data != 2 && scale.data != 4 &&
+       scale.data != 8)) {
+    Error(ErrorCode::ValidateInstructionInput, instr, 2);
+  }
+  auto const displacement = instr->input(3);
+  if (!displacement.is_immediate() || !displacement.is_int32())
+    Error(ErrorCode::ValidateInstructionInput, instr, 3);
+}
+
 void Validator::VisitUIntDivX64(UIntDivX64Instruction* instr) {
   auto const expected_output0 =
       Target::RegisterOf(instr->output(0).is_int32() ? isa::EAX : isa::RAX);
@@ -71,7 +102,7 @@ void Validator::VisitUIntMulX64(UIntMulX64Instruction* instr) {
     Error(ErrorCode::ValidateInstructionOutput, instr, 0);
   if (instr->output(1) != expected_output1)
     Error(ErrorCode::ValidateInstructionOutput, instr, 1);
-  if (instr->input(0) != expected_output0)
+  if (instr->input(0) != expected_output1)
     Error(ErrorCode::ValidateInstructionInput, instr, 0);
   if (Value::TypeOf(instr->input(1)) != Value::TypeOf(instr->input(0)))
     Error(ErrorCode::ValidateInstructionInput, instr, 1);
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <ostream>
+#include <unordered_set>
 #include <vector>
 
 #include "elang/optimizer/editor.h"
@@ -63,6 +64,28 @@ void Editor::Discard(Node* node) {
   auto const num_inputs = node->CountInputs();
   for (size_t position = 0; position < num_inputs; ++position)
     node->InputAt(position)->Reset();
+  if (auto const phi = node->as<PhiNode>())
+    phi->owner()->phi_nodes_.RemoveNode(phi);
+}
+
+void Editor::Discard(const std::vector<Node*>& nodes) {
+#ifndef NDEBUG
+  std::unordered_set<Node*> node_set(nodes.begin(), nodes.end());
+  for (auto const node : nodes) {
+    for (auto const edge : node->use_edges())
+      DCHECK(node_set.count(edge->from())) << *node << " " << *edge->from();
+  }
+#endif
+  for (auto const node : nodes) {
+    auto const num_inputs = node->CountInputs();
+    for (size_t position = 0; position < num_inputs; ++position)
+      node->InputAt(position)->Reset();
+  }
+  for (auto const node : nodes) {
+    DCHECK(!node->IsUsed()) << *node;
+    if (auto const phi = node->as<PhiNode>())
+      phi->owner()->phi_nodes_.RemoveNode(phi);
+  }
 }
 
 void Editor::Edit(Control* control) {
@@ -120,8 +143,21 @@ void Editor::RemovePhiInput(PhiNode* phi, Control* control) {
 void Editor::ReplaceAllUses(Node* new_node, Node* old_node) {
   std::vector<UseEdge*> edges(old_node->use_edges().begin(),
                               old_node->use_edges().end());
-  for (auto const edge : edges)
+  // Since |ElementNode| takes start of block as control, e.g. removing bounds
+  // check replaces 'if_true' with input of 'if', element nodes use start of
+  // block containing |new_node|.
+  auto block_start = new_node;
+  if (new_node->IsControl()) {
+    while (!block_start->IsBlockStart())
+      block_start = block_start->input(0);
+  }
+  for (auto const edge : edges) {
+    if (edge->from()->is<ElementNode>()) {
+      edge->SetTo(block_start);
+      continue;
+    }
     edge->SetTo(new_node);
+  }
 }
 
 Control* Editor::SetBranch(Data* condition) {
@@ -184,6 +220,14 @@ Control* Editor::SetRet(Effect* effect, Data* data) {
   return new_ret_node;
 }
 
+Control* Editor::SetThrow(Data* value) {
+  DCHECK(control_);
+  auto const merge_node = exit_node()->input(0)->as<MergeNode>();
+  auto const throw_node = NewThrow(control_, value);
+  merge_node->AppendInput(throw_node);
+  return throw_node;
+}
+
 bool Editor::Validate() const {
   Validator validator(factory(), function());
   return validator.Validate();
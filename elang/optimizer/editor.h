@@ -40,6 +40,7 @@ class ELANG_OPTIMIZER_EXPORT Editor final : public ErrorReporter,
   Control* SetBranch(Data* condition);
   Control* SetJump(Control* target);
   Control* SetRet(Effect* effect, Data* data);
+  Control* SetThrow(Data* value);
 
   // Edit input edge
   void AppendInput(Node* node, Node* new_value);
@@ -48,6 +49,9 @@ class ELANG_OPTIMIZER_EXPORT Editor final : public ErrorReporter,
 
   // Node
   void Discard(Node* node);
+  // Discards |nodes| which are used only by nodes in |nodes|, e.g. nodes in
+  // unreachable loop.
+  void Discard(const std::vector<Node*>& nodes);
   void ReplaceAllUses(Node* new_node, Node* old_node);
 
   // Phi
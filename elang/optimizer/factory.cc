@@ -17,8 +17,18 @@
 #include "elang/optimizer/node_factory.h"
 #include "elang/optimizer/scheduler/schedule.h"
 #include "elang/optimizer/scheduler/scheduler.h"
+#include "elang/optimizer/transforms/bounds_check_pass.h"
 #include "elang/optimizer/transforms/clean_pass.h"
 #include "elang/optimizer/transforms/dead_pass.h"
+#include "elang/optimizer/transforms/escape_pass.h"
+#include "elang/optimizer/transforms/gvn_pass.h"
+#include "elang/optimizer/transforms/inline_pass.h"
+#include "elang/optimizer/transforms/load_store_pass.h"
+#include "elang/optimizer/transforms/loop_pass.h"
+#include "elang/optimizer/transforms/reduce_pass.h"
+#include "elang/optimizer/transforms/sccp_pass.h"
+#include "elang/optimizer/transforms/strength_reduction_pass.h"
+#include "elang/optimizer/transforms/tail_call_pass.h"
 #include "elang/optimizer/types.h"
 #include "elang/optimizer/type_factory.h"
 
@@ -45,11 +55,22 @@ Factory::~Factory() {
 }
 
 std::unique_ptr<Schedule> Factory::ComputeSchedule(Function* function) {
+  return ComputeSchedule(function, nullptr);
+}
+
+std::unique_ptr<Schedule> Factory::ComputeSchedule(
+    Function* function,
+    const EdgeCounts::Map* edge_counts) {
   auto schedule = std::make_unique<Schedule>(function);
-  Scheduler(pass_controller_, schedule.get()).Run();
+  Scheduler(pass_controller_, schedule.get(), edge_counts).Run();
   return std::move(schedule);
 }
 
+Function* Factory::FunctionByName(AtomicString* name) const {
+  auto const it = function_map_.find(name);
+  return it == function_map_.end() ? nullptr : it->second;
+}
+
 AtomicString* Factory::NewAtomicString(base::StringPiece16 string) {
   return atomic_string_factory_->NewAtomicString(string);
 }
@@ -80,7 +101,18 @@ struct PassInfo {
 };
 
 PassInfo kPasses[] = {
+    {1, &RunPass<TailCallPass>},
+    {1, &RunPass<InlinePass>},
+    {1, &RunPass<SccpPass>},
+    {1, &RunPass<DeadPass>},
+    {0, &RunPass<ReducePass>},
     {0, &RunPass<CleanPass>},
+    {2, &RunPass<LoopPass>},
+    {1, &RunPass<GvnPass>},
+    {1, &RunPass<EscapePass>},
+    {1, &RunPass<LoadStorePass>},
+    {1, &RunPass<BoundsCheckPass>},
+    {1, &RunPass<StrengthReductionPass>},
     {0, &RunPass<DeadPass>},
 };
 
@@ -98,5 +130,10 @@ bool Factory::Optimize(Function* function, int level) {
   return true;
 }
 
+void Factory::RegisterFunction(AtomicString* name, Function* function) {
+  DCHECK(!function_map_.count(name)) << *name;
+  function_map_[name] = function;
+}
+
 }  // namespace optimizer
 }  // namespace elang
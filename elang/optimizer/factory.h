@@ -17,6 +17,7 @@
 #include "elang/optimizer/factory_config.h"
 #include "elang/optimizer/node_factory_user.h"
 #include "elang/optimizer/optimizer_export.h"
+#include "elang/optimizer/scheduler/edge_counts.h"
 #include "elang/optimizer/type_factory_user.h"
 
 namespace elang {
@@ -43,13 +44,25 @@ class ELANG_OPTIMIZER_EXPORT Factory final : public ErrorSink,
   api::PassController* pass_controller() const { return pass_controller_; }
 
   std::unique_ptr<Schedule> ComputeSchedule(Function* function);
+  // Computes schedule of |function| using |edge_counts| collected by training
+  // run instead of static prediction, if |edge_counts| isn't null.
+  std::unique_ptr<Schedule> ComputeSchedule(Function* function,
+                                            const EdgeCounts::Map* edge_counts);
+  // Returns function registered as |name| or null if there is no such
+  // function.
+  Function* FunctionByName(AtomicString* name) const;
   AtomicString* NewAtomicString(base::StringPiece16 string);
   Function* NewFunction(FunctionType* function_type);
   bool Optimize(Function* function, int level);
 
+  // Registers |function| as |name| for resolving callee of |CallNode|
+  // referenced by |ReferenceNode|.
+  void RegisterFunction(AtomicString* name, Function* function);
+
  private:
   AtomicStringFactory* const atomic_string_factory_;
   const FactoryConfig config_;
+  std::unordered_map<AtomicString*, Function*> function_map_;
   size_t last_function_id_;
   const std::unique_ptr<NodeFactory> node_factory_;
   api::PassController* const pass_controller_;
@@ -183,10 +183,15 @@ Control* NodeFactory::NewCall(Control* control,
   DCHECK(control->IsValidControl()) << *control;
   DCHECK(effect->IsValidEffect()) << *effect;
   DCHECK(callee->IsValidData()) << *callee;
-  DCHECK(callee->output_type()->is<FunctionType>()) << *callee;
   DCHECK(arguments->IsValidData()) << *arguments;
+  // Callee is a function, e.g. |ReferenceNode|, or a pointer to function, e.g.
+  // |FunctionReferenceNode|.
+  auto callee_type = callee->output_type();
+  if (auto const pointer_type = callee_type->as<PointerType>())
+    callee_type = pointer_type->pointee();
+  DCHECK(callee_type->is<FunctionType>()) << *callee;
   auto const output_type =
-      NewControlType(callee->output_type()->as<FunctionType>()->return_type());
+      NewControlType(callee_type->as<FunctionType>()->return_type());
   auto const node =
       new (zone()) CallNode(output_type, control, effect, callee, arguments);
   node->set_id(NewNodeId());
@@ -209,7 +214,10 @@ EffectPhiNode* NodeFactory::NewEffectPhi(PhiOwnerNode* owner) {
   return node;
 }
 
-Data* NodeFactory::NewElement(Data* array, Node* indexes) {
+Data* NodeFactory::NewElement(Data* array, Node* indexes, Control* control) {
+  DCHECK(control->IsValidControl()) << *control;
+  while (!control->IsBlockStart())
+    control = control->input(0)->as<Control>();
   auto const array_pointer_type = array->output_type()->as<PointerType>();
   DCHECK(array_pointer_type) << *array->output_type();
   auto const array_type = array_pointer_type->pointee()->as<ArrayType>();
@@ -224,7 +232,8 @@ Data* NodeFactory::NewElement(Data* array, Node* indexes) {
   }
 #endif
   auto const output_type = NewPointerType(array_type->element_type());
-  auto const node = new (zone()) ElementNode(output_type, array, indexes);
+  auto const node =
+      new (zone()) ElementNode(output_type, array, indexes, control);
   node->set_id(NewNodeId());
   return node;
 }
@@ -471,7 +480,7 @@ Data* NodeFactory::NewIntDiv(Data* left, Data* right) {
 
 Data* NodeFactory::NewIntMul(Data* left, Data* right) {
   if (left->IsLiteral() && !right->IsLiteral())
-    return NewIntAdd(right, left);
+    return NewIntMul(right, left);
   auto const type = left->output_type();
   DCHECK_EQ(type, right->output_type()) << *left << " " << *right;
   DCHECK(type->is_integer()) << *left << " " << *right;
@@ -479,7 +488,7 @@ Data* NodeFactory::NewIntMul(Data* left, Data* right) {
     return NewInt32(0);
   if (right == NewInt64(0))
     return NewInt64(0);
-  if (right == NewInt32(1) || right == NewInt32(1))
+  if (right == NewInt32(1) || right == NewInt64(1))
     return left;
   auto const node = new (zone()) IntMulNode(type, left, right);
   node->set_id(NewNodeId());
@@ -598,6 +607,18 @@ Data* NodeFactory::NewParameter(EntryNode* input, size_t field) {
   return node;
 }
 
+// Note: |offset| is number of elements rather than number of bytes.
+Data* NodeFactory::NewPointerAdd(Data* pointer, Data* offset) {
+  DCHECK(pointer->output_type()->is<PointerType>()) << *pointer;
+  DCHECK_EQ(int32_type(), offset->output_type()) << *offset;
+  if (offset == NewInt32(0))
+    return pointer;
+  auto const node =
+      new (zone()) PointerAddNode(pointer->output_type(), pointer, offset);
+  node->set_id(NewNodeId());
+  return node;
+}
+
 PhiNode* NodeFactory::NewPhi(Type* output_type, PhiOwnerNode* owner) {
   DCHECK(owner->IsValidControl()) << *owner;
   auto const node = new (zone()) PhiNode(output_type, zone(), owner);
@@ -644,6 +665,14 @@ Effect* NodeFactory::NewStore(Effect* effect,
   return node;
 }
 
+Control* NodeFactory::NewThrow(Control* control, Data* value) {
+  DCHECK(control->IsValidControl()) << *control;
+  DCHECK(value->IsValidData()) << *value;
+  auto const node = new (zone()) ThrowNode(control_type(), control, value);
+  node->set_id(NewNodeId());
+  return node;
+}
+
 Tuple* NodeFactory::NewTuple(const std::vector<Node*>& inputs) {
   std::vector<Type*> types(inputs.size());
   types.resize(0);
@@ -69,7 +69,6 @@ class ELANG_OPTIMIZER_EXPORT NodeFactory final : public TypeFactoryUser,
   Control* NewUnreachable(Control* input);
 
   // Two inputs
-  Data* NewElement(Data* array, Node* indexes);
   Data* NewField(Type* field_type, Data* instance, Data* field_name);
   Data* NewFloatCmp(FloatCondition condition, Data* left, Data* right);
   Control* NewIf(Control* control, Data* value);
@@ -78,9 +77,14 @@ class ELANG_OPTIMIZER_EXPORT NodeFactory final : public TypeFactoryUser,
   Data* NewIntShr(Data* left, Data* right);
   Data* NewLength(Data* array, size_t rank);
   Data* NewParameter(EntryNode* entry_node, size_t field);
-  Data* NewThrow(Control* control, Data* value);
+  Data* NewPointerAdd(Data* pointer, Data* offset);
+  Control* NewThrow(Control* control, Data* value);
 
   // Three inputs
+  // |control| is in block where element pointer is valid, e.g. 'if_true' of
+  // bounds check. Element node holds start of block containing |control|,
+  // and element pointer isn't computed before it.
+  Data* NewElement(Data* array, Node* indexes, Control* control);
   Data* NewLoad(Effect* effect, Data* base_pointer, Data* pointer);
   Control* NewRet(Control* control, Effect* effect, Data* data);
 
@@ -44,8 +44,10 @@ EffectPhiNode* NodeFactoryUser::NewEffectPhi(PhiOwnerNode* owner) {
   return node_factory_->NewEffectPhi(owner);
 }
 
-Data* NodeFactoryUser::NewElement(Data* array, Node* indexes) {
-  return node_factory_->NewElement(array, indexes);
+Data* NodeFactoryUser::NewElement(Data* array,
+                                  Node* indexes,
+                                  Control* control) {
+  return node_factory_->NewElement(array, indexes, control);
 }
 
 Data* NodeFactoryUser::NewField(Type* type, Data* instance, Data* field_name) {
@@ -58,6 +60,10 @@ Data* NodeFactoryUser::NewFloatCmp(FloatCondition condition,
   return node_factory_->NewFloatCmp(condition, left, right);
 }
 
+Data* NodeFactoryUser::NewFunctionReference(Function* function) {
+  return node_factory_->NewFunctionReference(function);
+}
+
 Data* NodeFactoryUser::NewGet(Tuple* input, size_t field) {
   return node_factory_->NewGet(input, field);
 }
@@ -118,6 +124,10 @@ Data* NodeFactoryUser::NewParameter(EntryNode* input, size_t field) {
   return node_factory_->NewParameter(input, field);
 }
 
+Data* NodeFactoryUser::NewPointerAdd(Data* pointer, Data* offset) {
+  return node_factory_->NewPointerAdd(pointer, offset);
+}
+
 PhiNode* NodeFactoryUser::NewPhi(Type* output_type, PhiOwnerNode* owner) {
   return node_factory_->NewPhi(output_type, owner);
 }
@@ -145,6 +155,10 @@ Effect* NodeFactoryUser::NewStore(Effect* effect,
   return node_factory_->NewStore(effect, anchor, pointer, new_value);
 }
 
+Control* NodeFactoryUser::NewThrow(Control* control, Data* value) {
+  return node_factory_->NewThrow(control, value);
+}
+
 Tuple* NodeFactoryUser::NewTuple(const std::vector<Node*>& inputs) {
   return node_factory_->NewTuple(inputs);
 }
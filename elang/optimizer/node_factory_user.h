@@ -63,7 +63,6 @@ class ELANG_OPTIMIZER_EXPORT NodeFactoryUser {
   Control* NewUnreachable(Control* control);
 
   // Two inputs
-  Data* NewElement(Data* array, Node* indexes);
   Data* NewField(Type* field_type, Data* instance, Data* field_name);
   Data* NewFloatCmp(FloatCondition condition, Data* left, Data* right);
   Control* NewIf(Control* control, Data* value);
@@ -72,10 +71,15 @@ class ELANG_OPTIMIZER_EXPORT NodeFactoryUser {
   Data* NewIntShr(Data* left, Data* right);
   Data* NewLength(Data* array, size_t rank);
   Data* NewParameter(EntryNode* entry_node, size_t field);
+  Data* NewPointerAdd(Data* pointer, Data* offset);
   Control* NewSwitch(Control* control, Data* value);
   Control* NewThrow(Control* control, Data* value);
 
   // Three inputs
+  // |control| is in block where element pointer is valid, e.g. 'if_true' of
+  // bounds check. Element node holds start of block containing |control|,
+  // and element pointer isn't computed before it.
+  Data* NewElement(Data* array, Node* indexes, Control* control);
   Data* NewLoad(Effect* effect, Data* base_pointer, Data* pointer);
   Control* NewRet(Control* control, Effect* effect, Data* value);
 
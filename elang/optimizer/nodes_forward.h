@@ -55,12 +55,12 @@ namespace optimizer {
   V(Unreachable, "unreachable", Control)
 
 #define FOR_EACH_OPTIMIZER_CONCRETE_SIMPLE_NODE_2(V) \
-  V(Element, "element", Data)                        \
   V(Field, "field", Data)                            \
   V(If, "if", Control)                               \
   V(IntShl, "shl", Data)                             \
   V(IntShr, "shr", Data)                             \
   V(Length, "length", Data)                          \
+  V(PointerAdd, "ptr_add", Data)                     \
   V(StackAlloc, "alloca", Data)                      \
   V(Switch, "switch", Control)                       \
   V(Throw, "throw", Control)
@@ -84,6 +84,7 @@ namespace optimizer {
   V(UIntMod, "umod", Data)
 
 #define FOR_EACH_OPTIMIZER_CONCRETE_SIMPLE_NODE_3(V) \
+  V(Element, "element", Data)                        \
   V(Load, "load", Data)                              \
   V(Ret, "ret", Control)
 
@@ -71,11 +71,14 @@ TEST_F(NodesTest, EffectPhi) {
 }
 
 TEST_F(NodesTest, ElementNode) {
+  auto const function = NewSampleFunction(void_type(), void_type());
   auto const array_pointer =
       NewReference(NewPointerType(NewArrayType(int32_type(), {-1})),
                    NewAtomicString(L"Sample.array_"));
-  auto const node = NewElement(array_pointer, NewInt32(3));
-  EXPECT_EQ("int32* %r1 = element(int32[]* Sample.array_, 3)", ToString(node));
+  auto const node =
+      NewElement(array_pointer, NewInt32(3), function->entry_node());
+  EXPECT_EQ("int32* %r4 = element(int32[]* Sample.array_, 3, %c1)",
+            ToString(node));
 }
 
 TEST_F(NodesTest, EntryNode) {
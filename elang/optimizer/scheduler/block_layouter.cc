@@ -23,6 +23,12 @@ namespace optimizer {
 
 namespace {
 
+// Blocks executed less than this per function call are cold. Since
+// |StaticPredictor| sets frequency of entry block to 1.0, this threshold
+// captures branches to 'throw' and 'unreachable', and branches never taken
+// in training run.
+const double kColdFrequency = 0.01;
+
 //////////////////////////////////////////////////////////////////////
 //
 // Edge
@@ -120,6 +126,7 @@ void BlockLayouter::BuildChain() {
     auto const from = pair.first.first;
     auto const to = pair.first.second;
     edges.push_back({from, to, pair.second});
+    frequency_map_[to] += pair.second;
     blocks.insert(from);
     blocks.insert(to);
   }
@@ -166,26 +173,51 @@ BlockLayouter::Chain* BlockLayouter::ChainOf(const BasicBlock* block) const {
   return it->second;
 }
 
+bool BlockLayouter::IsColdChain(const Chain* chain) const {
+  auto const block = chain->front();
+  if (block == control_flow_graph()->first_node())
+    return false;
+  auto const it = frequency_map_.find(block);
+  return it != frequency_map_.end() && it->second < kColdFrequency;
+}
+
 // Intuitions:
 //  * Entry node first
 //  * Tries to make edge from chain X to chain Y a forward branch
 //    - Predicted as take on target machine (forward branch isn't taken)
 //    - Edge remains only if it is lower probability choice
+//  * Cold chains after hot chains
 std::vector<BasicBlock*> BlockLayouter::Layout() {
   std::unordered_set<Chain*> placed_chains;
   std::unordered_set<Chain*> pending_chains;
   std::vector<BasicBlock*> blocks;
+  std::vector<Chain*> cold_chains;
   std::priority_queue<Chain*> work_list;
   auto const entry_block = control_flow_graph()->first_node();
   auto const exit_block = control_flow_graph()->last_node();
+  auto placing_cold_chains = false;
   work_list.push(ChainOf(entry_block));
   pending_chains.insert(work_list.top());
-  while (!work_list.empty()) {
+  for (;;) {
+    if (work_list.empty()) {
+      if (cold_chains.empty())
+        break;
+      // All hot chains are placed. Chains reachable only from cold chains
+      // are placed after them.
+      for (auto const chain : cold_chains)
+        work_list.push(chain);
+      cold_chains.clear();
+      placing_cold_chains = true;
+    }
     // Pick the chain C with lowest priority from |work_list|.
     auto const chain = work_list.top();
     DCHECK(pending_chains.count(chain)) << *chain;
     DCHECK(!placed_chains.count(chain)) << *chain;
     work_list.pop();
+    if (!placing_cold_chains && IsColdChain(chain)) {
+      cold_chains.push_back(chain);
+      continue;
+    }
     placed_chains.insert(chain);
     pending_chains.erase(chain);
     // Place it next in the code
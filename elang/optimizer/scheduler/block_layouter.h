@@ -29,6 +29,9 @@ class EdgeProfile;
 //  Keith D. Cooper, Linda Torczon
 //  February 2011
 //
+// Chains starting with cold block, e.g. 'throw' path, are placed after all
+// hot chains to keep hot code contiguous.
+//
 class BlockLayouter final : public api::Pass,
                             public ScheduleEditor::User,
                             public ZoneOwner {
@@ -46,6 +49,7 @@ class BlockLayouter final : public api::Pass,
  private:
   void BuildChain();
   Chain* ChainOf(const BasicBlock* block) const;
+  bool IsColdChain(const Chain* chain) const;
   std::vector<BasicBlock*> Layout();
 
   // api::Pass
@@ -54,6 +58,9 @@ class BlockLayouter final : public api::Pass,
   std::unordered_map<const BasicBlock*, Chain*> chain_map_;
   const EdgeProfile* const edge_map_;
 
+  // Sum of frequency of incoming edges of block.
+  std::unordered_map<const BasicBlock*, double> frequency_map_;
+
   DISALLOW_COPY_AND_ASSIGN(BlockLayouter);
 };
 
@@ -0,0 +1,69 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+#include "elang/optimizer/scheduler/edge_counts.h"
+
+#include "base/logging.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// EdgeCounts
+//
+EdgeCounts::EdgeCounts() {
+}
+
+EdgeCounts::~EdgeCounts() {
+}
+
+// Counts of the same edge are accumulated, since we may run training more
+// than once.
+void EdgeCounts::Add(base::StringPiece function_name,
+                     size_t from,
+                     size_t to,
+                     int64_t count) {
+  DCHECK_GE(count, 0);
+  function_map_[function_name.as_string()][std::make_pair(from, to)] += count;
+}
+
+const EdgeCounts::Map* EdgeCounts::CountsOf(
+    base::StringPiece function_name) const {
+  auto const it = function_map_.find(function_name.as_string());
+  return it == function_map_.end() ? nullptr : &it->second;
+}
+
+bool EdgeCounts::Load(std::istream* istream) {
+  std::string line;
+  while (std::getline(*istream, line)) {
+    if (line.empty())
+      continue;
+    std::istringstream fields(line);
+    std::string function_name;
+    size_t from = 0;
+    size_t to = 0;
+    int64_t count = 0;
+    if (!(fields >> function_name >> from >> to >> count) || count < 0)
+      return false;
+    Add(function_name, from, to, count);
+  }
+  return true;
+}
+
+void EdgeCounts::Save(std::ostream* ostream) const {
+  for (auto const& function : function_map_) {
+    for (auto const& edge : function.second) {
+      *ostream << function.first << " " << edge.first.first << " "
+               << edge.first.second << " " << edge.second << std::endl;
+    }
+  }
+}
+
+}  // namespace optimizer
+}  // namespace elang
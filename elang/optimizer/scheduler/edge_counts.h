@@ -0,0 +1,63 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_SCHEDULER_EDGE_COUNTS_H_
+#define ELANG_OPTIMIZER_SCHEDULER_EDGE_COUNTS_H_
+
+#include <stdint.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// EdgeCounts holds number of times control-flow edges are taken in training
+// run of instrumented code. An edge is identified by node id of branch node,
+// e.g. 'if', and node id of start node of target block, e.g. 'if_true'. Node
+// ids are stable among compilations of the same source with the same
+// optimization level.
+//
+// Text representation is one edge per line:
+//  function_name from_node_id to_node_id count
+//
+class ELANG_OPTIMIZER_EXPORT EdgeCounts final {
+ public:
+  using Edge = std::pair<size_t, size_t>;
+  using Map = std::map<Edge, int64_t>;
+
+  EdgeCounts();
+  ~EdgeCounts();
+
+  void Add(base::StringPiece function_name,
+           size_t from,
+           size_t to,
+           int64_t count);
+
+  // Returns edge counts of |function_name| or null if we don't have profile
+  // for |function_name|.
+  const Map* CountsOf(base::StringPiece function_name) const;
+
+  // Returns false if |istream| contains malformed line.
+  bool Load(std::istream* istream);
+  void Save(std::ostream* ostream) const;
+
+ private:
+  std::map<std::string, Map> function_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(EdgeCounts);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_SCHEDULER_EDGE_COUNTS_H_
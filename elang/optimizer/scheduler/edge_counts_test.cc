@@ -0,0 +1,54 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <sstream>
+#include <string>
+
+#include "elang/optimizer/scheduler/edge_counts.h"
+
+#include "gtest/gtest.h"
+
+namespace elang {
+namespace optimizer {
+
+TEST(EdgeCountsTest, Add) {
+  EdgeCounts edge_counts;
+  edge_counts.Add("Sample.Main", 6, 7, 10);
+  edge_counts.Add("Sample.Main", 6, 7, 5);
+  edge_counts.Add("Sample.Main", 6, 8, 1);
+
+  auto const counts = edge_counts.CountsOf("Sample.Main");
+  ASSERT_TRUE(counts);
+  EXPECT_EQ(2u, counts->size());
+  EXPECT_EQ(15, counts->at(std::make_pair(6u, 7u)));
+  EXPECT_EQ(1, counts->at(std::make_pair(6u, 8u)));
+  EXPECT_FALSE(edge_counts.CountsOf("Sample.Foo"));
+}
+
+TEST(EdgeCountsTest, LoadAndSave) {
+  std::istringstream istream(
+      "Sample.Foo 3 4 1\n"
+      "\n"
+      "Sample.Main 6 7 100000000000\n"
+      "Sample.Main 6 8 0\n");
+  EdgeCounts edge_counts;
+  EXPECT_TRUE(edge_counts.Load(&istream));
+
+  std::ostringstream ostream;
+  edge_counts.Save(&ostream);
+  EXPECT_EQ(
+      "Sample.Foo 3 4 1\n"
+      "Sample.Main 6 7 100000000000\n"
+      "Sample.Main 6 8 0\n",
+      ostream.str());
+}
+
+TEST(EdgeCountsTest, LoadMalformed) {
+  std::istringstream istream("Sample.Main 6 seven 1\n");
+  EdgeCounts edge_counts;
+  EXPECT_FALSE(edge_counts.Load(&istream));
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -28,8 +28,11 @@ namespace optimizer {
 
 namespace {
 
+// Note: |StoreNode| isn't pinned. It is placed at common dominator of its
+// effect users rather than block of its inputs, e.g. a store guarded by array
+// bounds check is placed after the check.
 bool IsPinned(const Node* node) {
-  if (node->IsControl() || node->IsEffect())
+  if (node->IsControl())
     return true;
   // Since all nodes have at least one input except for |EntryNode|, it is safe
   // to use |input(0)|.
@@ -135,10 +138,13 @@ void LateScheduler::DoDefaultVisit(Node* node) {
   BasicBlock* lca_block = nullptr;
   for (auto const edge : node->use_edges()) {
     auto const user = edge->from();
-    if (auto const phi = user->as<PhiNode>()) {
+    if (user->is<PhiNode>() || user->is<EffectPhiNode>()) {
+      auto const& phi_inputs =
+          user->is<PhiNode>() ? user->as<PhiNode>()->phi_inputs()
+                              : user->as<EffectPhiNode>()->phi_inputs();
       // This loop could be removed (and the code made asymptotically faster)
       // by using complex data structures. In practice it is never a bottleneck.
-      for (auto phi_operand : phi->phi_inputs()) {
+      for (auto phi_operand : phi_inputs) {
         if (phi_operand->value() != node)
           continue;
         auto const from_block = BlockOf(phi_operand->control());
@@ -315,11 +321,19 @@ base::StringPiece NodePlacer::name() const {
 //
 // Scheduler
 //
-Scheduler::Scheduler(api::PassController* pass_controller, Schedule* schedule)
-    : Pass(pass_controller), editor_(new ScheduleEditor(schedule)) {
+Scheduler::Scheduler(api::PassController* pass_controller,
+                     Schedule* schedule,
+                     const EdgeCounts::Map* edge_counts)
+    : Pass(pass_controller),
+      edge_counts_(edge_counts),
+      editor_(new ScheduleEditor(schedule)) {
   DCHECK(schedule);
 }
 
+Scheduler::Scheduler(api::PassController* pass_controller, Schedule* schedule)
+    : Scheduler(pass_controller, schedule, nullptr) {
+}
+
 Scheduler::~Scheduler() {
 }
 
@@ -331,7 +345,8 @@ void Scheduler::Run() {
   CfgBuilder(editor_.get()).Run();
   EarlyScheduler(editor_.get()).Run();
   LateScheduler(editor_.get()).Run();
-  auto const edge_map = StaticPredictor(pass_controller(), editor_.get()).Run();
+  auto const edge_map =
+      StaticPredictor(pass_controller(), editor_.get(), edge_counts_).Run();
   auto const blocks =
       BlockLayouter(pass_controller(), editor_.get(), edge_map.get()).Run();
   NodePlacer(pass_controller(), editor_.get(), blocks).Run();
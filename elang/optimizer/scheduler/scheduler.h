@@ -11,6 +11,7 @@
 #include "elang/api/pass.h"
 #include "elang/base/analysis/dominator_tree.h"
 #include "elang/optimizer/optimizer_export.h"
+#include "elang/optimizer/scheduler/edge_counts.h"
 
 namespace elang {
 namespace optimizer {
@@ -24,6 +25,10 @@ class ScheduleEditor;
 //
 class ELANG_OPTIMIZER_EXPORT Scheduler final : public api::Pass {
  public:
+  // |edge_counts| can be null if we don't have profile of function.
+  Scheduler(api::PassController* pass_controller,
+            Schedule* schedule,
+            const EdgeCounts::Map* edge_counts);
   Scheduler(api::PassController* pass_controller, Schedule* schedule);
   ~Scheduler();
 
@@ -35,6 +40,7 @@ class ELANG_OPTIMIZER_EXPORT Scheduler final : public api::Pass {
   void DumpAfterPass(const api::PassDumpContext& context) final;
   void DumpBeforePass(const api::PassDumpContext& context) final;
 
+  const EdgeCounts::Map* const edge_counts_;
   std::unique_ptr<ScheduleEditor> editor_;
 
   DISALLOW_COPY_AND_ASSIGN(Scheduler);
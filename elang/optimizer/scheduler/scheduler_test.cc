@@ -4,6 +4,7 @@
 
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "elang/optimizer/testing/optimizer_test.h"
 
@@ -11,6 +12,7 @@
 #include "elang/optimizer/factory.h"
 #include "elang/optimizer/function.h"
 #include "elang/optimizer/nodes.h"
+#include "elang/optimizer/scheduler/edge_counts.h"
 #include "elang/optimizer/scheduler/formatted_schedule.h"
 #include "elang/optimizer/scheduler/schedule.h"
 #include "elang/optimizer/scheduler/scheduler.h"
@@ -29,6 +31,8 @@ class SchedulerTest : public testing::OptimizerTest {
   ~SchedulerTest() override = default;
 
   std::string ScheduleOf(Function* function);
+  std::string ScheduleOf(Function* function,
+                         const EdgeCounts::Map& edge_counts);
 
  private:
   DISALLOW_COPY_AND_ASSIGN(SchedulerTest);
@@ -41,6 +45,14 @@ std::string SchedulerTest::ScheduleOf(Function* function) {
   return ostream.str();
 }
 
+std::string SchedulerTest::ScheduleOf(Function* function,
+                                      const EdgeCounts::Map& edge_counts) {
+  auto const schedule = factory()->ComputeSchedule(function, &edge_counts);
+  std::ostringstream ostream;
+  ostream << AsFormatted(*schedule);
+  return ostream.str();
+}
+
 TEST_F(SchedulerTest, SetBranch) {
   auto const function = NewSampleFunction(int32_type(), bool_type());
   Editor editor(factory(), function);
@@ -89,6 +101,198 @@ TEST_F(SchedulerTest, SetBranch) {
       ScheduleOf(function));
 }
 
+// 'throw' path is placed after hot blocks.
+TEST_F(SchedulerTest, SetBranchThrow) {
+  auto const function = NewSampleFunction(int32_type(), bool_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const if_node = editor.SetBranch(param0);
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, NewInt32(33));
+  editor.Commit();
+
+  EXPECT_EQ(
+      "function1 int32(bool)\n"
+      "block1:\n"
+      "  In:   {}\n"
+      "  Out:  {block7, block8}\n"
+      "  0000: control(bool) %c1 = entry()\n"
+      "  0001: effect %e4 = get_effect(%c1)\n"
+      "  0002: bool %r5 = param(%c1, 0)\n"
+      "  0003: control %c6 = if(%c1, %r5)\n"
+      "block8:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0004: control %c8 = if_false(%c6)\n"
+      "  0005: control %c10 = ret(%c8, %e4, 33)\n"
+      "block7:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0006: control %c7 = if_true(%c6)\n"
+      "  0007: control %c9 = throw(%c7, void)\n"
+      "block2:\n"
+      "  In:   {block7, block8}\n"
+      "  Out:  {}\n"
+      "  0008: control %c2 = merge(%c9, %c10)\n"
+      "  0009: exit(%c2)\n",
+      ScheduleOf(function));
+}
+
+// Edge counts of training run override static prediction, which places
+// 'if_true' block first as |SetBranch| test.
+TEST_F(SchedulerTest, SetBranchEdgeCounts) {
+  auto const function = NewSampleFunction(int32_type(), bool_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const if_node = editor.SetBranch(param0);
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetRet(effect, NewInt32(42));
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, NewInt32(33));
+  editor.Commit();
+
+  EdgeCounts::Map edge_counts;
+  edge_counts[std::make_pair(if_node->id(), if_true->id())] = 300;
+  edge_counts[std::make_pair(if_node->id(), if_false->id())] = 700;
+
+  EXPECT_EQ(
+      "function1 int32(bool)\n"
+      "block1:\n"
+      "  In:   {}\n"
+      "  Out:  {block7, block8}\n"
+      "  0000: control(bool) %c1 = entry()\n"
+      "  0001: effect %e4 = get_effect(%c1)\n"
+      "  0002: bool %r5 = param(%c1, 0)\n"
+      "  0003: control %c6 = if(%c1, %r5)\n"
+      "block8:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0004: control %c8 = if_false(%c6)\n"
+      "  0005: control %c10 = ret(%c8, %e4, 33)\n"
+      "block7:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0006: control %c7 = if_true(%c6)\n"
+      "  0007: control %c9 = ret(%c7, %e4, 42)\n"
+      "block2:\n"
+      "  In:   {block7, block8}\n"
+      "  Out:  {}\n"
+      "  0008: control %c2 = merge(%c9, %c10)\n"
+      "  0009: exit(%c2)\n",
+      ScheduleOf(function, edge_counts));
+}
+
+// Cold 'throw' block between hot blocks is placed after all hot blocks
+// rather than after its predecessor.
+TEST_F(SchedulerTest, SetBranchThrowInMiddle) {
+  auto const function = NewSampleFunction(
+      int32_type(),
+      NewTupleType({bool_type(), bool_type(), int32_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const if_node = editor.SetBranch(NewParameter(entry_node, 0));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_false);
+  auto const if_node2 = editor.SetBranch(NewParameter(entry_node, 1));
+  auto const if_true2 = NewIfTrue(if_node2);
+  auto const if_false2 = NewIfFalse(if_node2);
+  editor.Commit();
+
+  auto const ret_control = NewMerge({});
+
+  editor.Edit(if_true2);
+  editor.SetJump(ret_control);
+  editor.Commit();
+
+  editor.Edit(if_false2);
+  editor.SetJump(ret_control);
+  editor.Commit();
+
+  editor.Edit(ret_control);
+  auto const phi = NewPhi(int32_type(), ret_control);
+  editor.SetPhiInput(phi, ret_control->control(0), NewParameter(entry_node, 2));
+  editor.SetPhiInput(phi, ret_control->control(1), NewParameter(entry_node, 3));
+  editor.SetRet(effect, phi);
+  editor.Commit();
+
+  EXPECT_EQ(
+      "function1 int32(bool, bool, int32, int32)\n"
+      "block1:\n"
+      "  In:   {}\n"
+      "  Out:  {block7, block8}\n"
+      "  0000: control((bool, bool, int32, int32)) %c1 = entry()\n"
+      "  0001: effect %e4 = get_effect(%c1)\n"
+      "  0002: bool %r5 = param(%c1, 0)\n"
+      "  0003: bool %r10 = param(%c1, 1)\n"
+      "  0004: int32 %r18 = param(%c1, 2)\n"
+      "  0005: int32 %r19 = param(%c1, 3)\n"
+      "  0006: control %c6 = if(%c1, %r5)\n"
+      "block8:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block12, block13}\n"
+      "  0007: control %c8 = if_false(%c6)\n"
+      "  0008: control %c11 = if(%c8, %r10)\n"
+      "block12:\n"
+      "  In:   {block8}\n"
+      "  Out:  {block14}\n"
+      "  0009: control %c12 = if_true(%c11)\n"
+      "  0010: control %c15 = br(%c12)\n"
+      "block14:\n"
+      "  In:   {block12, block13}\n"
+      "  Out:  {block2}\n"
+      "  0011: control %c14 = merge(%c15, %c16)\n"
+      "  0012: int32 %r17 = phi(%c15: %r18, %c16: %r19)\n"
+      "  0013: control %c20 = ret(%c14, %e4, %r17)\n"
+      "block13:\n"
+      "  In:   {block8}\n"
+      "  Out:  {block14}\n"
+      "  0014: control %c13 = if_false(%c11)\n"
+      "  0015: control %c16 = br(%c13)\n"
+      "block7:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0016: control %c7 = if_true(%c6)\n"
+      "  0017: control %c9 = throw(%c7, void)\n"
+      "block2:\n"
+      "  In:   {block7, block14}\n"
+      "  Out:  {}\n"
+      "  0018: control %c2 = merge(%c9, %c20)\n"
+      "  0019: exit(%c2)\n",
+      ScheduleOf(function));
+}
+
 TEST_F(SchedulerTest, SetBranchPhi) {
   auto const function = NewSampleFunction(
       int32_type(), NewTupleType({bool_type(), int32_type(), int32_type()}));
@@ -154,6 +358,205 @@ TEST_F(SchedulerTest, SetBranchPhi) {
       ScheduleOf(function));
 }
 
+// Memory access guarded by bounds check is placed after the check.
+TEST_F(SchedulerTest, SetBranchStore) {
+  auto const function = NewSampleFunction(
+      void_type(), NewPointerType(NewArrayType(int32_type(), {-1})));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // array[1] = array[1] + 1
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const if_node = editor.SetBranch(
+      NewIntCmp(IntCondition::UnsignedGreaterThan,
+                NewStaticCast(uint32_type(), NewLength(array, 0)),
+                NewUInt32(1)));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_true);
+  auto const element = NewElement(array, NewInt32(1), if_true);
+  auto const value =
+      NewIntAdd(NewLoad(effect, array, element), NewInt32(1));
+  editor.SetRet(NewStore(effect, array, element, value), void_value());
+  editor.Commit();
+
+  EXPECT_EQ(
+      "function1 void(int32[]*)\n"
+      "block1:\n"
+      "  In:   {}\n"
+      "  Out:  {block10, block11}\n"
+      "  0000: control(int32[]*) %c1 = entry()\n"
+      "  0001: effect %e4 = get_effect(%c1)\n"
+      "  0002: int32[]* %r5 = param(%c1, 0)\n"
+      "  0003: int32 %r6 = length(%r5, 0)\n"
+      "  0004: uint32 %r7 = static_cast(%r6)\n"
+      "  0005: bool %r8 = cmp_ugt(%r7, 1u)\n"
+      "  0006: control %c9 = if(%c1, %r8)\n"
+      "block10:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0007: control %c10 = if_true(%c9)\n"
+      "  0008: int32* %r13 = element(%r5, 1, %c10)\n"
+      "  0009: int32 %r14 = load(%e4, %r5, %r13)\n"
+      "  0010: int32 %r15 = add(%r14, 1)\n"
+      "  0011: effect %e16 = store(%e4, %r5, %r13, %r15)\n"
+      "  0012: control %c17 = ret(%c10, %e16, void)\n"
+      "block11:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0013: control %c11 = if_false(%c9)\n"
+      "  0014: control %c12 = throw(%c11, void)\n"
+      "block2:\n"
+      "  In:   {block11, block10}\n"
+      "  Out:  {}\n"
+      "  0015: control %c2 = merge(%c12, %c17)\n"
+      "  0016: exit(%c2)\n",
+      ScheduleOf(function));
+}
+
+// Load of loop invariant element guarded by bounds check in loop isn't
+// hoisted out of loop, since the loop may not run and |k| may be out of range.
+TEST_F(SchedulerTest, SetBranchLoadInLoop) {
+  auto const function = NewSampleFunction(
+      int32_type(),
+      NewTupleType({NewPointerType(NewArrayType(int32_type(), {-1})),
+                    int32_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // for (i = 0; i < n; ++i) sum += array[k];
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const limit = editor.ParameterAt(1);
+  auto const index = editor.ParameterAt(2);
+  auto const guard_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, NewInt32(0),
+                                 limit));
+  auto const guard_true = NewIfTrue(guard_node);
+  auto const guard_false = NewIfFalse(guard_node);
+  editor.Commit();
+
+  editor.Edit(guard_false);
+  editor.SetRet(effect, NewInt32(0));
+  editor.Commit();
+
+  // Loop invariant nodes are hoisted into this block.
+  editor.Edit(guard_true);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const counter = NewPhi(int32_type(), loop_node);
+  auto const sum = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(counter, loop_node->control(0), NewInt32(0));
+  editor.SetPhiInput(sum, loop_node->control(0), NewInt32(0));
+  auto const if_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, counter, limit));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, sum);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  auto const check_node = editor.SetBranch(
+      NewIntCmp(IntCondition::UnsignedGreaterThan,
+                NewStaticCast(uint32_type(), NewLength(array, 0)),
+                NewStaticCast(uint32_type(), index)));
+  auto const in_range = NewIfTrue(check_node);
+  auto const out_of_range = NewIfFalse(check_node);
+  editor.Commit();
+
+  editor.Edit(out_of_range);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(in_range);
+  auto const element = NewElement(array, index, in_range);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(counter, loop_node->control(1),
+                     NewIntAdd(counter, NewInt32(1)));
+  editor.SetPhiInput(sum, loop_node->control(1),
+                     NewIntAdd(sum, NewLoad(effect, array, element)));
+  editor.Commit();
+
+  EXPECT_EQ(
+      "function1 int32(int32[]*, int32, int32)\n"
+      "block1:\n"
+      "  In:   {}\n"
+      "  Out:  {block11, block12}\n"
+      "  0000: control((int32[]*, int32, int32)) %c1 = entry()\n"
+      "  0001: effect %e4 = get_effect(%c1)\n"
+      "  0002: int32[]* %r6 = param(%c1, 0)\n"
+      "  0003: int32 %r7 = param(%c1, 1)\n"
+      "  0004: int32 %r8 = param(%c1, 2)\n"
+      "  0005: bool %r9 = cmp_ge(%r7, 0)\n"
+      "  0006: control %c10 = if(%c1, %r9)\n"
+      "block11:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block5}\n"
+      "  0007: control %c11 = if_true(%c10)\n"
+      "  0008: int32 %r23 = length(%r6, 0)\n"
+      "  0009: uint32 %r22 = static_cast(%r8)\n"
+      "  0010: uint32 %r24 = static_cast(%r23)\n"
+      "  0011: bool %r25 = cmp_ugt(%r24, %r22)\n"
+      "  0012: control %c14 = br(%c11)\n"
+      "block5:\n"
+      "  In:   {block11, block27}\n"
+      "  Out:  {block19, block20}\n"
+      "  0013: control %c5 = loop(%c14, %c31)\n"
+      "  0014: int32 %r15 = phi(%c14: 0, %c31: %r32)\n"
+      "  0015: int32 %r16 = phi(%c14: 0, %c31: %r34)\n"
+      "  0016: bool %r17 = cmp_lt(%r15, %r7)\n"
+      "  0017: control %c18 = if(%c5, %r17)\n"
+      "block19:\n"
+      "  In:   {block5}\n"
+      "  Out:  {block27, block28}\n"
+      "  0018: control %c19 = if_true(%c18)\n"
+      "  0019: control %c26 = if(%c19, %r25)\n"
+      "block27:\n"
+      "  In:   {block19}\n"
+      "  Out:  {block5}\n"
+      "  0020: control %c27 = if_true(%c26)\n"
+      "  0021: int32* %r30 = element(%r6, %r8, %c27)\n"
+      "  0022: int32 %r33 = load(%e4, %r6, %r30)\n"
+      "  0023: int32 %r34 = add(%r16, %r33)\n"
+      "  0024: control %c31 = br(%c27)\n"
+      "block28:\n"
+      "  In:   {block19}\n"
+      "  Out:  {block2}\n"
+      "  0025: control %c28 = if_false(%c26)\n"
+      "  0026: control %c29 = throw(%c28, void)\n"
+      "block12:\n"
+      "  In:   {block1}\n"
+      "  Out:  {block2}\n"
+      "  0027: control %c12 = if_false(%c10)\n"
+      "  0028: control %c13 = ret(%c12, %e4, 0)\n"
+      "block20:\n"
+      "  In:   {block5}\n"
+      "  Out:  {block2}\n"
+      "  0029: control %c20 = if_false(%c18)\n"
+      "  0030: control %c21 = ret(%c20, %e4, %r16)\n"
+      "block2:\n"
+      "  In:   {block12, block20, block28}\n"
+      "  Out:  {}\n"
+      "  0031: control %c2 = merge(%c13, %c21, %c29)\n"
+      "  0032: exit(%c2)\n",
+      ScheduleOf(function));
+}
+
 TEST_F(SchedulerTest, SetRet) {
   auto const function = NewSampleFunction(int32_type(), int32_type());
   Editor editor(factory(), function);
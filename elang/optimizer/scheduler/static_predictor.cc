@@ -126,15 +126,29 @@ Node* TrueTargetOf(const BasicBlock* block) {
 // StaticPredictor
 //
 StaticPredictor::StaticPredictor(api::PassController* pass_controller,
-                                 ScheduleEditor* editor)
+                                 ScheduleEditor* editor,
+                                 const EdgeCounts::Map* edge_counts)
     : Pass(pass_controller),
       ScheduleEditor::User(editor),
+      edge_counts_(edge_counts),
       edge_profile_(new EdgeProfileEditor()) {
 }
 
+StaticPredictor::StaticPredictor(api::PassController* pass_controller,
+                                 ScheduleEditor* editor)
+    : StaticPredictor(pass_controller, editor, nullptr) {
+}
+
 StaticPredictor::~StaticPredictor() {
 }
 
+int64_t StaticPredictor::CountOf(const Node* from, const Node* to) const {
+  if (!edge_counts_)
+    return 0;
+  auto const it = edge_counts_->find(std::make_pair(from->id(), to->id()));
+  return it == edge_counts_->end() ? 0 : it->second;
+}
+
 void StaticPredictor::Predict(const BasicBlock* from, double frequency) {
   auto const last_node = from->last_node();
   switch (last_node->opcode()) {
@@ -149,6 +163,25 @@ void StaticPredictor::Predict(const BasicBlock* from, double frequency) {
     case Opcode::If: {
       auto const true_block = BlockOf(TrueTargetOf(from));
       auto const false_block = BlockOf(FalseTargetOf(from));
+      auto const true_count = CountOf(last_node, TrueTargetOf(from));
+      auto const total_count =
+          true_count + CountOf(last_node, FalseTargetOf(from));
+      if (total_count) {
+        SetBranchFrequency(from, true_block, false_block, frequency,
+                           static_cast<double>(true_count) / total_count);
+        return;
+      }
+
+      // Branch to block ending with 'throw' or 'unreachable' is rarely
+      // taken.
+      auto const true_weight = EstimateBySuccessor(true_block);
+      auto const false_weight = EstimateBySuccessor(false_block);
+      if (true_weight != false_weight) {
+        SetBranchFrequency(from, true_block, false_block, frequency,
+                           true_weight < false_weight ? 0.001 : 0.999);
+        return;
+      }
+
       if (LoopDepthOf(true_block) != LoopDepthOf(false_block)) {
         SetBranchFrequency(
             from, true_block, false_block, frequency,
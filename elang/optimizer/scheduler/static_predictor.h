@@ -9,6 +9,7 @@
 
 #include "base/macros.h"
 #include "elang/api/pass.h"
+#include "elang/optimizer/scheduler/edge_counts.h"
 #include "elang/optimizer/scheduler/edge_profile.h"
 #include "elang/optimizer/scheduler/schedule_editor.h"
 
@@ -18,6 +19,7 @@ namespace optimizer {
 class BasicBlock;
 class EdgeProfile;
 class EdgeProfileEditor;
+class Node;
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -32,15 +34,22 @@ class EdgeProfileEditor;
 //  Brian L. Deitrich, Ben-Chung Cheng, Wen-mei W. Hwuy
 //  October 1998
 //
+// When |edge_counts| from training run is available, branch probability is
+// computed from it and heuristics are used only for branches not executed in
+// training run.
+//
 class StaticPredictor final : public api::Pass, public ScheduleEditor::User {
  public:
-  explicit StaticPredictor(api::PassController* pass_controller,
-                           ScheduleEditor* editor);
+  StaticPredictor(api::PassController* pass_controller,
+                  ScheduleEditor* editor,
+                  const EdgeCounts::Map* edge_counts);
+  StaticPredictor(api::PassController* pass_controller, ScheduleEditor* editor);
   ~StaticPredictor();
 
   std::unique_ptr<EdgeProfile> Run();
 
  private:
+  int64_t CountOf(const Node* from, const Node* to) const;
   void Predict(const BasicBlock* from, double frequency);
   void SetBranchFrequency(const BasicBlock* block,
                           const BasicBlock* true_block,
@@ -55,6 +64,7 @@ class StaticPredictor final : public api::Pass, public ScheduleEditor::User {
   base::StringPiece name() const final;
   void DumpAfterPass(const api::PassDumpContext& context) final;
 
+  const EdgeCounts::Map* const edge_counts_;
   std::unique_ptr<EdgeProfileEditor> edge_profile_;
 
   DISALLOW_COPY_AND_ASSIGN(StaticPredictor);
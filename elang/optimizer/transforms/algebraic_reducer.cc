@@ -0,0 +1,239 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/transforms/algebraic_reducer.h"
+
+#include "base/logging.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/node_factory.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+// Returns true if |node| is an integer literal, and stores its value into
+// |value|.
+bool GetIntValue(const Node* node, int64_t* value) {
+#define V(Name)                                      \
+  if (auto const literal = node->as<Name##Node>()) { \
+    *value = static_cast<int64_t>(literal->data());  \
+    return true;                                     \
+  }
+  V(Int8)
+  V(Int16)
+  V(Int32)
+  V(Int64)
+  V(IntPtr)
+  V(UInt8)
+  V(UInt16)
+  V(UInt32)
+  V(UInt64)
+  V(UIntPtr)
+#undef V
+  return false;
+}
+
+// Returns true if all bits of integer literal |node| are one. Since size of
+// |IntPtr| and |UIntPtr| depends on target, |bit_size()| of them is zero and
+// we don't know their all ones value.
+bool IsAllOnes(const Node* node) {
+  int64_t value;
+  if (!GetIntValue(node, &value))
+    return false;
+  auto const bit_size = node->output_type()->as<PrimitiveType>()->bit_size();
+  if (!bit_size)
+    return false;
+  auto const mask = bit_size == 64 ? ~static_cast<uint64_t>(0)
+                                   : (static_cast<uint64_t>(1) << bit_size) - 1;
+  return (static_cast<uint64_t>(value) & mask) == mask;
+}
+
+bool IsIntValue(const Node* node, int64_t expected) {
+  int64_t value;
+  return GetIntValue(node, &value) && value == expected;
+}
+
+bool IsOne(const Node* node) {
+  return IsIntValue(node, 1);
+}
+
+bool IsZero(const Node* node) {
+  return IsIntValue(node, 0);
+}
+
+// Returns true if all values of |type| can be represented in |other|.
+// Pointer sized integer types are subset of only themselves, since their
+// bit size is zero.
+bool IsSubsetOf(const Type* type, const Type* other) {
+  if (!type->is_integer() || !other->is_integer())
+    return false;
+  if (type == other)
+    return true;
+  auto const bit_size = type->as<PrimitiveType>()->bit_size();
+  auto const other_bit_size = other->as<PrimitiveType>()->bit_size();
+  if (!bit_size || !other_bit_size)
+    return false;
+  if (type->is_signed() == other->is_signed())
+    return bit_size <= other_bit_size;
+  // Unsigned value fits into wider signed type.
+  return type->is_unsigned() && bit_size < other_bit_size;
+}
+
+}  // namespace
+
+AlgebraicReducer::AlgebraicReducer(Editor* editor)
+    : editor_(*editor), new_node_(nullptr) {
+}
+
+AlgebraicReducer::~AlgebraicReducer() {
+}
+
+Data* AlgebraicReducer::ZeroOf(Type* type) const {
+  return editor_.node_factory()->DefaultValueOf(type);
+}
+
+// Reducer
+Node* AlgebraicReducer::Reduce(Node* node) {
+  new_node_ = nullptr;
+  node->Accept(this);
+  return new_node_;
+}
+
+// NodeVisitor
+void AlgebraicReducer::VisitIntAdd(IntAddNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (IsZero(right))
+    new_node_ = left;
+  else if (IsZero(left))
+    new_node_ = right;
+}
+
+void AlgebraicReducer::VisitIntBitAnd(IntBitAndNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (left == right || IsAllOnes(right))
+    new_node_ = left;
+  else if (IsAllOnes(left))
+    new_node_ = right;
+  else if (IsZero(left) || IsZero(right))
+    new_node_ = ZeroOf(node->output_type());
+}
+
+void AlgebraicReducer::VisitIntBitOr(IntBitOrNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (left == right || IsZero(right))
+    new_node_ = left;
+  else if (IsZero(left))
+    new_node_ = right;
+}
+
+void AlgebraicReducer::VisitIntBitXor(IntBitXorNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (left == right) {
+    new_node_ = ZeroOf(node->output_type());
+    return;
+  }
+  if (IsZero(right)) {
+    new_node_ = left;
+    return;
+  }
+  if (IsZero(left)) {
+    new_node_ = right;
+    return;
+  }
+  // (x ^ c) ^ c => x
+  auto const inner = left->as<IntBitXorNode>();
+  if (inner && right->IsLiteral() && inner->input(1) == right)
+    new_node_ = inner->input(0);
+}
+
+void AlgebraicReducer::VisitIntCmp(IntCmpNode* node) {
+  if (node->input(0) != node->input(1))
+    return;
+  switch (node->condition()) {
+    case IntCondition::Equal:
+    case IntCondition::SignedGreaterThanOrEqual:
+    case IntCondition::SignedLessThanOrEqual:
+    case IntCondition::UnsignedGreaterThanOrEqual:
+    case IntCondition::UnsignedLessThanOrEqual:
+      new_node_ = editor_.true_value();
+      return;
+    case IntCondition::NotEqual:
+    case IntCondition::SignedGreaterThan:
+    case IntCondition::SignedLessThan:
+    case IntCondition::UnsignedGreaterThan:
+    case IntCondition::UnsignedLessThan:
+      new_node_ = editor_.false_value();
+      return;
+    default:
+      NOTREACHED() << *node;
+      return;
+  }
+}
+
+void AlgebraicReducer::VisitIntMul(IntMulNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (IsOne(right))
+    new_node_ = left;
+  else if (IsOne(left))
+    new_node_ = right;
+  else if (IsZero(left) || IsZero(right))
+    new_node_ = ZeroOf(node->output_type());
+}
+
+void AlgebraicReducer::VisitIntShl(IntShlNode* node) {
+  if (IsZero(node->input(1)))
+    new_node_ = node->input(0);
+}
+
+void AlgebraicReducer::VisitIntShr(IntShrNode* node) {
+  if (IsZero(node->input(1)))
+    new_node_ = node->input(0);
+}
+
+void AlgebraicReducer::VisitIntSub(IntSubNode* node) {
+  auto const left = node->input(0);
+  auto const right = node->input(1);
+  if (left == right) {
+    new_node_ = ZeroOf(node->output_type());
+    return;
+  }
+  if (IsZero(right)) {
+    new_node_ = left;
+    return;
+  }
+  // 0 - (0 - x) => x
+  auto const inner = right->as<IntSubNode>();
+  if (IsZero(left) && inner && IsZero(inner->input(0)))
+    new_node_ = inner->input(1);
+}
+
+void AlgebraicReducer::VisitStaticCast(StaticCastNode* node) {
+  auto const input = node->input(0);
+  auto const output_type = node->output_type();
+  if (input->output_type() == output_type) {
+    new_node_ = input;
+    return;
+  }
+  // StaticCast(T, StaticCast(U, x:T)) => x if U can hold all values of T.
+  auto const inner = input->as<StaticCastNode>();
+  if (!inner)
+    return;
+  auto const source = inner->input(0);
+  if (source->output_type() != output_type)
+    return;
+  if (!IsSubsetOf(output_type, inner->output_type()))
+    return;
+  new_node_ = source;
+}
+
+}  // namespace optimizer
+}  // namespace elang
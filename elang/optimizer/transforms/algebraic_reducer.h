@@ -0,0 +1,64 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_ALGEBRAIC_REDUCER_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_ALGEBRAIC_REDUCER_H_
+
+#include "base/macros.h"
+#include "elang/optimizer/node_visitor.h"
+#include "elang/optimizer/optimizer_export.h"
+#include "elang/optimizer/transforms/graph_reducer.h"
+
+namespace elang {
+namespace optimizer {
+
+class Data;
+class Editor;
+class Type;
+
+//////////////////////////////////////////////////////////////////////
+//
+// AlgebraicReducer implements local algebraic identities on integer
+// arithmetic, e.g. x + 0 => x, x & x => x, x - x => 0, and casts, e.g.
+// StaticCast(T, StaticCast(U, x:T)) => x if |U| can hold all values of |T|.
+//
+// Note: We don't simplify float arithmetic and comparison, since they aren't
+// identities for NaN and signed zero.
+//
+class ELANG_OPTIMIZER_EXPORT AlgebraicReducer final : public Reducer,
+                                                      public NodeVisitor {
+ public:
+  explicit AlgebraicReducer(Editor* editor);
+  ~AlgebraicReducer() final;
+
+  // Reducer
+  Node* Reduce(Node* node) final;
+
+ private:
+  Data* ZeroOf(Type* type) const;
+
+  // NodeVisitor
+  void VisitIntAdd(IntAddNode* node) final;
+  void VisitIntBitAnd(IntBitAndNode* node) final;
+  void VisitIntBitOr(IntBitOrNode* node) final;
+  void VisitIntBitXor(IntBitXorNode* node) final;
+  void VisitIntCmp(IntCmpNode* node) final;
+  void VisitIntMul(IntMulNode* node) final;
+  void VisitIntShl(IntShlNode* node) final;
+  void VisitIntShr(IntShrNode* node) final;
+  void VisitIntSub(IntSubNode* node) final;
+  void VisitStaticCast(StaticCastNode* node) final;
+
+  Editor& editor_;
+
+  // Result of |Reduce()|, set by visitor functions.
+  Node* new_node_;
+
+  DISALLOW_COPY_AND_ASSIGN(AlgebraicReducer);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_ALGEBRAIC_REDUCER_H_
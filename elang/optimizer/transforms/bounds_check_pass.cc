@@ -0,0 +1,236 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/optimizer/transforms/bounds_check_pass.h"
+
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+// Returns immediate dominator of block containing |control| or previous
+// control node in same block. Since we don't compute dominator tree, we
+// return |nullptr| for merge node. Note: The first input of |LoopNode| is
+// loop entry and other inputs are back edges.
+Node* DominatorOf(Node* control) {
+  if (control->is<EntryNode>())
+    return nullptr;
+  if (control->is<MergeNode>())
+    return control->CountInputs() == 1 ? control->input(0) : nullptr;
+  return control->input(0);
+}
+
+// Returns input of |node| if |node| is |StaticCastNode|. Front end casts
+// length and index to unsigned integer type of same or larger size for
+// bounds check, so casting doesn't change non-negative value.
+Node* StripCast(Node* node) {
+  return node->is<StaticCastNode>() ? node->input(0) : node;
+}
+
+bool IsNonNegativeLiteral(Node* node) {
+  if (auto const literal = node->as<Int32Node>())
+    return literal->data() >= 0;
+  if (auto const literal = node->as<Int64Node>())
+    return literal->data() >= 0;
+  return false;
+}
+
+bool IsOneLiteral(Node* node) {
+  if (auto const literal = node->as<Int32Node>())
+    return literal->data() == 1;
+  if (auto const literal = node->as<Int64Node>())
+    return literal->data() == 1;
+  return false;
+}
+
+// Returns true if |condition| implies |0 <= value < length|.
+bool ImpliesInRange(Node* condition, Node* value, Node* length) {
+  auto const cmp = condition->as<IntCmpNode>();
+  return cmp && cmp->condition() == IntCondition::UnsignedGreaterThan &&
+         StripCast(cmp->input(0)) == length &&
+         StripCast(cmp->input(1)) == value;
+}
+
+// Returns true if |condition| implies |value < length|.
+bool ImpliesLessThan(Node* condition, Node* value, Node* length) {
+  if (ImpliesInRange(condition, value, length))
+    return true;
+  auto const cmp = condition->as<IntCmpNode>();
+  if (!cmp)
+    return false;
+  if (cmp->condition() == IntCondition::SignedLessThan)
+    return cmp->input(0) == value && cmp->input(1) == length;
+  if (cmp->condition() == IntCondition::SignedGreaterThan)
+    return cmp->input(0) == length && cmp->input(1) == value;
+  return false;
+}
+
+// Returns true if condition of one of |IfTrueNode| dominating |control|
+// satisfies |predicate|.
+template <typename Predicate>
+bool IsDominatedBy(Node* control, const Predicate& predicate) {
+  for (auto runner = control; runner; runner = DominatorOf(runner)) {
+    if (runner->is<IfTrueNode>() && predicate(runner->input(0)->input(1)))
+      return true;
+  }
+  return false;
+}
+
+// Returns true if |value| is a loop phi in |[0, length)|, e.g. all inputs
+// are non-negative literal or |phi + 1| and they are less than |length|.
+// Since |phi + 1| is less than |length|, it doesn't overflow.
+bool IsInductionVariable(Node* value, Node* length) {
+  auto const phi = value->as<PhiNode>();
+  if (!phi || !phi->owner()->is<LoopNode>())
+    return false;
+  for (auto const phi_input : phi->phi_inputs()) {
+    auto const input = phi_input->value();
+    if (!IsNonNegativeLiteral(input)) {
+      auto const add = input->as<IntAddNode>();
+      if (!add || add->input(0) != phi || !IsOneLiteral(add->input(1)))
+        return false;
+    }
+    auto const is_less_than = [input, length](Node* condition) {
+      return ImpliesLessThan(condition, input, length);
+    };
+    if (!IsDominatedBy(phi_input->control(), is_less_than))
+      return false;
+  }
+  return true;
+}
+
+// Returns |ThrowNode| reached from false branch of |node| if |node| is bounds
+// check emitted by front end, otherwise returns |nullptr|.
+Node* ThrowOfBoundsCheck(Node* node) {
+  if (!node->is<IfNode>())
+    return nullptr;
+  auto const cmp = node->input(1)->as<IntCmpNode>();
+  if (!cmp || cmp->condition() != IntCondition::UnsignedGreaterThan ||
+      !StripCast(cmp->input(0))->is<LengthNode>()) {
+    return nullptr;
+  }
+  auto const if_false = node->SelectUser(Opcode::IfFalse);
+  if (!if_false)
+    return nullptr;
+  auto const throw_node = if_false->SelectUserIfOne();
+  return throw_node && throw_node->is<ThrowNode>() ? throw_node : nullptr;
+}
+
+bool CanRemove(Node* if_node) {
+  auto const cmp = if_node->input(1);
+  auto const length = StripCast(cmp->input(0));
+  auto const index = StripCast(cmp->input(1));
+  auto const control = if_node->input(0);
+  auto const is_in_range = [index, length](Node* condition) {
+    return ImpliesInRange(condition, index, length);
+  };
+  if (IsDominatedBy(control, is_in_range))
+    return true;
+  if (IsInductionVariable(index, length))
+    return true;
+  if (!IsNonNegativeLiteral(index))
+    return false;
+  auto const is_less_than = [index, length](Node* condition) {
+    return ImpliesLessThan(condition, index, length);
+  };
+  return IsDominatedBy(control, is_less_than);
+}
+
+}  // namespace
+
+BoundsCheckPass::BoundsCheckPass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor) {
+}
+
+BoundsCheckPass::~BoundsCheckPass() {
+}
+
+void BoundsCheckPass::Remove(Node* if_node) {
+  DVLOG(1) << "Remove bounds check " << *if_node;
+  auto const throw_node = ThrowOfBoundsCheck(if_node);
+  auto const if_false = throw_node->input(0);
+  auto const if_true = if_node->SelectUser(Opcode::IfTrue);
+  editor_.RemoveControlInput(
+      editor_.function()->exit_node()->input(0)->as<PhiOwnerNode>(),
+      throw_node->as<Control>());
+  editor_.ReplaceAllUses(if_node->input(0), if_true);
+  editor_.Discard({throw_node, if_false, if_true, if_node});
+}
+
+void BoundsCheckPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(editor_.function(), &collector);
+
+  // Since removing a bounds check doesn't change values, we decide all
+  // removable bounds checks before removing them.
+  std::vector<Node*> if_nodes;
+  for (auto const node : collector.nodes()) {
+    if (ThrowOfBoundsCheck(node) && CanRemove(node))
+      if_nodes.push_back(node);
+  }
+  for (auto const if_node : if_nodes)
+    Remove(if_node);
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece BoundsCheckPass::name() const {
+  return "bounds_check";
+}
+
+void BoundsCheckPass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void BoundsCheckPass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
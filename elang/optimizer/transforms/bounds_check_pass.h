@@ -0,0 +1,60 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_BOUNDS_CHECK_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_BOUNDS_CHECK_PASS_H_
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Editor;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// BoundsCheckPass removes array bounds check which is always satisfied.
+// Front end emits bounds check as:
+//    %cmp = cmp_ugt(static_cast(length(%array, rank)), static_cast(%index))
+//    %if = if(%control, %cmp)
+//    throw(if_false(%if), void)
+//
+// We remove bounds check when
+//  - A dominating |IfTrueNode| has same condition, or
+//  - A dominating |IfTrueNode| has condition |%index < length| and |%index|
+//    is non-negative, or
+//  - |%index| is a loop phi whose inputs are non-negative literal or
+//    |phi + 1| and each of them is guarded by |input < length|, e.g.
+//    induction variable of rotated loop |for (i = 0; i < a.Length; ++i)|.
+//
+// Dead condition nodes are removed by |DeadPass|.
+//
+class ELANG_OPTIMIZER_EXPORT BoundsCheckPass final : public api::Pass {
+ public:
+  explicit BoundsCheckPass(Editor* editor);
+  ~BoundsCheckPass();
+
+  void Run();
+
+ private:
+  void Remove(Node* if_node);
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+
+  DISALLOW_COPY_AND_ASSIGN(BoundsCheckPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_BOUNDS_CHECK_PASS_H_
@@ -0,0 +1,147 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/bounds_check_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// BoundsCheckPassTest
+//
+class BoundsCheckPassTest : public testing::OptimizerTest {
+ protected:
+  BoundsCheckPassTest() = default;
+  ~BoundsCheckPassTest() override = default;
+
+  // Returns bounds check condition as front end emits.
+  Data* NewBoundsCheck(Data* length, Data* index);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BoundsCheckPassTest);
+};
+
+Data* BoundsCheckPassTest::NewBoundsCheck(Data* length, Data* index) {
+  return NewIntCmp(IntCondition::UnsignedGreaterThan,
+                   NewStaticCast(uint32_type(), length),
+                   NewStaticCast(uint32_type(), index));
+}
+
+TEST_F(BoundsCheckPassTest, Loop) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewPointerType(NewArrayType(int32_type(), {-1})));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // if (length > 0) { i = 0; do { array[i]; ++i; } while (i < length); }
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const length = NewLength(array, 0);
+  auto const if_node0 = editor.SetBranch(
+      NewIntCmp(IntCondition::SignedGreaterThan, length, NewInt32(0)));
+  auto const if_true0 = NewIfTrue(if_node0);
+  auto const if_false0 = NewIfFalse(if_node0);
+  editor.Commit();
+
+  editor.Edit(if_false0);
+  editor.SetRet(effect, NewInt32(0));
+  editor.Commit();
+
+  auto const loop_node = NewLoop();
+  editor.Edit(if_true0);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const phi = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(phi, loop_node->control(0), NewInt32(0));
+  auto const if_node1 = editor.SetBranch(NewBoundsCheck(length, phi));
+  auto const if_true1 = NewIfTrue(if_node1);
+  auto const if_false1 = NewIfFalse(if_node1);
+  editor.Commit();
+
+  editor.Edit(if_false1);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_true1);
+  auto const next = NewIntAdd(phi, NewInt32(1));
+  auto const if_node2 = editor.SetBranch(
+      NewIntCmp(IntCondition::SignedLessThan, next, length));
+  auto const if_true2 = NewIfTrue(if_node2);
+  auto const if_false2 = NewIfFalse(if_node2);
+  editor.Commit();
+
+  editor.Edit(if_true2);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(phi, loop_node->control(1), next);
+  editor.Commit();
+
+  editor.Edit(if_false2);
+  editor.SetRet(effect,
+                NewLoad(effect, array, NewElement(array, phi, if_false2)));
+  editor.Commit();
+
+  BoundsCheckPass(&editor).Run();
+
+  EXPECT_EQ(loop_node, if_node2->input(0));
+  EXPECT_EQ(2u, function->exit_node()->input(0)->CountInputs());
+}
+
+TEST_F(BoundsCheckPassTest, Redundant) {
+  auto const function = NewSampleFunction(
+      int32_type(),
+      NewTupleType(
+          {NewPointerType(NewArrayType(int32_type(), {-1})), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const index = editor.ParameterAt(1);
+  auto const condition = NewBoundsCheck(NewLength(array, 0), index);
+  auto const if_node1 = editor.SetBranch(condition);
+  auto const if_true1 = NewIfTrue(if_node1);
+  auto const if_false1 = NewIfFalse(if_node1);
+  editor.Commit();
+
+  editor.Edit(if_false1);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_true1);
+  auto const if_node2 = editor.SetBranch(condition);
+  auto const if_true2 = NewIfTrue(if_node2);
+  auto const if_false2 = NewIfFalse(if_node2);
+  editor.Commit();
+
+  editor.Edit(if_false2);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_true2);
+  auto const ret_node = editor.SetRet(
+      effect, NewLoad(effect, array, NewElement(array, index, if_true2)));
+  editor.Commit();
+
+  BoundsCheckPass(&editor).Run();
+
+  EXPECT_EQ(if_true1, ret_node->input(0));
+  // Element pointer is guarded by remaining bounds check.
+  EXPECT_EQ(if_true1, ret_node->input(2)->input(2)->input(2));
+  EXPECT_EQ(2u, function->exit_node()->input(0)->CountInputs());
+  EXPECT_FALSE(if_node2->IsUsed());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -160,7 +160,10 @@ void CleanPass::CleanJump(Node* jump_node) {
     editor_.ReplaceAllUses(effect_phi->input(0), effect_phi);
     editor_.Discard(effect_phi);
   }
-  for (auto const phi : target->phi_nodes()) {
+  // Note: |Editor::Discard()| removes |phi| from |target->phi_nodes()|.
+  std::vector<PhiNode*> phi_nodes(target->phi_nodes().begin(),
+                                  target->phi_nodes().end());
+  for (auto const phi : phi_nodes) {
     editor_.ReplaceAllUses(phi->input(0), phi);
     editor_.Discard(phi);
   }
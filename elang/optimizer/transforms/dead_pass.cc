@@ -6,7 +6,6 @@
 
 #include "elang/optimizer/transforms/dead_pass.h"
 
-#include "elang/base/work_list.h"
 #include "elang/optimizer/depth_first_traversal.h"
 #include "elang/optimizer/editor.h"
 #include "elang/optimizer/formatters/graphviz_formatter.h"
@@ -27,7 +26,7 @@ class DeadNodeCollector final : public NodeVisitor {
  public:
   DeadNodeCollector(const Function* function,
                     const std::vector<bool>& lives,
-                    WorkList<Node>* dead_nodes);
+                    std::vector<Node*>* dead_nodes);
   ~DeadNodeCollector() final = default;
 
   void Run();
@@ -36,7 +35,7 @@ class DeadNodeCollector final : public NodeVisitor {
   // NodeVisitor
   void DoDefaultVisit(Node* node) final;
 
-  WorkList<Node>& dead_nodes_;
+  std::vector<Node*>& dead_nodes_;
   const Function* const function_;
   const std::vector<bool>& lives_;
 
@@ -45,7 +44,7 @@ class DeadNodeCollector final : public NodeVisitor {
 
 DeadNodeCollector::DeadNodeCollector(const Function* function,
                                      const std::vector<bool>& lives,
-                                     WorkList<Node>* dead_nodes)
+                                     std::vector<Node*>* dead_nodes)
     : dead_nodes_(*dead_nodes), function_(function), lives_(lives) {
 }
 
@@ -58,7 +57,7 @@ void DeadNodeCollector::Run() {
 void DeadNodeCollector::DoDefaultVisit(Node* node) {
   if (lives_[node->id()])
     return;
-  dead_nodes_.Push(node);
+  dead_nodes_.push_back(node);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -115,14 +114,14 @@ void DeadPass::Run() {
   std::vector<bool> lives(function->max_node_id() + 1);
   LiveNodeCollector(function, &lives).Run();
 
-  WorkList<Node> dead_nodes;
+  std::vector<Node*> dead_nodes;
   DeadNodeCollector(function, lives, &dead_nodes).Run();
 
-  while (!dead_nodes.empty()) {
-    auto const dead_node = dead_nodes.Pop();
+  // Since dead nodes may form a cycle, e.g. an unreachable loop, we discard
+  // them at once.
+  for (auto const dead_node : dead_nodes)
     DVLOG(1) << "Dead " << *dead_node;
-    editor_.Discard(dead_node);
-  }
+  editor_.Discard(dead_nodes);
 }
 
 // api::Pass
@@ -0,0 +1,235 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/optimizer/transforms/escape_pass.h"
+
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/node_factory.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+// Returns users of |node| as vector, since editing edges during iterating
+// |use_edges()| isn't safe.
+std::vector<Node*> UsersOf(Node* node) {
+  std::vector<Node*> users;
+  for (auto const edge : node->use_edges())
+    users.push_back(edge->from());
+  return users;
+}
+
+// Returns true if |user| accesses field |pointer| of |object| without
+// leaking |object| or |pointer|.
+bool IsFieldAccess(Node* user, Node* object, Node* pointer) {
+  if (user->is<LoadNode>())
+    return user->input(1) == object && user->input(2) == pointer;
+  if (user->is<StoreNode>()) {
+    return user->input(1) == object && user->input(2) == pointer &&
+           user->input(3) != object && user->input(3) != pointer;
+  }
+  return false;
+}
+
+bool IsEscaped(Node* object) {
+  for (auto const edge : object->use_edges()) {
+    auto const user = edge->from();
+    if (user->is<LoadNode>() || user->is<StoreNode>()) {
+      // |object| is used as anchor of field access.
+      auto const pointer = user->input(2);
+      if (pointer->is<FieldNode>() && pointer->input(0) == object &&
+          IsFieldAccess(user, object, pointer)) {
+        continue;
+      }
+      return true;
+    }
+    if (!user->is<FieldNode>() || user->input(0) != object)
+      return true;
+    for (auto const field_edge : user->use_edges()) {
+      if (!IsFieldAccess(field_edge->from(), object, user))
+        return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+EscapePass::EscapePass(Editor* editor)
+    : api::Pass(editor->pass_controller()),
+      editor_(*editor),
+      heap_alloc_name_(editor->NewAtomicString(L"HeapAlloc")) {
+}
+
+EscapePass::~EscapePass() {
+}
+
+// Returns value of field loaded by |load| by walking effect chain backward
+// until store to the same field or allocation of |object|. Since |object|
+// doesn't escape, other stores and calls don't change fields of |object|.
+Data* EscapePass::FindStoredValue(Node* load, Node* object) const {
+  auto const field_name = load->input(2)->input(1);
+  auto const call = object->input(0);
+  auto effect = load->input(0);
+  for (;;) {
+    if (effect->is<StoreNode>()) {
+      auto const pointer = effect->input(2);
+      if (pointer->is<FieldNode>() && pointer->input(0) == object &&
+          pointer->input(1) == field_name) {
+        return effect->input(3)->as<Data>();
+      }
+      effect = effect->input(0);
+      continue;
+    }
+    if (!effect->is<GetEffectNode>())
+      return nullptr;
+    auto const control = effect->input(0);
+    if (control == call)
+      return editor_.node_factory()->DefaultValueOf(load->output_type());
+    if (!control->is<CallNode>())
+      return nullptr;
+    effect = control->input(1);
+  }
+}
+
+bool EscapePass::IsHeapAlloc(Node* node) const {
+  if (!node->is<CallNode>())
+    return false;
+  auto const callee = node->input(2)->as<ReferenceNode>();
+  return callee && callee->name() == heap_alloc_name_;
+}
+
+// Removes |call| of |HeapAlloc| from control and effect chain.
+void EscapePass::RemoveAllocation(Node* call) {
+  DCHECK(!call->SelectUser(Opcode::GetData)) << *call;
+  while (auto const effect = call->SelectUser(Opcode::GetEffect)) {
+    editor_.ReplaceAllUses(call->input(1), effect);
+    editor_.Discard(effect);
+  }
+  editor_.ReplaceAllUses(call->input(0), call);
+  editor_.Discard(call);
+}
+
+// Removes stores to |object| and fields of |object|. Caller should remove
+// all loads from |object| before calling this function.
+void EscapePass::RemoveStores(Node* object) {
+  for (auto const field : UsersOf(object)) {
+    if (!field->is<FieldNode>())
+      continue;
+    for (auto const store : UsersOf(field)) {
+      DCHECK(store->is<StoreNode>()) << *store;
+      editor_.ReplaceAllUses(store->input(0), store);
+      editor_.Discard(store);
+    }
+    editor_.Discard(field);
+  }
+}
+
+// Returns true if all loads from |object| are replaced with stored values.
+bool EscapePass::ReplaceLoads(Node* object) {
+  auto all_replaced = true;
+  for (auto const field : UsersOf(object)) {
+    if (!field->is<FieldNode>())
+      continue;
+    for (auto const load : UsersOf(field)) {
+      if (!load->is<LoadNode>())
+        continue;
+      auto const value = FindStoredValue(load, object);
+      if (!value) {
+        all_replaced = false;
+        continue;
+      }
+      DVLOG(1) << "Replace " << *load << " with " << *value;
+      editor_.ReplaceAllUses(value, load);
+      editor_.Discard(load);
+    }
+  }
+  return all_replaced;
+}
+
+void EscapePass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(editor_.function(), &collector);
+
+  for (auto const call : collector.nodes()) {
+    if (!IsHeapAlloc(call))
+      continue;
+    auto const object = call->SelectUser(Opcode::GetData);
+    if (!object) {
+      RemoveAllocation(call);
+      continue;
+    }
+    if (IsEscaped(object))
+      continue;
+    // TODO(eval1749) We should allocate |object| in stack when we can't
+    // replace all loads, once translator lowers |StackAllocNode|.
+    if (!ReplaceLoads(object))
+      continue;
+    DVLOG(1) << "Remove allocation " << *call;
+    RemoveStores(object);
+    editor_.Discard(object);
+    RemoveAllocation(call);
+  }
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece EscapePass::name() const {
+  return "escape";
+}
+
+void EscapePass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void EscapePass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,62 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_ESCAPE_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_ESCAPE_PASS_H_
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+class AtomicString;
+namespace optimizer {
+
+class Data;
+class Editor;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// EscapePass removes heap allocation, a call of |HeapAlloc| runtime function,
+// whose result doesn't escape from function. An allocated object escapes
+// when it is used other than an anchor of |LoadNode| and |StoreNode| or an
+// instance of |FieldNode|, e.g. stored into memory, passed to call, returned
+// or merged by phi.
+//
+// For non-escaping object, we replace each field load with value stored
+// by the nearest store along effect chain, or default value if there is no
+// store before load. If we can't find stored value, e.g. effect chain
+// reaches |EffectPhiNode|, we keep heap allocation.
+//
+class ELANG_OPTIMIZER_EXPORT EscapePass final : public api::Pass {
+ public:
+  explicit EscapePass(Editor* editor);
+  ~EscapePass();
+
+  void Run();
+
+ private:
+  Data* FindStoredValue(Node* load, Node* object) const;
+  bool IsHeapAlloc(Node* node) const;
+  void RemoveAllocation(Node* call);
+  void RemoveStores(Node* object);
+  bool ReplaceLoads(Node* object);
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+  AtomicString* const heap_alloc_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(EscapePass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_ESCAPE_PASS_H_
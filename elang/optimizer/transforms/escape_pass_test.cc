@@ -0,0 +1,175 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/escape_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// EscapePassTest
+//
+class EscapePassTest : public testing::OptimizerTest {
+ protected:
+  EscapePassTest()
+      : sample_type_(NewExternalType(NewAtomicString(L"Sample"))) {}
+  ~EscapePassTest() override = default;
+
+  Type* sample_type() const { return sample_type_; }
+
+  Data* NewFieldX(Data* object);
+  Control* NewHeapAlloc(Control* control, Effect* effect, Type* type);
+
+ private:
+  Type* const sample_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(EscapePassTest);
+};
+
+Data* EscapePassTest::NewFieldX(Data* object) {
+  return NewField(int32_type(), object,
+                  NewReference(int32_type(), NewAtomicString(L"Sample.x")));
+}
+
+Control* EscapePassTest::NewHeapAlloc(Control* control,
+                                      Effect* effect,
+                                      Type* type) {
+  auto const size = NewSizeOf(type);
+  auto const callee =
+      NewReference(NewFunctionType(NewPointerType(type), size->output_type()),
+                   NewAtomicString(L"HeapAlloc"));
+  return NewCall(control, effect, callee, size);
+}
+
+TEST_F(EscapePassTest, DefaultValue) {
+  auto const function = NewSampleFunction(int32_type(), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const call = NewHeapAlloc(entry_node, effect, sample_type());
+  editor.Commit();
+
+  editor.Edit(call);
+  auto const object = NewGetData(call);
+  auto const ret_node = editor.SetRet(
+      NewGetEffect(call),
+      NewLoad(NewGetEffect(call), object, NewFieldX(object)));
+  editor.Commit();
+
+  EscapePass(&editor).Run();
+
+  EXPECT_EQ(entry_node, ret_node->input(0));
+  EXPECT_EQ(effect, ret_node->input(1));
+  EXPECT_EQ(NewInt32(0), ret_node->input(2));
+}
+
+TEST_F(EscapePassTest, Escaped) {
+  auto const function =
+      NewSampleFunction(NewPointerType(sample_type()), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const call = NewHeapAlloc(entry_node, effect, sample_type());
+  editor.Commit();
+
+  editor.Edit(call);
+  auto const ret_node = editor.SetRet(NewGetEffect(call), NewGetData(call));
+  editor.Commit();
+
+  EscapePass(&editor).Run();
+
+  EXPECT_EQ(call, ret_node->input(0));
+  EXPECT_TRUE(ret_node->input(2)->is<GetDataNode>());
+}
+
+// Effect chain from load reaches |EffectPhiNode|.
+TEST_F(EscapePassTest, Merge) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({bool_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const call = NewHeapAlloc(entry_node, effect, sample_type());
+  editor.Commit();
+
+  editor.Edit(call);
+  auto const object = NewGetData(call);
+  auto const field = NewFieldX(object);
+  auto const if_node = editor.SetBranch(NewParameter(entry_node, 0));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+
+  editor.Edit(if_true);
+  auto const store =
+      NewStore(NewGetEffect(call), object, field, NewParameter(entry_node, 1));
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const effect_phi = NewEffectPhi(merge_node);
+  editor.SetPhiInput(effect_phi, merge_node->control(0), store);
+  editor.SetPhiInput(effect_phi, merge_node->control(1), NewGetEffect(call));
+  auto const ret_node =
+      editor.SetRet(effect_phi, NewLoad(effect_phi, object, field));
+  editor.Commit();
+
+  EscapePass(&editor).Run();
+
+  auto const load = ret_node->input(2);
+  ASSERT_TRUE(load->is<LoadNode>());
+  EXPECT_EQ(object, load->input(1));
+  EXPECT_EQ(call, object->input(0));
+}
+
+TEST_F(EscapePassTest, ScalarReplacement) {
+  auto const function = NewSampleFunction(int32_type(), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param = editor.ParameterAt(0);
+  auto const call = NewHeapAlloc(entry_node, effect, sample_type());
+  editor.Commit();
+
+  editor.Edit(call);
+  auto const object = NewGetData(call);
+  auto const field = NewFieldX(object);
+  auto const store = NewStore(NewGetEffect(call), object, field, param);
+  auto const ret_node =
+      editor.SetRet(store, NewIntAdd(NewLoad(store, object, field),
+                                     NewInt32(1)));
+  editor.Commit();
+
+  EscapePass(&editor).Run();
+
+  EXPECT_EQ(entry_node, ret_node->input(0));
+  EXPECT_EQ(effect, ret_node->input(1));
+  auto const add = ret_node->input(2);
+  ASSERT_TRUE(add->is<IntAddNode>());
+  EXPECT_EQ(param, add->input(0));
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,131 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/optimizer/transforms/graph_reducer.h"
+
+#include "base/logging.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  explicit NodeCollector(std::vector<Node*>* nodes);
+  ~NodeCollector() final = default;
+
+ private:
+  // NodeVisitor
+  void DoDefaultVisit(Node* node) final;
+
+  std::vector<Node*>& nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+NodeCollector::NodeCollector(std::vector<Node*>* nodes) : nodes_(*nodes) {
+}
+
+// NodeVisitor
+void NodeCollector::DoDefaultVisit(Node* node) {
+  if (node->IsLiteral())
+    return;
+  nodes_.push_back(node);
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// Reducer
+//
+Reducer::Reducer() {
+}
+
+Reducer::~Reducer() {
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// GraphReducer
+//
+GraphReducer::GraphReducer(Editor* editor) : editor_(*editor) {
+}
+
+GraphReducer::~GraphReducer() {
+}
+
+void GraphReducer::AddReducer(Reducer* reducer) {
+  reducers_.push_back(reducer);
+}
+
+void GraphReducer::Push(Node* node) {
+  if (node->IsLiteral() || work_list_.Contains(node))
+    return;
+  work_list_.Push(node);
+}
+
+bool GraphReducer::ReduceGraph() {
+  std::vector<Node*> nodes;
+  NodeCollector collector(&nodes);
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  walker.Traverse(editor_.function(), &collector);
+
+  // Since |work_list_| is LIFO, we push nodes in reverse post order to visit
+  // inputs before their users.
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+    Push(*it);
+
+  auto changed = false;
+  while (!work_list_.empty()) {
+    auto const node = work_list_.Pop();
+    // Reduction may make |node| dead.
+    if (!node->IsControl() && !node->IsUsed())
+      continue;
+    auto const new_node = ReduceNode(node);
+    if (!new_node)
+      continue;
+    changed = true;
+    Replace(node, new_node);
+  }
+  return changed;
+}
+
+Node* GraphReducer::ReduceNode(Node* node) {
+  for (auto const reducer : reducers_) {
+    if (auto const new_node = reducer->Reduce(node))
+      return new_node;
+  }
+  return nullptr;
+}
+
+void GraphReducer::Replace(Node* node, Node* new_node) {
+  DCHECK_NE(node, new_node);
+  DVLOG(1) << "Reduce " << *node << " to " << *new_node;
+  std::vector<Node*> users;
+  for (auto const edge : node->use_edges())
+    users.push_back(edge->from());
+  editor_.ReplaceAllUses(new_node, node);
+  editor_.Discard(node);
+
+  // |new_node| may be a node created by reducer, and users of |node| may be
+  // reducible with |new_node|.
+  Push(new_node);
+  for (auto const user : users)
+    Push(user);
+}
+
+}  // namespace optimizer
+}  // namespace elang
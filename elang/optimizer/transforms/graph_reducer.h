@@ -0,0 +1,72 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_GRAPH_REDUCER_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_GRAPH_REDUCER_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "elang/base/work_list.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Editor;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// Reducer represents a set of local rewriting rules applied by
+// |GraphReducer|.
+//
+class ELANG_OPTIMIZER_EXPORT Reducer {
+ public:
+  virtual ~Reducer();
+
+  // Returns a node which replaces |node|, or |nullptr| if no rule is
+  // applicable to |node|.
+  virtual Node* Reduce(Node* node) = 0;
+
+ protected:
+  Reducer();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Reducer);
+};
+
+//////////////////////////////////////////////////////////////////////
+//
+// GraphReducer applies |Reducer|s to nodes in function until no more
+// reduction happens. Initially, all nodes are in work list; after that
+// only users of replacement node are revisited, so cost of reaching fixed
+// point is proportional to number of changed nodes.
+//
+class ELANG_OPTIMIZER_EXPORT GraphReducer final {
+ public:
+  explicit GraphReducer(Editor* editor);
+  ~GraphReducer();
+
+  void AddReducer(Reducer* reducer);
+
+  // Returns true if graph is changed.
+  bool ReduceGraph();
+
+ private:
+  void Push(Node* node);
+  void Replace(Node* node, Node* new_node);
+  Node* ReduceNode(Node* node);
+
+  Editor& editor_;
+  std::vector<Reducer*> reducers_;
+  WorkList<Node> work_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(GraphReducer);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_GRAPH_REDUCER_H_
@@ -0,0 +1,264 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <functional>
+#include <vector>
+
+#include "elang/optimizer/transforms/gvn_pass.h"
+
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order, e.g. inputs of node are
+// collected before node except for back edges.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+bool IsCommutative(const Node* node) {
+  switch (node->opcode()) {
+    case Opcode::FloatAdd:
+    case Opcode::FloatMul:
+    case Opcode::IntAdd:
+    case Opcode::IntBitAnd:
+    case Opcode::IntBitOr:
+    case Opcode::IntBitXor:
+    case Opcode::IntMul:
+      return true;
+  }
+  return false;
+}
+
+// Returns true if |node| can be replaced with congruent node. Note: We don't
+// treat integer division and modulo as pure, since they may cause exception
+// and we don't represent division-by-zero yet.
+bool IsPure(const Node* node) {
+  switch (node->opcode()) {
+    case Opcode::Element:
+    case Opcode::Field:
+    case Opcode::FloatAdd:
+    case Opcode::FloatCmp:
+    case Opcode::FloatDiv:
+    case Opcode::FloatMod:
+    case Opcode::FloatMul:
+    case Opcode::FloatSub:
+    case Opcode::Get:
+    case Opcode::IntAdd:
+    case Opcode::IntBitAnd:
+    case Opcode::IntBitOr:
+    case Opcode::IntBitXor:
+    case Opcode::IntCmp:
+    case Opcode::IntMul:
+    case Opcode::IntShl:
+    case Opcode::IntShr:
+    case Opcode::IntSub:
+    case Opcode::Length:
+    case Opcode::Phi:
+    case Opcode::PointerAdd:
+    case Opcode::StaticCast:
+      return true;
+  }
+  return false;
+}
+
+// Returns condition of comparison or field of projection.
+size_t AttributeOf(const Node* node) {
+  if (auto const cmp = node->as<IntCmpNode>())
+    return static_cast<size_t>(cmp->condition());
+  if (auto const cmp = node->as<FloatCmpNode>())
+    return static_cast<size_t>(cmp->condition());
+  return node->has_field() ? node->field() : 0;
+}
+
+size_t HashOf(const Node* node) {
+  std::hash<const void*> hasher;
+  auto hash = static_cast<size_t>(node->opcode());
+  hash = hash * 31 + hasher(node->output_type());
+  hash = hash * 31 + AttributeOf(node);
+  if (auto const phi = node->as<PhiNode>())
+    hash = hash * 31 + hasher(phi->owner());
+  if (node->is<PhiNode>() || IsCommutative(node)) {
+    // Order of inputs doesn't matter.
+    auto sum = static_cast<size_t>(0);
+    for (auto const input : node->inputs())
+      sum += hasher(input);
+    return hash * 31 + sum;
+  }
+  for (auto const input : node->inputs())
+    hash = hash * 31 + hasher(input);
+  return hash;
+}
+
+Node* PhiInputOf(const PhiNode* phi, const Control* control) {
+  for (auto const phi_input : phi->phi_inputs()) {
+    if (phi_input->control() == control)
+      return phi_input->value();
+  }
+  return nullptr;
+}
+
+bool IsCongruentPhi(const PhiNode* phi1, const PhiNode* phi2) {
+  if (phi1->owner() != phi2->owner() ||
+      phi1->phi_inputs().size() != phi2->phi_inputs().size()) {
+    return false;
+  }
+  for (auto const phi_input : phi1->phi_inputs()) {
+    if (PhiInputOf(phi2, phi_input->control()) != phi_input->value())
+      return false;
+  }
+  return true;
+}
+
+bool IsCongruent(const Node* node1, const Node* node2) {
+  if (node1->opcode() != node2->opcode() ||
+      node1->output_type() != node2->output_type() ||
+      AttributeOf(node1) != AttributeOf(node2)) {
+    return false;
+  }
+  if (auto const phi1 = node1->as<PhiNode>())
+    return IsCongruentPhi(phi1, node2->as<PhiNode>());
+  auto const count = node1->CountInputs();
+  if (count != node2->CountInputs())
+    return false;
+  if (count == 2 && IsCommutative(node1) &&
+      node1->input(0) == node2->input(1) &&
+      node1->input(1) == node2->input(0)) {
+    return true;
+  }
+  for (size_t index = 0; index < count; ++index) {
+    if (node1->input(index) != node2->input(index))
+      return false;
+  }
+  return true;
+}
+
+// Returns a value if all inputs of |phi| are same value except for |phi|
+// itself, otherwise returns |nullptr|.
+Node* RedundantValueOf(const PhiNode* phi) {
+  auto value = static_cast<Node*>(nullptr);
+  for (auto const input : phi->inputs()) {
+    if (input == phi || input == value)
+      continue;
+    if (value)
+      return nullptr;
+    value = input;
+  }
+  return value;
+}
+
+}  // namespace
+
+GvnPass::GvnPass(Editor* editor)
+    : api::Pass(editor->pass_controller()), changed_(false), editor_(*editor) {
+}
+
+GvnPass::~GvnPass() {
+}
+
+Node* GvnPass::FindCongruentNode(Node* node) const {
+  auto const it = value_map_.find(HashOf(node));
+  if (it == value_map_.end())
+    return nullptr;
+  for (auto const candidate : it->second) {
+    if (IsCongruent(candidate, node))
+      return candidate;
+  }
+  return nullptr;
+}
+
+void GvnPass::Replace(Node* new_node, Node* old_node) {
+  DVLOG(1) << "Replace " << *old_node << " with " << *new_node;
+  editor_.ReplaceAllUses(new_node, old_node);
+  editor_.Discard(old_node);
+  changed_ = true;
+}
+
+void GvnPass::ValueNumber() {
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(editor_.function(), &collector);
+
+  value_map_.clear();
+  for (auto const node : collector.nodes()) {
+    // Note: Nodes replaced in this round have no users.
+    if (!IsPure(node) || !node->IsUsed())
+      continue;
+    if (auto const phi = node->as<PhiNode>()) {
+      if (auto const value = RedundantValueOf(phi)) {
+        Replace(value, phi);
+        continue;
+      }
+    }
+    if (auto const congruent_node = FindCongruentNode(node)) {
+      Replace(congruent_node, node);
+      continue;
+    }
+    value_map_[HashOf(node)].push_back(node);
+  }
+  value_map_.clear();
+}
+
+void GvnPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+  // Replacing a node makes its users congruent, and users of phi can be
+  // visited before phi. So, we iterate until we have no changes.
+  do {
+    changed_ = false;
+    ValueNumber();
+  } while (changed_);
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece GvnPass::name() const {
+  return "gvn";
+}
+
+void GvnPass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void GvnPass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,64 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_GVN_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_GVN_PASS_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Editor;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// GvnPass collapses congruent pure nodes in whole function. Two nodes are
+// congruent if they have same opcode, same output type, same attribute, e.g.
+// condition of comparison and field of projection, and same inputs.
+//
+// Since pure nodes aren't pinned to control, we don't need to check
+// dominance; scheduler places representative node into least common
+// ancestor of its users.
+//
+// |GvnPass| also replaces a redundant phi, whose inputs are same value except
+// for itself, with that value.
+//
+class ELANG_OPTIMIZER_EXPORT GvnPass final : public api::Pass {
+ public:
+  explicit GvnPass(Editor* editor);
+  ~GvnPass();
+
+  void Run();
+
+ private:
+  Node* FindCongruentNode(Node* node) const;
+  void Replace(Node* new_node, Node* old_node);
+  void ValueNumber();
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  bool changed_;
+  Editor& editor_;
+
+  // A map from hash code to representative nodes having hash code.
+  std::unordered_map<size_t, std::vector<Node*>> value_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(GvnPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_GVN_PASS_H_
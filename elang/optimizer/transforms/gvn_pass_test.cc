@@ -0,0 +1,231 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/gvn_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// GvnPassTest
+//
+class GvnPassTest : public testing::OptimizerTest {
+ protected:
+  GvnPassTest() = default;
+  ~GvnPassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(GvnPassTest);
+};
+
+TEST_F(GvnPassTest, Arithmetic) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({int32_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const param1 = editor.ParameterAt(1);
+  auto const add1 = NewIntAdd(param0, param1);
+  auto const add2 = NewIntAdd(param1, param0);
+  auto const sub1 = NewIntSub(add1, param1);
+  auto const sub2 = NewIntSub(add2, param1);
+  auto const mul = NewIntMul(sub1, sub2);
+  editor.SetRet(effect, mul);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(mul->input(0), mul->input(1));
+  EXPECT_EQ(add1, mul->input(0)->input(0));
+  EXPECT_FALSE(add2->IsUsed());
+  EXPECT_FALSE(sub2->IsUsed());
+}
+
+TEST_F(GvnPassTest, Element) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewPointerType(NewArrayType(int32_type(), {-1})));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const element1 = NewElement(array, NewInt32(1), entry_node);
+  auto const element2 = NewElement(array, NewInt32(1), entry_node);
+  auto const add = NewIntAdd(NewLoad(effect, array, element1),
+                             NewLoad(effect, array, element2));
+  editor.SetRet(effect, add);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(element1, add->input(0)->input(2));
+  EXPECT_EQ(element1, add->input(1)->input(2));
+  EXPECT_FALSE(element2->IsUsed());
+}
+
+TEST_F(GvnPassTest, Field) {
+  auto const sample_type = NewExternalType(NewAtomicString(L"Sample"));
+  auto const function =
+      NewSampleFunction(int32_type(), NewPointerType(sample_type));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const object = editor.ParameterAt(0);
+  auto const name = NewReference(int32_type(), NewAtomicString(L"Sample.x"));
+  auto const field1 = NewField(int32_type(), object, name);
+  auto const field2 = NewField(int32_type(), object, name);
+  auto const add = NewIntAdd(NewLoad(effect, object, field1),
+                             NewLoad(effect, object, field2));
+  editor.SetRet(effect, add);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(field1, add->input(0)->input(2));
+  EXPECT_EQ(field1, add->input(1)->input(2));
+  EXPECT_FALSE(field2->IsUsed());
+}
+
+TEST_F(GvnPassTest, Length) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewPointerType(NewArrayType(int32_type(), {-1})));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const length1 = NewLength(array, 0);
+  auto const length2 = NewLength(array, 0);
+  auto const sub = NewIntSub(length1, length2);
+  editor.SetRet(effect, sub);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(sub->input(0), sub->input(1));
+  EXPECT_FALSE(length2->IsUsed());
+}
+
+// Phi of outer loop becomes redundant only after phi of inner loop, which is
+// visited after it, is replaced.
+TEST_F(GvnPassTest, NestedLoopPhi) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({int32_type(), bool_type(), bool_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // do { do { } while (param1); } while (param2); return phi2;
+  auto const loop_node1 = NewLoop();
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const param1 = editor.ParameterAt(1);
+  auto const param2 = editor.ParameterAt(2);
+  editor.SetJump(loop_node1);
+  editor.Commit();
+
+  auto const loop_node2 = NewLoop();
+  editor.Edit(loop_node1);
+  auto const phi1 = NewPhi(int32_type(), loop_node1);
+  editor.SetPhiInput(phi1, loop_node1->control(0), param0);
+  editor.SetJump(loop_node2);
+  editor.Commit();
+
+  editor.Edit(loop_node2);
+  auto const phi2 = NewPhi(int32_type(), loop_node2);
+  editor.SetPhiInput(phi2, loop_node2->control(0), phi1);
+  auto const if_node1 = editor.SetBranch(param1);
+  auto const if_true1 = NewIfTrue(if_node1);
+  auto const if_false1 = NewIfFalse(if_node1);
+  editor.Commit();
+
+  editor.Edit(if_true1);
+  editor.SetJump(loop_node2);
+  editor.SetPhiInput(phi2, loop_node2->control(1), phi2);
+  editor.Commit();
+
+  editor.Edit(if_false1);
+  auto const if_node2 = editor.SetBranch(param2);
+  auto const if_true2 = NewIfTrue(if_node2);
+  auto const if_false2 = NewIfFalse(if_node2);
+  editor.Commit();
+
+  editor.Edit(if_true2);
+  editor.SetJump(loop_node1);
+  editor.SetPhiInput(phi1, loop_node1->control(1), phi2);
+  editor.Commit();
+
+  editor.Edit(if_false2);
+  auto const ret_node = editor.SetRet(effect, phi2);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(param0, ret_node->input(2));
+  EXPECT_FALSE(phi1->IsUsed());
+  EXPECT_FALSE(phi2->IsUsed());
+}
+
+TEST_F(GvnPassTest, Phi) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({bool_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param1 = editor.ParameterAt(1);
+  auto const if_node = editor.SetBranch(editor.ParameterAt(0));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+
+  editor.Edit(if_true);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const phi1 = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi1, merge_node->control(0), param1);
+  editor.SetPhiInput(phi1, merge_node->control(1), NewInt32(42));
+  auto const phi2 = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi2, merge_node->control(1), NewInt32(42));
+  editor.SetPhiInput(phi2, merge_node->control(0), param1);
+  auto const phi3 = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi3, merge_node->control(0), param1);
+  editor.SetPhiInput(phi3, merge_node->control(1), param1);
+  auto const add = NewIntAdd(NewIntAdd(phi1, phi2), phi3);
+  auto const ret_node = editor.SetRet(effect, add);
+  editor.Commit();
+
+  GvnPass(&editor).Run();
+
+  EXPECT_EQ(add, ret_node->input(2));
+  EXPECT_EQ(param1, add->input(1));
+  EXPECT_EQ(add->input(0)->input(0), add->input(0)->input(1));
+  EXPECT_FALSE(phi3->IsUsed());
+}
+
+}  // namespace optimizer
+}  // namespace elang
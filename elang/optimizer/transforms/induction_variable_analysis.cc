@@ -0,0 +1,164 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "elang/optimizer/transforms/induction_variable_analysis.h"
+
+#include "base/logging.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoopCollector collects loop nodes in post order.
+//
+class LoopCollector final : public NodeVisitor {
+ public:
+  LoopCollector() {}
+  ~LoopCollector() = default;
+
+  const std::vector<LoopNode*>& loops() const { return loops_; }
+
+ private:
+  void VisitLoop(LoopNode* node) final { loops_.push_back(node); }
+
+  std::vector<LoopNode*> loops_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopCollector);
+};
+
+// Returns |step| if |next| is |phi + step| or |phi - step|, otherwise returns
+// zero.
+int32_t StepOf(const PhiNode* phi, const Node* next) {
+  if (!next || next->CountInputs() != 2 || next->input(0) != phi)
+    return 0;
+  auto const literal = next->input(1)->as<Int32Node>();
+  if (!literal)
+    return 0;
+  if (next->is<IntAddNode>())
+    return literal->data();
+  if (next->is<IntSubNode>())
+    return -literal->data();
+  return 0;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// InductionVariableAnalysis::LoopInfo
+//
+struct InductionVariableAnalysis::LoopInfo {
+  // Control nodes in loop body including loop header.
+  std::unordered_set<Node*> controls;
+  // Cache of |IsLoopInvariant()|.
+  std::unordered_map<Node*, bool> invariants;
+};
+
+//////////////////////////////////////////////////////////////////////
+//
+// InductionVariableAnalysis
+//
+InductionVariableAnalysis::InductionVariableAnalysis(Function* function) {
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  LoopCollector collector;
+  walker.Traverse(function, &collector);
+  loops_ = collector.loops();
+  for (auto const loop : loops_)
+    AnalyzeLoop(loop);
+}
+
+InductionVariableAnalysis::~InductionVariableAnalysis() {
+}
+
+void InductionVariableAnalysis::AnalyzeLoop(LoopNode* loop) {
+  // Collect control nodes in loop body by walking from back edges to loop
+  // header.
+  std::unique_ptr<LoopInfo> info(new LoopInfo());
+  info->controls.insert(loop);
+  std::vector<Node*> work_list;
+  for (size_t index = 1; index < loop->CountInputs(); ++index)
+    work_list.push_back(loop->input(index));
+  while (!work_list.empty()) {
+    auto const control = work_list.back();
+    work_list.pop_back();
+    if (!info->controls.insert(control).second)
+      continue;
+    for (auto const input : control->inputs()) {
+      if (input->IsControl())
+        work_list.push_back(input);
+    }
+  }
+  loop_infos_.insert(std::make_pair(loop, std::move(info)));
+
+  if (loop->CountInputs() != 2)
+    return;
+  for (auto const phi : loop->phi_nodes()) {
+    if (!phi->output_type()->is<Int32Type>())
+      continue;
+    auto start = static_cast<Data*>(nullptr);
+    auto next = static_cast<Node*>(nullptr);
+    for (auto const phi_input : phi->phi_inputs()) {
+      if (phi_input->control() == loop->input(0))
+        start = phi_input->value()->as<Data>();
+      else
+        next = phi_input->value();
+    }
+    auto const step = StepOf(phi, next);
+    if (!start || !step)
+      continue;
+    induction_variables_.insert(
+        std::make_pair(phi, InductionVariable{loop, phi, start, step}));
+  }
+}
+
+const InductionVariable* InductionVariableAnalysis::InductionVariableOf(
+    const Node* node) const {
+  auto const it = induction_variables_.find(node);
+  return it == induction_variables_.end() ? nullptr : &it->second;
+}
+
+// Note: Since |PhiNode| outside |loop| dominates |loop| or isn't used in
+// |loop|, we don't need to look into inputs of |PhiNode|. So, walking inputs
+// never goes around cycle.
+bool InductionVariableAnalysis::IsLoopInvariant(LoopNode* loop, Node* node) {
+  auto const it = loop_infos_.find(loop);
+  DCHECK(it != loop_infos_.end()) << *loop;
+  auto& info = *it->second;
+  if (node->IsLiteral())
+    return true;
+  if (node->IsControl())
+    return !info.controls.count(node);
+  if (auto const phi = node->as<PhiNode>())
+    return !info.controls.count(phi->owner());
+  if (auto const phi = node->as<EffectPhiNode>())
+    return !info.controls.count(phi->owner());
+
+  auto const cached = info.invariants.find(node);
+  if (cached != info.invariants.end())
+    return cached->second;
+  auto invariant = true;
+  for (auto const input : node->inputs()) {
+    if (IsLoopInvariant(loop, input))
+      continue;
+    invariant = false;
+    break;
+  }
+  info.invariants[node] = invariant;
+  return invariant;
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,76 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_INDUCTION_VARIABLE_ANALYSIS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_INDUCTION_VARIABLE_ANALYSIS_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/macros.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Data;
+class Function;
+class LoopNode;
+class Node;
+class PhiNode;
+
+//////////////////////////////////////////////////////////////////////
+//
+// InductionVariable represents basic induction variable |phi| of |loop|,
+// which value is |start| at loop entry and is increased by |step| at back
+// edge of |loop|.
+//
+struct ELANG_OPTIMIZER_EXPORT InductionVariable {
+  LoopNode* loop;
+  PhiNode* phi;
+  Data* start;
+  int32_t step;
+};
+
+//////////////////////////////////////////////////////////////////////
+//
+// InductionVariableAnalysis finds basic induction variables in |Function|,
+// e.g. |PhiNode| of |LoopNode| of form |i = phi(start, i + step)| where
+// |step| is |int32| literal, and tells whether a node is loop invariant or
+// not.
+//
+class ELANG_OPTIMIZER_EXPORT InductionVariableAnalysis final {
+ public:
+  explicit InductionVariableAnalysis(Function* function);
+  ~InductionVariableAnalysis();
+
+  // Returns loops in |function| in post order.
+  const std::vector<LoopNode*>& loops() const { return loops_; }
+
+  // Returns basic induction variable represented by |node|, or |nullptr| if
+  // |node| isn't basic induction variable.
+  const InductionVariable* InductionVariableOf(const Node* node) const;
+
+  // Returns true if value of |node| doesn't change during execution of
+  // |loop|.
+  bool IsLoopInvariant(LoopNode* loop, Node* node);
+
+ private:
+  struct LoopInfo;
+
+  void AnalyzeLoop(LoopNode* loop);
+
+  std::unordered_map<const Node*, InductionVariable> induction_variables_;
+  std::unordered_map<LoopNode*, std::unique_ptr<LoopInfo>> loop_infos_;
+  std::vector<LoopNode*> loops_;
+
+  DISALLOW_COPY_AND_ASSIGN(InductionVariableAnalysis);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_INDUCTION_VARIABLE_ANALYSIS_H_
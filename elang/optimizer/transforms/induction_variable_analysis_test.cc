@@ -0,0 +1,95 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/induction_variable_analysis.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// InductionVariableAnalysisTest
+//
+class InductionVariableAnalysisTest : public testing::OptimizerTest {
+ protected:
+  InductionVariableAnalysisTest() = default;
+  ~InductionVariableAnalysisTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(InductionVariableAnalysisTest);
+};
+
+TEST_F(InductionVariableAnalysisTest, Basic) {
+  auto const function = NewSampleFunction(int32_type(), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // i = 0; j = n; k = 1; do { j -= 2; k *= 2; } while (++i < n); return j + k;
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const limit = editor.ParameterAt(0);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const phi_i = NewPhi(int32_type(), loop_node);
+  auto const phi_j = NewPhi(int32_type(), loop_node);
+  auto const phi_k = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(phi_i, loop_node->control(0), NewInt32(0));
+  editor.SetPhiInput(phi_j, loop_node->control(0), limit);
+  editor.SetPhiInput(phi_k, loop_node->control(0), NewInt32(1));
+  auto const next_i = NewIntAdd(phi_i, NewInt32(1));
+  auto const next_j = NewIntSub(phi_j, NewInt32(2));
+  auto const next_k = NewIntMul(phi_k, NewInt32(2));
+  auto const if_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, next_i, limit));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(phi_i, loop_node->control(1), next_i);
+  editor.SetPhiInput(phi_j, loop_node->control(1), next_j);
+  editor.SetPhiInput(phi_k, loop_node->control(1), next_k);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, NewIntAdd(next_j, next_k));
+  editor.Commit();
+
+  InductionVariableAnalysis analysis(function);
+  ASSERT_EQ(1u, analysis.loops().size());
+  EXPECT_EQ(loop_node, analysis.loops().front());
+
+  auto const variable_i = analysis.InductionVariableOf(phi_i);
+  ASSERT_TRUE(variable_i);
+  EXPECT_EQ(loop_node, variable_i->loop);
+  EXPECT_EQ(NewInt32(0), variable_i->start);
+  EXPECT_EQ(1, variable_i->step);
+
+  auto const variable_j = analysis.InductionVariableOf(phi_j);
+  ASSERT_TRUE(variable_j);
+  EXPECT_EQ(limit, variable_j->start);
+  EXPECT_EQ(-2, variable_j->step);
+
+  EXPECT_FALSE(analysis.InductionVariableOf(phi_k));
+  EXPECT_FALSE(analysis.InductionVariableOf(next_i));
+
+  EXPECT_TRUE(analysis.IsLoopInvariant(loop_node, limit));
+  EXPECT_TRUE(analysis.IsLoopInvariant(loop_node,
+                                       NewIntAdd(limit, NewInt32(1))));
+  EXPECT_FALSE(analysis.IsLoopInvariant(loop_node, phi_k));
+  EXPECT_FALSE(analysis.IsLoopInvariant(loop_node, next_i));
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,503 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <vector>
+
+#include "elang/optimizer/transforms/inline_pass.h"
+
+#include "base/logging.h"
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/factory.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+// Maximum number of nodes of callee to inline.
+const size_t kMaxInlineSize = 30;
+// Maximum number of nodes of callee to inline into loop.
+const size_t kMaxInlineSizeInLoop = 100;
+// Maximum number of nodes added to function.
+const size_t kMaxGrowth = 1000;
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+std::vector<Node*> CollectNodes(const Function* function) {
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(function, &collector);
+  return collector.nodes();
+}
+
+// Returns true if we can copy |node| into another function.
+bool IsClonable(const Node* node) {
+  if (node->IsLiteral())
+    return true;
+  switch (node->opcode()) {
+#define V(Name, ...) case Opcode::Name:
+    FOR_EACH_OPTIMIZER_CONCRETE_ARITHMETIC_NODE(V)
+#undef V
+    case Opcode::Call:
+    case Opcode::DynamicCast:
+    case Opcode::EffectPhi:
+    case Opcode::Element:
+    case Opcode::Entry:
+    case Opcode::Exit:
+    case Opcode::Field:
+    case Opcode::FloatCmp:
+    case Opcode::FunctionReference:
+    case Opcode::Get:
+    case Opcode::GetData:
+    case Opcode::GetEffect:
+    case Opcode::GetTuple:
+    case Opcode::If:
+    case Opcode::IfFalse:
+    case Opcode::IfTrue:
+    case Opcode::IntCmp:
+    case Opcode::IntShl:
+    case Opcode::IntShr:
+    case Opcode::Jump:
+    case Opcode::Length:
+    case Opcode::Load:
+    case Opcode::Loop:
+    case Opcode::Merge:
+    case Opcode::Parameter:
+    case Opcode::Phi:
+    case Opcode::PointerAdd:
+    case Opcode::Ret:
+    case Opcode::StaticCast:
+    case Opcode::Store:
+    case Opcode::Throw:
+    case Opcode::Tuple:
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+InlinePass::InlinePass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor), growth_(0) {
+}
+
+InlinePass::~InlinePass() {
+}
+
+// Returns callee function of |call| if |call| calls function statically.
+// Front-end refers callee by name with |ReferenceNode|, which we resolve by
+// functions registered in factory.
+Function* InlinePass::CalleeOf(const CallNode* call) const {
+  auto const callee = call->input(2);
+  if (auto const reference = callee->as<FunctionReferenceNode>())
+    return reference->function();
+  auto const reference = callee->as<ReferenceNode>();
+  if (!reference)
+    return nullptr;
+  auto const function = editor_.factory()->FunctionByName(reference->name());
+  if (!function || function->function_type() != reference->output_type())
+    return nullptr;
+  return function;
+}
+
+Node* InlinePass::ArgumentAt(CallNode* call, size_t index) const {
+  auto const arguments = call->input(3);
+  if (!arguments->output_type()->is<TupleType>()) {
+    DCHECK_EQ(index, 0u) << *call;
+    return arguments;
+  }
+  DCHECK(arguments->is<TupleNode>()) << *call;
+  return arguments->input(index);
+}
+
+bool InlinePass::CanInline(CallNode* call) const {
+  auto const callee = CalleeOf(call);
+  if (!callee || callee == editor_.function())
+    return false;
+  auto const arguments = call->input(3);
+  if (arguments->output_type()->is<TupleType>() &&
+      !arguments->is<TupleNode>()) {
+    return false;
+  }
+  for (auto const edge : call->use_edges()) {
+    auto const user = edge->from();
+    if (user->is<GetDataNode>() || user->is<GetEffectNode>())
+      continue;
+    // Exception handling isn't supported yet.
+    if (user->is<IfExceptionNode>() || user->is<IfSuccessNode>() ||
+        !user->IsControl()) {
+      return false;
+    }
+  }
+  // Control flow of callee should end with |RetNode| or |ThrowNode|, and at
+  // least one |RetNode| for continuation of |call|.
+  auto const exit_merge = callee->exit_node()->input(0)->as<MergeNode>();
+  if (!exit_merge || !exit_merge->phi_nodes().empty() ||
+      exit_merge->effect_phi()) {
+    return false;
+  }
+  auto has_ret = false;
+  for (auto const input : exit_merge->inputs()) {
+    if (input->is<RetNode>()) {
+      has_ret = true;
+      continue;
+    }
+    if (!input->is<ThrowNode>())
+      return false;
+  }
+  return has_ret;
+}
+
+Node* InlinePass::CloneOf(Node* node) {
+  if (node->IsLiteral() || node->is<FunctionReferenceNode>())
+    return node;
+  auto const it = node_map_.find(node);
+  if (it != node_map_.end())
+    return it->second;
+  auto const new_node = NewNodeLike(node);
+  node_map_[node] = new_node;
+  return new_node;
+}
+
+// Marks control nodes in natural loops by walking control inputs backward
+// from back edges to loop header.
+void InlinePass::CollectNodesInLoop(const std::vector<Node*>& nodes) {
+  for (auto const node : nodes) {
+    auto const loop = node->as<LoopNode>();
+    if (!loop)
+      continue;
+    nodes_in_loop_.insert(loop);
+    std::vector<Node*> stack;
+    auto const num_inputs = loop->CountInputs();
+    for (size_t index = 1; index < num_inputs; ++index)
+      stack.push_back(loop->input(index));
+    while (!stack.empty()) {
+      auto const control = stack.back();
+      stack.pop_back();
+      if (!nodes_in_loop_.insert(control).second)
+        continue;
+      for (auto const input : control->inputs()) {
+        if (input->IsControl())
+          stack.push_back(input);
+      }
+    }
+  }
+}
+
+void InlinePass::Inline(CallNode* call,
+                        const std::vector<Node*>& callee_nodes) {
+  auto const callee = CalleeOf(call);
+  DVLOG(1) << "Inline " << *call << " " << *callee->function_type();
+  node_map_.clear();
+
+  // Map entry, parameters and initial effect of callee to caller.
+  auto const entry_node = callee->entry_node();
+  node_map_[entry_node] = call->input(0);
+  for (auto const node : callee_nodes) {
+    if (auto const parameter = node->as<ParameterNode>()) {
+      node_map_[node] = ArgumentAt(call, parameter->field());
+      continue;
+    }
+    if (node->is<GetEffectNode>() && node->input(0) == entry_node) {
+      node_map_[node] = call->input(1);
+      continue;
+    }
+  }
+
+  // Populate phi owners and phis first to break cycles in callee graph.
+  auto const exit_merge = callee->exit_node()->input(0);
+  for (auto const node : callee_nodes) {
+    if (node->is<LoopNode>()) {
+      node_map_[node] = editor_.NewLoop();
+      continue;
+    }
+    if (node->is<MergeNode>() && node != exit_merge)
+      node_map_[node] = editor_.NewMerge({});
+  }
+  for (auto const node : callee_nodes) {
+    if (auto const phi = node->as<PhiNode>()) {
+      node_map_[phi] = editor_.NewPhi(
+          phi->output_type(), CloneOf(phi->owner())->as<PhiOwnerNode>());
+      continue;
+    }
+    if (auto const phi = node->as<EffectPhiNode>()) {
+      node_map_[phi] =
+          editor_.NewEffectPhi(CloneOf(phi->owner())->as<PhiOwnerNode>());
+    }
+  }
+
+  for (auto const node : callee_nodes) {
+    auto const phi_owner = node->as<PhiOwnerNode>();
+    if (!phi_owner || node == exit_merge)
+      continue;
+    auto const new_phi_owner = CloneOf(phi_owner);
+    for (auto const input : phi_owner->inputs())
+      editor_.AppendInput(new_phi_owner, CloneOf(input));
+  }
+  for (auto const node : callee_nodes) {
+    if (auto const phi = node->as<PhiNode>()) {
+      auto const new_phi = CloneOf(phi)->as<PhiNode>();
+      for (auto const phi_input : phi->phi_inputs()) {
+        editor_.SetPhiInput(new_phi,
+                            CloneOf(phi_input->control())->as<Control>(),
+                            CloneOf(phi_input->value())->as<Data>());
+      }
+      continue;
+    }
+    if (auto const phi = node->as<EffectPhiNode>()) {
+      auto const new_phi = CloneOf(phi)->as<EffectPhiNode>();
+      for (auto const phi_input : phi->phi_inputs()) {
+        editor_.SetPhiInput(new_phi,
+                            CloneOf(phi_input->control())->as<Control>(),
+                            CloneOf(phi_input->value())->as<Effect>());
+      }
+    }
+  }
+
+  // Since |call| isn't in exception handler, |ThrowNode|s of callee go to
+  // exit of caller.
+  std::vector<Node*> ret_nodes;
+  for (auto const exit : exit_merge->inputs()) {
+    if (exit->is<RetNode>()) {
+      ret_nodes.push_back(exit);
+      continue;
+    }
+    DCHECK(exit->is<ThrowNode>()) << *exit;
+    editor_.AppendInput(editor_.function()->exit_node()->input(0),
+                        CloneOf(exit)->as<Control>());
+  }
+
+  // Make continuation of call from |RetNode|s.
+  Control* control = nullptr;
+  Effect* effect = nullptr;
+  Data* value = nullptr;
+  if (ret_nodes.size() == 1) {
+    auto const ret_node = ret_nodes.front();
+    control = CloneOf(ret_node->input(0))->as<Control>();
+    effect = CloneOf(ret_node->input(1))->as<Effect>();
+    value = CloneOf(ret_node->input(2))->as<Data>();
+  } else {
+    auto const merge_node = editor_.NewMerge({});
+    auto const effect_phi = editor_.NewEffectPhi(merge_node);
+    auto const return_type = callee->return_type();
+    auto const phi = return_type->is<VoidType>()
+                         ? nullptr
+                         : editor_.NewPhi(return_type, merge_node);
+    for (auto const ret_node : ret_nodes) {
+      auto const jump_node =
+          editor_.NewJump(CloneOf(ret_node->input(0))->as<Control>());
+      editor_.AppendInput(merge_node, jump_node);
+      editor_.SetPhiInput(effect_phi, jump_node,
+                          CloneOf(ret_node->input(1))->as<Effect>());
+      if (phi) {
+        editor_.SetPhiInput(phi, jump_node,
+                            CloneOf(ret_node->input(2))->as<Data>());
+      }
+    }
+    control = merge_node;
+    effect = effect_phi;
+    value = phi ? static_cast<Data*>(phi) : editor_.void_value();
+  }
+  growth_ += node_map_.size();
+  node_map_.clear();
+
+  // Replace users of call.
+  std::vector<Node*> users;
+  for (auto const edge : call->use_edges())
+    users.push_back(edge->from());
+  for (auto const user : users) {
+    if (user->is<GetEffectNode>()) {
+      editor_.ReplaceAllUses(effect, user);
+      editor_.Discard(user);
+      continue;
+    }
+    if (user->is<GetDataNode>()) {
+      editor_.ReplaceAllUses(value, user);
+      editor_.Discard(user);
+    }
+  }
+  editor_.ReplaceAllUses(control, call);
+  auto const arguments = call->input(3);
+  editor_.Discard(call);
+  if (arguments->is<TupleNode>() && !arguments->IsUsed())
+    editor_.Discard(arguments);
+}
+
+Node* InlinePass::NewNodeLike(Node* node) {
+  DCHECK(IsClonable(node)) << *node;
+  auto const input_count = node->CountInputs();
+  std::vector<Node*> inputs(input_count);
+  for (size_t index = 0; index < input_count; ++index)
+    inputs[index] = CloneOf(node->input(index));
+  auto const control = [&inputs](size_t index) {
+    return inputs[index]->as<Control>();
+  };
+  auto const data = [&inputs](size_t index) {
+    return inputs[index]->as<Data>();
+  };
+  auto const effect = [&inputs](size_t index) {
+    return inputs[index]->as<Effect>();
+  };
+
+  switch (node->opcode()) {
+#define V(Name, ...)    \
+  case Opcode::Name:    \
+    return editor_.New##Name(data(0), data(1));
+    FOR_EACH_OPTIMIZER_CONCRETE_ARITHMETIC_NODE(V)
+#undef V
+    case Opcode::Call:
+      return editor_.NewCall(control(0), effect(1), data(2), inputs[3]);
+    case Opcode::DynamicCast:
+      return editor_.NewDynamicCast(node->output_type(), data(0));
+    case Opcode::Element:
+      return editor_.NewElement(data(0), inputs[1], control(2));
+    case Opcode::Field:
+      return editor_.NewField(
+          node->output_type()->as<PointerType>()->pointee(), data(0), data(1));
+    case Opcode::FloatCmp:
+      return editor_.NewFloatCmp(node->as<FloatCmpNode>()->condition(),
+                                 data(0), data(1));
+    case Opcode::Get:
+      return editor_.NewGet(inputs[0]->as<Tuple>(), node->field());
+    case Opcode::GetData:
+      return editor_.NewGetData(control(0));
+    case Opcode::GetEffect:
+      return editor_.NewGetEffect(control(0));
+    case Opcode::GetTuple:
+      return editor_.NewGetTuple(control(0));
+    case Opcode::If:
+      return editor_.NewIf(control(0), data(1));
+    case Opcode::IfFalse:
+      return editor_.NewIfFalse(control(0));
+    case Opcode::IfTrue:
+      return editor_.NewIfTrue(control(0));
+    case Opcode::IntCmp:
+      return editor_.NewIntCmp(node->as<IntCmpNode>()->condition(), data(0),
+                               data(1));
+    case Opcode::IntShl:
+      return editor_.NewIntShl(data(0), data(1));
+    case Opcode::IntShr:
+      return editor_.NewIntShr(data(0), data(1));
+    case Opcode::Jump:
+      return editor_.NewJump(control(0));
+    case Opcode::Length:
+      return editor_.NewLength(data(0),
+                               node->input(1)->as<Int32Node>()->data());
+    case Opcode::Load:
+      return editor_.NewLoad(effect(0), data(1), data(2));
+    case Opcode::PointerAdd:
+      return editor_.NewPointerAdd(data(0), data(1));
+    case Opcode::StaticCast:
+      return editor_.NewStaticCast(node->output_type(), data(0));
+    case Opcode::Store:
+      return editor_.NewStore(effect(0), data(1), data(2), data(3));
+    case Opcode::Throw:
+      return editor_.NewThrow(control(0), data(1));
+    case Opcode::Tuple:
+      return editor_.NewTuple(inputs);
+  }
+  NOTREACHED() << "Unexpected node " << *node;
+  return nullptr;
+}
+
+size_t InlinePass::SizeBudgetOf(CallNode* call) const {
+  if (growth_ >= kMaxGrowth)
+    return 0;
+  auto const budget =
+      nodes_in_loop_.count(call) ? kMaxInlineSizeInLoop : kMaxInlineSize;
+  return std::min(budget, kMaxGrowth - growth_);
+}
+
+void InlinePass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  auto const nodes = CollectNodes(editor_.function());
+  CollectNodesInLoop(nodes);
+
+  // Note: We don't inline calls introduced by inlining.
+  std::vector<CallNode*> calls;
+  for (auto const node : nodes) {
+    if (auto const call = node->as<CallNode>())
+      calls.push_back(call);
+  }
+
+  for (auto const call : calls) {
+    if (!CanInline(call))
+      continue;
+    auto const callee_nodes = CollectNodes(CalleeOf(call));
+    auto size = static_cast<size_t>(0);
+    auto clonable = true;
+    for (auto const node : callee_nodes) {
+      // Note: Only |ParameterNode| and |GetEffectNode| take data and effect
+      // from |EntryNode|.
+      if (!IsClonable(node) ||
+          ((node->is<GetDataNode>() || node->is<GetTupleNode>()) &&
+           node->input(0)->is<EntryNode>())) {
+        clonable = false;
+        break;
+      }
+      if (!node->IsLiteral())
+        ++size;
+    }
+    if (!clonable || size > SizeBudgetOf(call))
+      continue;
+    Inline(call, callee_nodes);
+  }
+  nodes_in_loop_.clear();
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece InlinePass::name() const {
+  return "inline";
+}
+
+void InlinePass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void InlinePass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
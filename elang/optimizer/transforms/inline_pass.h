@@ -0,0 +1,83 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_INLINE_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_INLINE_PASS_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class CallNode;
+class Editor;
+class Function;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// InlinePass replaces |CallNode| whose callee is |FunctionReferenceNode|, or
+// |ReferenceNode| naming function registered in |Factory|, with a copy of
+// callee's graph:
+//  - |EntryNode| of callee is mapped to control input of call.
+//  - |GetEffectNode| of callee entry is mapped to effect input of call.
+//  - |ParameterNode| is mapped to argument of call.
+//  - Control, effect and value of |RetNode| replace users of call. If
+//    callee has multiple |RetNode|, they are merged into new |MergeNode|
+//    with |EffectPhiNode| and |PhiNode|.
+//  - |ThrowNode| is added to exit of caller, since we don't inline calls
+//    in exception handler.
+//
+// We inline callee if number of nodes in callee is less than budget. Calls
+// in loop have larger budget than others, since they are executed many
+// times. Calls introduced by inlining aren't inlined in same pass to avoid
+// exponential growth.
+//
+class ELANG_OPTIMIZER_EXPORT InlinePass final : public api::Pass {
+ public:
+  explicit InlinePass(Editor* editor);
+  ~InlinePass();
+
+  void Run();
+
+ private:
+  Node* ArgumentAt(CallNode* call, size_t index) const;
+  Function* CalleeOf(const CallNode* call) const;
+  bool CanInline(CallNode* call) const;
+  Node* CloneOf(Node* node);
+  void CollectNodesInLoop(const std::vector<Node*>& nodes);
+  void Inline(CallNode* call, const std::vector<Node*>& callee_nodes);
+  Node* NewNodeLike(Node* node);
+  size_t SizeBudgetOf(CallNode* call) const;
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+
+  // Number of nodes added to function by this pass.
+  size_t growth_;
+
+  // A map from callee node to caller node during inlining a call.
+  std::unordered_map<Node*, Node*> node_map_;
+
+  // Control nodes in loops of function.
+  std::unordered_set<Node*> nodes_in_loop_;
+
+  DISALLOW_COPY_AND_ASSIGN(InlinePass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_INLINE_PASS_H_
@@ -0,0 +1,193 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/factory.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/inline_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// InlinePassTest
+//
+class InlinePassTest : public testing::OptimizerTest {
+ protected:
+  InlinePassTest() = default;
+  ~InlinePassTest() override = default;
+
+  // Returns a function which calls |callee| with |param0| and |42|.
+  Function* NewCaller(Data* callee);
+
+  // Returns a function which returns sum of two parameters.
+  Function* NewSampleCallee();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(InlinePassTest);
+};
+
+Function* InlinePassTest::NewCaller(Data* callee) {
+  auto const function =
+      NewFunction(NewFunctionType(int32_type(), int32_type()));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+  editor.Edit(entry_node);
+  auto const arguments = NewTuple({editor.ParameterAt(0), NewInt32(42)});
+  auto const call = NewCall(entry_node, effect, callee, arguments);
+  editor.Commit();
+  editor.Edit(call);
+  editor.SetRet(NewGetEffect(call), NewGetData(call));
+  editor.Commit();
+  return function;
+}
+
+Function* InlinePassTest::NewSampleCallee() {
+  auto const callee = NewFunction(NewFunctionType(
+      int32_type(), NewTupleType({int32_type(), int32_type()})));
+  Editor editor(factory(), callee);
+  auto const entry_node = callee->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+  editor.Edit(entry_node);
+  editor.SetRet(effect,
+                NewIntAdd(editor.ParameterAt(0), editor.ParameterAt(1)));
+  editor.Commit();
+  return callee;
+}
+
+TEST_F(InlinePassTest, Basic) {
+  auto const callee = NewSampleCallee();
+  auto const caller = NewCaller(NewFunctionReference(callee));
+  Editor editor(factory(), caller);
+  InlinePass(&editor).Run();
+
+  auto const ret_node = caller->exit_node()->input(0)->input(0);
+  ASSERT_TRUE(ret_node->is<RetNode>());
+  EXPECT_EQ(caller->entry_node(), ret_node->input(0));
+  auto const add = ret_node->input(2);
+  ASSERT_TRUE(add->is<IntAddNode>());
+  EXPECT_TRUE(add->input(0)->is<ParameterNode>());
+  EXPECT_EQ(NewInt32(42), add->input(1));
+}
+
+TEST_F(InlinePassTest, MultipleRet) {
+  auto const callee = NewFunction(NewFunctionType(
+      int32_type(), NewTupleType({int32_type(), int32_type()})));
+  {
+    Editor editor(factory(), callee);
+    auto const entry_node = callee->entry_node();
+    auto const effect = NewGetEffect(entry_node);
+    editor.Edit(entry_node);
+    auto const param0 = editor.ParameterAt(0);
+    auto const param1 = editor.ParameterAt(1);
+    auto const if_node = editor.SetBranch(
+        NewIntCmp(IntCondition::SignedLessThan, param0, param1));
+    auto const if_true = NewIfTrue(if_node);
+    auto const if_false = NewIfFalse(if_node);
+    editor.Commit();
+
+    editor.Edit(if_true);
+    editor.SetRet(effect, param0);
+    editor.Commit();
+
+    editor.Edit(if_false);
+    editor.SetRet(effect, param1);
+    editor.Commit();
+  }
+
+  auto const caller = NewCaller(NewFunctionReference(callee));
+  Editor editor(factory(), caller);
+  InlinePass(&editor).Run();
+
+  auto const ret_node = caller->exit_node()->input(0)->input(0);
+  ASSERT_TRUE(ret_node->is<RetNode>());
+  auto const merge_node = ret_node->input(0);
+  ASSERT_TRUE(merge_node->is<MergeNode>());
+  EXPECT_EQ(2u, merge_node->CountInputs());
+  auto const phi = ret_node->input(2);
+  ASSERT_TRUE(phi->is<PhiNode>());
+  EXPECT_EQ(merge_node, phi->as<PhiNode>()->owner());
+  EXPECT_EQ(merge_node->as<MergeNode>()->effect_phi(), ret_node->input(1));
+}
+
+// Callee which throws exception.
+TEST_F(InlinePassTest, Throw) {
+  auto const callee = NewFunction(NewFunctionType(
+      int32_type(), NewTupleType({int32_type(), int32_type()})));
+  {
+    Editor editor(factory(), callee);
+    auto const entry_node = callee->entry_node();
+    auto const effect = NewGetEffect(entry_node);
+    editor.Edit(entry_node);
+    auto const param0 = editor.ParameterAt(0);
+    auto const param1 = editor.ParameterAt(1);
+    auto const if_node = editor.SetBranch(
+        NewIntCmp(IntCondition::SignedLessThan, param0, param1));
+    auto const if_true = NewIfTrue(if_node);
+    auto const if_false = NewIfFalse(if_node);
+    editor.Commit();
+
+    editor.Edit(if_true);
+    editor.SetRet(effect, param0);
+    editor.Commit();
+
+    editor.Edit(if_false);
+    editor.SetThrow(param1);
+    editor.Commit();
+  }
+
+  auto const caller = NewCaller(NewFunctionReference(callee));
+  Editor editor(factory(), caller);
+  InlinePass(&editor).Run();
+
+  auto const exit_merge = caller->exit_node()->input(0);
+  ASSERT_EQ(2u, exit_merge->CountInputs());
+  auto const ret_node = exit_merge->input(0);
+  ASSERT_TRUE(ret_node->is<RetNode>());
+  EXPECT_TRUE(ret_node->input(0)->is<IfTrueNode>());
+  EXPECT_TRUE(ret_node->input(2)->is<ParameterNode>());
+  auto const throw_node = exit_merge->input(1);
+  ASSERT_TRUE(throw_node->is<ThrowNode>());
+  EXPECT_TRUE(throw_node->input(0)->is<IfFalseNode>());
+  EXPECT_EQ(NewInt32(42), throw_node->input(1));
+}
+
+// Front-end refers callee by name.
+TEST_F(InlinePassTest, ReferenceByName) {
+  auto const callee = NewSampleCallee();
+  auto const name = NewAtomicString(L"Sample.Add(int, int)");
+  factory()->RegisterFunction(name, callee);
+  auto const caller =
+      NewCaller(NewReference(callee->function_type(), name));
+  Editor editor(factory(), caller);
+  InlinePass(&editor).Run();
+
+  auto const ret_node = caller->exit_node()->input(0)->input(0);
+  ASSERT_TRUE(ret_node->is<RetNode>());
+  EXPECT_EQ(caller->entry_node(), ret_node->input(0));
+  EXPECT_TRUE(ret_node->input(2)->is<IntAddNode>());
+}
+
+// Unregistered name can not be inlined.
+TEST_F(InlinePassTest, ReferenceByNameUnknown) {
+  auto const callee = NewSampleCallee();
+  auto const name = NewAtomicString(L"Sample.Unknown(int, int)");
+  auto const caller =
+      NewCaller(NewReference(callee->function_type(), name));
+  Editor editor(factory(), caller);
+  InlinePass(&editor).Run();
+
+  auto const ret_node = caller->exit_node()->input(0)->input(0);
+  ASSERT_TRUE(ret_node->is<RetNode>());
+  EXPECT_TRUE(ret_node->input(2)->is<GetDataNode>());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,246 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/optimizer/transforms/load_store_pass.h"
+
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+// Returns immediate dominator of block containing |control| or previous
+// control node in same block. Since we don't compute dominator tree, we
+// return |nullptr| for merge node.
+Node* DominatorOf(Node* control) {
+  if (control->is<EntryNode>())
+    return nullptr;
+  if (control->is<MergeNode>())
+    return control->CountInputs() == 1 ? control->input(0) : nullptr;
+  return control->input(0);
+}
+
+// Returns true if |pointer1| is valid where |pointer2| is valid. Element
+// pointer is valid only in blocks dominated by its control, e.g. 'if_true' of
+// bounds check, other pointers are valid everywhere.
+bool IsValidAt(Node* pointer1, Node* pointer2) {
+  if (!pointer1->is<ElementNode>())
+    return true;
+  if (!pointer2->is<ElementNode>())
+    return false;
+  auto const control = pointer1->input(2);
+  for (auto runner = pointer2->input(2); runner; runner = DominatorOf(runner)) {
+    if (runner == control)
+      return true;
+  }
+  return false;
+}
+
+bool IsFieldOrElement(const Node* node) {
+  return node->is<FieldNode>() || node->is<ElementNode>();
+}
+
+// Returns true if |pointer1| and |pointer2| always point same location.
+bool IsSameLocation(const Node* pointer1, const Node* pointer2) {
+  if (pointer1 == pointer2)
+    return true;
+  if (pointer1->opcode() != pointer2->opcode() || !IsFieldOrElement(pointer1))
+    return false;
+  return pointer1->input(0) == pointer2->input(0) &&
+         pointer1->input(1) == pointer2->input(1);
+}
+
+}  // namespace
+
+LoadStorePass::LoadStorePass(Editor* editor)
+    : api::Pass(editor->pass_controller()),
+      editor_(*editor),
+      heap_alloc_name_(editor->NewAtomicString(L"HeapAlloc")) {
+}
+
+LoadStorePass::~LoadStorePass() {
+}
+
+// Returns stored value or earlier load of location read by |load|, or
+// |nullptr| if we can't find them. Since loads aren't ordered by control, we
+// use a load reading same location only if it is guarded by bounds check
+// dominating |load|, e.g. we don't use load in another arm of diamond.
+Node* LoadStorePass::FindLoadedValue(Node* load) const {
+  auto const pointer = load->input(2);
+  for (auto effect = load->input(0); effect;
+       effect = PreviousEffectOf(effect, pointer)) {
+    if (effect->is<StoreNode>() && IsSameLocation(effect->input(2), pointer))
+      return effect->input(3);
+    for (auto const edge : effect->use_edges()) {
+      auto const user = edge->from();
+      if (user != load && user->is<LoadNode>() &&
+          IsSameLocation(user->input(2), pointer) &&
+          IsValidAt(user->input(2), pointer)) {
+        return user;
+      }
+    }
+  }
+  return nullptr;
+}
+
+bool LoadStorePass::IsHeapAlloc(Node* node) const {
+  if (!node->is<CallNode>())
+    return false;
+  auto const callee = node->input(2)->as<ReferenceNode>();
+  return callee && callee->name() == heap_alloc_name_;
+}
+
+bool LoadStorePass::IsFresh(Node* node) const {
+  if (node->is<StackAllocNode>())
+    return true;
+  return node->is<GetDataNode>() && IsHeapAlloc(node->input(0));
+}
+
+bool LoadStorePass::MayAlias(Node* pointer1, Node* pointer2) const {
+  if (IsSameLocation(pointer1, pointer2))
+    return true;
+  if (pointer1->output_type() != pointer2->output_type())
+    return false;
+  if (!IsFieldOrElement(pointer1) || !IsFieldOrElement(pointer2))
+    return true;
+  if (pointer1->opcode() != pointer2->opcode())
+    return false;
+  if (pointer1->is<FieldNode>() && pointer1->input(1) != pointer2->input(1))
+    return false;
+  auto const base1 = pointer1->input(0);
+  auto const base2 = pointer2->input(0);
+  return base1 == base2 || !IsFresh(base1) || !IsFresh(base2);
+}
+
+// Returns effect before |effect| if |effect| doesn't write location pointed
+// by |pointer|, otherwise returns |nullptr|.
+Node* LoadStorePass::PreviousEffectOf(Node* effect, Node* pointer) const {
+  if (effect->is<StoreNode>())
+    return MayAlias(effect->input(2), pointer) ? nullptr : effect->input(0);
+  if (!effect->is<GetEffectNode>())
+    return nullptr;
+  auto const call = effect->input(0);
+  if (!IsHeapAlloc(call))
+    return nullptr;
+  // Allocation writes only allocated object.
+  auto const object = call->SelectUser(Opcode::GetData);
+  if (object && IsFieldOrElement(pointer) && pointer->input(0) == object)
+    return nullptr;
+  return call->input(1);
+}
+
+// Removes stores to location written by |store| which nobody reads before
+// |store|.
+void LoadStorePass::RemoveDeadStores(Node* store) {
+  auto const pointer = store->input(2);
+  auto next = store;
+  auto effect = store->input(0);
+  while (effect->is<StoreNode>()) {
+    // |effect| should be used only by |next| and loads which don't read
+    // |pointer|.
+    for (auto const edge : effect->use_edges()) {
+      auto const user = edge->from();
+      if (user == next)
+        continue;
+      if (user->is<LoadNode>() && !MayAlias(user->input(2), pointer))
+        continue;
+      return;
+    }
+    auto const previous = effect->input(0);
+    if (IsSameLocation(effect->input(2), pointer)) {
+      DVLOG(1) << "Remove dead store " << *effect;
+      editor_.ReplaceAllUses(previous, effect);
+      editor_.Discard(effect);
+    } else if (MayAlias(effect->input(2), pointer)) {
+      return;
+    } else {
+      next = effect;
+    }
+    effect = previous;
+  }
+}
+
+void LoadStorePass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(editor_.function(), &collector);
+
+  // Note: Nodes discarded in this pass have no users.
+  for (auto const node : collector.nodes()) {
+    if (!node->is<LoadNode>() || !node->IsUsed())
+      continue;
+    auto const value = FindLoadedValue(node);
+    if (!value)
+      continue;
+    DVLOG(1) << "Replace " << *node << " with " << *value;
+    editor_.ReplaceAllUses(value, node);
+    editor_.Discard(node);
+  }
+
+  for (auto const node : collector.nodes()) {
+    if (!node->is<StoreNode>() || !node->IsUsed())
+      continue;
+    RemoveDeadStores(node);
+  }
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece LoadStorePass::name() const {
+  return "load_store";
+}
+
+void LoadStorePass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void LoadStorePass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,70 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_LOAD_STORE_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_LOAD_STORE_PASS_H_
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+class AtomicString;
+namespace optimizer {
+
+class Editor;
+class Node;
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoadStorePass walks effect chain backward from |LoadNode| and |StoreNode|
+// to do:
+//  - Store-to-load forwarding: Replace load with value stored by the nearest
+//    store to same location.
+//  - Redundant load elimination: Replace load with earlier load from same
+//    location.
+//  - Dead store elimination: Remove store overwritten by later store to same
+//    location before anyone reads it.
+//
+// We use simple alias model; two locations don't alias if
+//  - They have different types, e.g. elements of |int32[]| and |float64[]|.
+//  - They are fields of different name.
+//  - One is field and another is array element.
+//  - They are in different fresh allocations, e.g. |StackAllocNode| or
+//    result of |HeapAlloc| call.
+//
+// Walking stops at |EffectPhiNode| and call other than |HeapAlloc|, since
+// we don't know what they write.
+//
+class ELANG_OPTIMIZER_EXPORT LoadStorePass final : public api::Pass {
+ public:
+  explicit LoadStorePass(Editor* editor);
+  ~LoadStorePass();
+
+  void Run();
+
+ private:
+  Node* FindLoadedValue(Node* load) const;
+  bool IsHeapAlloc(Node* node) const;
+  bool IsFresh(Node* node) const;
+  bool MayAlias(Node* pointer1, Node* pointer2) const;
+  Node* PreviousEffectOf(Node* effect, Node* pointer) const;
+  void RemoveDeadStores(Node* store);
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+  AtomicString* const heap_alloc_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadStorePass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_LOAD_STORE_PASS_H_
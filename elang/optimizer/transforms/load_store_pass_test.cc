@@ -0,0 +1,158 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/load_store_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoadStorePassTest
+//
+class LoadStorePassTest : public testing::OptimizerTest {
+ protected:
+  LoadStorePassTest() = default;
+  ~LoadStorePassTest() override = default;
+
+  Type* NewArrayPointerType(Type* element_type) {
+    return NewPointerType(NewArrayType(element_type, {-1}));
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LoadStorePassTest);
+};
+
+TEST_F(LoadStorePassTest, DeadStore) {
+  auto const function = NewSampleFunction(
+      void_type(), {NewArrayPointerType(int32_type()), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const element = NewElement(array, editor.ParameterAt(1), entry_node);
+  auto const store1 = NewStore(effect, array, element, NewInt32(1));
+  auto const store2 = NewStore(store1, array, element, NewInt32(2));
+  auto const ret_node = editor.SetRet(store2, void_value());
+  editor.Commit();
+
+  LoadStorePass(&editor).Run();
+
+  EXPECT_EQ(store2, ret_node->input(1));
+  EXPECT_EQ(effect, store2->input(0));
+  EXPECT_FALSE(store1->IsUsed());
+}
+
+TEST_F(LoadStorePassTest, RedundantLoad) {
+  auto const function = NewSampleFunction(
+      int32_type(), {NewArrayPointerType(int32_type()),
+                     NewArrayPointerType(float64_type()), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array1 = editor.ParameterAt(0);
+  auto const array2 = editor.ParameterAt(1);
+  auto const index = editor.ParameterAt(2);
+  auto const element1 = NewElement(array1, index, entry_node);
+  auto const load1 = NewLoad(effect, array1, element1);
+  // Store to |float64| array doesn't change |int32| array.
+  auto const store =
+      NewStore(effect, array2, NewElement(array2, index, entry_node),
+               NewFloat64(1.0));
+  auto const load2 = NewLoad(store, array1, element1);
+  auto const ret_node = editor.SetRet(store, NewIntAdd(load1, load2));
+  editor.Commit();
+
+  LoadStorePass(&editor).Run();
+
+  auto const add = ret_node->input(2);
+  ASSERT_TRUE(add->is<IntAddNode>());
+  EXPECT_EQ(add->input(0), add->input(1));
+}
+
+// Loads of |a[i]| in both arms of diamond are guarded by different controls,
+// so we don't unify them. Load of |a[j]| in |if_true| is dominated by load in
+// entry block.
+TEST_F(LoadStorePassTest, RedundantLoadDiamond) {
+  auto const function = NewSampleFunction(
+      int32_type(), {NewArrayPointerType(int32_type()), bool_type(),
+                     int32_type(), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const index_i = editor.ParameterAt(2);
+  auto const index_j = editor.ParameterAt(3);
+  auto const load_j0 =
+      NewLoad(effect, array, NewElement(array, index_j, entry_node));
+  auto const if_node = editor.SetBranch(editor.ParameterAt(1));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+
+  editor.Edit(if_true);
+  auto const load_i1 =
+      NewLoad(effect, array, NewElement(array, index_i, if_true));
+  auto const load_j1 =
+      NewLoad(effect, array, NewElement(array, index_j, if_true));
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  auto const load_i2 =
+      NewLoad(effect, array, NewElement(array, index_i, if_false));
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const phi = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi, merge_node->control(0), NewIntAdd(load_i1, load_j1));
+  editor.SetPhiInput(phi, merge_node->control(1), load_i2);
+  editor.SetRet(effect, NewIntAdd(phi, load_j0));
+  editor.Commit();
+
+  LoadStorePass(&editor).Run();
+
+  EXPECT_TRUE(load_i1->IsUsed());
+  EXPECT_TRUE(load_i2->IsUsed());
+  EXPECT_FALSE(load_j1->IsUsed());
+  EXPECT_EQ(load_j0, phi->input(0)->input(1));
+}
+
+TEST_F(LoadStorePassTest, StoreToLoad) {
+  auto const function = NewSampleFunction(
+      int32_type(), {NewArrayPointerType(int32_type()), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const element = NewElement(array, editor.ParameterAt(1), entry_node);
+  auto const store = NewStore(effect, array, element, NewInt32(42));
+  auto const ret_node =
+      editor.SetRet(store, NewLoad(store, array, element));
+  editor.Commit();
+
+  LoadStorePass(&editor).Run();
+
+  EXPECT_EQ(NewInt32(42), ret_node->input(2));
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,857 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "elang/optimizer/transforms/loop_pass.h"
+
+#include "base/logging.h"
+#include "elang/api/pass_controller.h"
+#include "elang/base/analysis/loop_tree_builder.h"
+#include "elang/base/zone_allocated.h"
+#include "elang/base/zone_owner.h"
+#include "elang/base/zone_vector.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+// Default number of copies of loop body in unrolled loop.
+const int kDefaultUnrollFactor = 4;
+// Maximum number of nodes in loop body to peel.
+const size_t kMaxPeelSize = 50;
+// Maximum number of nodes in unrolled loop body.
+const size_t kMaxUnrollSize = 200;
+
+//////////////////////////////////////////////////////////////////////
+//
+// ControlGraph is a graph of control nodes for building |LoopTree|.
+//
+class ControlGraph final : public ZoneOwner {
+ public:
+  class GraphNode final : public ZoneAllocated {
+   public:
+    GraphNode(Zone* zone, Node* node) : node_(node), successors_(zone) {}
+    ~GraphNode() = delete;
+
+    Node* node() const { return node_; }
+    const ZoneVector<GraphNode*>& successors() const { return successors_; }
+
+   private:
+    friend class ControlGraph;
+
+    Node* const node_;
+    ZoneVector<GraphNode*> successors_;
+
+    DISALLOW_COPY_AND_ASSIGN(GraphNode);
+  };
+
+  explicit ControlGraph(const Function* function);
+  ~ControlGraph() = default;
+
+  GraphNode* first_node() const { return first_node_; }
+
+ private:
+  GraphNode* GraphNodeOf(Node* node);
+
+  GraphNode* first_node_;
+  std::unordered_map<Node*, GraphNode*> map_;
+
+  DISALLOW_COPY_AND_ASSIGN(ControlGraph);
+};
+
+ControlGraph::ControlGraph(const Function* function) : first_node_(nullptr) {
+  first_node_ = GraphNodeOf(function->entry_node());
+  std::vector<GraphNode*> stack{first_node_};
+  while (!stack.empty()) {
+    auto const graph_node = stack.back();
+    stack.pop_back();
+    for (auto const edge : graph_node->node()->use_edges()) {
+      auto const user = edge->from();
+      if (!user->IsControl())
+        continue;
+      auto const is_new = !map_.count(user);
+      auto const successor = GraphNodeOf(user);
+      graph_node->successors_.push_back(successor);
+      if (is_new)
+        stack.push_back(successor);
+    }
+  }
+}
+
+ControlGraph::GraphNode* ControlGraph::GraphNodeOf(Node* node) {
+  auto const it = map_.find(node);
+  if (it != map_.end())
+    return it->second;
+  auto const graph_node = new (zone()) GraphNode(zone(), node);
+  map_[node] = graph_node;
+  return graph_node;
+}
+
+// Returns true if we can copy |node| in loop body.
+bool IsClonable(const Node* node) {
+  switch (node->opcode()) {
+#define V(Name, ...) case Opcode::Name:
+    FOR_EACH_OPTIMIZER_CONCRETE_ARITHMETIC_NODE(V)
+#undef V
+    case Opcode::Call:
+    case Opcode::DynamicCast:
+    case Opcode::EffectPhi:
+    case Opcode::Element:
+    case Opcode::Field:
+    case Opcode::FloatCmp:
+    case Opcode::Get:
+    case Opcode::GetData:
+    case Opcode::GetEffect:
+    case Opcode::GetTuple:
+    case Opcode::If:
+    case Opcode::IfFalse:
+    case Opcode::IfTrue:
+    case Opcode::IntCmp:
+    case Opcode::IntShl:
+    case Opcode::IntShr:
+    case Opcode::Jump:
+    case Opcode::Length:
+    case Opcode::Load:
+    case Opcode::Merge:
+    case Opcode::Phi:
+    case Opcode::PointerAdd:
+    case Opcode::Ret:
+    case Opcode::StaticCast:
+    case Opcode::Store:
+    case Opcode::Throw:
+    case Opcode::Tuple:
+      return true;
+  }
+  return false;
+}
+
+// Returns owner of |node| if |node| is |PhiNode| or |EffectPhiNode|.
+PhiOwnerNode* PhiOwnerOf(Node* node) {
+  if (auto const phi = node->as<PhiNode>())
+    return phi->owner();
+  if (auto const phi = node->as<EffectPhiNode>())
+    return phi->owner();
+  return nullptr;
+}
+
+// Returns value of |phi| coming from |control|.
+template <typename Phi>
+Node* PhiInputOf(Phi* phi, Node* control) {
+  for (auto const phi_input : phi->phi_inputs()) {
+    if (phi_input->control() == control)
+      return phi_input->value();
+  }
+  NOTREACHED() << *phi << " " << *control;
+  return nullptr;
+}
+
+// Returns users of |node| as vector, since editing edges during iterating
+// |use_edges()| isn't safe.
+std::vector<Node*> UsersOf(Node* node) {
+  std::vector<Node*> users;
+  for (auto const edge : node->use_edges())
+    users.push_back(edge->from());
+  return users;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoopPass::LoopBody
+//
+struct LoopPass::LoopBody {
+  // Returns true if |node| is loop header or phi of loop header.
+  bool IsHeader(Node* node) const;
+  // Returns true if |node| is in loop, or phi of exit target which takes
+  // values from loop exits.
+  bool IsInside(Node* node) const;
+
+  LoopNode* loop;
+  Control* entry_jump;
+  Control* back_jump;
+
+  // Control nodes in loop including |loop|.
+  std::unordered_set<Node*> controls;
+
+  // Nodes depending on control nodes and phis in loop.
+  std::unordered_set<Node*> dependents;
+
+  // Block end nodes of loop exit, e.g. |JumpNode| to outside of loop,
+  // |RetNode| and |ThrowNode|.
+  std::vector<Node*> exits;
+
+  // Merge nodes targeted by |JumpNode| in |exits|.
+  std::unordered_set<Node*> exit_targets;
+
+  // Nodes to copy: control nodes except for |loop|, loop exits, and data and
+  // effect nodes in |dependents| used in loop.
+  std::unordered_set<Node*> nodes;
+
+  // Nodes in loop used outside of loop without phi of exit target.
+  std::vector<Node*> escaped_nodes;
+};
+
+bool LoopPass::LoopBody::IsHeader(Node* node) const {
+  return node == loop || PhiOwnerOf(node) == loop;
+}
+
+bool LoopPass::LoopBody::IsInside(Node* node) const {
+  if (nodes.count(node) || IsHeader(node))
+    return true;
+  auto const owner = PhiOwnerOf(node);
+  return owner && exit_targets.count(owner);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoopPass
+//
+LoopPass::LoopPass(Editor* editor) : LoopPass(editor, kDefaultUnrollFactor) {
+}
+
+LoopPass::LoopPass(Editor* editor, int unroll_factor)
+    : api::Pass(editor->pass_controller()),
+      editor_(*editor),
+      unroll_factor_(unroll_factor) {
+}
+
+LoopPass::~LoopPass() {
+}
+
+// Collects nodes in loop body from |controls|, control nodes in loop
+// computed by |LoopTree|. Returns false if we can't copy loop body.
+bool LoopPass::AnalyzeLoop(LoopNode* loop,
+                           const std::vector<Node*>& controls,
+                           LoopBody* body) const {
+  if (loop->CountInputs() != 2)
+    return false;
+  body->loop = loop;
+  body->entry_jump = loop->input(0)->as<Control>();
+  body->back_jump = loop->input(1)->as<Control>();
+  body->controls.insert(controls.begin(), controls.end());
+  if (!body->controls.count(body->back_jump))
+    return false;
+
+  // Collect control nodes and loop exits to copy. A loop exit should be
+  // |IfTrueNode| or |IfFalseNode| followed by |JumpNode| to |MergeNode|,
+  // |RetNode| or |ThrowNode|.
+  std::vector<Node*> stack;
+  for (auto const control : controls) {
+    if (control == loop)
+      continue;
+    if (!IsClonable(control))
+      return false;
+    body->nodes.insert(control);
+    stack.push_back(control);
+    for (auto const user : UsersOf(control)) {
+      if (!user->IsControl()) {
+        // |user| is |GetDataNode|, |GetEffectNode| or |GetTupleNode| of
+        // |CallNode|, or |ElementNode| guarded by |control|.
+        if (body->nodes.insert(user).second)
+          stack.push_back(user);
+        continue;
+      }
+      if (body->controls.count(user))
+        continue;
+      if (!user->is<IfTrueNode>() && !user->is<IfFalseNode>())
+        return false;
+      auto const exit = user->SelectUserIfOne();
+      if (!exit)
+        return false;
+      if (exit->is<JumpNode>()) {
+        auto const target = exit->SelectUserIfOne();
+        if (!target->is<MergeNode>())
+          return false;
+        body->exit_targets.insert(target);
+      } else if (!exit->is<RetNode>() && !exit->is<ThrowNode>()) {
+        return false;
+      }
+      body->nodes.insert(user);
+      body->nodes.insert(exit);
+      body->exits.push_back(exit);
+      stack.push_back(exit);
+    }
+  }
+
+  // Collect nodes depending on control nodes and phis in loop.
+  std::vector<Node*> worklist(controls.begin(), controls.end());
+  for (auto const control : controls) {
+    auto const phi_owner = control->as<PhiOwnerNode>();
+    if (!phi_owner)
+      continue;
+    for (auto const phi : phi_owner->phi_nodes()) {
+      body->dependents.insert(phi);
+      worklist.push_back(phi);
+    }
+    if (auto const effect_phi = phi_owner->effect_phi()) {
+      body->dependents.insert(effect_phi);
+      worklist.push_back(effect_phi);
+    }
+  }
+  while (!worklist.empty()) {
+    auto const node = worklist.back();
+    worklist.pop_back();
+    for (auto const edge : node->use_edges()) {
+      auto const user = edge->from();
+      if (user->IsControl())
+        continue;
+      auto const owner = PhiOwnerOf(user);
+      if (owner && !body->controls.count(owner))
+        continue;
+      if (body->dependents.insert(user).second)
+        worklist.push_back(user);
+    }
+  }
+
+  // Collect data and effect nodes used in loop and loop exits. Phis of loop
+  // header aren't copied, but their inputs from back edge are.
+  for (auto const control : controls) {
+    auto const phi_owner = control->as<PhiOwnerNode>();
+    if (!phi_owner)
+      continue;
+    for (auto const phi : phi_owner->phi_nodes())
+      stack.push_back(phi);
+    if (auto const effect_phi = phi_owner->effect_phi())
+      stack.push_back(effect_phi);
+  }
+  for (auto const exit : body->exits) {
+    if (!exit->is<JumpNode>())
+      continue;
+    auto const target = exit->SelectUserIfOne()->as<PhiOwnerNode>();
+    for (auto const phi : target->phi_nodes())
+      stack.push_back(PhiInputOf(phi, exit));
+    if (auto const effect_phi = target->effect_phi())
+      stack.push_back(PhiInputOf(effect_phi, exit));
+  }
+  for (auto const node : stack) {
+    if (body->dependents.count(node) && !body->IsHeader(node))
+      body->nodes.insert(node);
+  }
+  while (!stack.empty()) {
+    auto const node = stack.back();
+    stack.pop_back();
+    for (auto const input : node->inputs()) {
+      if (!body->dependents.count(input) || body->IsHeader(input) ||
+          !body->nodes.insert(input).second) {
+        continue;
+      }
+      stack.push_back(input);
+    }
+  }
+
+  for (auto const node : body->nodes) {
+    if (!IsClonable(node))
+      return false;
+  }
+
+  // Collect nodes used outside of loop.
+  std::vector<Node*> candidates(body->nodes.begin(), body->nodes.end());
+  for (auto const phi : loop->phi_nodes())
+    candidates.push_back(phi);
+  if (auto const effect_phi = loop->effect_phi())
+    candidates.push_back(effect_phi);
+  auto number_of_escaped_effects = 0;
+  for (auto const node : candidates) {
+    if (node->IsControl())
+      continue;
+    for (auto const edge : node->use_edges()) {
+      if (body->IsInside(edge->from()))
+        continue;
+      if (!node->IsData() && !node->IsEffect())
+        return false;
+      if (node->IsEffect())
+        ++number_of_escaped_effects;
+      body->escaped_nodes.push_back(node);
+      break;
+    }
+  }
+  if (body->escaped_nodes.empty())
+    return true;
+
+  // Escaped nodes are passed to outside of loop via new phis of exit target.
+  // So, all predecessors of exit target should be loop exits.
+  if (body->exit_targets.size() != 1)
+    return false;
+  auto const target = (*body->exit_targets.begin())->as<PhiOwnerNode>();
+  for (auto const input : target->inputs()) {
+    if (std::find(body->exits.begin(), body->exits.end(), input) ==
+        body->exits.end()) {
+      return false;
+    }
+  }
+  if (!number_of_escaped_effects)
+    return true;
+  return number_of_escaped_effects == 1 && !target->effect_phi();
+}
+
+// Returns true if |body| contains branch on loop invariant condition.
+bool LoopPass::CanPeel(const LoopBody& body) const {
+  if (body.nodes.size() > kMaxPeelSize)
+    return false;
+  for (auto const control : body.controls) {
+    if (!control->is<IfNode>())
+      continue;
+    auto const condition = control->input(1);
+    if (!condition->IsLiteral() && !body.dependents.count(condition))
+      return true;
+  }
+  return false;
+}
+
+Node* LoopPass::CloneOf(const LoopBody& body, Node* node) {
+  auto const it = node_map_.find(node);
+  if (it != node_map_.end())
+    return it->second;
+  if (!body.nodes.count(node))
+    return node;
+  auto const new_node = NewNodeLike(body, node);
+  node_map_[node] = new_node;
+  return new_node;
+}
+
+// Makes nodes used outside of loop to be used via phi of exit target, as
+// loop closed SSA form, so copies of loop body can add their values to phi.
+void LoopPass::CloseLoop(const LoopBody& body) {
+  if (body.escaped_nodes.empty())
+    return;
+  auto const target = (*body.exit_targets.begin())->as<PhiOwnerNode>();
+  for (auto const node : body.escaped_nodes) {
+    Node* phi = nullptr;
+    if (node->IsEffect()) {
+      auto const effect_phi = editor_.NewEffectPhi(target);
+      for (auto const control : target->inputs()) {
+        editor_.SetPhiInput(effect_phi, control->as<Control>(),
+                            node->as<Effect>());
+      }
+      phi = effect_phi;
+    } else {
+      auto const data_phi = editor_.NewPhi(node->output_type(), target);
+      for (auto const control : target->inputs())
+        editor_.SetPhiInput(data_phi, control->as<Control>(), node->as<Data>());
+      phi = data_phi;
+    }
+    for (auto const user : UsersOf(node)) {
+      if (body.IsInside(user))
+        continue;
+      auto const num_inputs = user->CountInputs();
+      for (size_t index = 0; index < num_inputs; ++index) {
+        if (user->input(index) == node)
+          editor_.ChangeInput(user, index, phi);
+      }
+    }
+  }
+}
+
+// Copies loop exit |exit| and connects copied one to exit target.
+void LoopPass::CopyExit(const LoopBody& body, Node* exit) {
+  auto const new_exit = CloneOf(body, exit)->as<Control>();
+  if (!exit->is<JumpNode>()) {
+    editor_.AppendInput(editor_.function()->exit_node()->input(0), new_exit);
+    return;
+  }
+  auto const target = exit->SelectUserIfOne()->as<PhiOwnerNode>();
+  editor_.AppendInput(target, new_exit);
+  for (auto const phi : target->phi_nodes()) {
+    editor_.SetPhiInput(phi, new_exit,
+                        CloneOf(body, PhiInputOf(phi, exit))->as<Data>());
+  }
+  if (auto const effect_phi = target->effect_phi()) {
+    editor_.SetPhiInput(
+        effect_phi, new_exit,
+        CloneOf(body, PhiInputOf(effect_phi, exit))->as<Effect>());
+  }
+}
+
+// Returns loop counter |i| if |body| is a counted loop:
+//   loop: i = phi(start, next) ... next = i + 1; if (next < limit) goto loop;
+// where |start| is non-negative int32 literal and |limit| is loop invariant.
+PhiNode* LoopPass::CounterOf(const LoopBody& body) const {
+  auto const back_label = body.back_jump->input(0);
+  if (!back_label->is<IfTrueNode>())
+    return nullptr;
+  auto const bottom_if = back_label->input(0);
+  auto const exit_label = bottom_if->SelectUser(Opcode::IfFalse);
+  if (!exit_label || !body.nodes.count(exit_label))
+    return nullptr;
+  auto const exit_jump = exit_label->SelectUserIfOne();
+  if (!exit_jump->is<JumpNode>())
+    return nullptr;
+  // Other exits should not have values passed to exit target.
+  for (auto const exit : body.exits) {
+    if (exit != exit_jump && exit->is<JumpNode>())
+      return nullptr;
+  }
+  auto const condition = bottom_if->input(1)->as<IntCmpNode>();
+  if (!condition || condition->condition() != IntCondition::SignedLessThan ||
+      body.dependents.count(condition->input(1))) {
+    return nullptr;
+  }
+  auto const next = condition->input(0);
+  if (!next->is<IntAddNode>() || next->input(1) != editor_.NewInt32(1))
+    return nullptr;
+  auto const counter = next->input(0)->as<PhiNode>();
+  if (!counter || counter->owner() != body.loop ||
+      PhiInputOf(counter, body.back_jump) != next) {
+    return nullptr;
+  }
+  auto const start = PhiInputOf(counter, body.entry_jump)->as<Int32Node>();
+  if (!start || start->data() < 0 ||
+      start->data() > std::numeric_limits<int32_t>::max() - unroll_factor_) {
+    return nullptr;
+  }
+  return counter;
+}
+
+Node* LoopPass::NewNodeLike(const LoopBody& body, Node* node) {
+  DCHECK(IsClonable(node)) << *node;
+  if (node->is<MergeNode>()) {
+    auto const new_merge = editor_.NewMerge({});
+    for (auto const input : node->inputs())
+      editor_.AppendInput(new_merge, CloneOf(body, input));
+    return new_merge;
+  }
+  if (auto const phi = node->as<PhiNode>()) {
+    auto const new_phi = editor_.NewPhi(
+        phi->output_type(), CloneOf(body, phi->owner())->as<PhiOwnerNode>());
+    for (auto const phi_input : phi->phi_inputs()) {
+      editor_.SetPhiInput(new_phi,
+                          CloneOf(body, phi_input->control())->as<Control>(),
+                          CloneOf(body, phi_input->value())->as<Data>());
+    }
+    return new_phi;
+  }
+  if (auto const phi = node->as<EffectPhiNode>()) {
+    auto const new_phi = editor_.NewEffectPhi(
+        CloneOf(body, phi->owner())->as<PhiOwnerNode>());
+    for (auto const phi_input : phi->phi_inputs()) {
+      editor_.SetPhiInput(new_phi,
+                          CloneOf(body, phi_input->control())->as<Control>(),
+                          CloneOf(body, phi_input->value())->as<Effect>());
+    }
+    return new_phi;
+  }
+
+  auto const input_count = node->CountInputs();
+  std::vector<Node*> inputs(input_count);
+  for (size_t index = 0; index < input_count; ++index)
+    inputs[index] = CloneOf(body, node->input(index));
+  auto const control = [&inputs](size_t index) {
+    return inputs[index]->as<Control>();
+  };
+  auto const data = [&inputs](size_t index) {
+    return inputs[index]->as<Data>();
+  };
+  auto const effect = [&inputs](size_t index) {
+    return inputs[index]->as<Effect>();
+  };
+
+  switch (node->opcode()) {
+#define V(Name, ...)    \
+  case Opcode::Name:    \
+    return editor_.New##Name(data(0), data(1));
+    FOR_EACH_OPTIMIZER_CONCRETE_ARITHMETIC_NODE(V)
+#undef V
+    case Opcode::Call:
+      return editor_.NewCall(control(0), effect(1), data(2), inputs[3]);
+    case Opcode::DynamicCast:
+      return editor_.NewDynamicCast(node->output_type(), data(0));
+    case Opcode::Element:
+      return editor_.NewElement(data(0), inputs[1], control(2));
+    case Opcode::Field:
+      return editor_.NewField(
+          node->output_type()->as<PointerType>()->pointee(), data(0), data(1));
+    case Opcode::FloatCmp:
+      return editor_.NewFloatCmp(node->as<FloatCmpNode>()->condition(),
+                                 data(0), data(1));
+    case Opcode::Get:
+      return editor_.NewGet(inputs[0]->as<Tuple>(), node->field());
+    case Opcode::GetData:
+      return editor_.NewGetData(control(0));
+    case Opcode::GetEffect:
+      return editor_.NewGetEffect(control(0));
+    case Opcode::GetTuple:
+      return editor_.NewGetTuple(control(0));
+    case Opcode::If:
+      return editor_.NewIf(control(0), data(1));
+    case Opcode::IfFalse:
+      return editor_.NewIfFalse(control(0));
+    case Opcode::IfTrue:
+      return editor_.NewIfTrue(control(0));
+    case Opcode::IntCmp:
+      return editor_.NewIntCmp(node->as<IntCmpNode>()->condition(), data(0),
+                               data(1));
+    case Opcode::IntShl:
+      return editor_.NewIntShl(data(0), data(1));
+    case Opcode::IntShr:
+      return editor_.NewIntShr(data(0), data(1));
+    case Opcode::Jump:
+      return editor_.NewJump(control(0));
+    case Opcode::Length:
+      return editor_.NewLength(data(0),
+                               node->input(1)->as<Int32Node>()->data());
+    case Opcode::Load:
+      return editor_.NewLoad(effect(0), data(1), data(2));
+    case Opcode::PointerAdd:
+      return editor_.NewPointerAdd(data(0), data(1));
+    case Opcode::Ret:
+      return editor_.NewRet(control(0), effect(1), data(2));
+    case Opcode::StaticCast:
+      return editor_.NewStaticCast(node->output_type(), data(0));
+    case Opcode::Store:
+      return editor_.NewStore(effect(0), data(1), data(2), data(3));
+    case Opcode::Throw:
+      return editor_.NewThrow(control(0), data(1));
+    case Opcode::Tuple:
+      return editor_.NewTuple(inputs);
+  }
+  NOTREACHED() << "Unexpected node " << *node;
+  return nullptr;
+}
+
+// Copies loop body before loop as the first iteration.
+void LoopPass::Peel(const LoopBody& body) {
+  DVLOG(1) << "Peel " << *body.loop;
+  auto const loop = body.loop;
+  auto const entry_jump = body.entry_jump;
+  auto const back_jump = body.back_jump;
+  auto const effect_phi = loop->effect_phi();
+
+  std::vector<Node*> values;
+  for (auto const phi : loop->phi_nodes())
+    values.push_back(PhiInputOf(phi, entry_jump));
+  StartCopy(body, entry_jump->input(0), values,
+            effect_phi ? PhiInputOf(effect_phi, entry_jump) : nullptr);
+  for (auto const exit : body.exits)
+    CopyExit(body, exit);
+
+  // Enter loop from the end of peeled iteration.
+  auto const control = CloneOf(body, back_jump->input(0));
+  values.clear();
+  for (auto const phi : loop->phi_nodes())
+    values.push_back(CloneOf(body, PhiInputOf(phi, back_jump)));
+  auto const effect =
+      effect_phi ? CloneOf(body, PhiInputOf(effect_phi, back_jump)) : nullptr;
+  node_map_.clear();
+
+  editor_.ChangeInput(entry_jump, 0, control);
+  auto value = values.begin();
+  for (auto const phi : loop->phi_nodes())
+    editor_.SetPhiInput(phi, entry_jump, (*value++)->as<Data>());
+  if (effect_phi)
+    editor_.SetPhiInput(effect_phi, entry_jump, effect->as<Effect>());
+}
+
+// Starts new copy of loop body by mapping loop header to |control|, phis of
+// loop header to |values| and effect phi of loop header to |effect|.
+void LoopPass::StartCopy(const LoopBody& body,
+                         Node* control,
+                         const std::vector<Node*>& values,
+                         Node* effect) {
+  node_map_.clear();
+  node_map_[body.loop] = control;
+  auto value = values.begin();
+  for (auto const phi : body.loop->phi_nodes())
+    node_map_[phi] = *value++;
+  if (auto const effect_phi = body.loop->effect_phi())
+    node_map_[effect_phi] = effect;
+}
+
+// Makes unrolled loop before the original loop:
+//   if (limit > start + factor - 1) {
+//     do {
+//       body(i); body(i + 1); ... body(i + factor - 1);
+//       i += factor;
+//     } while (limit - i > factor - 1);
+//     if (i >= limit) goto exit;
+//   }
+//   do { body(i); } while (++i < limit);
+// Since |start| is non-negative and |i| is less than or equal to |limit| at
+// end of unrolled loop, |limit - i| doesn't overflow.
+void LoopPass::Unroll(const LoopBody& body, PhiNode* counter) {
+  DVLOG(1) << "Unroll " << *body.loop << " by " << unroll_factor_;
+  auto const loop = body.loop;
+  auto const entry_jump = body.entry_jump;
+  auto const back_jump = body.back_jump;
+  auto const effect_phi = loop->effect_phi();
+  auto const bottom_if = back_jump->input(0)->input(0);
+  auto const last_control = bottom_if->input(0);
+  auto const exit_jump =
+      bottom_if->SelectUser(Opcode::IfFalse)->SelectUserIfOne();
+  auto const exit_target = exit_jump->SelectUserIfOne()->as<PhiOwnerNode>();
+  auto const limit = bottom_if->input(1)->input(1)->as<Data>();
+  auto const start = PhiInputOf(counter, entry_jump)->as<Int32Node>()->data();
+
+  auto const main_if = editor_.NewIf(
+      entry_jump->input(0)->as<Control>(),
+      editor_.NewIntCmp(IntCondition::SignedGreaterThan, limit,
+                        editor_.NewInt32(start + unroll_factor_ - 1)));
+  auto const main_loop = editor_.NewLoop();
+  auto const main_entry = editor_.NewJump(editor_.NewIfTrue(main_if));
+  editor_.AppendInput(main_loop, main_entry);
+  std::vector<PhiNode*> main_phis;
+  std::vector<Node*> values;
+  for (auto const phi : loop->phi_nodes()) {
+    auto const main_phi = editor_.NewPhi(phi->output_type(), main_loop);
+    editor_.SetPhiInput(main_phi, main_entry,
+                        PhiInputOf(phi, entry_jump)->as<Data>());
+    main_phis.push_back(main_phi);
+    values.push_back(main_phi);
+  }
+  EffectPhiNode* main_effect_phi = nullptr;
+  Node* effect = nullptr;
+  if (effect_phi) {
+    main_effect_phi = editor_.NewEffectPhi(main_loop);
+    editor_.SetPhiInput(main_effect_phi, main_entry,
+                        PhiInputOf(effect_phi, entry_jump)->as<Effect>());
+    effect = main_effect_phi;
+  }
+
+  // Copy loop body without the bottom compare and branch, since it is true
+  // except for the last copy.
+  Node* control = main_loop;
+  for (auto count = 0; count < unroll_factor_; ++count) {
+    StartCopy(body, control, values, effect);
+    for (auto const exit : body.exits) {
+      if (exit != exit_jump)
+        CopyExit(body, exit);
+    }
+    control = CloneOf(body, last_control);
+    values.clear();
+    for (auto const phi : loop->phi_nodes())
+      values.push_back(CloneOf(body, PhiInputOf(phi, back_jump)));
+    if (effect_phi)
+      effect = CloneOf(body, PhiInputOf(effect_phi, back_jump));
+  }
+  auto const next = CloneOf(body, PhiInputOf(counter, back_jump))->as<Data>();
+  std::vector<Node*> exit_values;
+  for (auto const phi : exit_target->phi_nodes())
+    exit_values.push_back(CloneOf(body, PhiInputOf(phi, exit_jump)));
+  auto const exit_effect =
+      exit_target->effect_phi()
+          ? CloneOf(body, PhiInputOf(exit_target->effect_phi(), exit_jump))
+          : nullptr;
+  node_map_.clear();
+
+  auto const main_bottom = editor_.NewIf(
+      control->as<Control>(),
+      editor_.NewIntCmp(IntCondition::SignedGreaterThan,
+                        editor_.NewIntSub(limit, next),
+                        editor_.NewInt32(unroll_factor_ - 1)));
+  auto const main_back = editor_.NewJump(editor_.NewIfTrue(main_bottom));
+  editor_.AppendInput(main_loop, main_back);
+  for (size_t index = 0; index < main_phis.size(); ++index)
+    editor_.SetPhiInput(main_phis[index], main_back, values[index]->as<Data>());
+  if (main_effect_phi)
+    editor_.SetPhiInput(main_effect_phi, main_back, effect->as<Effect>());
+
+  // Exit if the original loop doesn't run any more iteration.
+  auto const check_if =
+      editor_.NewIf(editor_.NewIfFalse(main_bottom),
+                    editor_.NewIntCmp(IntCondition::SignedLessThan, next, limit));
+  auto const new_exit = editor_.NewJump(editor_.NewIfFalse(check_if));
+  editor_.AppendInput(exit_target, new_exit);
+  auto exit_value = exit_values.begin();
+  for (auto const phi : exit_target->phi_nodes())
+    editor_.SetPhiInput(phi, new_exit, (*exit_value++)->as<Data>());
+  if (exit_effect) {
+    editor_.SetPhiInput(exit_target->effect_phi(), new_exit,
+                        exit_effect->as<Effect>());
+  }
+
+  // Run remaining iterations in the original loop.
+  auto const skip_jump = editor_.NewJump(editor_.NewIfFalse(main_if));
+  auto const enter_jump = editor_.NewJump(editor_.NewIfTrue(check_if));
+  auto const remainder = editor_.NewMerge({skip_jump, enter_jump});
+  auto value = values.begin();
+  for (auto const phi : loop->phi_nodes()) {
+    auto const remainder_phi = editor_.NewPhi(phi->output_type(), remainder);
+    editor_.SetPhiInput(remainder_phi, skip_jump,
+                        PhiInputOf(phi, entry_jump)->as<Data>());
+    editor_.SetPhiInput(remainder_phi, enter_jump, (*value++)->as<Data>());
+    editor_.SetPhiInput(phi, entry_jump, remainder_phi);
+  }
+  if (effect_phi) {
+    auto const remainder_effect_phi = editor_.NewEffectPhi(remainder);
+    editor_.SetPhiInput(remainder_effect_phi, skip_jump,
+                        PhiInputOf(effect_phi, entry_jump)->as<Effect>());
+    editor_.SetPhiInput(remainder_effect_phi, enter_jump,
+                        effect->as<Effect>());
+    editor_.SetPhiInput(effect_phi, entry_jump, remainder_effect_phi);
+  }
+  editor_.ChangeInput(entry_jump, 0, remainder);
+}
+
+void LoopPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  ControlGraph graph(editor_.function());
+  auto const loop_tree = LoopTreeBuilder<ControlGraph>(&graph).Build();
+  for (auto const tree_node : *loop_tree) {
+    if (!tree_node->is_single_entry() || !tree_node->children().empty())
+      continue;
+    auto const loop = tree_node->entry()->node()->as<LoopNode>();
+    if (!loop)
+      continue;
+    std::vector<Node*> controls{loop};
+    for (auto const graph_node : tree_node->nodes())
+      controls.push_back(graph_node->node());
+    LoopBody body;
+    if (!AnalyzeLoop(loop, controls, &body))
+      continue;
+    auto const counter = unroll_factor_ > 1 ? CounterOf(body) : nullptr;
+    if (counter && body.nodes.size() * static_cast<size_t>(unroll_factor_) <=
+                       kMaxUnrollSize) {
+      CloseLoop(body);
+      Unroll(body, counter);
+      continue;
+    }
+    if (!CanPeel(body))
+      continue;
+    CloseLoop(body);
+    Peel(body);
+  }
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece LoopPass::name() const {
+  return "loop";
+}
+
+void LoopPass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void LoopPass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
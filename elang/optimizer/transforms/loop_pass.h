@@ -0,0 +1,85 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_LOOP_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_LOOP_PASS_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Editor;
+class LoopNode;
+class Node;
+class PhiNode;
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoopPass duplicates body of innermost loops found in loop tree of control
+// nodes:
+//  - Unrolling: A counted loop, e.g. |do { ... } while (++i < n)|, is
+//    replaced with a loop executing |unroll_factor| copies of loop body per
+//    iteration, and the original loop as remainder loop. Only the last copy
+//    compares and jumps back.
+//  - Peeling: The first iteration of loop having loop invariant branch, e.g.
+//    bounds check of loop invariant index, is copied before loop, so later
+//    passes can fold the branch in loop.
+//
+// Loop should have one back edge and loop body should not contain call with
+// exception handling.
+//
+class ELANG_OPTIMIZER_EXPORT LoopPass final : public api::Pass {
+ public:
+  explicit LoopPass(Editor* editor);
+  LoopPass(Editor* editor, int unroll_factor);
+  ~LoopPass();
+
+  void Run();
+
+ private:
+  struct LoopBody;
+
+  bool AnalyzeLoop(LoopNode* loop,
+                   const std::vector<Node*>& controls,
+                   LoopBody* body) const;
+  bool CanPeel(const LoopBody& body) const;
+  Node* CloneOf(const LoopBody& body, Node* node);
+  void CloseLoop(const LoopBody& body);
+  void CopyExit(const LoopBody& body, Node* exit);
+  PhiNode* CounterOf(const LoopBody& body) const;
+  Node* NewNodeLike(const LoopBody& body, Node* node);
+  void Peel(const LoopBody& body);
+  void StartCopy(const LoopBody& body,
+                 Node* control,
+                 const std::vector<Node*>& values,
+                 Node* effect);
+  void Unroll(const LoopBody& body, PhiNode* counter);
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+
+  // A map from node in loop body to its copy during copying loop body.
+  std::unordered_map<Node*, Node*> node_map_;
+
+  // Number of copies of loop body in unrolled loop.
+  int const unroll_factor_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_LOOP_PASS_H_
@@ -0,0 +1,152 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+#include "elang/optimizer/transforms/loop_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// LoopPassTest
+//
+class LoopPassTest : public testing::OptimizerTest {
+ protected:
+  LoopPassTest() = default;
+  ~LoopPassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LoopPassTest);
+};
+
+TEST_F(LoopPassTest, Peel) {
+  auto const function =
+      NewSampleFunction(int32_type(), {int32_type(), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // i = 0; do { if (x <= 0) throw; } while (++i < n); return i;
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const param = editor.ParameterAt(0);
+  auto const limit = editor.ParameterAt(1);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const counter = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(counter, loop_node->control(0), NewInt32(0));
+  auto const if_node1 = editor.SetBranch(
+      NewIntCmp(IntCondition::SignedGreaterThan, param, NewInt32(0)));
+  auto const if_true1 = NewIfTrue(if_node1);
+  auto const if_false1 = NewIfFalse(if_node1);
+  editor.Commit();
+
+  editor.Edit(if_false1);
+  editor.SetThrow(void_value());
+  editor.Commit();
+
+  editor.Edit(if_true1);
+  auto const next = NewIntAdd(counter, NewInt32(1));
+  auto const if_node2 =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, next, limit));
+  auto const if_true2 = NewIfTrue(if_node2);
+  auto const if_false2 = NewIfFalse(if_node2);
+  editor.Commit();
+
+  editor.Edit(if_true2);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(counter, loop_node->control(1), next);
+  editor.Commit();
+
+  editor.Edit(if_false2);
+  editor.SetRet(effect, next);
+  editor.Commit();
+
+  // Unroll factor 1 disables unrolling.
+  LoopPass(&editor, 1).Run();
+
+  // Loop is entered from the end of peeled iteration.
+  auto const peeled_true = loop_node->input(0)->input(0);
+  ASSERT_TRUE(peeled_true->is<IfTrueNode>());
+  EXPECT_NE(if_node2, peeled_true->input(0));
+  EXPECT_EQ(entry_node, peeled_true->input(0)->input(0)->input(0)->input(0));
+  EXPECT_TRUE(counter->input(0)->is<IntAddNode>());
+  // |ThrowNode| and |RetNode| are copied.
+  EXPECT_EQ(4u, function->exit_node()->input(0)->CountInputs());
+}
+
+TEST_F(LoopPassTest, Unroll) {
+  auto const function = NewSampleFunction(int32_type(), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // i = 0; sum = 0; do { sum += i; } while (++i < n); return sum;
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const limit = editor.ParameterAt(0);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const counter = NewPhi(int32_type(), loop_node);
+  auto const sum = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(counter, loop_node->control(0), NewInt32(0));
+  editor.SetPhiInput(sum, loop_node->control(0), NewInt32(0));
+  auto const next_sum = NewIntAdd(sum, counter);
+  auto const next = NewIntAdd(counter, NewInt32(1));
+  auto const if_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, next, limit));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(counter, loop_node->control(1), next);
+  editor.SetPhiInput(sum, loop_node->control(1), next_sum);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+  editor.Edit(if_false);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const ret_node = editor.SetRet(effect, next_sum);
+  editor.Commit();
+
+  LoopPass(&editor, 4).Run();
+
+  // Unrolled loop is entered if the original loop runs at least 4 times.
+  auto const main_if = entry_node->SelectUser(Opcode::If);
+  ASSERT_TRUE(main_if);
+  auto const main_loop =
+      main_if->SelectUser(Opcode::IfTrue)->SelectUserIfOne()->SelectUserIfOne();
+  ASSERT_TRUE(main_loop->is<LoopNode>());
+  EXPECT_EQ(2u, main_loop->CountInputs());
+
+  // The original loop is entered from the remainder merge.
+  auto const remainder = loop_node->input(0)->input(0);
+  ASSERT_TRUE(remainder->is<MergeNode>());
+  EXPECT_EQ(2u, remainder->CountInputs());
+
+  // Sum is passed to return via phi of loop exit.
+  EXPECT_EQ(2u, merge_node->CountInputs());
+  auto const result = ret_node->input(2)->as<PhiNode>();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(merge_node, result->owner());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,61 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/transforms/reduce_pass.h"
+
+#include "base/logging.h"
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/transforms/algebraic_reducer.h"
+#include "elang/optimizer/transforms/graph_reducer.h"
+
+namespace elang {
+namespace optimizer {
+
+ReducePass::ReducePass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor) {
+}
+
+ReducePass::~ReducePass() {
+}
+
+void ReducePass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+  AlgebraicReducer algebraic_reducer(&editor_);
+  GraphReducer graph_reducer(&editor_);
+  graph_reducer.AddReducer(&algebraic_reducer);
+  graph_reducer.ReduceGraph();
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece ReducePass::name() const {
+  return "reduce";
+}
+
+void ReducePass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void ReducePass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,136 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/reduce_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// ReducePassTest
+//
+class ReducePassTest : public testing::OptimizerTest {
+ protected:
+  ReducePassTest() = default;
+  ~ReducePassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReducePassTest);
+};
+
+TEST_F(ReducePassTest, Basic) {
+  auto const function =
+      NewSampleFunction(int32_type(), {int32_type(), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // return (x ^ x) | y; => return y;
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const param1 = editor.ParameterAt(1);
+  auto const ret_node =
+      editor.SetRet(effect, NewIntBitOr(NewIntBitXor(param0, param0), param1));
+  editor.Commit();
+
+  ReducePass(&editor).Run();
+
+  EXPECT_EQ(param1, ret_node->input(2));
+}
+
+TEST_F(ReducePassTest, IntBitAndIntPtr) {
+  auto const function = NewSampleFunction(intptr_type(), intptr_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // return x & 255; Size of intptr depends on target, 255 isn't all ones.
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const bit_and = NewIntBitAnd(param0, NewIntPtr(255));
+  auto const ret_node = editor.SetRet(effect, bit_and);
+  editor.Commit();
+
+  ReducePass(&editor).Run();
+
+  EXPECT_EQ(bit_and, ret_node->input(2));
+}
+
+TEST_F(ReducePassTest, IntCmp) {
+  auto const function = NewSampleFunction(bool_type(), int32_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // return x < 0 - (0 - x); => return false;
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const zero = NewInt32(0);
+  auto const ret_node = editor.SetRet(
+      effect, NewIntCmp(IntCondition::SignedLessThan, param0,
+                        NewIntSub(zero, NewIntSub(zero, param0))));
+  editor.Commit();
+
+  ReducePass(&editor).Run();
+
+  EXPECT_EQ(false_value(), ret_node->input(2));
+}
+
+TEST_F(ReducePassTest, StaticCast) {
+  auto const function =
+      NewSampleFunction(int32_type(), {int32_type(), int64_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // return (int)(long)x + (int)(long)(int)y;
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const param1 = editor.ParameterAt(1);
+  auto const narrow = NewStaticCast(int32_type(), param1);
+  auto const widen = NewStaticCast(int64_type(), narrow);
+  auto const add = NewIntAdd(
+      NewStaticCast(int32_type(), NewStaticCast(int64_type(), param0)),
+      NewStaticCast(int32_type(), widen));
+  editor.SetRet(effect, add);
+  editor.Commit();
+
+  ReducePass(&editor).Run();
+
+  // Widening |int| to |long| is lossless, but narrowing |y| isn't.
+  EXPECT_EQ(param0, add->input(0));
+  EXPECT_EQ(narrow, add->input(1));
+  EXPECT_EQ(param1, narrow->input(0));
+}
+
+TEST_F(ReducePassTest, StaticCastIntPtr) {
+  auto const function = NewSampleFunction(intptr_type(), intptr_type());
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // return (intptr)(int)x; int may not hold all values of intptr.
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const narrow = NewStaticCast(int32_type(), param0);
+  auto const ret_node =
+      editor.SetRet(effect, NewStaticCast(intptr_type(), narrow));
+  editor.Commit();
+
+  ReducePass(&editor).Run();
+
+  auto const cast = ret_node->input(2);
+  ASSERT_TRUE(cast->is<StaticCastNode>());
+  EXPECT_EQ(narrow, cast->input(0));
+}
+
+}  // namespace optimizer
+}  // namespace elang
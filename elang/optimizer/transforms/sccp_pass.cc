@@ -0,0 +1,620 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cmath>
+#include <vector>
+
+#include "elang/optimizer/transforms/sccp_pass.h"
+
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// NodeCollector collects nodes in post order.
+//
+class NodeCollector final : public NodeVisitor {
+ public:
+  NodeCollector() {}
+  ~NodeCollector() = default;
+
+  const std::vector<Node*>& nodes() const { return nodes_; }
+
+ private:
+  void DoDefaultVisit(Node* node) final { nodes_.push_back(node); }
+
+  std::vector<Node*> nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeCollector);
+};
+
+// Returns true if |node| is an integer literal and set sign or zero extended
+// value of |node| to |value|.
+bool IntegerValueOf(const Node* node, int64_t* value) {
+  if (auto const literal = node->as<BoolNode>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<CharNode>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<Int8Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<Int16Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<Int32Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<Int64Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<IntPtrNode>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<UInt8Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<UInt16Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<UInt32Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<UInt64Node>()) {
+    *value = static_cast<int64_t>(literal->data());
+    return true;
+  }
+  if (auto const literal = node->as<UIntPtrNode>()) {
+    *value = static_cast<int64_t>(literal->data());
+    return true;
+  }
+  return false;
+}
+
+bool FloatValueOf(const Node* node, float64_t* value) {
+  if (auto const literal = node->as<Float32Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  if (auto const literal = node->as<Float64Node>()) {
+    *value = literal->data();
+    return true;
+  }
+  return false;
+}
+
+// Returns number of bits of integer |type|. Note: |IntPtrType| and
+// |UIntPtrType| return zero from |bit_size()|.
+int BitSizeOf(const Type* type) {
+  auto const bit_size = type->as<PrimitiveType>()->bit_size();
+  return bit_size ? bit_size : 64;
+}
+
+bool EvaluateCondition(IntCondition condition, int64_t left, int64_t right) {
+  auto const left_u64 = static_cast<uint64_t>(left);
+  auto const right_u64 = static_cast<uint64_t>(right);
+  switch (condition) {
+    case IntCondition::Equal:
+      return left == right;
+    case IntCondition::NotEqual:
+      return left != right;
+    case IntCondition::SignedGreaterThan:
+      return left > right;
+    case IntCondition::SignedGreaterThanOrEqual:
+      return left >= right;
+    case IntCondition::SignedLessThan:
+      return left < right;
+    case IntCondition::SignedLessThanOrEqual:
+      return left <= right;
+    case IntCondition::UnsignedGreaterThan:
+      return left_u64 > right_u64;
+    case IntCondition::UnsignedGreaterThanOrEqual:
+      return left_u64 >= right_u64;
+    case IntCondition::UnsignedLessThan:
+      return left_u64 < right_u64;
+    case IntCondition::UnsignedLessThanOrEqual:
+      return left_u64 <= right_u64;
+  }
+  NOTREACHED() << "Invalid condition: " << condition;
+  return false;
+}
+
+bool EvaluateCondition(FloatCondition condition,
+                       float64_t left,
+                       float64_t right) {
+  auto const unordered = std::isnan(left) || std::isnan(right);
+  switch (condition) {
+    case FloatCondition::OrderedEqual:
+      return !unordered && left == right;
+    case FloatCondition::OrderedGreaterThan:
+      return !unordered && left > right;
+    case FloatCondition::OrderedGreaterThanOrEqual:
+      return !unordered && left >= right;
+    case FloatCondition::OrderedLessThan:
+      return !unordered && left < right;
+    case FloatCondition::OrderedLessThanOrEqual:
+      return !unordered && left <= right;
+    case FloatCondition::OrderedNotEqual:
+      return !unordered && left != right;
+    case FloatCondition::UnorderedEqual:
+      return unordered || left == right;
+    case FloatCondition::UnorderedGreaterThan:
+      return unordered || left > right;
+    case FloatCondition::UnorderedGreaterThanOrEqual:
+      return unordered || left >= right;
+    case FloatCondition::UnorderedLessThan:
+      return unordered || left < right;
+    case FloatCondition::UnorderedLessThanOrEqual:
+      return unordered || left <= right;
+    case FloatCondition::UnorderedNotEqual:
+      return unordered || left != right;
+  }
+  NOTREACHED() << "Invalid condition: " << condition;
+  return false;
+}
+
+// Returns true if we can compute value of |node| from literal inputs.
+bool IsFoldable(const Node* node) {
+  switch (node->opcode()) {
+    case Opcode::FloatAdd:
+    case Opcode::FloatCmp:
+    case Opcode::FloatDiv:
+    case Opcode::FloatMul:
+    case Opcode::FloatSub:
+    case Opcode::IntAdd:
+    case Opcode::IntBitAnd:
+    case Opcode::IntBitOr:
+    case Opcode::IntBitXor:
+    case Opcode::IntCmp:
+    case Opcode::IntDiv:
+    case Opcode::IntMod:
+    case Opcode::IntMul:
+    case Opcode::IntShl:
+    case Opcode::IntShr:
+    case Opcode::IntSub:
+    case Opcode::StaticCast:
+    case Opcode::UIntDiv:
+    case Opcode::UIntMod:
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+SccpPass::SccpPass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor) {
+}
+
+SccpPass::~SccpPass() {
+}
+
+// Returns lattice value of |node| computed from lattice values of its inputs.
+Node* SccpPass::Evaluate(Node* node) {
+  if (auto const phi = node->as<PhiNode>())
+    return EvaluatePhi(phi);
+  if (!IsFoldable(node))
+    return node;
+  for (auto const input : node->inputs()) {
+    auto const value = ValueOf(input);
+    if (!value)
+      return nullptr;
+    if (!value->IsLiteral())
+      return node;
+  }
+  if (auto const literal = Fold(node))
+    return literal;
+  return node;
+}
+
+// Phi node takes meet of values from reachable predecessors only.
+Node* SccpPass::EvaluatePhi(PhiNode* phi) {
+  if (!IsReachable(phi->owner()))
+    return nullptr;
+  auto result = static_cast<Node*>(nullptr);
+  for (auto const phi_input : phi->phi_inputs()) {
+    if (!IsReachable(phi_input->control()))
+      continue;
+    auto const value = ValueOf(phi_input->value());
+    if (!value || value == result)
+      continue;
+    if (result || !value->IsLiteral())
+      return phi;
+    result = value;
+  }
+  return result;
+}
+
+Node* SccpPass::Fold(Node* node) {
+  if (auto const cmp = node->as<IntCmpNode>()) {
+    auto const left = ValueOf(cmp->input(0));
+    auto const right = ValueOf(cmp->input(1));
+    if (left->is<NullNode>() && right->is<NullNode>()) {
+      if (cmp->condition() == IntCondition::Equal)
+        return editor_.true_value();
+      if (cmp->condition() == IntCondition::NotEqual)
+        return editor_.false_value();
+      return nullptr;
+    }
+    int64_t left_value;
+    int64_t right_value;
+    if (!IntegerValueOf(left, &left_value) ||
+        !IntegerValueOf(right, &right_value)) {
+      return nullptr;
+    }
+    return EvaluateCondition(cmp->condition(), left_value, right_value)
+               ? editor_.true_value()
+               : editor_.false_value();
+  }
+
+  if (auto const cmp = node->as<FloatCmpNode>()) {
+    float64_t left_value;
+    float64_t right_value;
+    if (!FloatValueOf(ValueOf(cmp->input(0)), &left_value) ||
+        !FloatValueOf(ValueOf(cmp->input(1)), &right_value)) {
+      return nullptr;
+    }
+    return EvaluateCondition(cmp->condition(), left_value, right_value)
+               ? editor_.true_value()
+               : editor_.false_value();
+  }
+
+  if (node->is<StaticCastNode>()) {
+    auto const input = ValueOf(node->input(0));
+    auto const input_type = input->output_type();
+    auto const output_type = node->output_type();
+    int64_t int_value;
+    if (input_type->is_integer() && IntegerValueOf(input, &int_value)) {
+      if (output_type->is_integer())
+        return NewIntLiteral(output_type, int_value);
+      if (output_type->is<Float32Type>()) {
+        return editor_.NewFloat32(
+            input_type->is_unsigned()
+                ? static_cast<float32_t>(static_cast<uint64_t>(int_value))
+                : static_cast<float32_t>(int_value));
+      }
+      if (output_type->is<Float64Type>()) {
+        return editor_.NewFloat64(
+            input_type->is_unsigned()
+                ? static_cast<float64_t>(static_cast<uint64_t>(int_value))
+                : static_cast<float64_t>(int_value));
+      }
+      return nullptr;
+    }
+    // TODO(eval1749) We should fold float to integer conversion once we
+    // define its semantics for out of range values.
+    float64_t float_value;
+    if (output_type->is_float() && FloatValueOf(input, &float_value))
+      return NewFloatLiteral(output_type, float_value);
+    return nullptr;
+  }
+
+  auto const type = node->output_type();
+  if (type->is_float())
+    return FoldFloat(node);
+  if (type->is_integer())
+    return FoldInteger(node);
+  return nullptr;
+}
+
+Node* SccpPass::FoldFloat(Node* node) {
+  float64_t left;
+  float64_t right;
+  if (!FloatValueOf(ValueOf(node->input(0)), &left) ||
+      !FloatValueOf(ValueOf(node->input(1)), &right)) {
+    return nullptr;
+  }
+  auto const type = node->output_type();
+  switch (node->opcode()) {
+    case Opcode::FloatAdd:
+      return NewFloatLiteral(type, left + right);
+    case Opcode::FloatDiv:
+      return NewFloatLiteral(type, left / right);
+    case Opcode::FloatMul:
+      return NewFloatLiteral(type, left * right);
+    case Opcode::FloatSub:
+      return NewFloatLiteral(type, left - right);
+  }
+  return nullptr;
+}
+
+// Integer arithmetic is done in 64-bit with wraparound, then result is
+// truncated to output type by |NewIntLiteral()|.
+Node* SccpPass::FoldInteger(Node* node) {
+  int64_t left;
+  int64_t right;
+  if (!IntegerValueOf(ValueOf(node->input(0)), &left) ||
+      !IntegerValueOf(ValueOf(node->input(1)), &right)) {
+    return nullptr;
+  }
+  auto const type = node->output_type();
+  auto const left_u64 = static_cast<uint64_t>(left);
+  auto const right_u64 = static_cast<uint64_t>(right);
+  switch (node->opcode()) {
+    case Opcode::IntAdd:
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 + right_u64));
+    case Opcode::IntBitAnd:
+      return NewIntLiteral(type, left & right);
+    case Opcode::IntBitOr:
+      return NewIntLiteral(type, left | right);
+    case Opcode::IntBitXor:
+      return NewIntLiteral(type, left ^ right);
+    case Opcode::IntDiv:
+      // Division by zero throws exception and division of minimum value by
+      // minus one overflows. We leave them to run time.
+      if (!right || right == -1)
+        return nullptr;
+      return NewIntLiteral(type, left / right);
+    case Opcode::IntMod:
+      if (!right || right == -1)
+        return nullptr;
+      return NewIntLiteral(type, left % right);
+    case Opcode::IntMul:
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 * right_u64));
+    case Opcode::IntShl:
+    case Opcode::IntShr: {
+      // Result of shift by count out of range depends on processor.
+      if (right < 0 || right >= BitSizeOf(type))
+        return nullptr;
+      if (node->opcode() == Opcode::IntShl)
+        return NewIntLiteral(type, static_cast<int64_t>(left_u64 << right));
+      if (type->is_signed())
+        return NewIntLiteral(type, left >> right);
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 >> right));
+    }
+    case Opcode::IntSub:
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 - right_u64));
+    case Opcode::UIntDiv:
+      if (!right_u64)
+        return nullptr;
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 / right_u64));
+    case Opcode::UIntMod:
+      if (!right_u64)
+        return nullptr;
+      return NewIntLiteral(type, static_cast<int64_t>(left_u64 % right_u64));
+  }
+  return nullptr;
+}
+
+bool SccpPass::IsReachable(Node* control) const {
+  return reachables_.count(control) != 0;
+}
+
+void SccpPass::MarkReachable(Node* control) {
+  DCHECK(control->IsControl()) << *control;
+  if (!reachables_.insert(control).second)
+    return;
+  DVLOG(1) << "Reachable " << *control;
+  Push(control);
+}
+
+Data* SccpPass::NewFloatLiteral(Type* type, float64_t value) {
+  if (type->is<Float32Type>())
+    return editor_.NewFloat32(static_cast<float32_t>(value));
+  if (type->is<Float64Type>())
+    return editor_.NewFloat64(value);
+  return nullptr;
+}
+
+Data* SccpPass::NewIntLiteral(Type* type, int64_t value) {
+  if (type->is<CharType>())
+    return editor_.NewChar(static_cast<base::char16>(value));
+  if (type->is<Int8Type>())
+    return editor_.NewInt8(static_cast<int8_t>(value));
+  if (type->is<Int16Type>())
+    return editor_.NewInt16(static_cast<int16_t>(value));
+  if (type->is<Int32Type>())
+    return editor_.NewInt32(static_cast<int32_t>(value));
+  if (type->is<Int64Type>())
+    return editor_.NewInt64(value);
+  if (type->is<IntPtrType>())
+    return editor_.NewIntPtr(static_cast<intptr_t>(value));
+  if (type->is<UInt8Type>())
+    return editor_.NewUInt8(static_cast<uint8_t>(value));
+  if (type->is<UInt16Type>())
+    return editor_.NewUInt16(static_cast<uint16_t>(value));
+  if (type->is<UInt32Type>())
+    return editor_.NewUInt32(static_cast<uint32_t>(value));
+  if (type->is<UInt64Type>())
+    return editor_.NewUInt64(static_cast<uint64_t>(value));
+  if (type->is<UIntPtrType>())
+    return editor_.NewUIntPtr(static_cast<uintptr_t>(value));
+  return nullptr;
+}
+
+void SccpPass::Propagate() {
+  while (!work_list_.empty()) {
+    auto const node = work_list_.Pop();
+    if (node->IsControl()) {
+      if (IsReachable(node))
+        PropagateControl(node);
+      continue;
+    }
+    PropagateData(node);
+  }
+}
+
+void SccpPass::PropagateControl(Node* control) {
+  if (auto const if_node = control->as<IfNode>()) {
+    auto const condition = ValueOf(if_node->input(1));
+    if (!condition)
+      return;
+    for (auto const edge : if_node->use_edges()) {
+      auto const user = edge->from();
+      if (condition == editor_.true_value() && !user->is<IfTrueNode>())
+        continue;
+      if (condition == editor_.false_value() && !user->is<IfFalseNode>())
+        continue;
+      MarkReachable(user);
+    }
+    return;
+  }
+  for (auto const edge : control->use_edges()) {
+    auto const user = edge->from();
+    if (auto const phi_owner = user->as<PhiOwnerNode>()) {
+      MarkReachable(phi_owner);
+      // A new predecessor of |phi_owner| becomes reachable.
+      for (auto const phi : phi_owner->phi_nodes())
+        Push(phi);
+      continue;
+    }
+    if (user->IsControl()) {
+      MarkReachable(user);
+      continue;
+    }
+    Push(user);
+  }
+}
+
+void SccpPass::PropagateData(Node* node) {
+  auto const old_value = ValueOf(node);
+  if (old_value == node)
+    return;
+  auto new_value = Evaluate(node);
+  if (new_value == old_value)
+    return;
+  // Lattice value of |node| only goes down.
+  if (old_value)
+    new_value = node;
+  DVLOG(1) << "Value of " << *node << " is " << *new_value;
+  values_[node] = new_value;
+  for (auto const edge : node->use_edges())
+    Push(edge->from());
+}
+
+void SccpPass::Push(Node* node) {
+  if (node->IsLiteral() || work_list_.Contains(node))
+    return;
+  work_list_.Push(node);
+}
+
+void SccpPass::RemoveUnreachablePredecessors(PhiOwnerNode* phi_owner) {
+  std::vector<Control*> unreachables;
+  for (auto const input : phi_owner->inputs()) {
+    if (!IsReachable(input))
+      unreachables.push_back(input->as<Control>());
+  }
+  for (auto const control : unreachables) {
+    DVLOG(1) << "Remove unreachable " << *control << " from " << *phi_owner;
+    editor_.RemoveControlInput(phi_owner, control);
+  }
+}
+
+void SccpPass::ReplaceWithLiterals(const std::vector<Node*>& nodes) {
+  for (auto const node : nodes) {
+    if (node->IsLiteral() || !node->IsUsed())
+      continue;
+    auto const value = ValueOf(node);
+    if (!value || !value->IsLiteral())
+      continue;
+    DVLOG(1) << "Replace " << *node << " with " << *value;
+    editor_.ReplaceAllUses(value, node);
+    editor_.Discard(node);
+  }
+}
+
+// Makes block containing |if_node| to continue to live successor.
+void SccpPass::RewireIf(IfNode* if_node) {
+  auto const condition = ValueOf(if_node->input(1));
+  if (!condition || !condition->IsLiteral())
+    return;
+  for (auto const edge : if_node->use_edges()) {
+    auto const projection = edge->from();
+    if (!IsReachable(projection))
+      continue;
+    DVLOG(1) << "Rewire " << *if_node << " to " << *projection;
+    editor_.ReplaceAllUses(if_node->input(0), projection);
+    return;
+  }
+}
+
+Node* SccpPass::ValueOf(Node* node) const {
+  if (node->IsLiteral())
+    return node;
+  auto const it = values_.find(node);
+  return it == values_.end() ? nullptr : it->second;
+}
+
+void SccpPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  DepthFirstTraversal<OnInputEdge, const Function> walker;
+  NodeCollector collector;
+  walker.Traverse(editor_.function(), &collector);
+
+  for (auto const node : collector.nodes()) {
+    if (!node->IsControl())
+      Push(node);
+  }
+  MarkReachable(editor_.function()->entry_node());
+  Propagate();
+
+  // Rewrite control flow. Note: Unreachable nodes are removed by |DeadPass|.
+  for (auto const node : collector.nodes()) {
+    if (!IsReachable(node))
+      continue;
+    if (auto const phi_owner = node->as<PhiOwnerNode>()) {
+      RemoveUnreachablePredecessors(phi_owner);
+      continue;
+    }
+    if (auto const if_node = node->as<IfNode>())
+      RewireIf(if_node);
+  }
+
+  ReplaceWithLiterals(collector.nodes());
+  reachables_.clear();
+  values_.clear();
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece SccpPass::name() const {
+  return "sccp";
+}
+
+void SccpPass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void SccpPass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
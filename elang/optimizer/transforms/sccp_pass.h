@@ -0,0 +1,91 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_SCCP_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_SCCP_PASS_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/base/float_types.h"
+#include "elang/base/work_list.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Control;
+class Data;
+class Editor;
+class IfNode;
+class Node;
+class PhiNode;
+class PhiOwnerNode;
+class Type;
+
+//////////////////////////////////////////////////////////////////////
+//
+// SccpPass does sparse conditional constant propagation based on algorithm
+// described in:
+//  Constant Propagation with Conditional Branches
+//  Mark N. Wegman, F. Kenneth Zadeck
+//  ACM TOPLAS, April 1991
+//
+// A lattice value of node is one of:
+//   Top      |nullptr|, value isn't known yet.
+//   Constant a literal node from |NodeCache|.
+//   Bottom   node itself, value is varying.
+//
+// After propagation, |SccpPass| replaces constant nodes with literal nodes,
+// rewires |IfNode| with constant condition to live successor, and removes
+// unreachable predecessors from merge and loop nodes. Unreachable nodes are
+// removed by |DeadPass| and empty blocks are removed by |CleanPass|.
+//
+class ELANG_OPTIMIZER_EXPORT SccpPass final : public api::Pass {
+ public:
+  explicit SccpPass(Editor* editor);
+  ~SccpPass();
+
+  void Run();
+
+ private:
+  Node* Evaluate(Node* node);
+  Node* EvaluatePhi(PhiNode* phi);
+  Node* Fold(Node* node);
+  Node* FoldFloat(Node* node);
+  Node* FoldInteger(Node* node);
+  bool IsReachable(Node* control) const;
+  void MarkReachable(Node* control);
+  Data* NewFloatLiteral(Type* type, float64_t value);
+  Data* NewIntLiteral(Type* type, int64_t value);
+  void Propagate();
+  void PropagateControl(Node* control);
+  void PropagateData(Node* node);
+  void Push(Node* node);
+  void RemoveUnreachablePredecessors(PhiOwnerNode* phi_owner);
+  void ReplaceWithLiterals(const std::vector<Node*>& nodes);
+  void RewireIf(IfNode* if_node);
+  Node* ValueOf(Node* node) const;
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+  std::unordered_set<Node*> reachables_;
+  std::unordered_map<Node*, Node*> values_;
+  WorkList<Node> work_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(SccpPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_SCCP_PASS_H_
@@ -0,0 +1,106 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/sccp_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// SccpPassTest
+//
+class SccpPassTest : public testing::OptimizerTest {
+ protected:
+  SccpPassTest() = default;
+  ~SccpPassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SccpPassTest);
+};
+
+TEST_F(SccpPassTest, ConstantBranch) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({bool_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param1 = editor.ParameterAt(1);
+  auto const if_node = editor.SetBranch(true_value());
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+
+  editor.Edit(if_true);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const phi = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi, merge_node->control(0), param1);
+  editor.SetPhiInput(phi, merge_node->control(1), NewInt32(42));
+  editor.SetRet(effect, phi);
+  editor.Commit();
+
+  SccpPass(&editor).Run();
+
+  EXPECT_EQ(1u, merge_node->CountInputs());
+  EXPECT_EQ(param1, phi->input(0));
+  EXPECT_FALSE(if_true->IsUsed());
+}
+
+TEST_F(SccpPassTest, Phi) {
+  auto const function = NewSampleFunction(
+      int32_type(), NewTupleType({bool_type(), int32_type()}));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const if_node = editor.SetBranch(editor.ParameterAt(0));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  auto const merge_node = NewMerge({});
+
+  editor.Edit(if_true);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetJump(merge_node);
+  editor.Commit();
+
+  editor.Edit(merge_node);
+  auto const phi = NewPhi(int32_type(), merge_node);
+  editor.SetPhiInput(phi, merge_node->control(0), NewInt32(40));
+  editor.SetPhiInput(phi, merge_node->control(1), NewInt32(40));
+  auto const add = NewIntAdd(phi, NewInt32(2));
+  auto const ret_node = editor.SetRet(effect, add);
+  editor.Commit();
+
+  SccpPass(&editor).Run();
+
+  EXPECT_EQ(NewInt32(42), ret_node->input(2));
+  EXPECT_FALSE(phi->IsUsed());
+  EXPECT_EQ(2u, merge_node->CountInputs());
+}
+
+}  // namespace optimizer
+}  // namespace elang
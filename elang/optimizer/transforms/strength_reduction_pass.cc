@@ -0,0 +1,176 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "elang/optimizer/transforms/strength_reduction_pass.h"
+
+#include "base/logging.h"
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/depth_first_traversal.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/induction_variable_analysis.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////
+//
+// ElementCollector collects element nodes in post order.
+//
+class ElementCollector final : public NodeVisitor {
+ public:
+  ElementCollector() {}
+  ~ElementCollector() = default;
+
+  const std::vector<ElementNode*>& elements() const { return elements_; }
+
+ private:
+  void VisitElement(ElementNode* node) final { elements_.push_back(node); }
+
+  std::vector<ElementNode*> elements_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElementCollector);
+};
+
+}  // namespace
+
+StrengthReductionPass::StrengthReductionPass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor) {
+}
+
+StrengthReductionPass::~StrengthReductionPass() {
+}
+
+// Returns number of elements between |array[..., i, ...]| and
+// |array[..., i + step, ...]| where |i| is index of |dimension|.
+Data* StrengthReductionPass::NewStride(Data* array,
+                                       size_t dimension,
+                                       size_t rank,
+                                       int32_t step) {
+  auto stride = editor_.NewInt32(step);
+  for (auto position = dimension + 1; position < rank; ++position)
+    stride = editor_.NewIntMul(editor_.NewLength(array, position), stride);
+  return stride;
+}
+
+// Replaces |element| with pointer phi if one of indexes of |element| is |i|
+// or |i + offset|, where |i| is basic induction variable and |offset| is loop
+// invariant, and other indexes are loop invariant.
+void StrengthReductionPass::ReduceElement(InductionVariableAnalysis* analysis,
+                                          ElementNode* element) {
+  auto const array = element->input(0)->as<Data>();
+  auto const indexes = element->input(1)->as<TupleNode>();
+  std::vector<Node*> components;
+  if (indexes) {
+    for (auto const index : indexes->inputs())
+      components.push_back(index);
+  } else {
+    components.push_back(element->input(1));
+  }
+
+  for (size_t dimension = 0; dimension < components.size(); ++dimension) {
+    auto const index = components[dimension];
+    auto offset = static_cast<Data*>(nullptr);
+    auto induction_variable = analysis->InductionVariableOf(index);
+    if (!induction_variable && index->is<IntAddNode>()) {
+      induction_variable = analysis->InductionVariableOf(index->input(0));
+      offset = index->input(1)->as<Data>();
+    }
+    if (!induction_variable)
+      continue;
+    auto const loop = induction_variable->loop;
+    if (!analysis->IsLoopInvariant(loop, array))
+      continue;
+    if (offset && !analysis->IsLoopInvariant(loop, offset))
+      continue;
+    auto is_invariant = true;
+    for (auto const other : components) {
+      if (other == index || analysis->IsLoopInvariant(loop, other))
+        continue;
+      is_invariant = false;
+      break;
+    }
+    if (!is_invariant)
+      continue;
+
+    // Replace |element| with pointer which starts at element of the first
+    // iteration and is advanced by stride at back edge.
+    auto const start_index =
+        offset ? editor_.NewIntAdd(induction_variable->start, offset)
+               : induction_variable->start;
+    components[dimension] = start_index;
+    auto start_indexes = static_cast<Node*>(start_index);
+    if (indexes)
+      start_indexes = editor_.NewTuple(components);
+    // Since |start| is computed before loop, it isn't guarded by bounds check
+    // in loop. It is safe, since we don't access memory until we enter loop.
+    auto const start =
+        editor_.NewElement(array, start_indexes, loop->control(0));
+    auto const stride = NewStride(array, dimension, components.size(),
+                                  induction_variable->step);
+    auto const pointer = editor_.NewPhi(element->output_type(), loop);
+    editor_.SetPhiInput(pointer, loop->control(0), start);
+    editor_.SetPhiInput(pointer, loop->control(1),
+                        editor_.NewPointerAdd(pointer, stride));
+    DVLOG(1) << "Replace " << *element << " with " << *pointer;
+    editor_.ReplaceAllUses(pointer, element);
+    editor_.Discard(element);
+    return;
+  }
+}
+
+void StrengthReductionPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  InductionVariableAnalysis analysis(editor_.function());
+  if (!analysis.loops().empty()) {
+    DepthFirstTraversal<OnInputEdge, const Function> walker;
+    ElementCollector collector;
+    walker.Traverse(editor_.function(), &collector);
+    for (auto const element : collector.elements()) {
+      if (!element->IsUsed())
+        continue;
+      ReduceElement(&analysis, element);
+    }
+  }
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece StrengthReductionPass::name() const {
+  return "strength_reduction";
+}
+
+void StrengthReductionPass::DumpBeforePass(
+    const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void StrengthReductionPass::DumpAfterPass(
+    const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,64 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_STRENGTH_REDUCTION_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_STRENGTH_REDUCTION_PASS_H_
+
+#include "base/basictypes.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class Data;
+class Editor;
+class ElementNode;
+class InductionVariableAnalysis;
+
+//////////////////////////////////////////////////////////////////////
+//
+// StrengthReductionPass replaces |ElementNode| indexed by basic induction
+// variable in loop with pointer advanced by constant stride:
+//
+//   loop:
+//     i = phi(start, i + step)
+//     p = element array, i
+//   =>
+//   loop:
+//     p = phi(element array, start, ptr_add p, step)
+//
+// For multiple dimensions array, stride is |step| times lengths of
+// dimensions after the dimension indexed by induction variable, and other
+// indexes must be loop invariant. So we don't calculate row-major index for
+// each iteration.
+//
+class ELANG_OPTIMIZER_EXPORT StrengthReductionPass final : public api::Pass {
+ public:
+  explicit StrengthReductionPass(Editor* editor);
+  ~StrengthReductionPass();
+
+  void Run();
+
+ private:
+  Data* NewStride(Data* array, size_t dimension, size_t rank, int32_t step);
+  void ReduceElement(InductionVariableAnalysis* analysis,
+                     ElementNode* element);
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+
+  DISALLOW_COPY_AND_ASSIGN(StrengthReductionPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_STRENGTH_REDUCTION_PASS_H_
@@ -0,0 +1,155 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/transforms/strength_reduction_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// StrengthReductionPassTest
+//
+class StrengthReductionPassTest : public testing::OptimizerTest {
+ protected:
+  StrengthReductionPassTest() = default;
+  ~StrengthReductionPassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(StrengthReductionPassTest);
+};
+
+TEST_F(StrengthReductionPassTest, Vector) {
+  auto const function = NewSampleFunction(
+      int32_type(),
+      {NewPointerType(NewArrayType(int32_type(), {-1})), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // i = 0; sum = 0; do { sum += array[i]; } while (++i < n); return sum;
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const limit = editor.ParameterAt(1);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const counter = NewPhi(int32_type(), loop_node);
+  auto const sum = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(counter, loop_node->control(0), NewInt32(0));
+  editor.SetPhiInput(sum, loop_node->control(0), NewInt32(0));
+  auto const load =
+      NewLoad(effect, array, NewElement(array, counter, loop_node));
+  auto const next_sum = NewIntAdd(sum, load);
+  auto const next = NewIntAdd(counter, NewInt32(1));
+  auto const if_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, next, limit));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(counter, loop_node->control(1), next);
+  editor.SetPhiInput(sum, loop_node->control(1), next_sum);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, next_sum);
+  editor.Commit();
+
+  StrengthReductionPass(&editor).Run();
+
+  // array[i] is replaced with pointer advanced by one element.
+  auto const pointer = load->input(2)->as<PhiNode>();
+  ASSERT_TRUE(pointer);
+  EXPECT_EQ(loop_node, pointer->owner());
+  auto const start = pointer->input(0)->as<ElementNode>();
+  ASSERT_TRUE(start);
+  EXPECT_EQ(array, start->input(0));
+  EXPECT_EQ(NewInt32(0), start->input(1));
+  EXPECT_EQ(entry_node, start->input(2));
+  auto const advance = pointer->input(1)->as<PointerAddNode>();
+  ASSERT_TRUE(advance);
+  EXPECT_EQ(pointer, advance->input(0));
+  EXPECT_EQ(NewInt32(1), advance->input(1));
+}
+
+TEST_F(StrengthReductionPassTest, TwoDimensions) {
+  auto const function = NewSampleFunction(
+      int32_type(), {NewPointerType(NewArrayType(int32_type(), {-1, -1})),
+                     int32_type(), int32_type()});
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // i = 0; do { array[k, i] + array[i, k]; } while (++i < n);
+  auto const loop_node = NewLoop();
+  editor.Edit(entry_node);
+  auto const array = editor.ParameterAt(0);
+  auto const fixed = editor.ParameterAt(1);
+  auto const limit = editor.ParameterAt(2);
+  editor.SetJump(loop_node);
+  editor.Commit();
+
+  editor.Edit(loop_node);
+  auto const counter = NewPhi(int32_type(), loop_node);
+  auto const sum = NewPhi(int32_type(), loop_node);
+  editor.SetPhiInput(counter, loop_node->control(0), NewInt32(0));
+  editor.SetPhiInput(sum, loop_node->control(0), NewInt32(0));
+  auto const row_load = NewLoad(
+      effect, array, NewElement(array, NewTuple({fixed, counter}), loop_node));
+  auto const column_load = NewLoad(
+      effect, array, NewElement(array, NewTuple({counter, fixed}), loop_node));
+  auto const next_sum = NewIntAdd(sum, NewIntAdd(row_load, column_load));
+  auto const next = NewIntAdd(counter, NewInt32(1));
+  auto const if_node =
+      editor.SetBranch(NewIntCmp(IntCondition::SignedLessThan, next, limit));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetJump(loop_node);
+  editor.SetPhiInput(counter, loop_node->control(1), next);
+  editor.SetPhiInput(sum, loop_node->control(1), next_sum);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  editor.SetRet(effect, next_sum);
+  editor.Commit();
+
+  StrengthReductionPass(&editor).Run();
+
+  // array[k, i] advances by one element.
+  auto const row_pointer = row_load->input(2)->as<PhiNode>();
+  ASSERT_TRUE(row_pointer);
+  auto const row_start = row_pointer->input(0)->as<ElementNode>();
+  ASSERT_TRUE(row_start);
+  EXPECT_EQ(fixed, row_start->input(1)->input(0));
+  EXPECT_EQ(NewInt32(0), row_start->input(1)->input(1));
+  EXPECT_EQ(NewInt32(1), row_pointer->input(1)->input(1));
+
+  // array[i, k] advances by length of the second dimension.
+  auto const column_pointer = column_load->input(2)->as<PhiNode>();
+  ASSERT_TRUE(column_pointer);
+  auto const column_start = column_pointer->input(0)->as<ElementNode>();
+  ASSERT_TRUE(column_start);
+  EXPECT_EQ(NewInt32(0), column_start->input(1)->input(0));
+  EXPECT_EQ(fixed, column_start->input(1)->input(1));
+  auto const stride = column_pointer->input(1)->input(1)->as<LengthNode>();
+  ASSERT_TRUE(stride);
+  EXPECT_EQ(NewInt32(1), stride->input(1));
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -0,0 +1,208 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <map>
+#include <vector>
+
+#include "elang/optimizer/transforms/tail_call_pass.h"
+
+#include "base/logging.h"
+#include "elang/api/pass_controller.h"
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/factory.h"
+#include "elang/optimizer/formatters/graphviz_formatter.h"
+#include "elang/optimizer/formatters/text_formatter.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+TailCallPass::TailCallPass(Editor* editor)
+    : api::Pass(editor->pass_controller()), editor_(*editor) {
+}
+
+TailCallPass::~TailCallPass() {
+}
+
+Node* TailCallPass::ArgumentAt(CallNode* call, size_t index) const {
+  auto const arguments = call->input(3);
+  if (!arguments->output_type()->is<TupleType>()) {
+    DCHECK_EQ(index, 0u) << *call;
+    return arguments;
+  }
+  DCHECK(arguments->is<TupleNode>()) << *call;
+  return arguments->input(index);
+}
+
+void TailCallPass::ConvertToLoop(const std::vector<RetNode*>& ret_nodes) {
+  auto const function = editor_.function();
+  auto const entry_node = function->entry_node();
+
+  std::vector<Node*> controls;
+  std::vector<Node*> effects;
+  std::map<size_t, std::vector<Node*>> parameters;
+  for (auto const edge : entry_node->use_edges()) {
+    auto const user = edge->from();
+    if (user->is<ParameterNode>()) {
+      parameters[user->field()].push_back(user);
+      continue;
+    }
+    if (user->is<GetEffectNode>()) {
+      effects.push_back(user);
+      continue;
+    }
+    DCHECK(user->IsControl()) << *user;
+    controls.push_back(user);
+  }
+  DCHECK(!effects.empty()) << *entry_node;
+
+  // Insert loop between entry node and its successor.
+  auto const loop_node = editor_.NewLoop();
+  auto const entry_jump = editor_.NewJump(entry_node);
+  editor_.AppendInput(loop_node, entry_jump);
+  for (auto const control : controls)
+    editor_.ChangeInput(control, 0, loop_node);
+
+  // Note: We should add phi inputs after replacing uses, since phi input
+  // is also use of replaced node.
+  auto const effect_phi = editor_.NewEffectPhi(loop_node);
+  for (auto const effect : effects)
+    editor_.ReplaceAllUses(effect_phi, effect);
+  editor_.SetPhiInput(effect_phi, entry_jump, effects.front()->as<Effect>());
+  for (auto const effect : effects) {
+    if (effect != effects.front())
+      editor_.Discard(effect);
+  }
+
+  std::map<size_t, PhiNode*> phis;
+  for (auto const pair : parameters) {
+    auto const parameter = pair.second.front();
+    auto const phi = editor_.NewPhi(parameter->output_type(), loop_node);
+    for (auto const node : pair.second)
+      editor_.ReplaceAllUses(phi, node);
+    editor_.SetPhiInput(phi, entry_jump, parameter->as<Data>());
+    for (auto const node : pair.second) {
+      if (node != parameter)
+        editor_.Discard(node);
+    }
+    phis[pair.first] = phi;
+  }
+
+  // Replace tail calls with back edges.
+  auto const exit_merge = function->exit_node()->input(0)->as<PhiOwnerNode>();
+  for (auto const ret_node : ret_nodes) {
+    auto const call = ret_node->input(0)->as<CallNode>();
+    DVLOG(1) << "Convert tail call " << *call;
+    auto const back_jump = editor_.NewJump(call->input(0)->as<Control>());
+    editor_.AppendInput(loop_node, back_jump);
+    editor_.SetPhiInput(effect_phi, back_jump, call->input(1)->as<Effect>());
+    for (auto const pair : phis) {
+      editor_.SetPhiInput(pair.second, back_jump,
+                          ArgumentAt(call, pair.first)->as<Data>());
+    }
+
+    auto const effect = ret_node->input(1);
+    auto const value = ret_node->input(2);
+    editor_.RemoveControlInput(exit_merge, ret_node);
+    editor_.Discard(ret_node);
+    editor_.Discard(effect);
+    if (value->is<GetDataNode>())
+      editor_.Discard(value);
+    auto const arguments = call->input(3);
+    editor_.Discard(call);
+    if (arguments->is<TupleNode>() && !arguments->IsUsed())
+      editor_.Discard(arguments);
+  }
+}
+
+// Returns true if |call| calls function itself. Front-end refers callee by
+// name with |ReferenceNode|.
+bool TailCallPass::IsSelfCall(const CallNode* call) const {
+  auto const callee = call->input(2);
+  if (auto const reference = callee->as<FunctionReferenceNode>())
+    return reference->function() == editor_.function();
+  auto const reference = callee->as<ReferenceNode>();
+  return reference &&
+         editor_.factory()->FunctionByName(reference->name()) ==
+             editor_.function();
+}
+
+// Returns true if |ret_node| returns result of calling function itself.
+bool TailCallPass::IsSelfTailCall(RetNode* ret_node) const {
+  auto const call = ret_node->input(0)->as<CallNode>();
+  if (!call || !IsSelfCall(call))
+    return false;
+  auto const arguments = call->input(3);
+  if (arguments->output_type()->is<TupleType>() &&
+      !arguments->is<TupleNode>()) {
+    return false;
+  }
+  auto const effect = ret_node->input(1);
+  if (!effect->is<GetEffectNode>() || effect->input(0) != call)
+    return false;
+  auto const value = ret_node->input(2);
+  if (value->is<GetDataNode>()) {
+    if (value->input(0) != call)
+      return false;
+  } else if (!value->is<VoidNode>()) {
+    return false;
+  }
+  // Result of call should be used only by |ret_node|.
+  for (auto const edge : call->use_edges()) {
+    auto const user = edge->from();
+    if (user == ret_node)
+      continue;
+    if ((user == effect || user == value) &&
+        user->SelectUserIfOne() == ret_node) {
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+void TailCallPass::Run() {
+  RunScope scope(this);
+  if (scope.IsStop())
+    return;
+
+  auto const exit_merge = editor_.function()->exit_node()->input(0);
+  std::vector<RetNode*> ret_nodes;
+  for (auto const input : exit_merge->inputs()) {
+    auto const ret_node = input->as<RetNode>();
+    if (ret_node && IsSelfTailCall(ret_node))
+      ret_nodes.push_back(ret_node);
+  }
+  if (!ret_nodes.empty() && ret_nodes.size() < exit_merge->CountInputs())
+    ConvertToLoop(ret_nodes);
+  DCHECK(editor_.Validate()) << editor_;
+}
+
+// api::Pass
+base::StringPiece TailCallPass::name() const {
+  return "tail_call";
+}
+
+void TailCallPass::DumpBeforePass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+void TailCallPass::DumpAfterPass(const api::PassDumpContext& context) {
+  auto& ostream = *context.ostream;
+  if (context.IsGraph()) {
+    ostream << AsGraphviz(editor_.function());
+    return;
+  }
+  ostream << AsReversePostOrder(editor_.function());
+}
+
+}  // namespace optimizer
+}  // namespace elang
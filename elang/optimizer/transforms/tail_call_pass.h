@@ -0,0 +1,62 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ELANG_OPTIMIZER_TRANSFORMS_TAIL_CALL_PASS_H_
+#define ELANG_OPTIMIZER_TRANSFORMS_TAIL_CALL_PASS_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "elang/api/pass.h"
+#include "elang/optimizer/optimizer_export.h"
+
+namespace elang {
+namespace optimizer {
+
+class CallNode;
+class Editor;
+class Node;
+class RetNode;
+
+//////////////////////////////////////////////////////////////////////
+//
+// TailCallPass converts self-recursive tail calls, e.g. |CallNode| calling
+// function itself and its result is returned by |RetNode| immediately, into
+// back edges of new |LoopNode| placed after |EntryNode|:
+//  - |ParameterNode|s are replaced with |PhiNode|s of loop. Arguments of
+//    tail calls are passed via back edges.
+//  - Initial effect of function is replaced with |EffectPhiNode| of loop.
+//
+// So, recursion runs in constant stack depth without setting up frame for
+// each call. We don't convert function which has only tail calls, since it
+// never returns.
+//
+class ELANG_OPTIMIZER_EXPORT TailCallPass final : public api::Pass {
+ public:
+  explicit TailCallPass(Editor* editor);
+  ~TailCallPass();
+
+  void Run();
+
+ private:
+  Node* ArgumentAt(CallNode* call, size_t index) const;
+  void ConvertToLoop(const std::vector<RetNode*>& ret_nodes);
+  bool IsSelfCall(const CallNode* call) const;
+  bool IsSelfTailCall(RetNode* ret_node) const;
+
+  // api::Pass
+  base::StringPiece name() const final;
+  void DumpAfterPass(const api::PassDumpContext& context) final;
+  void DumpBeforePass(const api::PassDumpContext& context) final;
+
+  Editor& editor_;
+
+  DISALLOW_COPY_AND_ASSIGN(TailCallPass);
+};
+
+}  // namespace optimizer
+}  // namespace elang
+
+#endif  // ELANG_OPTIMIZER_TRANSFORMS_TAIL_CALL_PASS_H_
@@ -0,0 +1,121 @@
+// Copyright 2015 Project Vogue. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "elang/optimizer/testing/optimizer_test.h"
+
+#include "elang/optimizer/editor.h"
+#include "elang/optimizer/function.h"
+#include "elang/optimizer/nodes.h"
+#include "elang/optimizer/opcode.h"
+#include "elang/optimizer/transforms/tail_call_pass.h"
+#include "elang/optimizer/types.h"
+
+namespace elang {
+namespace optimizer {
+
+//////////////////////////////////////////////////////////////////////
+//
+// TailCallPassTest
+//
+class TailCallPassTest : public testing::OptimizerTest {
+ protected:
+  TailCallPassTest() = default;
+  ~TailCallPassTest() override = default;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TailCallPassTest);
+};
+
+TEST_F(TailCallPassTest, Basic) {
+  auto const function = NewFunction(NewFunctionType(
+      int32_type(), NewTupleType({int32_type(), int32_type()})));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // int Sum(int n, int acc) {
+  //   if (n <= 0) return acc;
+  //   return Sum(n - 1, acc + n);
+  // }
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const param1 = editor.ParameterAt(1);
+  auto const if_node = editor.SetBranch(
+      NewIntCmp(IntCondition::SignedLessThanOrEqual, param0, NewInt32(0)));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetRet(effect, param1);
+  editor.Commit();
+
+  editor.Edit(if_false);
+  auto const arguments = NewTuple(
+      {NewIntSub(param0, NewInt32(1)), NewIntAdd(param1, param0)});
+  auto const call = NewCall(if_false, effect, NewFunctionReference(function),
+                            arguments);
+  editor.Commit();
+
+  editor.Edit(call);
+  editor.SetRet(NewGetEffect(call), NewGetData(call));
+  editor.Commit();
+
+  TailCallPass(&editor).Run();
+
+  auto const loop_node =
+      entry_node->SelectUser(Opcode::Jump)->SelectUserIfOne()->as<LoopNode>();
+  ASSERT_TRUE(loop_node);
+  EXPECT_EQ(2u, loop_node->CountInputs());
+  EXPECT_EQ(loop_node, if_node->input(0));
+  EXPECT_TRUE(loop_node->effect_phi());
+
+  // Parameters are passed via phis.
+  auto const phi = if_node->input(1)->input(0)->as<PhiNode>();
+  ASSERT_TRUE(phi);
+  EXPECT_EQ(loop_node, phi->owner());
+  EXPECT_EQ(param0, phi->input(0));
+  EXPECT_TRUE(phi->input(1)->is<IntSubNode>());
+
+  // Only non-tail call return is remained.
+  EXPECT_EQ(1u, function->exit_node()->input(0)->CountInputs());
+}
+
+TEST_F(TailCallPassTest, NotTailCall) {
+  auto const function =
+      NewFunction(NewFunctionType(int32_type(), int32_type()));
+  Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  // int Count(int n) { if (n <= 0) return 0; return Count(n - 1) + 1; }
+  editor.Edit(entry_node);
+  auto const param0 = editor.ParameterAt(0);
+  auto const if_node = editor.SetBranch(
+      NewIntCmp(IntCondition::SignedLessThanOrEqual, param0, NewInt32(0)));
+  auto const if_true = NewIfTrue(if_node);
+  auto const if_false = NewIfFalse(if_node);
+  editor.Commit();
+
+  editor.Edit(if_true);
+  editor.SetRet(effect, NewInt32(0));
+  editor.Commit();
+
+  editor.Edit(if_false);
+  auto const call = NewCall(if_false, effect, NewFunctionReference(function),
+                            NewIntSub(param0, NewInt32(1)));
+  editor.Commit();
+
+  editor.Edit(call);
+  editor.SetRet(NewGetEffect(call), NewIntAdd(NewGetData(call), NewInt32(1)));
+  editor.Commit();
+
+  TailCallPass(&editor).Run();
+
+  EXPECT_EQ(entry_node, if_node->input(0));
+  EXPECT_EQ(2u, function->exit_node()->input(0)->CountInputs());
+}
+
+}  // namespace optimizer
+}  // namespace elang
@@ -60,6 +60,7 @@ class Validator::Context : public NodeVisitor {
   void VisitPhi(PhiNode* node) final;
   void VisitRet(RetNode* node) final;
   void VisitParameter(ParameterNode* node) final;
+  void VisitPointerAdd(PointerAddNode* node) final;
 
   bool is_valid_;
   Validator* const validator_;
@@ -134,7 +135,10 @@ void Validator::Context::VisitCall(CallNode* node) {
   if (!node->input(1)->output_type()->is<EffectType>())
     ErrorInInput(node, 1);
 
-  auto const callee_type = node->input(2)->output_type()->as<FunctionType>();
+  auto callee = node->input(2)->output_type();
+  if (auto const pointer_type = callee->as<PointerType>())
+    callee = pointer_type->pointee();
+  auto const callee_type = callee->as<FunctionType>();
   if (!callee_type)
     return ErrorInInput(node, 2);
   if (output_type->data_type() != callee_type->return_type())
@@ -163,6 +167,9 @@ void Validator::Context::VisitElement(ElementNode* node) {
   if (pointer_type && (pointer_type->pointee() != array_type->element_type()))
     return Error(ErrorCode::ValidateNodeOutput, node);
 
+  if (!node->input(2)->IsValidControl() || !node->input(2)->IsBlockStart())
+    return ErrorInInput(node, 2);
+
   if (array_type->rank() == 1) {
     if (!node->input(1)->output_type()->is<Int32Type>())
       ErrorInInput(node, 1);
@@ -323,6 +330,15 @@ void Validator::Context::VisitParameter(ParameterNode* node) {
   }
 }
 
+void Validator::Context::VisitPointerAdd(PointerAddNode* node) {
+  if (!node->output_type()->is<PointerType>())
+    return Error(ErrorCode::ValidateNodeOutput, node);
+  if (node->input(0)->output_type() != node->output_type())
+    ErrorInInput(node, 0);
+  if (!node->input(1)->output_type()->is<Int32Type>())
+    ErrorInInput(node, 1);
+}
+
 void Validator::Context::VisitPhi(PhiNode* node) {
   if (!node->owner()->IsValidControl())
     return Error(ErrorCode::ValidatePhiNodeOwner, node, node->owner());
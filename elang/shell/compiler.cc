@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <vector>
@@ -50,6 +52,7 @@
 #include "elang/optimizer/error_data.h"
 #include "elang/optimizer/factory.h"
 #include "elang/optimizer/function.h"
+#include "elang/optimizer/scheduler/edge_counts.h"
 #include "elang/optimizer/scheduler/schedule.h"
 #include "elang/optimizer/types.h"
 #include "elang/shell/disasm.h"
@@ -84,12 +87,15 @@ class InstructionSelectionPass final : public api::Pass {
   lir::Function* Run(const hir::Function* function);
   lir::Function* Run(const ir::Schedule* schedule);
 
+  void set_edge_counters(int64_t* counters) { edge_counters_ = counters; }
+
  private:
   // api::Pass
   base::StringPiece name() const final { return "select"; }
   void DumpAfterPass(const api::PassDumpContext& context) final;
   void DumpBeforePass(const api::PassDumpContext& context) final;
 
+  int64_t* edge_counters_;
   lir::Factory* const factory_;
   lir::Function* function_;
   const hir::Function* hir_function_;
@@ -102,6 +108,7 @@ InstructionSelectionPass::InstructionSelectionPass(
     api::PassController* pass_controller,
     lir::Factory* factory)
     : api::Pass(pass_controller),
+      edge_counters_(nullptr),
       factory_(factory),
       function_(nullptr),
       hir_function_(nullptr),
@@ -129,7 +136,9 @@ lir::Function* InstructionSelectionPass::Run(const ir::Schedule* schedule) {
   RunScope scope(this);
   if (scope.IsStop())
     return nullptr;
-  return function_ = ::elang::translator::Translator(factory_, schedule).Run();
+  ::elang::translator::Translator translator(factory_, schedule);
+  translator.set_edge_counters(edge_counters_);
+  return function_ = translator.Run();
 }
 
 void InstructionSelectionPass::DumpBeforePass(
@@ -322,10 +331,13 @@ ast::Method* FindMainMethod(CompilationSession* session,
 
 vm::MachineCodeFunction* GenerateMachineCode(vm::Factory* vm_factory,
                                              lir::Factory* lir_factory,
-                                             lir::Function* lir_function) {
+                                             lir::Function* lir_function,
+                                             int optimize_level) {
   vm::MachineCodeBuilderImpl mc_builder(vm_factory);
-  if (!lir_factory->GenerateMachineCode(&mc_builder, lir_function))
+  if (!lir_factory->GenerateMachineCode(&mc_builder, lir_function,
+                                        optimize_level)) {
     return nullptr;
+  }
   return mc_builder.NewMachineCodeFunction();
 }
 
@@ -344,6 +356,20 @@ std::vector<std::string> SwitchValuesOf(base::StringPiece switch_name) {
       base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
 }
 
+// Loads edge counts from |file_path| into |edge_counts|. Missing file is
+// treated as empty profile.
+void LoadEdgeCounts(const base::FilePath& file_path,
+                    ir::EdgeCounts* edge_counts) {
+  std::ifstream istream(file_path.value().c_str());
+  if (!istream)
+    return;
+  if (edge_counts->Load(&istream))
+    return;
+  std::cerr << "Malformed edge profile " << file_path.value() << std::endl;
+}
+
+const char kEdgeProfile[] = "edge_profile";
+const char kInstrumentEdges[] = "instrument_edges";
 const char kUseHir[] = "use_hir";
 
 }  // namespace
@@ -402,6 +428,7 @@ void Compiler::CompileAndGoInternal() {
   PopulateNamespace(&name_resolver);
 
   std::unique_ptr<lir::Factory> lir_factory(new lir::Factory(this));
+  std::unique_ptr<vm::Factory> vm_factory(new vm::Factory());
   auto lir_function = static_cast<lir::Function*>(nullptr);
   auto has_parameter = false;
   auto has_return_value = false;
@@ -435,6 +462,20 @@ void Compiler::CompileAndGoInternal() {
 
   auto const optimize_level = SwitchValueAsInt("O", 0);
 
+  // --edge_profile=file
+  //    Use edge counts in |file| instead of static branch prediction.
+  // --instrument_edges=file
+  //    Count edges of 'if' in main function and write them into |file|
+  //    after execution.
+  ir::EdgeCounts edge_counts;
+  if (command_line->HasSwitch(kEdgeProfile)) {
+    LoadEdgeCounts(command_line->GetSwitchValuePath(kEdgeProfile),
+                   &edge_counts);
+  }
+  std::vector<std::pair<size_t, size_t>> profiled_edges;
+  auto edge_counters = static_cast<int64_t*>(nullptr);
+  std::string profile_name;
+
   if (!command_line->HasSwitch(kUseHir)) {
     // Compile to Optimizer-IR
     auto const factory_config = NewIrFactoryConfig(session());
@@ -458,11 +499,21 @@ void Compiler::CompileAndGoInternal() {
       return;
 
     // Translate IR to LIR
-    auto const schedule = factory->ComputeSchedule(main_function);
+    profile_name = base::UTF16ToUTF8(main_method->NewQualifiedName());
+    auto const schedule = factory->ComputeSchedule(
+        main_function, edge_counts.CountsOf(profile_name));
     if (ReportIrErrors(factory.get()) || stop_)
       return;
-    lir_function =
-        InstructionSelectionPass(this, lir_factory.get()).Run(schedule.get());
+    InstructionSelectionPass selection_pass(this, lir_factory.get());
+    if (command_line->HasSwitch(kInstrumentEdges)) {
+      profiled_edges = translator::Translator::ProfiledEdgesOf(*schedule);
+      auto const size = std::max(profiled_edges.size(), size_t(1));
+      edge_counters = static_cast<int64_t*>(
+          vm_factory->NewDataBlob(size * sizeof(int64_t)));
+      std::fill(edge_counters, edge_counters + size, 0);
+      selection_pass.set_edge_counters(edge_counters);
+    }
+    lir_function = selection_pass.Run(schedule.get());
     if (ReportLirErrors(lir_factory.get()) || stop_ || !lir_function)
       return;
     has_parameter = !main_function->parameters_type()->is<ir::VoidType>();
@@ -500,9 +551,9 @@ void Compiler::CompileAndGoInternal() {
   }
 
   // Translate LIR to Machine code
-  std::unique_ptr<vm::Factory> vm_factory(new vm::Factory());
   auto const mc_function =
-      GenerateMachineCode(vm_factory.get(), lir_factory.get(), lir_function);
+      GenerateMachineCode(vm_factory.get(), lir_factory.get(), lir_function,
+                          optimize_level);
   if (ReportLirErrors(lir_factory.get()) || stop_ || !mc_function)
     return;
 
@@ -519,6 +570,27 @@ void Compiler::CompileAndGoInternal() {
   }
 
   // Execute
+  Execute(vm_factory.get(), mc_function, has_parameter, has_return_value);
+  if (!edge_counters)
+    return;
+
+  // Write edge counts of training run.
+  for (auto index = 0u; index < profiled_edges.size(); ++index) {
+    auto const& edge = profiled_edges[index];
+    edge_counts.Add(profile_name, edge.first, edge.second,
+                    edge_counters[index]);
+  }
+  auto const profile_path = command_line->GetSwitchValuePath(kInstrumentEdges);
+  std::ofstream ostream(profile_path.value().c_str());
+  edge_counts.Save(&ostream);
+  if (!ostream)
+    std::cerr << "Unable to write " << profile_path.value() << std::endl;
+}
+
+void Compiler::Execute(vm::Factory* vm_factory,
+                       vm::MachineCodeFunction* mc_function,
+                       bool has_parameter,
+                       bool has_return_value) {
   if (!has_parameter) {
     if (has_return_value) {
       exit_code_ = mc_function->Call<int>();
@@ -29,6 +29,10 @@ class Factory;
 namespace optimizer {
 class Factory;
 }
+namespace vm {
+class Factory;
+class MachineCodeFunction;
+}
 namespace compiler {
 class CompilationSession;
 namespace shell {
@@ -56,6 +60,12 @@ class Compiler final : public api::PassController {
 
   void CompileAndGoInternal();
 
+  // Run |mc_function| and set |exit_code_|.
+  void Execute(vm::Factory* vm_factory,
+               vm::MachineCodeFunction* mc_function,
+               bool has_parameter,
+               bool has_return_value);
+
   // Report compilation errors so far.
   bool ReportCompileErrors();
   bool ReportHirErrors(const hir::Factory* factory);
@@ -385,11 +385,11 @@
                                                   \
   V2(0xF20F2A, CVTSI2SD, Vsd, Ed)                 \
   V2(0xF20F2C, CVTTSD2SI, Gd, Wsd)                \
-  V2(0xF20F2C, CVTSD2SI, Gd, Wsd)                 \
+  V2(0xF20F2D, CVTSD2SI, Gd, Wsd)                 \
                                                   \
   V2(0xF30F2A, CVTSI2SS, Vss, Ed)                 \
   V2(0xF30F2C, CVTTSS2SI, Gd, Wss)                \
-  V2(0xF20F2D, CVTSS2SI, Gd, Wss)                 \
+  V2(0xF30F2D, CVTSS2SI, Gd, Wss)                 \
                                                   \
   /* 0x0F40 */                                    \
   V2(0x0F40, CMOVcc, Gv, Ev)                      \
@@ -828,25 +828,26 @@
   V3(0xF20F2A, VCVTSI2SD, Vsd, Hsd, Ey) \
   V3(0xF30F2A, VCVTSI2SS, Vss, Hss, Ey) \
   V2(0xF20F2C, VCVTTSD2SI, Gy, Wsd)     \
-  V2(0xF30F2C, VCVTTSS2SI, Gy, Wsd)     \
+  V2(0xF30F2C, VCVTTSS2SI, Gy, Wss)     \
   V2(0xF20F2D, VCVTSD2SI, Gy, Wsd)      \
-  V2(0xF30F2D, VCVTSS2SI, Gy, Wsd)      \
+  V2(0xF30F2D, VCVTSS2SI, Gy, Wss)      \
   V2(0x0F2E, VUCOMISS, Vss, Wss)        \
-  V2(0x660F2E, VUCOMISD, Vss, Wss)      \
+  V2(0x660F2E, VUCOMISD, Vsd, Wsd)      \
   V2(0x0F2F, VCOMISS, Vss, Wss)         \
-  V2(0x660F2F, VCOMISD, Vss, Wss)       \
+  V2(0x660F2F, VCOMISD, Vsd, Wsd)       \
   /* 50-57 */                           \
   V3(0xF20F51, VSQRTSD, Vsd, Hsd, Wsd)  \
   V3(0xF30F51, VSQRTSS, Vss, Hss, Wss)  \
   V3(0xF30F52, VRSQRTSS, Vss, Hss, Wss) \
   V3(0xF30F53, VRCPSS, Vss, Hss, Wss)   \
+  V3(0x0F57, VXORPS, Vps, Hps, Wps)     \
   /* 58-5F */                           \
   V3(0xF20F58, VADDSD, Vsd, Hsd, Wsd)   \
   V3(0xF30F58, VADDSS, Vss, Hss, Wss)   \
   V3(0xF20F59, VMULSD, Vsd, Hsd, Wsd)   \
   V3(0xF30F59, VMULSS, Vss, Hss, Wss)   \
-  V3(0xF20F5A, VCVTSS2SD, Vss, Hx, Wsd) \
-  V3(0xF30F5A, VCVTSD2SS, Vsd, Hx, Wss) \
+  V3(0xF30F5A, VCVTSS2SD, Vsd, Hx, Wss) \
+  V3(0xF20F5A, VCVTSD2SS, Vss, Hx, Wsd) \
   V3(0xF20F5C, VSUBSD, Vsd, Hsd, Wsd)   \
   V3(0xF30F5C, VSUBSS, Vss, Hss, Wss)   \
   V3(0xF20F5D, VMINSD, Vsd, Hsd, Wsd)   \
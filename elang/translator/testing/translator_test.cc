@@ -57,6 +57,11 @@ std::string TranslatorTest::Format(const lir::Function* function) {
 }
 
 std::string TranslatorTest::Translate(const ir::Editor& editor) {
+  return Translate(editor, nullptr);
+}
+
+std::string TranslatorTest::Translate(const ir::Editor& editor,
+                                      int64_t* edge_counters) {
   if (!editor.Validate()) {
     std::ostringstream ostream;
     ostream << factory()->errors();
@@ -64,6 +69,7 @@ std::string TranslatorTest::Translate(const ir::Editor& editor) {
   }
   auto const schedule = factory_->ComputeSchedule(editor.function());
   Translator translator(lir_factory(), schedule.get());
+  translator.set_edge_counters(edge_counters);
   return TranslatorTest::Format(translator.Run());
 }
 
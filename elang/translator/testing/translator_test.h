@@ -5,6 +5,7 @@
 #ifndef ELANG_TRANSLATOR_TESTING_TRANSLATOR_TEST_H_
 #define ELANG_TRANSLATOR_TESTING_TRANSLATOR_TEST_H_
 
+#include <stdint.h>
 #include <string>
 #include <memory>
 
@@ -53,6 +54,10 @@ class TranslatorTest : public ::testing::Test,
   // Returns formatted LIR function converted from |ir::Editor|.
   std::string Translate(const ir::Editor& editor);
 
+  // Returns formatted LIR function converted from |ir::Editor| with edge
+  // counters instrumentation using |edge_counters|.
+  std::string Translate(const ir::Editor& editor, int64_t* edge_counters);
+
   // Returns new HIR function with specified signature.
   ir::Function* NewFunction(ir::Type* return_type, ir::Type* parameters_type);
 
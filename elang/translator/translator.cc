@@ -25,6 +25,15 @@ namespace translator {
 
 namespace {
 
+lir::FloatCondition MapCondition(ir::FloatCondition condition) {
+#define V(Name, ...)                                                    \
+  DCHECK_EQ(static_cast<ir::FloatCondition>(lir::FloatCondition::Name), \
+            ir::FloatCondition::Name);
+  FOR_EACH_OPTIMIZER_FLOAT_CONDITION(V)
+#undef V
+  return static_cast<lir::FloatCondition>(condition);
+}
+
 lir::IntCondition MapCondition(ir::IntCondition condition) {
 #define V(Name, ...)                                                \
   DCHECK_EQ(static_cast<ir::IntCondition>(lir::IntCondition::Name), \
@@ -38,6 +47,10 @@ lir::Value PromoteType(lir::Value type) {
   return type.is_int8() || type.is_int16() ? lir::Value::Int32Type() : type;
 }
 
+int RoundUp(int num, int unit) {
+  return (num + unit - 1) / unit * unit;
+}
+
 ir::Node* SelectNode(const ir::Node* node, ir::Opcode opcode) {
   for (auto const edge : node->use_edges()) {
     if (edge->from()->opcode() == opcode)
@@ -78,6 +91,7 @@ int SizeOfType(ir::Type* type) {
 //
 Translator::Translator(lir::Factory* factory, const ir::Schedule* schedule)
     : FactoryUser(factory),
+      edge_counters_(nullptr),
       editor_(
           new lir::Editor(factory, NewFunction(factory, schedule->function()))),
       schedule_(*schedule) {
@@ -106,6 +120,26 @@ void Translator::EmitCopy(lir::Value output, lir::Value input) {
   Emit(NewCopyInstruction(output, input));
 }
 
+//  lit %ptr = counter
+//  load %count = %ptr, %ptr, 0
+//  add %count2 = %count, 1
+//  store %ptr, %ptr, 0, %count2
+void Translator::EmitEdgeCounter() {
+  if (!edge_counters_)
+    return;
+  auto const pointer = NewRegister(lir::Value::IntPtrType());
+  Emit(NewLiteralInstruction(
+      pointer, NewIntValue(lir::Value::IntPtrType(),
+                           reinterpret_cast<intptr_t>(edge_counters_))));
+  ++edge_counters_;
+  auto const offset = lir::Value::SmallInt32(0);
+  auto const count = NewRegister(lir::Value::Int64Type());
+  Emit(NewLoadInstruction(count, pointer, pointer, offset));
+  auto const new_count = NewRegister(lir::Value::Int64Type());
+  Emit(NewIntAddInstruction(new_count, count, lir::Value::SmallInt64(1)));
+  Emit(New<lir::StoreInstruction>(pointer, pointer, offset, new_count));
+}
+
 void Translator::EmitSetValue(lir::Value output, ir::Node* node) {
   DCHECK(output.is_register()) << output;
   auto const input = MapInput(node);
@@ -116,21 +150,6 @@ void Translator::EmitSetValue(lir::Value output, ir::Node* node) {
   Emit(NewLiteralInstruction(output, input));
 }
 
-lir::Value Translator::EmitShl(lir::Value input, int shift_count) {
-  DCHECK_GE(shift_count, 0);
-  shift_count &= lir::Value::BitSizeOf(input) - 1;
-  DCHECK_GE(shift_count, 0);
-  if (!shift_count)
-    return input;
-  auto const output = NewRegister(input);
-  if (shift_count == 1) {
-    Emit(NewIntAddInstruction(output, input, input));
-    return output;
-  }
-  Emit(NewShlInstruction(output, input, lir::Value::SmallInt32(shift_count)));
-  return output;
-}
-
 lir::Value Translator::MapInput(ir::Node* node) {
   DCHECK(node->IsData()) << *node;
 
@@ -280,6 +299,17 @@ void Translator::PopulatePhiOperands() {
   }
 }
 
+std::vector<std::pair<size_t, size_t>> Translator::ProfiledEdgesOf(
+    const ir::Schedule& schedule) {
+  std::vector<std::pair<size_t, size_t>> edges;
+  for (auto const node : schedule.nodes()) {
+    if (!node->is<ir::IfTrueNode>() && !node->is<ir::IfFalseNode>())
+      continue;
+    edges.push_back(std::make_pair(node->input(0)->id(), node->id()));
+  }
+  return edges;
+}
+
 void Translator::PrepareBlocks() {
   auto block = static_cast<lir::BasicBlock*>(nullptr);
   auto const exit_block = editor()->exit_block();
@@ -401,7 +431,7 @@ void Translator::VisitIfException(ir::IfExceptionNode* node) {
 }
 
 void Translator::VisitIfFalse(ir::IfFalseNode* node) {
-  // nothing to do
+  EmitEdgeCounter();
 }
 
 void Translator::VisitIfSuccess(ir::IfSuccessNode* node) {
@@ -409,7 +439,7 @@ void Translator::VisitIfSuccess(ir::IfSuccessNode* node) {
 }
 
 void Translator::VisitIfTrue(ir::IfTrueNode* node) {
-  // nothing to do
+  EmitEdgeCounter();
 }
 
 void Translator::VisitJump(ir::JumpNode* node) {
@@ -458,56 +488,63 @@ void Translator::VisitUnreachable(ir::UnreachableNode* node) {
 
 // Simple node 2
 void Translator::VisitElement(ir::ElementNode* node) {
-  auto const indexes = node->input(1)->as<ir::TupleNode>();
-  if (indexes) {
-    // Multiple dimensions array:
-    //   T* %ptr = element %array_ptr, %index...
-    //   =>
-    //   pcopy RCX, RDX, ... = %array_ptr%, %index...
-    //   call `CalculateRowMajorIndex` //   for multiple dimension array
-    //   copy %row_major_index, EAX
-    //   sext %row_major_index64, %row_major_index
-    //   add %element_ptr = %array_ptr, %row_major_index64
-    //   aload %output = %array_ptr, %element_ptr, sizeof(ArrayHeader)
-    // or
-    //   astore %array_ptr, %element_ptr, sizeof(ArrayHeader), %new_value
-    // TODO(eval1749) We need to have helper function to calculate row-major-
-    // index from array type.
-    NOTREACHED() << "NYI: multiple dimension array access" << *node;
-    // Layout of multiple dimensions array object:
-    //  +0 object header
-    //  +8 dimension[0]
-    //  +16 dimension[1]
-    //  ...
-    //  +8*(n+1) element[0]
-  }
-
   // Vector (single dimension array)
   //   T* %ptr = element %array_ptr, %index
   //   =>
-  //   add %element_start = %array_ptr, sizeof(ArrayHeader)
-  //   shl %offset = %index, log2(sizeof(element_type))
-  //   sext %offset64 = %offset
-  //   add %element_ptr = %element_start, %offset64
+  //   sext %index64 = %index
+  //   lea %element_ptr = %array_ptr + %index64 * sizeof(element_type) +
+  //                      sizeof(ArrayHeader)
+  //
+  // Multiple dimensions array: we calculate row-major index by loading
+  // lengths of dimensions from array object.
+  //   T* %ptr = element %array_ptr, (%index0, %index1, ...)
+  //   =>
+  //   load %length1 = %array_ptr, %array_ptr, 12
+  //   mul %row_major1 = %index0, %length1
+  //   add %row_major_index1 = %row_major1, %index1
+  //   ...
+  //   sext %index64 = %row_major_index
+  //   lea %element_ptr = %array_ptr + %index64 * sizeof(element_type) +
+  //                      sizeof(ArrayHeader)
+  //
+  // Note: Strength reduction pass replaces |ElementNode| in loop with
+  // |PointerAddNode|, so we don't calculate row-major index for each
+  // iteration.
   auto const array_pointer = MapInput(node->input(0));
   auto const element_type =
       MapType(node->output_type()->as<ir::PointerType>()->pointee());
+  auto const indexes = node->input(1)->as<ir::TupleNode>();
+  auto const rank = indexes ? static_cast<int>(indexes->CountInputs()) : 1;
 
-  // Layout of vector object:
+  // Layout of array object:
   //  +0 object header
-  //  +8 length
-  //  +16 element[0]
+  //  +8 length[0]
+  //  +12 length[1]
+  //  ...
+  //  +8+(rank-1)*4 length[rank-1]
+  //  +8+rank*4 padding for align(16)
+  //  +8+rank*4+align(16) element[0]
   auto const sizeof_array_header =
-      lir::Value::SmallInt64(lir::Value::SizeOf(lir::Value::IntPtrType()) * 2);
-  auto const element_start = NewRegister(lir::Value::IntPtrType());
-  Emit(NewIntAddInstruction(element_start, array_pointer, sizeof_array_header));
+      RoundUp(lir::Value::SizeOf(lir::Value::IntPtrType()) + rank * 4, 16);
+
+  auto index = MapInput(indexes ? indexes->input(0) : node->input(1));
+  for (auto position = 1; position < rank; ++position) {
+    auto const length = NewRegister(lir::Value::Int32Type());
+    auto const length_offset =
+        lir::Value::SizeOf(lir::Value::IntPtrType()) + position * 4;
+    Emit(NewLoadInstruction(length, array_pointer, array_pointer,
+                            lir::Value::SmallInt32(length_offset)));
+    auto const row_major = NewRegister(lir::Value::Int32Type());
+    Emit(NewIntMulInstruction(row_major, index, length));
+    auto const row_major_index = NewRegister(lir::Value::Int32Type());
+    Emit(NewIntAddInstruction(row_major_index, row_major,
+                              MapInput(indexes->input(position))));
+    index = row_major_index;
+  }
 
   auto const shift_count = lir::Value::Log2Of(element_type) - 3;
-  auto const offset = EmitShl(MapInput(node->input(1)), shift_count);
-  auto const offset64 = NewRegister(lir::Value::IntPtrType());
-  Emit(NewSignExtendInstruction(offset64, offset));
-
-  Emit(NewIntAddInstruction(MapOutput(node), element_start, offset64));
+  EmitAddress(MapOutput(node), array_pointer, index, shift_count,
+              sizeof_array_header);
 }
 
 void Translator::VisitField(ir::FieldNode* node) {
@@ -548,6 +585,21 @@ void Translator::VisitLength(ir::LengthNode* node) {
                           lir::Value::SmallInt32(offset)));
 }
 
+//  T* %ptr = ptr_add T* %pointer, int32 %offset
+//  =>
+//  sext %offset64 = %offset
+//  lea %ptr = %pointer + %offset64 * sizeof(T)
+// or, for literal offset
+//  add %ptr = %pointer, offset * sizeof(T)
+void Translator::VisitPointerAdd(ir::PointerAddNode* node) {
+  auto const pointer = MapInput(node->input(0));
+  auto const element_type =
+      MapType(node->output_type()->as<ir::PointerType>()->pointee());
+  auto const shift_count = lir::Value::Log2Of(element_type) - 3;
+  EmitAddress(MapOutput(node), pointer, MapInput(node->input(1)), shift_count,
+              0);
+}
+
 void Translator::VisitStackAlloc(ir::StackAllocNode* node) {
   // TODO(eval1749): NYI translate StackAlloc
   NOTREACHED() << *node;
@@ -558,9 +610,14 @@ void Translator::VisitSwitch(ir::SwitchNode* node) {
   NOTREACHED() << *node;
 }
 
+// We lower throw into call to runtime function which never returns.
+// TODO(eval1749): Pass exception object to runtime.
 void Translator::VisitThrow(ir::ThrowNode* node) {
-  // TODO(eval1749): NYI translate Throw
-  NOTREACHED() << *node;
+  DCHECK(node->input(1)->is<ir::VoidNode>()) << "NYI: throw value " << *node;
+  auto const callee =
+      NewStringValue(L"System.Void System.Runtime.ThrowException()");
+  Emit(NewCallInstruction(std::vector<lir::Value>(), callee));
+  editor()->SetReturn();
 }
 
 // Arithmetic nodes
@@ -685,9 +742,12 @@ void Translator::VisitCase(ir::CaseNode* node) {
 
 void Translator::VisitTuple(ir::TupleNode* node) {
   // TODO(eval1749): NYI translate Tuple
-  DCHECK(node->SelectUserIfOne()) << *node;
-  DCHECK_EQ(ir::Opcode::Call, node->SelectUserIfOne()->opcode())
-      << *node << " by " << *node->SelectUserIfOne();
+  // Note: |ElementNode| of multiple dimensions array reads indexes from tuple.
+  for (auto const edge : node->use_edges()) {
+    DCHECK(edge->from()->opcode() == ir::Opcode::Call ||
+           edge->from()->opcode() == ir::Opcode::Element)
+        << *node << " by " << *edge->from();
+  }
 }
 
 // Non simple inputs node
@@ -713,8 +773,14 @@ void Translator::VisitEntry(ir::EntryNode* node) {
 }
 
 void Translator::VisitFloatCmp(ir::FloatCmpNode* node) {
-  // TODO(eval1749): NYI translate FloatCmp
-  NOTREACHED() << *node;
+  auto const output = NewConditional();
+  DCHECK(!register_map_.count(node)) << *node;
+  register_map_.insert(std::make_pair(node, output));
+
+  auto const left = MapInput(node->input(0));
+  auto const right = MapInput(node->input(1));
+  Emit(NewFloatCmpInstruction(output, MapCondition(node->condition()), left,
+                              right));
 }
 
 void Translator::VisitFunctionReference(ir::FunctionReferenceNode* node) {
@@ -5,9 +5,13 @@
 #ifndef ELANG_TRANSLATOR_TRANSLATOR_H_
 #define ELANG_TRANSLATOR_TRANSLATOR_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "elang/base/zone_owner.h"
 #include "elang/lir/factory_user.h"
@@ -48,6 +52,16 @@ class Translator final : public ZoneOwner,
 
   lir::Function* Run();
 
+  // Instruments 'if_true' and 'if_false' blocks to increment 64-bit counter
+  // in |counters|, which must be live while generated code runs, in order of
+  // |ProfiledEdgesOf(schedule)|.
+  void set_edge_counters(int64_t* counters) { edge_counters_ = counters; }
+
+  // Returns pairs of node id of 'if' and its 'if_true' or 'if_false' in
+  // |schedule| for counters filled by instrumented code.
+  static std::vector<std::pair<size_t, size_t>> ProfiledEdgesOf(
+      const ir::Schedule& schedule);
+
  private:
   lir::Editor* editor() const { return editor_.get(); }
   lir::Function* function() const;
@@ -55,10 +69,17 @@ class Translator final : public ZoneOwner,
   lir::BasicBlock* BlockOf(ir::Node* node) const;
   void Emit(lir::Instruction* instruction);
   void EmitCopy(lir::Value output, lir::Value input);
+  void EmitEdgeCounter();
   void EmitSetValue(lir::Value output, ir::Node* node);
 
-  // Generate literal or |ShlInstruction|.
-  lir::Value EmitShl(lir::Value input, int shift_count);
+  // Emit instructions to compute |output| = |base| + |index| << |shift_count|
+  // + |displacement|. This function is implemented in target specific file
+  // to use target's addressing mode.
+  void EmitAddress(lir::Value output,
+                   lir::Value base,
+                   lir::Value index,
+                   int shift_count,
+                   int displacement);
 
   lir::Value MapInput(ir::Node* node);
   lir::Value MapLiteral(ir::Node* node);
@@ -82,6 +103,9 @@ class Translator final : public ZoneOwner,
   FOR_EACH_OPTIMIZER_CONCRETE_NODE(V)
 #undef V
 
+  // Pointer to next edge counter for instrumentation, or null.
+  int64_t* edge_counters_;
+
   // A map block start and block end |ir::Node| to |lir::BasicBlock|.
   // For block end nodes in empty blocks, they are mapped to predecessor blocks
   // rather than successor blocks.
@@ -4,8 +4,10 @@
 
 #include "elang/translator/translator.h"
 
+#include "base/logging.h"
 #include "elang/lir/editor.h"
-#include "elang/lir/instructions.h"
+#include "elang/lir/factory.h"
+#include "elang/lir/instructions_x64.h"
 #include "elang/lir/literals.h"
 #include "elang/lir/target.h"
 #include "elang/optimizer/nodes.h"
@@ -15,7 +17,42 @@
 namespace elang {
 namespace translator {
 
-// We don't have x64 specific translators yet.
+// x64 has addressing mode |base + index * scale + disp32| where scale is one of
+// 1, 2, 4 and 8. We use 'lea' instruction instead of computing address with
+// 'shl' and 'add' instructions:
+//   sext %index64 = %index
+//   lea %output = %base + %index64 * (1 << shift_count) + displacement
+// or, for immediate |index|:
+//   add %output = %base, (index << shift_count) + displacement
+void Translator::EmitAddress(lir::Value output,
+                             lir::Value base,
+                             lir::Value index,
+                             int shift_count,
+                             int displacement) {
+  DCHECK_GE(shift_count, 0);
+  DCHECK_LE(shift_count, 3);
+  auto const intptr_type = lir::Value::IntPtrType();
+  if (index.is_immediate()) {
+    auto const offset =
+        (static_cast<int64_t>(index.data) << shift_count) + displacement;
+    Emit(NewIntAddInstruction(output, base, NewIntValue(intptr_type, offset)));
+    return;
+  }
+
+  auto index_register = index;
+  if (!index.is_register()) {
+    index_register = NewRegister(index);
+    Emit(NewLiteralInstruction(index_register, index));
+  }
+  auto index64 = index_register;
+  if (index64.size != intptr_type.size) {
+    index64 = NewRegister(intptr_type);
+    Emit(NewSignExtendInstruction(index64, index_register));
+  }
+  Emit(factory()->NewLeaX64Instruction(
+      output, base, index64, lir::Value::SmallInt32(1 << shift_count),
+      lir::Value::SmallInt32(displacement)));
+}
 
 }  // namespace translator
 }  // namespace elang
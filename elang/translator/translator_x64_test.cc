@@ -2,13 +2,20 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+#include <utility>
+
 #include "elang/translator/testing/translator_test.h"
 
+#include "base/strings/string_number_conversions.h"
+
 #include "elang/optimizer/editor.h"
 #include "elang/optimizer/factory.h"
 #include "elang/optimizer/function.h"
 #include "elang/optimizer/nodes.h"
+#include "elang/optimizer/scheduler/schedule.h"
 #include "elang/optimizer/types.h"
+#include "elang/translator/translator.h"
 
 namespace elang {
 namespace translator {
@@ -136,7 +143,7 @@ TEST_F(TranslatorX64Test, ElementNode) {
 
   editor.Edit(entry_node);
   auto const array = NewParameter(entry_node, 0);
-  editor.SetRet(effect, NewElement(array, NewInt32(42)));
+  editor.SetRet(effect, NewElement(array, NewInt32(42), entry_node));
   ASSERT_EQ("", Commit(&editor));
   EXPECT_EQ(
       "function1:\n"
@@ -145,10 +152,41 @@ TEST_F(TranslatorX64Test, ElementNode) {
       "  // Out: {block2}\n"
       "  entry RCX =\n"
       "  pcopy %r1l = RCX\n"
-      "  add %r2l = %r1l, 16l\n"
-      "  shl %r3 = 42, 2\n"
-      "  sext %r4l = %r3\n"
-      "  add %r5l = %r2l, %r4l\n"
+      "  add %r2l = %r1l, 184l\n"
+      "  mov RAX = %r2l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      Translate(editor));
+}
+
+TEST_F(TranslatorX64Test, ElementNodeTwoDimensions) {
+  auto const function =
+      NewFunction(NewPointerType(int32_type()),
+                  NewPointerType(NewArrayType(int32_type(), {-1, -1})));
+  ir::Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const array = NewParameter(entry_node, 0);
+  editor.SetRet(effect, NewElement(array, NewTuple({NewInt32(3), NewInt32(4)}),
+                                   entry_node));
+  ASSERT_EQ("", Commit(&editor));
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX =\n"
+      "  pcopy %r1l = RCX\n"
+      "  load %r2 = %r1l, %r1l, 12\n"
+      "  mul %r3 = 3, %r2\n"
+      "  add %r4 = %r3, 4\n"
+      "  sext %r6l = %r4\n"
+      "  lea_x64 %r5l = %r1l, %r6l, 4, 16\n"
       "  mov RAX = %r5l\n"
       "  ret block2\n"
       "block2:\n"
@@ -375,6 +413,80 @@ TEST_F(TranslatorX64Test, IfNode) {
       Translate(editor));
 }
 
+// 'if_true' and 'if_false' blocks increment counters in order of
+// |Translator::ProfiledEdgesOf()|.
+TEST_F(TranslatorX64Test, IfNodeEdgeCounters) {
+  auto const function = NewFunction(int32_type(), int32_type());
+  ir::Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const param0 = NewParameter(entry_node, 0);
+  auto const condition =
+      NewIntCmp(ir::IntCondition::SignedLessThan, param0, NewInt32(42));
+  auto const if_node = editor.SetBranch(condition);
+  ASSERT_EQ("", Commit(&editor));
+
+  auto const if_true = NewIfTrue(if_node);
+  editor.Edit(if_true);
+  editor.SetRet(effect, NewInt32(12));
+  ASSERT_EQ("", Commit(&editor));
+
+  auto const if_false = NewIfFalse(if_node);
+  editor.Edit(if_false);
+  editor.SetRet(effect, NewInt32(34));
+  ASSERT_EQ("", Commit(&editor));
+
+  auto const schedule = factory()->ComputeSchedule(function);
+  auto const edges = Translator::ProfiledEdgesOf(*schedule);
+  ASSERT_EQ(2u, edges.size());
+  EXPECT_EQ(std::make_pair(if_node->id(), if_true->id()), edges[0]);
+  EXPECT_EQ(std::make_pair(if_node->id(), if_false->id()), edges[1]);
+
+  int64_t counters[2] = {0};
+  auto const counter0 =
+      base::Int64ToString(reinterpret_cast<intptr_t>(&counters[0]));
+  auto const counter1 =
+      base::Int64ToString(reinterpret_cast<intptr_t>(&counters[1]));
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block3, block4}\n"
+      "  entry ECX =\n"
+      "  pcopy %r1 = ECX\n"
+      "  cmp_lt %b2 = %r1, 42\n"
+      "  br %b2, block3, block4\n"
+      "block3:\n"
+      "  // In: {block1}\n"
+      "  // Out: {block2}\n"
+      "  lit %r2l = " +
+          counter0 +
+          "l\n"
+          "  load %r3l = %r2l, %r2l, 0\n"
+          "  add %r4l = %r3l, 1l\n"
+          "  store %r2l, %r2l, 0, %r4l\n"
+          "  lit EAX = 12\n"
+          "  ret block2\n"
+          "block4:\n"
+          "  // In: {block1}\n"
+          "  // Out: {block2}\n"
+          "  lit %r5l = " +
+          counter1 +
+          "l\n"
+          "  load %r6l = %r5l, %r5l, 0\n"
+          "  add %r7l = %r6l, 1l\n"
+          "  store %r5l, %r5l, 0, %r7l\n"
+          "  lit EAX = 34\n"
+          "  ret block2\n"
+          "block2:\n"
+          "  // In: {block3, block4}\n"
+          "  // Out: {}\n"
+          "  exit\n",
+      Translate(editor, counters));
+}
+
 #define DEFINE_INT_ARITHMETIC_TEST(Name, mnemonic)                 \
   TEST_F(TranslatorX64Test, Name##Node) {                          \
     auto const function = NewFunction(int32_type(), int32_type()); \
@@ -558,6 +670,37 @@ TEST_F(TranslatorX64Test, PhiNode) {
       Translate(editor));
 }
 
+TEST_F(TranslatorX64Test, PointerAddNode) {
+  auto const function =
+      NewFunction(NewPointerType(int32_type()),
+                  NewTupleType({NewPointerType(int32_type()), int32_type()}));
+  ir::Editor editor(factory(), function);
+  auto const entry_node = function->entry_node();
+  auto const effect = NewGetEffect(entry_node);
+
+  editor.Edit(entry_node);
+  auto const pointer = NewParameter(entry_node, 0);
+  auto const offset = NewParameter(entry_node, 1);
+  editor.SetRet(effect, NewPointerAdd(pointer, offset));
+  ASSERT_EQ("", Commit(&editor));
+  EXPECT_EQ(
+      "function1:\n"
+      "block1:\n"
+      "  // In: {}\n"
+      "  // Out: {block2}\n"
+      "  entry RCX, EDX =\n"
+      "  pcopy %r1l, %r2 = RCX, EDX\n"
+      "  sext %r4l = %r2\n"
+      "  lea_x64 %r3l = %r1l, %r4l, 4, 0\n"
+      "  mov RAX = %r3l\n"
+      "  ret block2\n"
+      "block2:\n"
+      "  // In: {block1}\n"
+      "  // Out: {}\n"
+      "  exit\n",
+      Translate(editor));
+}
+
 #define DEFINE_RET_TEST(Name, name, value, line)                   \
   TEST_F(TranslatorX64Test, Ret##Name) {                           \
     auto const function = NewFunction(name##_type(), void_type()); \
@@ -7,6 +7,7 @@
 #include "elang/vm/machine_code_builder_impl.h"
 
 #include "base/logging.h"
+#include "base/macros.h"
 #include "elang/base/atomic_string.h"
 #include "elang/base/castable.h"
 #include "elang/base/zone_allocated.h"
@@ -33,6 +34,9 @@ class MachineCodeBuilderImpl::CodeBuffer final {
   size_t size() const { return bytes_.size(); }
 
   void Append(const uint8_t* bytes, size_t size);
+  uint8_t* Reserve(size_t size);
+  void SetInt32(size_t offset, int32_t data);
+  void SetInt64(size_t offset, int64_t data);
   void SetRelativeAddress32(size_t offset, const uint8_t* address);
 
  private:
@@ -54,6 +58,26 @@ void MachineCodeBuilderImpl::CodeBuffer::Append(const uint8_t* bytes,
   size_ = new_size;
 }
 
+uint8_t* MachineCodeBuilderImpl::CodeBuffer::Reserve(size_t size) {
+  auto const new_size = size_ + size;
+  DCHECK_LE(new_size, bytes_.size());
+  auto const bytes = const_cast<uint8_t*>(bytes_.bytes()) + size_;
+  size_ = new_size;
+  return bytes;
+}
+
+void MachineCodeBuilderImpl::CodeBuffer::SetInt32(size_t offset,
+                                                  int32_t data) {
+  DCHECK_LE(offset + 4, size_);
+  bytes_.SetInt32(offset, data);
+}
+
+void MachineCodeBuilderImpl::CodeBuffer::SetInt64(size_t offset,
+                                                  int64_t data) {
+  DCHECK_LE(offset + 8, size_);
+  bytes_.SetInt64(offset, data);
+}
+
 void MachineCodeBuilderImpl::CodeBuffer::SetRelativeAddress32(
     size_t offset,
     const uint8_t* address) {
@@ -92,6 +116,11 @@ void MachineCodeBuilderImpl::PrepareCode(size_t size) {
   code_buffer_.reset(new CodeBuffer(bytes, size));
 }
 
+uint8_t* MachineCodeBuilderImpl::ReserveCode(size_t size) {
+  PrepareCode(size);
+  return code_buffer_->Reserve(size);
+}
+
 void MachineCodeBuilderImpl::SetCallSite(size_t offset,
                                          base::StringPiece16 string) {
   auto const name = factory_->NewAtomicString(string);
@@ -107,15 +136,19 @@ void MachineCodeBuilderImpl::SetCodeOffset(size_t offset,
 }
 
 void MachineCodeBuilderImpl::SetFloat32(size_t offset, float32_t data) {
+  code_buffer_->SetInt32(offset, bit_cast<int32_t>(data));
 }
 
 void MachineCodeBuilderImpl::SetFloat64(size_t offset, float64_t data) {
+  code_buffer_->SetInt64(offset, bit_cast<int64_t>(data));
 }
 
 void MachineCodeBuilderImpl::SetInt32(size_t offset, int32_t data) {
+  code_buffer_->SetInt32(offset, data);
 }
 
 void MachineCodeBuilderImpl::SetInt64(size_t offset, int64_t data) {
+  code_buffer_->SetInt64(offset, data);
 }
 
 void MachineCodeBuilderImpl::SetSourceCodeLocation(
@@ -37,6 +37,7 @@ class MachineCodeBuilderImpl final : public api::MachineCodeBuilder {
   void EmitCode(const uint8_t* bytes, size_t code_size) final;
   void FinishCode() final;
   void PrepareCode(size_t code_size) final;
+  uint8_t* ReserveCode(size_t code_size) final;
   void SetCallSite(size_t offset, base::StringPiece16 string) final;
   void SetCodeOffset(size_t offset, size_t target_offset) final;
   void SetFloat32(size_t offset, float32_t float32) final;
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
 #include <array>
 #include <memory>
 #include <sstream>
@@ -55,5 +57,27 @@ TEST_F(MachineCodeBuilderImplTest, Basic) {
   EXPECT_EQ(123, function->Call<int>());
 }
 
+TEST_F(MachineCodeBuilderImplTest, ReserveCode) {
+  auto const builder = static_cast<api::MachineCodeBuilder*>(builder_impl());
+#if ELANG_TARGET_ARCH_X64
+  std::array<uint8_t, 6> bytes{
+      0xB8,  // mov eax, imm32
+      0x00,
+      0x00,
+      0x00,
+      0x00,
+      0xC3,  // ret
+  };
+#else
+#error "You should provide machine code for ReserveCode test"
+#endif
+  auto const code = builder->ReserveCode(bytes.size());
+  ::memcpy(code, bytes.data(), bytes.size());
+  builder->SetInt32(1, 456);
+  builder->FinishCode();
+  auto const function = builder_impl()->NewMachineCodeFunction();
+  EXPECT_EQ(456, function->Call<int>());
+}
+
 }  // namespace vm
 }  // namespace elang
@@ -25,6 +25,12 @@ void ConsoleWriteLineString(impl::String* string) {
   std::cout << base::UTF16ToUTF8(data.as_string()) << std::endl;
 }
 
+// TODO(eval1749) We should unwind stack to exception handler once we
+// support exception object and try-catch statement.
+void RuntimeThrowException() {
+  LOG(FATAL) << "Unhandled exception";
+}
+
 }  // namespace
 
 MachineCodeCollection::MachineCodeCollection(Factory* factory)
@@ -32,6 +38,9 @@ MachineCodeCollection::MachineCodeCollection(Factory* factory)
   InstallPredefinedFunction(
       factory, "System.Void System.Console.WriteLine(System.String)",
       reinterpret_cast<uintptr_t>(&ConsoleWriteLineString));
+  InstallPredefinedFunction(
+      factory, "System.Void System.Runtime.ThrowException()",
+      reinterpret_cast<uintptr_t>(&RuntimeThrowException));
 }
 
 MachineCodeCollection::~MachineCodeCollection() {